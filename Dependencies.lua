@@ -39,10 +39,13 @@ Library["ShaderC_Debug"]			= "%{LibraryDir.VulkanSDK_Debug}/shaderc_sharedd.lib"
 Library["SPIRV_cross_Debug"]		= "%{LibraryDir.VulkanSDK_Debug}/spirv-cross-cored.lib"
 Library["SPIRV_cross_glsl_Debug"]	= "%{LibraryDir.VulkanSDK_Debug}/spirv-cross-glsld.lib"
 Library["SPIRV_Tools_Debug"]		= "%{LibraryDir.VulkanSDK_Debug}/spirv-Toolsd.lib"
+Library["SPIRV_Tools_opt_Debug"]	= "%{LibraryDir.VulkanSDK_Debug}/SPIRV-Tools-optd.lib"
 
 Library["ShaderC_Release"]			= "%{LibraryDir.VulkanSDK}/shaderc_shared.lib"
 Library["SPIRV_cross_Release"]		= "%{LibraryDir.VulkanSDK}/spirv-cross-core.lib"
 Library["SPIRV_cross_glsl_Release"]	= "%{LibraryDir.VulkanSDK}/spirv-cross-glsl.lib"
+Library["SPIRV_Tools_Release"]		= "%{LibraryDir.VulkanSDK}/SPIRV-Tools.lib"
+Library["SPIRV_Tools_opt_Release"]	= "%{LibraryDir.VulkanSDK}/SPIRV-Tools-opt.lib"
 
 
 
@@ -59,6 +59,7 @@ void main()
 #version 460
 #extension GL_ARB_shader_draw_parameters : enable
 #extension GL_EXT_shader_explicit_arithmetic_types_int64 : enable
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) out vec4 color;
 
@@ -101,13 +102,18 @@ layout(std140, set = 1, binding = 0) readonly buffer ObjectData
 
 //layout(binding = 0) uniform sampler2D u_Textures[32];
 layout(set = 2, binding = 0) uniform sampler u_Sampler;
-layout(set = 2, binding = 1) uniform texture2D u_Textures[32];
+layout(set = 2, binding = 1) uniform texture2D u_Textures[];
 
 void main()
 {
 	vec4 texColor = Input.Color;
-	texColor *= texture(sampler2D(u_Textures[int(v_TexID)], u_Sampler), Input.TexCoord * 1.0f);	
+	texColor *= texture(sampler2D(u_Textures[nonuniformEXT(int(v_TexID))], u_Sampler), Input.TexCoord * 1.0f);	
 	color = vec4(texColor.rgb + u_Scene.AmbientColor.rgb * u_Scene.AmbientColor.a, texColor.a);	
+#ifdef PX_FOG
+	// 1 / w is the view depth of the fragment, FogDistance.x is where the fog starts and FogDistance.y where it is opaque
+	float fog = clamp((1.0f / gl_FragCoord.w - u_Scene.FogDistance.x) / max(u_Scene.FogDistance.y - u_Scene.FogDistance.x, 0.0001f), 0.0f, 1.0f);
+	color.rgb = mix(color.rgb, u_Scene.FogColor.rgb, fog * u_Scene.FogColor.a);
+#endif
 	
 	
 	//entityID = v_EntityID;
@@ -0,0 +1,103 @@
+#type vertex
+#version 460
+#extension GL_ARB_shader_draw_parameters : enable
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : enable
+
+// No vertex input, every quad is expanded from its instance record
+layout(std140, set = 0, binding = 0) uniform CameraData
+{
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+} u_Camera;
+
+layout(std140, set = 0, binding = 1) uniform SceneData
+{
+	vec4 FogColor;
+	vec4 FogDistance;
+	vec4 AmbientColor;
+	vec4 SunlightDirection;
+	vec4 SunlightColor;
+} u_Scene;
+
+struct QuadInstance
+{
+	vec4 AxisX;			// xyz: first transform column, w: tiling factor
+	vec4 AxisY;			// xyz: second transform column, w: bits of the bindless texture index
+	vec3 Translation;
+	uint Color;			// RGBA8
+};
+layout(std430, set = 1, binding = 0) readonly buffer QuadInstanceData
+{
+	QuadInstance Instances[];
+} b_Instances;
+
+struct VertexOutput
+{
+	vec4 Color;
+	vec2 TexCoord;
+};
+
+layout(location = 0) out VertexOutput Output;
+layout(location = 2) out flat float o_TexID;
+
+const vec2 c_Corners[4] = vec2[](vec2(-0.5f, -0.5f), vec2(0.5f, -0.5f), vec2(0.5f, 0.5f), vec2(-0.5f, 0.5f));
+const vec2 c_TexCoords[4] = vec2[](vec2(0.0f, 0.0f), vec2(1.0f, 0.0f), vec2(1.0f, 1.0f), vec2(0.0f, 1.0f));
+const uint c_Indices[6] = uint[](0, 1, 2, 2, 3, 0);
+
+void main()
+{
+	QuadInstance instance = b_Instances.Instances[gl_InstanceIndex];
+	uint corner = c_Indices[gl_VertexIndex];
+
+	vec3 position = instance.AxisX.xyz * c_Corners[corner].x + instance.AxisY.xyz * c_Corners[corner].y + instance.Translation;
+
+	Output.Color = unpackUnorm4x8(instance.Color);
+	Output.TexCoord = c_TexCoords[corner] * instance.AxisX.w;
+	o_TexID = float(floatBitsToUint(instance.AxisY.w));
+
+	gl_Position = u_Camera.ViewProjection * vec4(position, 1.0f);
+}
+
+#type fragment
+#version 460
+#extension GL_ARB_shader_draw_parameters : enable
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : enable
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 color;
+
+struct VertexInput
+{
+	vec4 Color;
+	vec2 TexCoord;
+};
+
+layout(location = 0) in VertexInput Input;
+layout(location = 2) in flat float v_TexID;
+
+layout(std140, set = 0, binding = 0) uniform CameraData
+{
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+} u_Camera;
+
+layout(std140, set = 0, binding = 1) uniform SceneData
+{
+	vec4 FogColor;
+	vec4 FogDistance;
+	vec4 AmbientColor;
+	vec4 SunlightDirection;
+	vec4 SunlightColor;
+} u_Scene;
+
+layout(set = 2, binding = 0) uniform sampler u_Sampler;
+layout(set = 2, binding = 1) uniform texture2D u_Textures[];
+
+void main()
+{
+	vec4 texColor = Input.Color;
+	texColor *= texture(sampler2D(u_Textures[nonuniformEXT(int(v_TexID))], u_Sampler), Input.TexCoord);
+	color = vec4(texColor.rgb + u_Scene.AmbientColor.rgb * u_Scene.AmbientColor.a, texColor.a);
+}
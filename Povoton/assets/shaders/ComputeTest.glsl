@@ -39,7 +39,8 @@ layout(std140, set = 1, binding = 1) buffer ParticleSSBOOut
 
 //layout(set = 2, binding = 0, rgba8) uniform writeonly image2D DistanceField;
 
-layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+// Defaults to 1, specialized through ComputePipelineSpecification::WorkGroupSize
+layout (local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
 
 void main() 
 {
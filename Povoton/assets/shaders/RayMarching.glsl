@@ -108,15 +108,18 @@ vec3 Phongg(in vec3 viewDir, in vec3 hitPos, in vec3 lightPos, in vec3 normal, i
 	//return ambientLight + diffuseLight + specularLight;
 }
 
-const float MAX_STEPS = 128;
-const float HIT_DISTANCE = 0.5;
-const float MAX_DISTANCE = 1000.0;
+// Specialized per pipeline, see PipelineSpecification::SpecializationConstants
+layout(constant_id = 0) const int MAX_STEPS = 128;
+layout(constant_id = 1) const float HIT_DISTANCE = 0.5;
+layout(constant_id = 2) const float MAX_DISTANCE = 1000.0;
 
 const vec2 SPECULAR = vec2(0.5, 2.0);
 const vec3 LIGHT = vec3(0.0, 5.0, 0.0);
 
-vec3 RayMarch(in Ray currentRay)
+// Distance along the ray to the hit, MAX_DISTANCE if nothing was hit
+vec3 RayMarch(in Ray currentRay, out float hitDistance)
 {
+	hitDistance = MAX_DISTANCE;
 	Particle nearestParticle;
 	float shortestDist = 10000.0;
 	float totalDistanceTraveled = 0.0;
@@ -135,6 +138,7 @@ vec3 RayMarch(in Ray currentRay)
 				if(currentDist <= HIT_DISTANCE)
 				{
 					vec3 normal = CalculateSurfaceNormal(currentRay.Position, nearestParticle.PositionRadius);
+					hitDistance = length(currentRay.Position - currentRay.Origin);
 					return Phongg(currentRay.Direction, currentRay.Position, LIGHT, normal, vec4(u_RayMarching.BackgroundColor.rgb, 0.8), SPECULAR, vec4(nearestParticle.Color.rgb, 0.3));			
 				}
 			}
@@ -172,6 +176,9 @@ void main()
 	currentRay.Direction = CalculateDirection(currentRay.Origin, v_UV, u_Camera.Forward.xyz, u_Camera.FOV, u_RayMarching.ResolutionTime.xy);
 	
 	//finalColor = vec4(SphereSDF, 1.0);
-	finalColor = vec4(RayMarch(currentRay), 1.0);
+	float hitDistance;
+	finalColor = vec4(RayMarch(currentRay, hitDistance), 1.0);
+	// Linear in the ray distance, just below the cleared depth for misses so they still pass the LESS test
+	gl_FragDepth = min(hitDistance / MAX_DISTANCE, 1.0 - epsilon);
 	//finalColor = vec4(1.0);
 }
\ No newline at end of file
@@ -16,8 +16,9 @@ namespace Povox {
 		//Povox::Renderer::GetShaderManager()->Add("ComputeTest", Povox::Shader::Create(std::filesystem::path("assets/shaders/ComputeTest.glsl")));
 		//Povox::Renderer::GetShaderManager()->Add("RayMarching", Povox::Shader::Create(std::filesystem::path("assets/shaders/RayMarching.glsl")));
 
-		m_ComputeShaderHandle = Povox::Renderer::GetShaderManager()->Load("ComputeTest.glsl");
-		m_RayMarchingShaderHandle = Povox::Renderer::GetShaderManager()->Load("RayMarching.glsl");
+		std::vector<ShaderHandle> handles = Povox::Renderer::GetShaderManager()->LoadAll({ "ComputeTest.glsl", "RayMarching.glsl" });
+		m_ComputeShaderHandle = handles[0];
+		m_RayMarchingShaderHandle = handles[1];
 	}
 
 
@@ -47,13 +48,12 @@ namespace Povox {
 
 
 		// Renderpass chaining
-		// Renderpasses are chained via Predecessor and Successor (Normal and Compute) ( TODO: make them more general with proper abstraction)
-		// They can be set via SetPre/Successors() to chain them together or via the specification. The renderer will then take care of the synchronization of attached descriptor resources between
-		// the passes.
-		// ( The first pass that runs won't have a predecessor, but the last will contain the first as successor )
+		// Passes are added to a RenderGraph, which orders them by the resources they bind as in- and outputs and takes care of the
+		// synchronization of those resources between the passes (and queues).
+		// Only passes contributing to an output pass run.
 		//
 		// Example:
-		//			DistanceField compute pass happens before the RayMarching render
+		//			ParticleMovement compute pass writes the ParticleSSBO, so it happens before the RayMarching render reading it
 
 		m_CameraData = Povox::CreateRef<Povox::UniformBuffer>(Povox::BufferLayout({
 			{ Povox::ShaderDataType::Mat4, "View" },
@@ -72,10 +72,12 @@ namespace Povox {
 			"RayMarchingUBO"			
 			);
 
+		// Shared by the compute and graphics queue: the simulation writes one half while the ray marching reads the other
 		m_ParticleSSBO = Povox::CreateRef<Povox::StorageBufferDynamic>(m_Specification.ParticleLayout, 
 			1024*1024,
 			"ParticleDataSSBO",
-			false);
+			false,
+			true);
 
 
 		ImageSpecification distanceFieldSpec{};
@@ -132,7 +134,10 @@ namespace Povox {
 		{
 			FramebufferSpecification framebufferSpecs{};
 			framebufferSpecs.DebugName = "RaymarchingFramebuffer";
-			framebufferSpecs.Attachments = { {ImageFormat::RGBA8} };
+			// The depth of the ray marched hits is only tested within the pass, so the graph may alias it
+			FramebufferAttachmentSpecification depthAttachment{ ImageFormat::Depth };
+			depthAttachment.Transient = true;
+			framebufferSpecs.Attachments = { {ImageFormat::RGBA8}, depthAttachment };
 			framebufferSpecs.Width = m_Specification.ViewportWidth;
 			framebufferSpecs.Height = m_Specification.ViewportHeight;			
 			m_RayMarchingFramebuffer = Framebuffer::Create(framebufferSpecs);
@@ -166,12 +171,23 @@ namespace Povox {
 			m_RayMarchingRenderpass->Bake();
 
 			//m_RayMarchingPipeline->PrintShaderLayout();
+		}
 
-			//TODO: this should be done in a RenderGraph(manager)
-			m_RayMarchingRenderpass->SetPredecessor(m_DistanceFieldComputePass);
-			m_RayMarchingRenderpass->SetSuccessor(m_DistanceFieldComputePass);
-			m_DistanceFieldComputePass->SetPredecessor(m_RayMarchingRenderpass);
-			m_DistanceFieldComputePass->SetSuccessor(m_RayMarchingRenderpass);
+		// RenderGraph
+		{
+			RenderGraphSpecification graphSpecs{};
+			graphSpecs.DebugName = "SciParticleRenderGraph";
+			m_RenderGraph = RenderGraph::Create(graphSpecs);
+
+			m_RenderGraph->AddPass(m_RayMarchingRenderpass, [this]()
+				{
+					Renderer::Draw(m_FullscreenQuadVertexBuffer, m_RayMarchingMaterial, m_FullscreenQuadIndexBuffer, 6, true);
+				});
+			m_RenderGraph->AddPass(m_DistanceFieldComputePass);
+			m_RenderGraph->MarkOutput(m_RayMarchingRenderpass);
+			// Enabled once a particle set is uploaded and simulated
+			m_RenderGraph->SetPassEnabled(m_DistanceFieldComputePass, false);
+			m_RenderGraph->Compile();
 		}
 
 		// Fullscreen
@@ -230,15 +246,17 @@ namespace Povox {
 		m_DeltaTimne = deltaTime;
 
 
-		for(auto& [name, set] : m_LoadedParticleSets)
+		// The particle data is still on its way to the GPU
+		bool simulate = Renderer::IsUploadComplete(m_ParticleUpload);
+		if (simulate)
 		{
-			if (set->GetSpecifications().GPUSimulationActive)
-			{
-				//Renderer::StartTimestampQuery("ParticleMovementComputePass");
-				Renderer::DispatchCompute(m_DistanceFieldComputePass);
-				//Renderer::StopTimestampQuery("ParticleMovementComputePass");
-			}
+			simulate = false;
+			for (auto& [name, set] : m_LoadedParticleSets)
+				simulate |= set->GetSpecifications().GPUSimulationActive;
 		}
+		// Dispatched by the RenderGraph in End. It writes the next step into ParticleSSBOOut while the ray marching still reads the current one
+		m_Simulating = simulate;
+		m_RenderGraph->SetPassEnabled(m_DistanceFieldComputePass, simulate);
 	}
 
 	void SciParticleRenderer::OnResize(uint32_t width, uint32_t height)
@@ -265,6 +283,9 @@ namespace Povox {
 
 		// RayMarching
 		m_RayMarchingRenderpass->Recreate(width, height);
+
+		// The framebuffer's images were recreated, transient ones have to be placed again
+		m_RenderGraph->Compile();
 	}
 
 
@@ -302,7 +323,7 @@ namespace Povox {
 
 
 		m_ParticleSSBO->AddDescriptor("ParticleSSBOIn", set->GetSize(), StorageBufferDynamic::FrameBehaviour::FRAME_SWAP_IN_OUT, 0, "ParticleSSBOOut");
-		m_ParticleSSBO->SetDescriptorData("ParticleSSBOIn", set->GetDataBuffer(), set->GetSize(), 0);
+		m_ParticleUpload = m_ParticleSSBO->SetDescriptorDataAsync("ParticleSSBOIn", set->GetDataBuffer(), set->GetSize(), 0);
 		m_ParticleSSBO->AddDescriptor("ParticleSSBOOut", set->GetSize(), StorageBufferDynamic::FrameBehaviour::FRAME_SWAP_IN_OUT, 1, "ParticleSSBOIn");
 		m_ParticleSSBO->SetDescriptorData("ParticleSSBOOut", nullptr, 0, 0);
 
@@ -320,15 +341,13 @@ namespace Povox {
 		uint32_t currentFrameIndex = Renderer::GetCurrentFrameIndex();
 		auto cmd = Renderer::GetCommandBuffer(currentFrameIndex);
 		Renderer::BeginCommandBuffer(cmd);
-		Renderer::StartTimestampQuery("RaymarchingRenderpass");
-		Renderer::BeginRenderPass(m_RayMarchingRenderpass);
-
-		Renderer::Draw(m_FullscreenQuadVertexBuffer, m_RayMarchingMaterial, m_FullscreenQuadIndexBuffer, 6, true);
-
-		Renderer::EndRenderPass();
-		Renderer::StopTimestampQuery("RaymarchingRenderpass");
+		m_RenderGraph->Execute();
 		Renderer::EndCommandBuffer();
 
+		// The step just dispatched is read by the next frame, which simulates the one after it in the other half
+		if (m_Simulating)
+			m_ParticleSSBO->SwapInOut();
+
 		m_FinalImage = m_RayMarchingFramebuffer->GetColorAttachment(0);
 	}
 
@@ -338,7 +357,7 @@ namespace Povox {
 	void SciParticleRenderer::DrawParticleSet(Povox::Ref<SciParticleSet> particleSet, uint32_t maxParticleDraws)
 	{	
 		m_RayMarchingUniform.ResolutionTime.z = m_DeltaTimne;
-		m_RayMarchingUniform.ParticleCount = maxParticleDraws;
+		m_RayMarchingUniform.ParticleCount = Renderer::IsUploadComplete(m_ParticleUpload) ? maxParticleDraws : 0;
 		//m_RayMarchingUniform.ParticleCount = particleSet->GetParticleCount();
 
 		m_RayMarchingData->SetData((void*)&m_RayMarchingUniform, sizeof(RayMarchingUniform));
@@ -54,6 +54,7 @@ namespace Povox {
 		inline const Povox::Ref<Povox::Image2D> GetFinalImage() const { return m_FinalImage; }
 
 		const SciParticleRendererStatistics& GetStatistics() const { return m_Statistics; }
+		inline const Povox::TransientMemoryStatistics& GetTransientMemoryStatistics() const { return m_RenderGraph->GetTransientMemoryStatistics(); }
 		void ResetStatistics();
 
 	private:
@@ -75,6 +76,10 @@ namespace Povox {
 		Povox::Ref<Povox::StorageImage> m_DistanceField = nullptr;
 
 		std::unordered_map<std::string, Povox::Ref<SciParticleSet>> m_LoadedParticleSets;
+		Povox::UploadHandle m_ParticleUpload{};
+		bool m_Simulating = false;
+
+		Povox::Ref<Povox::RenderGraph> m_RenderGraph = nullptr;
 
 		// Particles
 		// Compute
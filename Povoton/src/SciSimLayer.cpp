@@ -253,6 +253,16 @@ namespace Povox {
 				ImGui::Text(caption.c_str(), timeInMS);
 			}
 			ImGui::Separator();
+			Povox::BufferPoolStatistics poolStats = Povox::Renderer::GetBufferPool()->GetStatistics();
+			ImGui::Text("BufferPool: %u allocations in %u buffers", poolStats.AllocationCount, poolStats.BackingBufferCount);
+			ImGui::Text("BufferPool used: %.2fMB of %.2fMB", poolStats.UsedBytes / (1024.0 * 1024.0), poolStats.ReservedBytes / (1024.0 * 1024.0));
+			ImGui::Text("BufferPool fragmentation: %.1f%% (%u free ranges)", poolStats.Fragmentation * 100.0f, poolStats.FreeRangeCount);
+			ImGui::Separator();
+			const Povox::TransientMemoryStatistics& transientStats = m_SciRenderer->GetTransientMemoryStatistics();
+			ImGui::Text("Transient images: %u aliased in %u allocations, %.2fMB instead of %.2fMB", transientStats.ImageCount, transientStats.AllocationCount,
+				transientStats.AllocatedBytes / (1024.0 * 1024.0), transientStats.RequiredBytes / (1024.0 * 1024.0));
+			ImGui::Text("Transient images: %u unaliased, %.2fMB", transientStats.UnaliasedImageCount, transientStats.UnaliasedBytes / (1024.0 * 1024.0));
+			ImGui::Separator();
 			ImGui::Text("TotalFrames: %u", rendererStats.State->TotalFrames);
 
 
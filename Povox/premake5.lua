@@ -99,7 +99,9 @@ project "Povox"
 		{
 			"%{Library.ShaderC_Debug}",
 			"%{Library.SPIRV_cross_Debug}",
-			"%{Library.SPIRV_cross_glsl_Debug}"
+			"%{Library.SPIRV_cross_glsl_Debug}",
+			"%{Library.SPIRV_Tools_Debug}",
+			"%{Library.SPIRV_Tools_opt_Debug}"
 		}
 
 		
@@ -112,7 +114,9 @@ project "Povox"
 		{
 			"%{Library.ShaderC_Release}",			
 			"%{Library.SPIRV_cross_Release}",		
-			"%{Library.SPIRV_cross_glsl_Release}"
+			"%{Library.SPIRV_cross_glsl_Release}",
+			"%{Library.SPIRV_Tools_Release}",
+			"%{Library.SPIRV_Tools_opt_Release}"
 		}
 
 	filter "configurations:Dist"
@@ -124,5 +128,7 @@ project "Povox"
 		{
 			"%{Library.ShaderC_Release}",			
 			"%{Library.SPIRV_cross_Release}",		
-			"%{Library.SPIRV_cross_glsl_Release}"
+			"%{Library.SPIRV_cross_glsl_Release}",
+			"%{Library.SPIRV_Tools_Release}",
+			"%{Library.SPIRV_Tools_opt_Release}"
 		}
@@ -0,0 +1,458 @@
+#include "pxpch.h"
+#include "VulkanBarrierBatcher.h"
+
+#include "Platform/Vulkan/VulkanContext.h"
+#include "Platform/Vulkan/VulkanDebug.h"
+
+
+namespace Povox {
+
+	namespace VulkanUtils {
+
+		template<typename Barrier>
+		static void AddOwnershipTransfer(const Barrier& barrier, uint32_t srcFamily, uint32_t dstFamily, std::vector<Barrier>& releases, std::vector<Barrier>& acquires)
+		{
+			if (srcFamily == dstFamily)
+			{
+				// Different queues of the same family do not need a QFOT, a plain barrier on the consumer is enough
+				Barrier merged = barrier;
+				merged.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				merged.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				acquires.push_back(merged);
+				return;
+			}
+
+			// The dst scope of a release is ignored. The acquire's src scope has to match the stage its submit waits on the semaphore at (ALL_COMMANDS),
+			// so the acquire and a layout transition in it are chained to that wait
+			Barrier release = barrier;
+			release.srcQueueFamilyIndex = srcFamily;
+			release.dstQueueFamilyIndex = dstFamily;
+			release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+			release.dstAccessMask = 0;
+			releases.push_back(release);
+
+			Barrier acquire = barrier;
+			acquire.srcQueueFamilyIndex = srcFamily;
+			acquire.dstQueueFamilyIndex = dstFamily;
+			acquire.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquire.srcAccessMask = 0;
+			acquires.push_back(acquire);
+		}
+	}
+
+	VulkanBarrierBatcher::VulkanBarrierBatcher(uint32_t framesInFlight)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_INFO("VulkanBarrierBatcher: Creating command resources for {0} frames...", framesInFlight);
+
+		m_Frames.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++)
+			CreateCommandResources(m_Frames[i], "BarrierBatcher_Frame" + std::to_string(i));
+		CreateCommandResources(m_Immediate, "BarrierBatcher_Immediate");
+
+		VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+		fenceInfo.flags = 0;
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+			PX_CORE_VK_ASSERT(vkCreateFence(device, &fenceInfo, nullptr, &m_ImmediateFences[slot]), VK_SUCCESS, "Failed to create barrier batcher fence!");
+
+		PX_CORE_INFO("VulkanBarrierBatcher: Completed creation.");
+	}
+
+	void VulkanBarrierBatcher::Destroy()
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+
+		for (auto& frame : m_Frames)
+			DestroyCommandResources(frame);
+		m_Frames.clear();
+		DestroyCommandResources(m_Immediate);
+
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			vkDestroyFence(device, m_ImmediateFences[slot], nullptr);
+			m_ImmediateFences[slot] = VK_NULL_HANDLE;
+		}
+
+		for (auto& pending : m_Pending)
+			pending = PendingBarriers{};
+	}
+
+	void VulkanBarrierBatcher::BeginFrame(uint32_t frameIndex)
+	{
+		PX_CORE_ASSERT(frameIndex < m_Frames.size(), "Frame index out of range!");
+
+		if (HasPending())
+			PX_CORE_WARN("VulkanBarrierBatcher::BeginFrame: Barriers of the last frame were never recorded!");
+
+		m_CurrentFrameIndex = frameIndex;
+		ResetCommandResources(m_Frames[frameIndex]);
+	}
+
+	void VulkanBarrierBatcher::SetQueueTimeline(QueueFamilyOwnership queue, VkSemaphore timeline)
+	{
+		m_Timelines[GetSlot(queue)].Semaphore = timeline;
+	}
+
+	void VulkanBarrierBatcher::SetQueueTimelineValue(QueueFamilyOwnership queue, uint64_t value)
+	{
+		m_Timelines[GetSlot(queue)].Value = value;
+	}
+
+	void VulkanBarrierBatcher::AddBufferBarrier(QueueFamilyOwnership queue, const VkBufferMemoryBarrier2& barrier)
+	{
+		m_Pending[GetSlot(queue)].BufferAcquires.push_back(barrier);
+	}
+
+	void VulkanBarrierBatcher::AddImageBarrier(QueueFamilyOwnership queue, const VkImageMemoryBarrier2& barrier)
+	{
+		m_Pending[GetSlot(queue)].ImageAcquires.push_back(barrier);
+	}
+
+	void VulkanBarrierBatcher::AddBufferOwnershipTransfer(QueueFamilyOwnership src, QueueFamilyOwnership dst, const VkBufferMemoryBarrier2& barrier)
+	{
+		uint32_t srcSlot = GetSlot(src);
+		uint32_t dstSlot = GetSlot(dst);
+		if (srcSlot == dstSlot)
+		{
+			AddBufferBarrier(dst, barrier);
+			return;
+		}
+
+		VulkanUtils::AddOwnershipTransfer(barrier, GetFamilyIndex(srcSlot), GetFamilyIndex(dstSlot), m_Pending[srcSlot].BufferReleases, m_Pending[dstSlot].BufferAcquires);
+		m_Pending[srcSlot].ReleaseTargets[dstSlot] = true;
+	}
+
+	void VulkanBarrierBatcher::AddImageOwnershipTransfer(QueueFamilyOwnership src, QueueFamilyOwnership dst, const VkImageMemoryBarrier2& barrier)
+	{
+		uint32_t srcSlot = GetSlot(src);
+		uint32_t dstSlot = GetSlot(dst);
+		if (srcSlot == dstSlot)
+		{
+			AddImageBarrier(dst, barrier);
+			return;
+		}
+
+		VulkanUtils::AddOwnershipTransfer(barrier, GetFamilyIndex(srcSlot), GetFamilyIndex(dstSlot), m_Pending[srcSlot].ImageReleases, m_Pending[dstSlot].ImageAcquires);
+		m_Pending[srcSlot].ReleaseTargets[dstSlot] = true;
+	}
+
+	void VulkanBarrierBatcher::AddBufferQueueDependency(QueueFamilyOwnership src, QueueFamilyOwnership dst, uint64_t waitValue, const VkBufferMemoryBarrier2& barrier)
+	{
+		uint32_t srcSlot = GetSlot(src);
+		uint32_t dstSlot = GetSlot(dst);
+		if (GetQueue(srcSlot) == GetQueue(dstSlot))
+		{
+			// Submission order already covers the earlier submits of the same queue, a barrier is enough
+			AddBufferBarrier(dst, barrier);
+			return;
+		}
+
+		const QueueTimeline& timeline = m_Timelines[srcSlot];
+		PX_CORE_ASSERT(timeline.Semaphore != VK_NULL_HANDLE, "Queue has no timeline semaphore!");
+		if (waitValue == 0)
+			return;
+
+		uint64_t& pendingValue = m_Pending[dstSlot].TimelineWaits[timeline.Semaphore];
+		pendingValue = std::max(pendingValue, waitValue);
+	}
+
+	void VulkanBarrierBatcher::SubmitReleases(QueueFamilyOwnership queue)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		// No fence, the consumers wait on the semaphores and their frame fences cover this batch
+		SubmitReleases(m_Frames[m_CurrentFrameIndex], GetSlot(queue));
+	}
+
+	void VulkanBarrierBatcher::RecordReleases(QueueFamilyOwnership queue, VkCommandBuffer cmd, std::vector<VkSemaphore>& outSignalSemaphores)
+	{
+		uint32_t slot = GetSlot(queue);
+		PendingBarriers& pending = m_Pending[slot];
+		RecordBarriers(cmd, pending.BufferReleases, pending.ImageReleases);
+
+		GetReleaseSemaphores(m_Frames[m_CurrentFrameIndex], slot, outSignalSemaphores);
+	}
+
+	void VulkanBarrierBatcher::RecordAcquires(QueueFamilyOwnership queue, VkCommandBuffer cmd, std::vector<VkSemaphore>& outWaitSemaphores, std::vector<uint64_t>& outWaitValues)
+	{
+		PendingBarriers& pending = m_Pending[GetSlot(queue)];
+		RecordBarriers(cmd, pending.BufferAcquires, pending.ImageAcquires);
+
+		outWaitSemaphores.insert(outWaitSemaphores.end(), pending.WaitSemaphores.begin(), pending.WaitSemaphores.end());
+		outWaitValues.resize(outWaitSemaphores.size(), 0);
+		pending.WaitSemaphores.clear();
+
+		for (const auto& [semaphore, value] : pending.TimelineWaits)
+		{
+			outWaitSemaphores.push_back(semaphore);
+			outWaitValues.push_back(value);
+		}
+		pending.TimelineWaits.clear();
+	}
+
+	void VulkanBarrierBatcher::SubmitImmediate()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		if (!HasPending())
+			return;
+
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+			SubmitReleases(m_Immediate, slot);
+
+		std::vector<VkFence> fences;
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			PendingBarriers& pending = m_Pending[slot];
+			if (!pending.HasAcquires() && pending.WaitSemaphores.empty() && pending.TimelineWaits.empty())
+				continue;
+
+			VkCommandBuffer cmd = BeginCommands(m_Immediate, slot);
+			std::vector<VkSemaphore> waitSemaphores;
+			std::vector<uint64_t> waitValues;
+			RecordAcquires(static_cast<QueueFamilyOwnership>(slot), cmd, waitSemaphores, waitValues);
+			PX_CORE_VK_ASSERT(vkEndCommandBuffer(cmd), VK_SUCCESS, "Failed to end barrier batcher acquire buffer!");
+
+			std::vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+			VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+			timelineInfo.pNext = nullptr;
+			timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+			timelineInfo.pWaitSemaphoreValues = waitValues.data();
+			timelineInfo.signalSemaphoreValueCount = 0;
+			timelineInfo.pSignalSemaphoreValues = nullptr;
+
+			VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+			submitInfo.pNext = &timelineInfo;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &cmd;
+			submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+			submitInfo.pWaitSemaphores = waitSemaphores.data();
+			submitInfo.pWaitDstStageMask = waitStages.data();
+			submitInfo.signalSemaphoreCount = 0;
+			submitInfo.pSignalSemaphores = nullptr;
+
+			// Releases this acquire depends on are either waited on or were submitted earlier on the same queue, so this fence covers them
+			PX_CORE_VK_ASSERT(vkQueueSubmit(GetQueue(slot), 1, &submitInfo, m_ImmediateFences[slot]), VK_SUCCESS, "Failed to submit barrier batcher acquire buffer!");
+			fences.push_back(m_ImmediateFences[slot]);
+		}
+
+		if (!fences.empty())
+		{
+			VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+			vkWaitForFences(device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+			vkResetFences(device, static_cast<uint32_t>(fences.size()), fences.data());
+		}
+		ResetCommandResources(m_Immediate);
+	}
+
+	bool VulkanBarrierBatcher::HasPending() const
+	{
+		for (const auto& pending : m_Pending)
+		{
+			if (pending.HasReleases() || pending.HasAcquires() || !pending.WaitSemaphores.empty() || !pending.TimelineWaits.empty())
+				return true;
+			for (bool target : pending.ReleaseTargets)
+			{
+				if (target)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	void VulkanBarrierBatcher::SubmitReleases(CommandResources& resources, uint32_t slot)
+	{
+		PendingBarriers& pending = m_Pending[slot];
+
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		if (pending.HasReleases())
+		{
+			cmd = BeginCommands(resources, slot);
+			RecordBarriers(cmd, pending.BufferReleases, pending.ImageReleases);
+			PX_CORE_VK_ASSERT(vkEndCommandBuffer(cmd), VK_SUCCESS, "Failed to end barrier batcher release buffer!");
+		}
+
+		std::vector<VkSemaphore> signalSemaphores;
+		GetReleaseSemaphores(resources, slot, signalSemaphores);
+
+		if (cmd == VK_NULL_HANDLE && signalSemaphores.empty())
+			return;
+
+		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.pNext = nullptr;
+		submitInfo.commandBufferCount = cmd != VK_NULL_HANDLE ? 1 : 0;
+		submitInfo.pCommandBuffers = cmd != VK_NULL_HANDLE ? &cmd : nullptr;
+		submitInfo.waitSemaphoreCount = 0;
+		submitInfo.pWaitSemaphores = nullptr;
+		submitInfo.pWaitDstStageMask = nullptr;
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+		PX_CORE_VK_ASSERT(vkQueueSubmit(GetQueue(slot), 1, &submitInfo, VK_NULL_HANDLE), VK_SUCCESS, "Failed to submit barrier batcher release buffer!");
+	}
+
+	void VulkanBarrierBatcher::GetReleaseSemaphores(CommandResources& resources, uint32_t slot, std::vector<VkSemaphore>& outSignalSemaphores)
+	{
+		PendingBarriers& pending = m_Pending[slot];
+		VkQueue queue = GetQueue(slot);
+		for (uint32_t target = 1; target < QueueSlotCount; target++)
+		{
+			if (!pending.ReleaseTargets[target])
+				continue;
+			pending.ReleaseTargets[target] = false;
+
+			// Consumers on the same VkQueue are ordered by submission already
+			if (GetQueue(target) == queue)
+				continue;
+
+			VkSemaphore semaphore = GetSemaphore(resources);
+			outSignalSemaphores.push_back(semaphore);
+			m_Pending[target].WaitSemaphores.push_back(semaphore);
+		}
+	}
+
+	bool VulkanBarrierBatcher::RecordBarriers(VkCommandBuffer cmd, std::vector<VkBufferMemoryBarrier2>& bufferBarriers, std::vector<VkImageMemoryBarrier2>& imageBarriers)
+	{
+		if (bufferBarriers.empty() && imageBarriers.empty())
+			return false;
+
+		VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		dependency.pNext = nullptr;
+		dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+		dependency.pBufferMemoryBarriers = bufferBarriers.data();
+		dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+		dependency.pImageMemoryBarriers = imageBarriers.data();
+		vkCmdPipelineBarrier2(cmd, &dependency);
+
+		bufferBarriers.clear();
+		imageBarriers.clear();
+		return true;
+	}
+
+	VkCommandBuffer VulkanBarrierBatcher::BeginCommands(CommandResources& resources, uint32_t slot)
+	{
+		auto& buffers = resources.Buffers[slot];
+		uint32_t& next = resources.NextBuffer[slot];
+		if (next == buffers.size())
+		{
+			VkCommandBufferAllocateInfo bufferAllocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			bufferAllocateInfo.pNext = nullptr;
+			bufferAllocateInfo.commandPool = resources.Pools[slot];
+			bufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			bufferAllocateInfo.commandBufferCount = 1;
+
+			VkCommandBuffer cmd;
+			PX_CORE_VK_ASSERT(vkAllocateCommandBuffers(VulkanContext::GetDevice()->GetVulkanDevice(), &bufferAllocateInfo, &cmd), VK_SUCCESS, "Failed to create barrier batcher CommandBuffer!");
+			buffers.push_back(cmd);
+		}
+		VkCommandBuffer cmd = buffers[next++];
+
+		VkCommandBufferBeginInfo cmdBeginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		cmdBeginInfo.pNext = nullptr;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cmdBeginInfo.pInheritanceInfo = nullptr;
+		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(cmd, &cmdBeginInfo), VK_SUCCESS, "Failed to begin barrier batcher CommandBuffer!");
+
+		return cmd;
+	}
+
+	VkSemaphore VulkanBarrierBatcher::GetSemaphore(CommandResources& resources)
+	{
+		if (resources.NextSemaphore == resources.Semaphores.size())
+		{
+			VkSemaphoreCreateInfo semaInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			VkSemaphore semaphore;
+			PX_CORE_VK_ASSERT(vkCreateSemaphore(VulkanContext::GetDevice()->GetVulkanDevice(), &semaInfo, nullptr, &semaphore), VK_SUCCESS, "Failed to create Ownership Transfer Semaphore!");
+			resources.Semaphores.push_back(semaphore);
+		}
+		return resources.Semaphores[resources.NextSemaphore++];
+	}
+
+	void VulkanBarrierBatcher::CreateCommandResources(CommandResources& resources, const std::string& debugName)
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+
+		VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		poolInfo.pNext = nullptr;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			poolInfo.queueFamilyIndex = GetFamilyIndex(slot);
+			PX_CORE_VK_ASSERT(vkCreateCommandPool(device, &poolInfo, nullptr, &resources.Pools[slot]), VK_SUCCESS, "Failed to create barrier batcher command pool!");
+
+#ifdef PX_DEBUG
+			VkDebugUtilsObjectNameInfoEXT nameInfo{};
+			nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+			nameInfo.objectType = VK_OBJECT_TYPE_COMMAND_POOL;
+			nameInfo.objectHandle = (uint64_t)resources.Pools[slot];
+			std::string poolName = debugName + "_" + ToStringUtility::QueueFamilyOwnershipToString(static_cast<QueueFamilyOwnership>(slot));
+			nameInfo.pObjectName = poolName.c_str();
+			NameVkObject(device, nameInfo);
+#endif // DEBUG
+		}
+	}
+
+	void VulkanBarrierBatcher::DestroyCommandResources(CommandResources& resources)
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			vkDestroyCommandPool(device, resources.Pools[slot], nullptr);
+			resources.Pools[slot] = VK_NULL_HANDLE;
+			resources.Buffers[slot].clear();
+			resources.NextBuffer[slot] = 0;
+		}
+		for (VkSemaphore semaphore : resources.Semaphores)
+			vkDestroySemaphore(device, semaphore, nullptr);
+		resources.Semaphores.clear();
+		resources.NextSemaphore = 0;
+	}
+
+	void VulkanBarrierBatcher::ResetCommandResources(CommandResources& resources)
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			PX_CORE_VK_ASSERT(vkResetCommandPool(device, resources.Pools[slot], 0), VK_SUCCESS, "Failed to reset barrier batcher command pool!");
+			resources.NextBuffer[slot] = 0;
+		}
+		resources.NextSemaphore = 0;
+	}
+
+	uint32_t VulkanBarrierBatcher::GetSlot(QueueFamilyOwnership queue)
+	{
+		PX_CORE_ASSERT(queue != QueueFamilyOwnership::QFO_UNDEFINED, "Barriers need a defined queue!");
+		return static_cast<uint32_t>(queue);
+	}
+
+	uint32_t VulkanBarrierBatcher::GetFamilyIndex(uint32_t slot)
+	{
+		auto& families = VulkanContext::GetDevice()->GetQueueFamilies();
+		switch (static_cast<QueueFamilyOwnership>(slot))
+		{
+			case QueueFamilyOwnership::QFO_TRANSFER: return families.TransferFamilyIndex;
+			case QueueFamilyOwnership::QFO_COMPUTE: return families.ComputeFamilyIndex;
+			default: return families.GraphicsFamilyIndex;
+		}
+	}
+
+	VkQueue VulkanBarrierBatcher::GetQueue(uint32_t slot)
+	{
+		auto& queues = VulkanContext::GetDevice()->GetQueueFamilies().Queues;
+		switch (static_cast<QueueFamilyOwnership>(slot))
+		{
+			case QueueFamilyOwnership::QFO_TRANSFER: return queues.TransferQueue;
+			case QueueFamilyOwnership::QFO_COMPUTE: return queues.ComputeQueue;
+			default: return queues.GraphicsQueue;
+		}
+	}
+}
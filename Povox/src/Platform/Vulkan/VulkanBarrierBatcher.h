@@ -0,0 +1,117 @@
+#pragma once
+#include "Platform/Vulkan/VulkanUtilities.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <map>
+
+namespace Povox {
+
+	/**
+	 * Collects pipeline barriers and queue family ownership transfers (QFOT) and emits them as one vkCmdPipelineBarrier2 per queue.
+	 * Releases of a queue go out as a single small submit which signals a semaphore for every consuming queue,
+	 * acquires are recorded into the consumer's own command buffer and its submit waits on those semaphores.
+	 * Concurrently shared buffers need no transfer, their consumer waits on the timeline semaphore the producer's frame submits signal.
+	 */
+	class VulkanBarrierBatcher
+	{
+	public:
+		VulkanBarrierBatcher(uint32_t framesInFlight);
+		~VulkanBarrierBatcher() = default;
+
+		void Destroy();
+
+		// Has to be called after the frame slot's previous frame completed on the graphics and compute timeline
+		void BeginFrame(uint32_t frameIndex);
+
+		// Frame submits of the queue signal this timeline semaphore
+		void SetQueueTimeline(QueueFamilyOwnership queue, VkSemaphore timeline);
+		// Value the queue's last submit signals, or is going to signal for the graphics frame submit
+		void SetQueueTimelineValue(QueueFamilyOwnership queue, uint64_t value);
+		inline uint64_t GetQueueTimelineValue(QueueFamilyOwnership queue) const { return m_Timelines[GetSlot(queue)].Value; }
+
+		// Queue internal barriers, they are recorded together with the acquires of that queue
+		void AddBufferBarrier(QueueFamilyOwnership queue, const VkBufferMemoryBarrier2& barrier);
+		void AddImageBarrier(QueueFamilyOwnership queue, const VkImageMemoryBarrier2& barrier);
+		// The barrier carries the src stage/access of the releasing and the dst stage/access of the acquiring queue, family indices are filled in here
+		void AddBufferOwnershipTransfer(QueueFamilyOwnership src, QueueFamilyOwnership dst, const VkBufferMemoryBarrier2& barrier);
+		void AddImageOwnershipTransfer(QueueFamilyOwnership src, QueueFamilyOwnership dst, const VkImageMemoryBarrier2& barrier);
+		// Concurrent buffers: the consumer's next submit waits until the producer's timeline reached waitValue, the value of the submit that accessed the range.
+		// If both run on the same VkQueue the barrier is recorded on the consumer instead
+		void AddBufferQueueDependency(QueueFamilyOwnership src, QueueFamilyOwnership dst, uint64_t waitValue, const VkBufferMemoryBarrier2& barrier);
+
+		// Submits all pending releases of this queue as one batch, does nothing if there are none
+		void SubmitReleases(QueueFamilyOwnership queue);
+		// Records all pending releases of this queue at the end of cmd instead of submitting them on their own. The submit of cmd has to signal outSignalSemaphores
+		void RecordReleases(QueueFamilyOwnership queue, VkCommandBuffer cmd, std::vector<VkSemaphore>& outSignalSemaphores);
+		// Records all pending acquires and barriers of this queue into cmd. The submit of cmd has to wait on outWaitSemaphores,
+		// outWaitValues holds one value per semaphore (0 for binary ones) for its VkTimelineSemaphoreSubmitInfo
+		void RecordAcquires(QueueFamilyOwnership queue, VkCommandBuffer cmd, std::vector<VkSemaphore>& outWaitSemaphores, std::vector<uint64_t>& outWaitValues);
+
+		// Outside of the frame loop: submits everything that is pending, at most two submits per queue, and waits once
+		void SubmitImmediate();
+
+		bool HasPending() const;
+
+	private:
+		static constexpr uint32_t QueueSlotCount = 4; // Indexed by QueueFamilyOwnership
+
+		struct PendingBarriers
+		{
+			std::vector<VkBufferMemoryBarrier2> BufferReleases;
+			std::vector<VkImageMemoryBarrier2> ImageReleases;
+			std::vector<VkBufferMemoryBarrier2> BufferAcquires;
+			std::vector<VkImageMemoryBarrier2> ImageAcquires;
+
+			// Queues that consume this queue's next release submit
+			std::array<bool, QueueSlotCount> ReleaseTargets{};
+			std::vector<VkSemaphore> WaitSemaphores;
+			// Highest value waited on per queue timeline
+			std::map<VkSemaphore, uint64_t> TimelineWaits;
+
+			inline bool HasReleases() const { return !BufferReleases.empty() || !ImageReleases.empty(); }
+			inline bool HasAcquires() const { return !BufferAcquires.empty() || !ImageAcquires.empty(); }
+		};
+
+		struct QueueTimeline
+		{
+			VkSemaphore Semaphore = VK_NULL_HANDLE;
+			uint64_t Value = 0;
+		};
+
+		struct CommandResources
+		{
+			std::array<VkCommandPool, QueueSlotCount> Pools{};
+			std::array<std::vector<VkCommandBuffer>, QueueSlotCount> Buffers;
+			std::array<uint32_t, QueueSlotCount> NextBuffer{};
+
+			std::vector<VkSemaphore> Semaphores;
+			uint32_t NextSemaphore = 0;
+		};
+
+		void CreateCommandResources(CommandResources& resources, const std::string& debugName);
+		void DestroyCommandResources(CommandResources& resources);
+		void ResetCommandResources(CommandResources& resources);
+
+		VkCommandBuffer BeginCommands(CommandResources& resources, uint32_t slot);
+		VkSemaphore GetSemaphore(CommandResources& resources);
+		void SubmitReleases(CommandResources& resources, uint32_t slot);
+		void GetReleaseSemaphores(CommandResources& resources, uint32_t slot, std::vector<VkSemaphore>& outSignalSemaphores);
+		bool RecordBarriers(VkCommandBuffer cmd, std::vector<VkBufferMemoryBarrier2>& bufferBarriers, std::vector<VkImageMemoryBarrier2>& imageBarriers);
+
+		static uint32_t GetSlot(QueueFamilyOwnership queue);
+		static uint32_t GetFamilyIndex(uint32_t slot);
+		static VkQueue GetQueue(uint32_t slot);
+
+	private:
+		std::array<PendingBarriers, QueueSlotCount> m_Pending;
+		std::array<QueueTimeline, QueueSlotCount> m_Timelines{};
+
+		std::vector<CommandResources> m_Frames;
+		CommandResources m_Immediate;
+		std::array<VkFence, QueueSlotCount> m_ImmediateFences{};
+
+		uint32_t m_CurrentFrameIndex = 0;
+	};
+}
@@ -1,9 +1,12 @@
 #include "pxpch.h"
 
 #include "VulkanBuffer.h"
+#include "VulkanBufferPool.h"
 #include "VulkanCommands.h"
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
+#include "VulkanStagingRing.h"
+#include "VulkanTransferScheduler.h"
 
 
 namespace Povox {
@@ -25,15 +28,24 @@ namespace Povox {
 		}
 	}
 
-	VulkanBuffer::VulkanBuffer(const BufferSpecification& specs)
+	VulkanBuffer::VulkanBuffer(const BufferSpecification& specs, bool dedicatedStaging/* = true*/)
 		: m_Specification(specs)
 	{
 		PX_CORE_ASSERT(specs.Size > 0, "A size needs to be defined!");
 		m_Size = specs.Size;
+		m_FreeRanges[0] = m_Size;
 
 		m_Ownership = QueueFamilyOwnership::QFO_GRAPHICS;
-		m_Allocation = CreateAllocation(m_Size, VulkanUtils::GetVulkanBufferUsage(specs.Usage) | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VulkanUtils::GetVmaUsage(specs.MemUsage), m_Ownership, specs.DebugName+ "Allocation");
-		m_Staging = CreateAllocation(m_Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, QueueFamilyOwnership::QFO_TRANSFER, specs.DebugName + "Staging");
+		if (specs.MemUsage == MemoryUtils::MemoryUsage::DIRECT_WRITE)
+		{
+			CreateDirectWriteAllocation();
+		}
+		else
+		{
+			m_Allocation = CreateAllocation(m_Size, VulkanUtils::GetVulkanBufferUsage(specs.Usage) | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VulkanUtils::GetVmaUsage(specs.MemUsage), m_Ownership, specs.DebugName+ "Allocation", specs.Concurrent);
+			if (dedicatedStaging)
+				m_Staging = CreateAllocation(m_Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, QueueFamilyOwnership::QFO_TRANSFER, specs.DebugName + "Staging");
+		}
 
 		CreateDescriptorInfo();
 
@@ -59,20 +71,52 @@ namespace Povox {
 
 	void VulkanBuffer::Free()
 	{
-		PX_CORE_WARN("VulkanBuffer::Free Buffer {}", m_Specification.DebugName);
-
-		VulkanContext::SubmitResourceFree([=]() 
+		// Captured by value, the buffer object itself may be gone by the time this runs
+		VulkanContext::SubmitResourceFree([allocation = m_Allocation, staging = m_Staging]() 
 			{
-				PX_CORE_WARN("VulkanBuffer Destroying Buffer {}", m_Specification.DebugName);
-
 				VmaAllocator allocator = VulkanContext::GetAllocator();
 
-				vmaDestroyBuffer(allocator, m_Allocation.Buffer, m_Allocation.Allocation);
-				vmaDestroyBuffer(allocator, m_Staging.Buffer, m_Staging.Allocation);
+				vmaDestroyBuffer(allocator, allocation.Buffer, allocation.Allocation);
+				vmaDestroyBuffer(allocator, staging.Buffer, staging.Allocation);
 			});
 	}
 
-	void VulkanBuffer::UploadToGPU()
+	void VulkanBuffer::CreateDirectWriteAllocation()
+	{
+		VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferInfo.pNext = nullptr;
+		bufferInfo.size = m_Size;
+		bufferInfo.usage = VulkanUtils::GetVulkanBufferUsage(m_Specification.Usage);
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		// PREFER_DEVICE together with sequential host writes picks HOST_VISIBLE | DEVICE_LOCAL memory if there is any and falls back to plain host memory
+		VmaAllocationCreateInfo vmaAllocInfo{};
+		vmaAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+		vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VmaAllocator allocator = VulkanContext::GetAllocator();
+		VmaAllocationInfo allocInfo{};
+		PX_CORE_VK_ASSERT(vmaCreateBuffer(allocator, &bufferInfo, &vmaAllocInfo, &m_Allocation.Buffer, &m_Allocation.Allocation, &allocInfo), VK_SUCCESS, "Failed to create direct write Buffer!");
+		m_MappedData = allocInfo.pMappedData;
+		PX_CORE_ASSERT(m_MappedData, "Direct write buffer is not mapped!");
+
+		VkMemoryPropertyFlags memProperties;
+		vmaGetAllocationMemoryProperties(allocator, m_Allocation.Allocation, &memProperties);
+		m_IsDeviceLocal = (memProperties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+		if (!m_IsDeviceLocal)
+			PX_CORE_INFO("VulkanBuffer: No host visible device local memory for {0}, falling back to CPU_TO_GPU memory.", m_Specification.DebugName);
+	}
+
+	void VulkanBuffer::FlushMappedData(size_t offset, size_t size)
+	{
+		if (!m_MappedData)
+			return;
+
+		// No-op for host coherent memory
+		vmaFlushAllocation(VulkanContext::GetAllocator(), m_Allocation.Allocation, offset, size);
+	}
+
+	void VulkanBuffer::UploadToGPU(size_t offset, size_t size)
 	{	
 		PX_CORE_ASSERT(m_StagingMapped, "Something went wrong, staging should be mapped!");
 
@@ -80,149 +124,168 @@ namespace Povox {
 		vmaUnmapMemory(allocator, m_Staging.Allocation);
 		m_StagingMapped = false;
 
-		QueueFamilyOwnership originalOwnership = m_Ownership;
+		CopyFromStaging(m_Staging.Buffer, offset, offset, size);
+		CreateDescriptorInfo();
+	}
 
-		auto& queueFamilies = VulkanContext::GetDevice()->GetQueueFamilies();
-		uint32_t currentIndex;
-		VulkanCommandControl::SubmitType submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_UNDEFINED;
-		VulkanCommandControl::SubmitType reverseSubmitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_UNDEFINED;
+	void VulkanBuffer::UploadWithoutStaging(const void* inputData, size_t offset, size_t size)
+	{
+		if (Ref<VulkanTransferScheduler> scheduler = VulkanCommandControl::GetTransferScheduler())
+		{
+			QueueFamilyOwnership consumer = m_Ownership == QueueFamilyOwnership::QFO_UNDEFINED ? QueueFamilyOwnership::QFO_GRAPHICS : m_Ownership;
+			scheduler->Wait(scheduler->UploadBuffer(m_Allocation.Buffer, offset, inputData, size, consumer, m_Specification.Concurrent));
+			return;
+		}
 
+		// Only before the scheduler exists, a staging buffer of just this upload's size is used once
+		VmaAllocator allocator = VulkanContext::GetAllocator();
+		AllocatedBuffer staging = CreateAllocation(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, QueueFamilyOwnership::QFO_TRANSFER, m_Specification.DebugName + "UploadStaging");
+		void* data = nullptr;
+		vmaMapMemory(allocator, staging.Allocation, &data);
+		memcpy(data, inputData, size);
+		vmaUnmapMemory(allocator, staging.Allocation);
+
+		CopyFromStaging(staging.Buffer, 0, offset, size);
+		// The immediate submit waited for the copy
+		vmaDestroyBuffer(allocator, staging.Buffer, staging.Allocation);
+	}
+
+	void VulkanBuffer::CopyFromStaging(VkBuffer staging, size_t srcOffset, size_t dstOffset, size_t size)
+	{
+		// Every queue family supports transfer commands, so the copy runs on the queue that owns the buffer.
+		// That saves the two ownership round-trips to the transfer queue and their CPU waits.
+		VulkanCommandControl::SubmitType submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_GRAPHICS;
 		switch (m_Ownership)
 		{
-			case QueueFamilyOwnership::QFO_GRAPHICS:
-			{
-				currentIndex = queueFamilies.GraphicsFamilyIndex;
-				submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_TRANSFER;
-				reverseSubmitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_GRAPHICS;
-
-				break;
-			}
-			case QueueFamilyOwnership::QFO_TRANSFER:
-			{
-				currentIndex = queueFamilies.TransferFamilyIndex;				
-				submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_TRANSFER;
-				
-				break;
-			}
-			case QueueFamilyOwnership::QFO_COMPUTE:
-			{
-				currentIndex = queueFamilies.ComputeFamilyIndex;				
-				submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_TRANSFER;
-				reverseSubmitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_COMPUTE;
-				break;
-			}
-			default:
-			{
-				PX_CORE_ASSERT(true, "QueueFamilyOwnership not caught!");
-				break;
-			}
+			case QueueFamilyOwnership::QFO_TRANSFER: submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_TRANSFER; break;
+			case QueueFamilyOwnership::QFO_COMPUTE: submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_COMPUTE; break;
+			default: break;
 		}
 
-		VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(submitType, [=](VkCommandBuffer releaseCmd)
+		VulkanCommandControl::ImmidiateSubmit(submitType, [=](VkCommandBuffer cmd)
 			{
 				VkBufferMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
 				barrier.pNext = nullptr;
 				barrier.buffer = m_Allocation.Buffer;
-				barrier.size = m_Size;
-				barrier.offset = 0; // TODO:
-				barrier.srcQueueFamilyIndex = currentIndex;
-				barrier.dstQueueFamilyIndex = queueFamilies.TransferFamilyIndex;
+				barrier.offset = dstOffset;
+				barrier.size = size;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
-				barrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+				// Earlier submits on this queue may still read the buffer
+				barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 				barrier.srcAccessMask = 0;
-
-				VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-				dependency.bufferMemoryBarrierCount = 1;
-				dependency.pBufferMemoryBarriers = &barrier;
-
-				vkCmdPipelineBarrier2(releaseCmd, &dependency);
-
-			}, [=](VkCommandBuffer acquireCmd)
-			{
-				VkBufferMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-				barrier.pNext = nullptr;
-				barrier.buffer = m_Allocation.Buffer;
-				barrier.size = m_Size;
-				barrier.offset = 0; // TODO:
-				barrier.srcQueueFamilyIndex = currentIndex;
-				barrier.dstQueueFamilyIndex = queueFamilies.TransferFamilyIndex;
-
-				barrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+				barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
 				barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
 
 				VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
 				dependency.bufferMemoryBarrierCount = 1;
 				dependency.pBufferMemoryBarriers = &barrier;
+				vkCmdPipelineBarrier2(cmd, &dependency);
 
-				vkCmdPipelineBarrier2(acquireCmd, &dependency);
-			});
-		m_Ownership = QueueFamilyOwnership::QFO_TRANSFER;
-
-		VulkanCommandControl::ImmidiateSubmit(VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_TRANSFER, [=](VkCommandBuffer cmd)
-			{
+				// Only the written range, other ranges of the buffer may have been updated through the staging ring since
 				VkBufferCopy copyRegion{};
-				copyRegion.size = m_Size;
+				copyRegion.srcOffset = srcOffset;
+				copyRegion.dstOffset = dstOffset;
+				copyRegion.size = size;
+				vkCmdCopyBuffer(cmd, staging, m_Allocation.Buffer, 1, &copyRegion);
 
-				vkCmdCopyBuffer(cmd, m_Staging.Buffer, m_Allocation.Buffer, 1, &copyRegion);
-			});
-
-		VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(reverseSubmitType, [=](VkCommandBuffer releaseCmd)
-			{
-				VkBufferMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-				barrier.pNext = nullptr;
-				barrier.buffer = m_Allocation.Buffer;
-				barrier.size = m_Size;
-				barrier.offset = 0; // TODO:
-				barrier.srcQueueFamilyIndex = queueFamilies.TransferFamilyIndex;
-				barrier.dstQueueFamilyIndex = currentIndex;
-
-				barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+				barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
 				barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+				barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+				barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+				vkCmdPipelineBarrier2(cmd, &dependency);
+			});
+	}
 
-				VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-				dependency.bufferMemoryBarrierCount = 1;
-				dependency.pBufferMemoryBarriers = &barrier;
-
-				vkCmdPipelineBarrier2(releaseCmd, &dependency);
+	Ref<BufferSuballocation> VulkanBuffer::GetSuballocation(size_t size)
+	{
+		size_t alignment = GetOffsetAlignment();
+		size_t paddedSize = (size + alignment - 1) & ~(alignment - 1);
 
-			}, [=](VkCommandBuffer acquireCmd)
-			{
-				VkBufferMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-				barrier.pNext = nullptr;
-				barrier.buffer = m_Allocation.Buffer;
-				barrier.size = m_Size;
-				barrier.offset = 0; // TODO:
-				barrier.srcQueueFamilyIndex = queueFamilies.TransferFamilyIndex;
-				barrier.dstQueueFamilyIndex = currentIndex;
+		// First fit, ranges are sorted by offset so low offsets are reused first and the tail stays contiguous
+		for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); it++)
+		{
+			size_t rangeOffset = it->first;
+			size_t rangeSize = it->second;
+			size_t offset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+			if (offset + paddedSize > rangeOffset + rangeSize)
+				continue;
+
+			m_FreeRanges.erase(it);
+			if (offset > rangeOffset)
+				m_FreeRanges[rangeOffset] = offset - rangeOffset;
+			if (offset + paddedSize < rangeOffset + rangeSize)
+				m_FreeRanges[offset + paddedSize] = rangeOffset + rangeSize - (offset + paddedSize);
+
+			m_SuballocatedBytes += paddedSize;
+			m_SuballocationCount++;
+			return CreateRef<BufferSuballocation>(GetPtr(), offset, paddedSize);
+		}
 
+		return nullptr;
+	}
 
-				barrier.dstStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
-				barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	void VulkanBuffer::FreeSuballocation(size_t offset, size_t size)
+	{
+		if (Ref<VulkanBufferPool> pool = m_Pool.lock())
+		{
+			pool->Retire(std::static_pointer_cast<VulkanBuffer>(GetPtr()), offset, size);
+			return;
+		}
+		ReleaseRange(offset, size);
+	}
 
-				VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-				dependency.bufferMemoryBarrierCount = 1;
-				dependency.pBufferMemoryBarriers = &barrier;
+	void VulkanBuffer::ReleaseRange(size_t offset, size_t size)
+	{
+		PX_CORE_ASSERT(m_SuballocationCount > 0, "Released a range of a buffer without suballocations!");
 
-				vkCmdPipelineBarrier2(acquireCmd, &dependency);
-			});
-		m_Ownership = originalOwnership;
+		m_SuballocatedBytes -= size;
+		m_SuballocationCount--;
 
-		CreateDescriptorInfo();
+		auto next = m_FreeRanges.lower_bound(offset);
+		if (next != m_FreeRanges.end() && offset + size == next->first)
+		{
+			size += next->second;
+			next = m_FreeRanges.erase(next);
+		}
+		if (next != m_FreeRanges.begin())
+		{
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset)
+			{
+				prev->second += size;
+				return;
+			}
+		}
+		m_FreeRanges[offset] = size;
 	}
 
-	Ref<BufferSuballocation> VulkanBuffer::GetSuballocation(size_t size)
+	size_t VulkanBuffer::GetOffsetAlignment() const
 	{
-		// TODO: catch this, create new buffer and return a suballocation to this using a bufferPool
-		if (m_Size - size < m_SuballocationOffset)
+		const auto& limits = VulkanContext::GetDevice()->GetPhysicalDeviceProperties().limits;
+		switch (m_Specification.Usage)
 		{
-			PX_CORE_ASSERT(true, "Requested suballocation size exceeds size left in this buffer!");
+			case BufferUsage::UNIFORM_BUFFER:
+			case BufferUsage::UNIFORM_BUFFER_DYNAMIC: return std::max<size_t>(limits.minUniformBufferOffsetAlignment, 16);
+			case BufferUsage::STORAGE_BUFFER:
+			case BufferUsage::STORAGE_BUFFER_DYNAMIC: return std::max<size_t>(limits.minStorageBufferOffsetAlignment, 16);
+			default: return 16;
 		}
-		size_t paddedSize = PadSize(size);
-		size_t offset = m_SuballocationOffset;
-		Ref<BufferSuballocation> sub = CreateRef<BufferSuballocation>(GetPtr(), offset, paddedSize);
-		m_SuballocationOffset =+ paddedSize;
+	}
 
-		return sub;
+	void VulkanBuffer::AccumulateStatistics(BufferPoolStatistics& stats) const
+	{
+		stats.BackingBufferCount++;
+		stats.AllocationCount += m_SuballocationCount;
+		stats.ReservedBytes += m_Size;
+		stats.UsedBytes += m_SuballocatedBytes;
+		for (const auto& [offset, size] : m_FreeRanges)
+		{
+			stats.FreeBytes += size;
+			stats.LargestFreeRange = std::max(stats.LargestFreeRange, size);
+			stats.FreeRangeCount++;
+		}
 	}
 
 	uint32_t VulkanBuffer::GetPadding()
@@ -252,6 +315,22 @@ namespace Povox {
 			return;
 		}
 
+		if (m_MappedData)
+		{
+			memcpy(m_MappedData, inputData, size);
+			FlushMappedData(0, size);
+			return;
+		}
+
+		if (RecordFrameUpload(inputData, 0, size))
+			return;
+
+		if (!m_Staging.Buffer)
+		{
+			UploadWithoutStaging(inputData, 0, size);
+			return;
+		}
+
 		if (!m_StagingMapped)
 		{
 			VmaAllocator allocator = VulkanContext::GetAllocator();
@@ -260,12 +339,27 @@ namespace Povox {
 		}
 		memcpy(m_Data, inputData, size);
 
-		UploadToGPU();
+		UploadToGPU(0, size);
 	}
 	void VulkanBuffer::SetData(void* inputData, size_t offset, size_t size)
 	{
-		PX_CORE_ASSERT((offset + size) < m_Specification.Size, "Out of bounds!");
+		PX_CORE_ASSERT((offset + size) <= m_Specification.Size, "Out of bounds!");
 
+		if (m_MappedData)
+		{
+			memcpy((char*)m_MappedData + offset, inputData, size);
+			FlushMappedData(offset, size);
+			return;
+		}
+
+		if (RecordFrameUpload(inputData, offset, size))
+			return;
+
+		if (!m_Staging.Buffer)
+		{
+			UploadWithoutStaging(inputData, offset, size);
+			return;
+		}
 
 		if (!m_StagingMapped)
 		{
@@ -276,10 +370,44 @@ namespace Povox {
 		char* data = (char*)m_Data;
 		memcpy(data + offset, inputData, size);
 
-		UploadToGPU();
+		UploadToGPU(offset, size);
 	}	
+	UploadHandle VulkanBuffer::SetDataAsync(void* inputData, size_t offset, size_t size)
+	{
+		PX_CORE_ASSERT((offset + size) <= m_Specification.Size, "Out of bounds!");
+
+		if (m_MappedData)
+		{
+			memcpy((char*)m_MappedData + offset, inputData, size);
+			FlushMappedData(offset, size);
+			return UploadHandle{};
+		}
+
+		Ref<VulkanTransferScheduler> scheduler = VulkanCommandControl::GetTransferScheduler();
+		if (!scheduler)
+		{
+			SetData(inputData, offset, size);
+			return UploadHandle{};
+		}
+
+		QueueFamilyOwnership consumer = m_Ownership == QueueFamilyOwnership::QFO_UNDEFINED ? QueueFamilyOwnership::QFO_GRAPHICS : m_Ownership;
+		return scheduler->UploadBuffer(m_Allocation.Buffer, offset, inputData, size, consumer, m_Specification.Concurrent);
+	}
 
-	AllocatedBuffer VulkanBuffer::CreateAllocation(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, QueueFamilyOwnership ownership, std::string debugName)
+	bool VulkanBuffer::RecordFrameUpload(const void* inputData, size_t offset, size_t size)
+	{
+		// Only buffers owned by the graphics family can be copied to from the frame's graphics upload commands
+		if (m_Ownership != QueueFamilyOwnership::QFO_GRAPHICS)
+			return false;
+
+		Ref<VulkanStagingRing> stagingRing = VulkanCommandControl::GetStagingRing();
+		if (!stagingRing || !stagingRing->IsRecording())
+			return false;
+
+		return stagingRing->RecordBufferUpload(m_Allocation.Buffer, offset, inputData, size);
+	}
+
+	AllocatedBuffer VulkanBuffer::CreateAllocation(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, QueueFamilyOwnership ownership, std::string debugName, bool concurrent)
 	{
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -288,38 +416,50 @@ namespace Povox {
 		bufferInfo.size = allocSize;
 		bufferInfo.usage = usage;
 
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		bufferInfo.queueFamilyIndexCount = 1;
 		auto& families = VulkanContext::GetDevice()->GetQueueFamilies();
-		
-		// TODO: queue family can be empty if not concurrent
-		switch (ownership)
+
+		// Has to outlive the switch, vmaCreateBuffer reads it
+		std::vector<uint32_t> familyIndices;
+		if (concurrent)
 		{
-			case QueueFamilyOwnership::QFO_UNDEFINED:
-			case QueueFamilyOwnership::QFO_GRAPHICS:
-			{
-				uint32_t familyIndex[] = { families.GraphicsFamilyIndex };
-				bufferInfo.pQueueFamilyIndices = familyIndex;
-				break;
-			}
-			case QueueFamilyOwnership::QFO_TRANSFER:
-			{
-				uint32_t familyIndex[] = { families.TransferFamilyIndex };
-				bufferInfo.pQueueFamilyIndices = familyIndex;
-				break;
-			}
-			case QueueFamilyOwnership::QFO_COMPUTE:
+			for (uint32_t index : { families.GraphicsFamilyIndex, families.ComputeFamilyIndex, families.TransferFamilyIndex })
 			{
-				uint32_t familyIndex[] = { families.ComputeFamilyIndex };
-				bufferInfo.pQueueFamilyIndices = familyIndex;
-				break;
+				if (std::find(familyIndices.begin(), familyIndices.end(), index) == familyIndices.end())
+					familyIndices.push_back(index);
 			}
-			default:
+		}
+		else
+		{
+			switch (ownership)
 			{
-				PX_CORE_ASSERT(true, "QueueFamilyOwnership not caught!");
+				case QueueFamilyOwnership::QFO_UNDEFINED:
+				case QueueFamilyOwnership::QFO_GRAPHICS:
+				{
+					familyIndices.push_back(families.GraphicsFamilyIndex);
+					break;
+				}
+				case QueueFamilyOwnership::QFO_TRANSFER:
+				{
+					familyIndices.push_back(families.TransferFamilyIndex);
+					break;
+				}
+				case QueueFamilyOwnership::QFO_COMPUTE:
+				{
+					familyIndices.push_back(families.ComputeFamilyIndex);
+					break;
+				}
+				default:
+				{
+					PX_CORE_ASSERT(true, "QueueFamilyOwnership not caught!");
+				}
 			}
 		}
 
+		// With a single queue family for everything a concurrent buffer is exclusive anyway
+		bufferInfo.sharingMode = familyIndices.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+		bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(familyIndices.size());
+		bufferInfo.pQueueFamilyIndices = familyIndices.data();
+
 		VmaAllocationCreateInfo vmaAllocInfo{};
 		//vmaAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
 		//vmaAllocInfo.flags = 
@@ -16,32 +16,52 @@ namespace Povox {
 		VmaAllocation Allocation = nullptr;
 	};	
 
+	class VulkanBufferPool;
 	class VulkanBuffer : public Buffer
 	{
 	public:
-		VulkanBuffer(const BufferSpecification& specs);
+		// Without a dedicated staging buffer, uploads outside the staging ring go through the transfer scheduler, e.g. for pool blocks
+		VulkanBuffer(const BufferSpecification& specs, bool dedicatedStaging = true);
 		virtual ~VulkanBuffer() = default;
 		virtual void Free() override;
 
 		virtual BufferHandle GetID() const override { return m_Handle; }
 
 		virtual Ref<BufferSuballocation> GetSuballocation(size_t size) override;
+		virtual void FreeSuballocation(size_t offset, size_t size) override;
+		// Returns the range to the free list right away, the GPU must be done with it
+		void ReleaseRange(size_t offset, size_t size);
+		// Offsets of suballocations are aligned to the min offset alignment of the buffers descriptor type
+		size_t GetOffsetAlignment() const;
+
+		inline size_t GetSize() const { return m_Size; }
+		inline bool HasSuballocations() const { return m_SuballocationCount > 0; }
+		void AccumulateStatistics(BufferPoolStatistics& stats) const;
+		// Pooled buffers defer freed ranges to their pool
+		inline void SetPool(const Ref<VulkanBufferPool>& pool) { m_Pool = pool; }
 
 		static uint32_t GetPadding();
 		static size_t PadSize(size_t initialSize);
 
 		virtual void SetData(void* inputData, size_t size) override;
 		virtual void SetData(void* inputData, size_t offset, size_t size) override;
+		virtual UploadHandle SetDataAsync(void* inputData, size_t offset, size_t size) override;
 		virtual void SetLayout(const BufferLayout& layout) override { m_Specification.Layout = layout; };
 
 		virtual inline BufferSpecification& GetSpecification() override { return m_Specification; }
 
+		virtual inline void* GetMappedData() override { return m_MappedData; }
+		virtual void FlushMappedData(size_t offset, size_t size) override;
+		inline bool IsDeviceLocal() const { return m_IsDeviceLocal; }
+		inline QueueFamilyOwnership GetOwnership() const { return m_Ownership; }
+		inline bool IsConcurrent() const { return m_Specification.Concurrent; }
+
 		inline const AllocatedBuffer& GetAllocation() const { return m_Allocation; }
 		inline AllocatedBuffer& GetAllocation() { return m_Allocation; }
 
 		inline VkDescriptorBufferInfo GetBufferInfo(size_t offset = 0, size_t range = 0) { return CreateDescriptorInfo(offset, range); }
 
-		static AllocatedBuffer CreateAllocation(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, QueueFamilyOwnership ownership = QueueFamilyOwnership::QFO_UNDEFINED, std::string debugName = std::string());
+		static AllocatedBuffer CreateAllocation(size_t allocSize, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, QueueFamilyOwnership ownership = QueueFamilyOwnership::QFO_UNDEFINED, std::string debugName = std::string(), bool concurrent = false);
 
 		virtual const std::string& GetDebugName() const override { return m_Specification.DebugName; }
 		
@@ -49,7 +69,13 @@ namespace Povox {
 		virtual bool operator==(const Buffer& other) const override { return m_Handle == ((VulkanBuffer&)other).m_Handle; }
 
 	private:
-		void UploadToGPU();
+		void CreateDirectWriteAllocation();
+		// Records the copy into the current frame's staging ring, returns false if the immediate path has to be taken
+		bool RecordFrameUpload(const void* inputData, size_t offset, size_t size);
+		void UploadToGPU(size_t offset, size_t size);
+		// Waits for the upload, like the dedicated staging path
+		void UploadWithoutStaging(const void* inputData, size_t offset, size_t size);
+		void CopyFromStaging(VkBuffer staging, size_t srcOffset, size_t dstOffset, size_t size);
 
 		VkDescriptorBufferInfo CreateDescriptorInfo(size_t offset = 0, size_t range = 0);
 
@@ -64,7 +90,16 @@ namespace Povox {
 		bool m_StagingMapped = false;
 		void* m_Data = nullptr;
 		size_t m_Size = 0;
-		size_t m_SuballocationOffset = 0;
+
+		// Free ranges by offset, neighbours are merged on release
+		std::map<size_t, size_t> m_FreeRanges;
+		size_t m_SuballocatedBytes = 0;
+		uint32_t m_SuballocationCount = 0;
+		std::weak_ptr<VulkanBufferPool> m_Pool;
+
+		// DIRECT_WRITE only, persistently mapped for the buffers lifetime
+		void* m_MappedData = nullptr;
+		bool m_IsDeviceLocal = true;
 				
 
 		QueueFamilyOwnership m_Ownership = QueueFamilyOwnership::QFO_UNDEFINED;
@@ -0,0 +1,159 @@
+#include "pxpch.h"
+#include "VulkanBufferPool.h"
+
+#include "Platform/Vulkan/VulkanContext.h"
+
+
+namespace Povox {
+
+	VulkanBufferPool::VulkanBufferPool(uint32_t framesInFlight, size_t blockSize)
+		: m_BlockSize(blockSize)
+	{
+		PX_CORE_INFO("VulkanBufferPool: Creating pool with {0} byte blocks for {1} frames...", blockSize, framesInFlight);
+
+		m_Retired.resize(framesInFlight);
+	}
+
+	void VulkanBufferPool::Destroy()
+	{
+		// Ranges retired by the last frames are not in use anymore after the device went idle
+		for (auto& retired : m_Retired)
+		{
+			for (auto& range : retired)
+				range.Buffer->ReleaseRange(range.Offset, range.Size);
+			retired.clear();
+		}
+
+		for (auto& [usage, blocks] : m_Blocks)
+		{
+			for (auto& block : blocks)
+			{
+				if (block->HasSuballocations())
+					PX_CORE_WARN("VulkanBufferPool::Destroy: {0} still has suballocations in use!", block->GetDebugName());
+				block->SetPool(nullptr);
+				block->Free();
+			}
+		}
+		m_Blocks.clear();
+	}
+
+	void VulkanBufferPool::BeginFrame(uint32_t frameIndex)
+	{
+		PX_CORE_ASSERT(frameIndex < m_Retired.size(), "Frame index out of range!");
+
+		m_CurrentFrameIndex = frameIndex;
+
+		auto& retired = m_Retired[frameIndex];
+		if (retired.empty())
+			return;
+
+		for (auto& range : retired)
+			range.Buffer->ReleaseRange(range.Offset, range.Size);
+		retired.clear();
+
+		for (auto& [usage, blocks] : m_Blocks)
+			ReleaseEmptyBlocks(blocks);
+	}
+
+	Ref<BufferSuballocation> VulkanBufferPool::Allocate(BufferUsage usage, size_t size)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		auto& blocks = m_Blocks[usage];
+		for (auto& block : blocks)
+		{
+			if (Ref<BufferSuballocation> sub = block->GetSuballocation(size))
+				return sub;
+		}
+
+		// Requests larger than a block get a dedicated one, it is released again once it is empty
+		Ref<VulkanBuffer> block = CreateBlock(usage, std::max(size, m_BlockSize));
+		blocks.push_back(block);
+
+		Ref<BufferSuballocation> sub = block->GetSuballocation(size);
+		PX_CORE_ASSERT(sub, "Failed to suballocate from a new block!");
+		return sub;
+	}
+
+	void VulkanBufferPool::Retire(Ref<VulkanBuffer> buffer, size_t offset, size_t size)
+	{
+		m_Retired[m_CurrentFrameIndex].push_back(RetiredRange{ buffer, offset, size });
+	}
+
+	BufferPoolStatistics VulkanBufferPool::GetStatistics(BufferUsage usage) const
+	{
+		BufferPoolStatistics stats{};
+		size_t largestRangeSum = 0;
+
+		auto it = m_Blocks.find(usage);
+		if (it != m_Blocks.end())
+			AccumulateStatistics(it->second, stats, largestRangeSum);
+
+		if (stats.FreeBytes > 0)
+			stats.Fragmentation = 1.0f - static_cast<float>(largestRangeSum) / static_cast<float>(stats.FreeBytes);
+		return stats;
+	}
+
+	BufferPoolStatistics VulkanBufferPool::GetStatistics() const
+	{
+		BufferPoolStatistics stats{};
+		size_t largestRangeSum = 0;
+
+		for (const auto& [usage, blocks] : m_Blocks)
+			AccumulateStatistics(blocks, stats, largestRangeSum);
+
+		if (stats.FreeBytes > 0)
+			stats.Fragmentation = 1.0f - static_cast<float>(largestRangeSum) / static_cast<float>(stats.FreeBytes);
+		return stats;
+	}
+
+	Ref<VulkanBuffer> VulkanBufferPool::CreateBlock(BufferUsage usage, size_t size)
+	{
+		BufferSpecification specs{};
+		specs.Usage = usage;
+		specs.MemUsage = MemoryUtils::MemoryUsage::GPU_ONLY;
+		specs.Size = size;
+		specs.DebugName = std::string("BufferPool_") + EnumToString::BufferUsageString(usage) + "_" + std::to_string(m_Blocks[usage].size());
+
+		PX_CORE_INFO("VulkanBufferPool: Growing by {0} ({1} bytes).", specs.DebugName, size);
+
+		// Suballocations upload through the staging ring or the transfer scheduler, a block sized staging buffer would double the pool's memory
+		Ref<VulkanBuffer> block = CreateRef<VulkanBuffer>(specs, false);
+		block->SetPool(shared_from_this());
+		return block;
+	}
+
+	void VulkanBufferPool::ReleaseEmptyBlocks(std::vector<Ref<VulkanBuffer>>& blocks)
+	{
+		// The first block is kept around, it would most likely be recreated right away
+		for (size_t i = blocks.size(); i-- > 1;)
+		{
+			if (blocks[i]->HasSuballocations())
+				continue;
+
+			PX_CORE_INFO("VulkanBufferPool: Releasing empty block {0}.", blocks[i]->GetDebugName());
+			blocks[i]->SetPool(nullptr);
+			blocks[i]->Free();
+			blocks.erase(blocks.begin() + i);
+		}
+	}
+
+	void VulkanBufferPool::AccumulateStatistics(const std::vector<Ref<VulkanBuffer>>& blocks, BufferPoolStatistics& stats, size_t& largestRangeSum)
+	{
+		for (const auto& block : blocks)
+		{
+			BufferPoolStatistics blockStats{};
+			block->AccumulateStatistics(blockStats);
+			largestRangeSum += blockStats.LargestFreeRange;
+
+			stats.BackingBufferCount += blockStats.BackingBufferCount;
+			stats.AllocationCount += blockStats.AllocationCount;
+			stats.ReservedBytes += blockStats.ReservedBytes;
+			stats.UsedBytes += blockStats.UsedBytes;
+			stats.FreeBytes += blockStats.FreeBytes;
+			stats.FreeRangeCount += blockStats.FreeRangeCount;
+			stats.LargestFreeRange = std::max(stats.LargestFreeRange, blockStats.LargestFreeRange);
+		}
+	}
+}
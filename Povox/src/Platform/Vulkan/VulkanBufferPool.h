@@ -0,0 +1,52 @@
+#pragma once
+#include "Platform/Vulkan/VulkanBuffer.h"
+
+#include "Povox/Renderer/Buffer.h"
+
+#include <unordered_map>
+
+namespace Povox {
+
+	/**
+	 * Free list sub-allocator on top of large GPU_ONLY VulkanBuffers, one list of backing buffers per BufferUsage.
+	 * Freed ranges are retired with the current frame and go back to their buffer's free list once that frame slot comes around again,
+	 * backing buffers that end up empty are released except for the first one of each usage.
+	 */
+	class VulkanBufferPool : public BufferPool, public std::enable_shared_from_this<VulkanBufferPool>
+	{
+	public:
+		VulkanBufferPool(uint32_t framesInFlight, size_t blockSize);
+		virtual ~VulkanBufferPool() = default;
+
+		void Destroy();
+
+		// Has to be called after the frame slot's previous frame has completed
+		void BeginFrame(uint32_t frameIndex);
+
+		virtual Ref<BufferSuballocation> Allocate(BufferUsage usage, size_t size) override;
+		void Retire(Ref<VulkanBuffer> buffer, size_t offset, size_t size);
+
+		virtual BufferPoolStatistics GetStatistics(BufferUsage usage) const override;
+		virtual BufferPoolStatistics GetStatistics() const override;
+
+	private:
+		Ref<VulkanBuffer> CreateBlock(BufferUsage usage, size_t size);
+		void ReleaseEmptyBlocks(std::vector<Ref<VulkanBuffer>>& blocks);
+
+		static void AccumulateStatistics(const std::vector<Ref<VulkanBuffer>>& blocks, BufferPoolStatistics& stats, size_t& largestRangeSum);
+
+	private:
+		struct RetiredRange
+		{
+			Ref<VulkanBuffer> Buffer = nullptr;
+			size_t Offset = 0;
+			size_t Size = 0;
+		};
+
+		size_t m_BlockSize = 0;
+		std::unordered_map<BufferUsage, std::vector<Ref<VulkanBuffer>>> m_Blocks;
+
+		std::vector<std::vector<RetiredRange>> m_Retired;
+		uint32_t m_CurrentFrameIndex = 0;
+	};
+}
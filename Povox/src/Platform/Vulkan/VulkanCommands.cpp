@@ -1,8 +1,11 @@
 #include "pxpch.h"
 #include "VulkanCommands.h"
 
+#include "Platform/Vulkan/VulkanBarrierBatcher.h"
 #include "Platform/Vulkan/VulkanContext.h"
 #include "Platform/Vulkan/VulkanDebug.h"
+#include "Platform/Vulkan/VulkanStagingRing.h"
+#include "Platform/Vulkan/VulkanTransferScheduler.h"
 #include "Platform/Vulkan/VulkanUtilities.h"
 
 namespace Povox {
@@ -10,201 +13,11 @@ namespace Povox {
 // ========== Commands ==========
 	CommandControlState VulkanCommandControl::s_CommandControlState{};
 	Ref<UploadContext> VulkanCommandControl::s_UploadContext = nullptr;
+	Ref<VulkanStagingRing> VulkanCommandControl::s_StagingRing = nullptr;
+	Ref<VulkanBarrierBatcher> VulkanCommandControl::s_BarrierBatcher = nullptr;
+	Ref<VulkanTransferScheduler> VulkanCommandControl::s_TransferScheduler = nullptr;
 		
 
-	void VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(SubmitType submitType,
-		std::function<void(VkCommandBuffer releasingCmd)>&& releaseFunction,
-		std::function<void(VkCommandBuffer acquireCmd) >&& acquireFunction)
-	{
-		if (!s_CommandControlState.IsInitialized)
-		{
-			PX_CORE_ERROR("UploadContext has to be set first!");
-			return;
-		}
-
-		VkCommandPool currentPool = VK_NULL_HANDLE;
-		VkCommandBuffer currentBuffer = VK_NULL_HANDLE;
-		VkQueue currentQueue = VK_NULL_HANDLE;
-		VkFence currentFence = VK_NULL_HANDLE;
-		switch (submitType)
-		{
-			case SubmitType::SUBMIT_TYPE_GRAPHICS_COMPUTE:
-			case SubmitType::SUBMIT_TYPE_GRAPHICS_TRANSFER:
-			{
-				currentPool = s_UploadContext->GraphicsCmdPool;
-				currentBuffer = s_UploadContext->GraphicsCmdBuffer;
-				currentFence = s_UploadContext->GraphicsFence;
-				currentQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue;
-				break;
-			}
-			case SubmitType::SUBMIT_TYPE_TRANSFER_GRAPHICS:
-			case SubmitType::SUBMIT_TYPE_TRANSFER_COMPUTE:
-			{
-				currentPool = s_UploadContext->TransferCmdPool;
-				currentBuffer = s_UploadContext->TransferCmdBuffer;
-				currentFence = s_UploadContext->TransferFence;
-				currentQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.TransferQueue;
-				break;
-			}
-			case SubmitType::SUBMIT_TYPE_COMPUTE_GRAPHICS:
-			case SubmitType::SUBMIT_TYPE_COMPUTE_TRANSFER:
-			{
-				currentPool = s_UploadContext->ComputeCmdPool;
-				currentBuffer = s_UploadContext->ComputeCmdBuffer;
-				currentFence = s_UploadContext->ComputeFence;
-				currentQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.ComputeQueue;
-				break;
-			}
-			default:
-			{
-				currentPool = s_UploadContext->GraphicsCmdPool;
-				currentBuffer = s_UploadContext->GraphicsCmdBuffer;
-				currentFence = s_UploadContext->GraphicsFence;
-				currentQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue;
-				PX_CORE_ERROR("This submit is only allowed for QOFT commands. Use VulkanCommandControl::ImmidiateSubmitOwnershipTransfer otherwise! Falling back to graphics queue");
-			}
-
-		}
-		VkCommandPool targetPool = VK_NULL_HANDLE;
-		VkCommandBuffer targetBuffer = VK_NULL_HANDLE;
-		VkQueue targetQueue = VK_NULL_HANDLE;
-		VkFence targetFence = VK_NULL_HANDLE;
-		switch (submitType)
-		{
-			case SubmitType::SUBMIT_TYPE_TRANSFER_GRAPHICS:
-			case SubmitType::SUBMIT_TYPE_COMPUTE_GRAPHICS:
-			{
-				targetPool = s_UploadContext->GraphicsCmdPool;
-				targetBuffer = s_UploadContext->GraphicsCmdBuffer;
-				targetFence = s_UploadContext->GraphicsFence;
-				targetQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue;
-				break;
-			}
-			case SubmitType::SUBMIT_TYPE_GRAPHICS_TRANSFER:
-			case SubmitType::SUBMIT_TYPE_COMPUTE_TRANSFER:
-			{
-				targetPool = s_UploadContext->TransferCmdPool;
-				targetBuffer = s_UploadContext->TransferCmdBuffer;
-				targetFence = s_UploadContext->TransferFence;
-				targetQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.TransferQueue;
-				break;
-			}
-			case SubmitType::SUBMIT_TYPE_GRAPHICS_COMPUTE:
-			case SubmitType::SUBMIT_TYPE_TRANSFER_COMPUTE:
-			{
-				targetPool = s_UploadContext->ComputeCmdPool;
-				targetBuffer = s_UploadContext->ComputeCmdBuffer;
-				targetFence = s_UploadContext->TransferFence;
-				targetQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.ComputeQueue;
-				break;
-			}
-			default:
-			{
-				targetPool = s_UploadContext->GraphicsCmdPool;
-				targetBuffer = s_UploadContext->GraphicsCmdBuffer;
-				targetFence = s_UploadContext->ComputeFence;
-				targetQueue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue;
-				PX_CORE_ERROR("This submit is only allowed for QOFT commands. Use VulkanCommandControl::ImmidiateSubmitOwnershipTransfer otherwise! Falling back to graphics queue");
-			}
-		}
-		if (!currentPool || !targetPool || !currentBuffer || !targetBuffer || !currentQueue || !targetQueue)
-		{
-			PX_CORE_ASSERT(true, "Something went wrong!");
-			return;
-		}
-
-		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-		VkSemaphore ownershipSemaphore;
-		VkSemaphoreCreateInfo semaInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
-		semaInfo.flags = VK_SEMAPHORE_TYPE_BINARY;
-		PX_CORE_VK_ASSERT(vkCreateSemaphore(device, &semaInfo, nullptr, &ownershipSemaphore), VK_SUCCESS, "Failed to create Ownership Transfer Semaphore!");
-				
-
-		VkCommandBufferBeginInfo cmdBeginInfo{};
-		cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		cmdBeginInfo.pInheritanceInfo = nullptr;
-				
-
-		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(currentBuffer, &cmdBeginInfo), VK_SUCCESS, "Failed to begin immidiate submit cmd buffer!");
-		releaseFunction(currentBuffer);
-		PX_CORE_VK_ASSERT(vkEndCommandBuffer(currentBuffer), VK_SUCCESS, "Failed to end cmd buffer!");
-		
-		VkCommandBufferSubmitInfo cmdBeginInfos{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
-		cmdBeginInfos.pNext = nullptr;
-		cmdBeginInfos.commandBuffer = currentBuffer;
-		cmdBeginInfos.deviceMask = 0;
-
-		VkSemaphoreSubmitInfo semaSubmitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-		semaSubmitInfo.pNext = nullptr;
-		semaSubmitInfo.semaphore = ownershipSemaphore;
-		semaSubmitInfo.deviceIndex = 0;
-		semaSubmitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-
-		VkSubmitInfo2 submitInfo2{ VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
-		submitInfo2.pNext = nullptr;
-		submitInfo2.flags = 0;
-		submitInfo2.waitSemaphoreInfoCount = 0;
-		submitInfo2.pWaitSemaphoreInfos = nullptr;
-		submitInfo2.signalSemaphoreInfoCount = 1;
-		submitInfo2.pSignalSemaphoreInfos = &semaSubmitInfo;
-		submitInfo2.commandBufferInfoCount = 1;
-		submitInfo2.pCommandBufferInfos = &cmdBeginInfos;
-
-// 		VkSubmitInfo submitInfo{};
-// 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-// 		submitInfo.pNext = nullptr;
-// 
-// 		submitInfo.waitSemaphoreCount = 0;
-// 		submitInfo.pWaitSemaphores = nullptr;
-// 		submitInfo.signalSemaphoreCount = 1;
-// 		submitInfo.pSignalSemaphores = &ownershipSemaphore;
-// 		submitInfo.pWaitDstStageMask = nullptr;
-// 		submitInfo.commandBufferCount = 1;
-// 		submitInfo.pCommandBuffers = &currentBuffer;
-		//PX_CORE_VK_ASSERT(vkQueueSubmit(currentQueue, 1, &submitInfo, currentFence), VK_SUCCESS, "Failed to submit cmd buffer!");
-		PX_CORE_VK_ASSERT(vkQueueSubmit2(currentQueue, 1, &submitInfo2, currentFence), VK_SUCCESS, "Failed to submit cmd buffer!");
-		
-		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(targetBuffer, &cmdBeginInfo), VK_SUCCESS, "Failed to begin immidate submit cmd buffer!");
-		acquireFunction(targetBuffer);
-		PX_CORE_VK_ASSERT(vkEndCommandBuffer(targetBuffer), VK_SUCCESS, "Failed to end cmd buffer!");
-
-		VkCommandBufferSubmitInfo targedCmdSubmit{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
-		targedCmdSubmit.pNext = nullptr;
-		targedCmdSubmit.commandBuffer = targetBuffer;
-		targedCmdSubmit.deviceMask = 0;
-		
-		submitInfo2.waitSemaphoreInfoCount = 1;
-		submitInfo2.pWaitSemaphoreInfos = &semaSubmitInfo;
-		submitInfo2.signalSemaphoreInfoCount = 0;
-		submitInfo2.pSignalSemaphoreInfos = nullptr;
-		submitInfo2.commandBufferInfoCount = 1;
-		submitInfo2.pCommandBufferInfos = &targedCmdSubmit;
-		
-// 		submitInfo.waitSemaphoreCount = 1;
-// 		submitInfo.pWaitSemaphores = &ownershipSemaphore;
-// 		submitInfo.signalSemaphoreCount = 0;
-// 		submitInfo.pSignalSemaphores = nullptr;
-
-// 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT };
-// 		submitInfo.pWaitDstStageMask = waitStages;
-// 		submitInfo.pCommandBuffers = &targetBuffer;
-		
-		
-		//PX_CORE_VK_ASSERT(vkQueueSubmit(targetQueue, 1, &submitInfo, targetFence), VK_SUCCESS, "Failed to submit cmd buffer!");
-		PX_CORE_VK_ASSERT(vkQueueSubmit2(targetQueue, 1, &submitInfo2, targetFence), VK_SUCCESS, "Failed to submit cmd buffer!");
-		
-		vkWaitForFences(device, 1, &currentFence, VK_TRUE, UINT64_MAX);
-		vkWaitForFences(device, 1, &targetFence, VK_TRUE, UINT64_MAX);
-		vkResetFences(device, 1, &currentFence);
-		vkResetFences(device, 1, &targetFence);
-
-		vkDestroySemaphore(device, ownershipSemaphore, nullptr);
-
-		PX_CORE_VK_ASSERT(vkResetCommandPool(device, currentPool, 0), VK_SUCCESS, "Failed to reset current command pool!");
-		PX_CORE_VK_ASSERT(vkResetCommandPool(device, targetPool, 0), VK_SUCCESS, "Failed to reset target command pool!");
-	}
-
 	void VulkanCommandControl::ImmidiateSubmit(SubmitType submitType, std::function<void(VkCommandBuffer cmd)>&& function)
 	{
 		if (!s_CommandControlState.IsInitialized)
@@ -240,6 +53,7 @@ namespace Povox {
 				pool = s_UploadContext->ComputeCmdPool;
 				buffer = s_UploadContext->ComputeCmdBuffer;
 				queue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.ComputeQueue;
+				fence = s_UploadContext->ComputeFence;
 				break;
 			}
 			default:
@@ -248,7 +62,7 @@ namespace Povox {
 				buffer = s_UploadContext->GraphicsCmdBuffer;
 				fence = s_UploadContext->ComputeFence;
 				queue = VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue;
-				PX_CORE_ERROR("This submit is only allowed for queue internal commands. Use VulkanCommandControl::ImmidiateSubmitOwnershipTransfer otherwise! Falling back to graphics queue");
+				PX_CORE_ERROR("This submit is only allowed for queue internal commands. Use the VulkanBarrierBatcher for ownership transfers! Falling back to graphics queue");
 			}
 		}
 		if (!pool || !buffer || !queue)
@@ -375,6 +189,36 @@ namespace Povox {
 		return s_UploadContext;
 	}
 
+	Ref<VulkanStagingRing> VulkanCommandControl::CreateStagingRing(uint32_t framesInFlight, size_t frameCapacity)
+	{
+		PX_CORE_INFO("VulkanCommandControl::CreateStagingRing: Creating...");
+
+		s_StagingRing = CreateRef<VulkanStagingRing>(framesInFlight, frameCapacity);
+
+		PX_CORE_INFO("VulkanCommandControl::CreateStagingRing: Completed.");
+		return s_StagingRing;
+	}
+
+	Ref<VulkanBarrierBatcher> VulkanCommandControl::CreateBarrierBatcher(uint32_t framesInFlight)
+	{
+		PX_CORE_INFO("VulkanCommandControl::CreateBarrierBatcher: Creating...");
+
+		s_BarrierBatcher = CreateRef<VulkanBarrierBatcher>(framesInFlight);
+
+		PX_CORE_INFO("VulkanCommandControl::CreateBarrierBatcher: Completed.");
+		return s_BarrierBatcher;
+	}
+
+	Ref<VulkanTransferScheduler> VulkanCommandControl::CreateTransferScheduler(uint32_t framesInFlight, size_t stagingBlockSize)
+	{
+		PX_CORE_INFO("VulkanCommandControl::CreateTransferScheduler: Creating...");
+
+		s_TransferScheduler = CreateRef<VulkanTransferScheduler>(framesInFlight, stagingBlockSize);
+
+		PX_CORE_INFO("VulkanCommandControl::CreateTransferScheduler: Completed.");
+		return s_TransferScheduler;
+	}
+
 	VulkanCommandControl::~VulkanCommandControl()
 	{
 		Destroy();
@@ -405,5 +249,21 @@ namespace Povox {
 		s_UploadContext->TransferFence = VK_NULL_HANDLE;
 		vkDestroyFence(device, s_UploadContext->ComputeFence, nullptr);
 		s_UploadContext->ComputeFence = VK_NULL_HANDLE;
+
+		if (s_StagingRing)
+		{
+			s_StagingRing->Destroy();
+			s_StagingRing = nullptr;
+		}
+		if (s_BarrierBatcher)
+		{
+			s_BarrierBatcher->Destroy();
+			s_BarrierBatcher = nullptr;
+		}
+		if (s_TransferScheduler)
+		{
+			s_TransferScheduler->Destroy();
+			s_TransferScheduler = nullptr;
+		}
 	}
 }
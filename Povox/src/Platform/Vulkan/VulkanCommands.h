@@ -9,6 +9,10 @@
 
 namespace Povox {
 
+	class VulkanBarrierBatcher;
+	class VulkanStagingRing;
+	class VulkanTransferScheduler;
+
 	struct CommandControlState
 	{
 		bool IsInitialized = false;
@@ -22,6 +26,9 @@ namespace Povox {
 
 		void Destroy();
 		Ref<UploadContext> CreateUploadContext();
+		Ref<VulkanStagingRing> CreateStagingRing(uint32_t framesInFlight, size_t frameCapacity);
+		Ref<VulkanBarrierBatcher> CreateBarrierBatcher(uint32_t framesInFlight);
+		Ref<VulkanTransferScheduler> CreateTransferScheduler(uint32_t framesInFlight, size_t stagingBlockSize);
 
 		enum class SubmitType
 		{
@@ -37,13 +44,14 @@ namespace Povox {
 			SUBMIT_TYPE_COMPUTE_GRAPHICS
 		};
 
-		static void ImmidiateSubmitOwnershipTransfer(SubmitType submitType,
-			std::function<void(VkCommandBuffer releasingCmd)> && releaseFunction,
-			std::function<void(VkCommandBuffer acquireCmd)> && acquireFunction);
-
 		static void ImmidiateSubmit(SubmitType submitType, std::function<void(VkCommandBuffer cmd)>&& function);
 
 		inline const Ref<UploadContext> GetUploadContext() { return s_UploadContext; }
+		static inline Ref<VulkanStagingRing> GetStagingRing() { return s_StagingRing; }
+		// Queue family ownership transfers go through here, see VulkanBarrierBatcher
+		static inline Ref<VulkanBarrierBatcher> GetBarrierBatcher() { return s_BarrierBatcher; }
+		// Asynchronous uploads on the transfer queue, see VulkanTransferScheduler
+		static inline Ref<VulkanTransferScheduler> GetTransferScheduler() { return s_TransferScheduler; }
 
 		static inline CommandControlState& GetState() { return s_CommandControlState; }
 		static inline bool IsInitialized() { return s_CommandControlState.IsInitialized; }
@@ -51,5 +59,8 @@ namespace Povox {
 	private:
 		static CommandControlState s_CommandControlState;
 		static Ref<UploadContext> s_UploadContext;
+		static Ref<VulkanStagingRing> s_StagingRing;
+		static Ref<VulkanBarrierBatcher> s_BarrierBatcher;
+		static Ref<VulkanTransferScheduler> s_TransferScheduler;
 	};
 }
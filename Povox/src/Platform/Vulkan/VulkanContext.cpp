@@ -6,6 +6,9 @@
 
 #include "Povox/Core/Application.h"
 #include "Povox/Renderer/Renderer.h"
+#include "Povox/Utils/FileUtility.h"
+
+#include "xxHash.h"
 
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -17,10 +20,11 @@ namespace Povox {
 	Ref<VulkanDevice> VulkanContext::s_Device = nullptr;
 	VkInstance VulkanContext::s_Instance = nullptr;
 	VmaAllocator VulkanContext::s_Allocator = nullptr;
+	VkPipelineCache VulkanContext::s_PipelineCache = VK_NULL_HANDLE;
 	Ref<VulkanDescriptorAllocator> VulkanContext::s_DescriptorAllocator = nullptr;
 	Ref<VulkanDescriptorLayoutCache> VulkanContext::s_DescriptorLayoutCache = nullptr;
 
-	std::vector<std::vector<std::function<void()>>> VulkanContext::s_ResourceFreeQueue;
+	std::deque<std::pair<uint64_t, std::function<void()>>> VulkanContext::s_ResourceFreeQueue;
 
 	VulkanContext::VulkanContext()
 	{
@@ -66,8 +70,11 @@ namespace Povox {
 		PX_CORE_ASSERT(s_DescriptorLayoutCache, "Failed to create DescriptorLayoutCache!");			
 		
 		PX_CORE_INFO("Completed DescriptorAllocator and DescriptorLayoutCache creation.");
+		PX_CORE_INFO("Creating PipelineCache...");
+
+		CreatePipelineCache();
 
-		s_ResourceFreeQueue.resize(Application::Get()->GetSpecification().MaxFramesInFlight);
+		PX_CORE_INFO("Completed PipelineCache creation.");
 
 		PX_CORE_INFO("VulkanContext: Completed initialization.");
 	}
@@ -79,16 +86,16 @@ namespace Povox {
 
 		vkDeviceWaitIdle(s_Device->GetVulkanDevice());
 
-		for (uint32_t frame = 0; frame < s_ResourceFreeQueue.size(); frame++)
-		{
-			FreeFrameResources(frame);
-		}
-		s_ResourceFreeQueue.clear();
+		FreeCompletedResources(UINT64_MAX);
 
 		
 		s_DescriptorAllocator->Cleanup();
 		s_DescriptorLayoutCache->Cleanup();
 
+		SavePipelineCache();
+		vkDestroyPipelineCache(s_Device->GetVulkanDevice(), s_PipelineCache, nullptr);
+		s_PipelineCache = VK_NULL_HANDLE;
+
 		//TODO: Destroy Devices
 		
 
@@ -98,6 +105,144 @@ namespace Povox {
 	}
 
 
+	// PipelineCache
+	namespace Utils {
+
+		static constexpr uint32_t PipelineCacheMagic = 0x43505850; // "PXPC"
+		static constexpr uint32_t PipelineCacheFileVersion = 1;
+
+		// Precedes the driver's cache data. The driver ignores data of other devices anyway, but a stale cache is dropped before it gets there
+		struct PipelineCacheFileHeader
+		{
+			uint32_t Magic = PipelineCacheMagic;
+			uint32_t FileVersion = PipelineCacheFileVersion;
+			uint32_t VendorID = 0;
+			uint32_t DeviceID = 0;
+			uint32_t DriverVersion = 0;
+			uint8_t DeviceUUID[VK_UUID_SIZE]{};
+			uint8_t PipelineCacheUUID[VK_UUID_SIZE]{};
+			uint64_t DataSize = 0;
+			uint64_t DataHash = 0;
+		};
+
+		static std::filesystem::path GetPipelineCachePath()
+		{
+			return std::filesystem::path(Utils::Pipeline::GetVKCacheDirectory()) / "PipelineCache.bin";
+		}
+
+		static PipelineCacheFileHeader GetDevicePipelineCacheHeader(VkPhysicalDevice physicalDevice)
+		{
+			VkPhysicalDeviceIDProperties idProperties{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
+			idProperties.pNext = nullptr;
+			VkPhysicalDeviceProperties2 properties{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+			properties.pNext = &idProperties;
+			vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+			PipelineCacheFileHeader header{};
+			header.VendorID = properties.properties.vendorID;
+			header.DeviceID = properties.properties.deviceID;
+			header.DriverVersion = properties.properties.driverVersion;
+			memcpy(header.DeviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+			memcpy(header.PipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+			return header;
+		}
+
+		static bool IsPipelineCacheCompatible(const PipelineCacheFileHeader& file, const PipelineCacheFileHeader& device)
+		{
+			return file.Magic == PipelineCacheMagic
+				&& file.FileVersion == PipelineCacheFileVersion
+				&& file.VendorID == device.VendorID
+				&& file.DeviceID == device.DeviceID
+				&& file.DriverVersion == device.DriverVersion
+				&& memcmp(file.DeviceUUID, device.DeviceUUID, VK_UUID_SIZE) == 0
+				&& memcmp(file.PipelineCacheUUID, device.PipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+	}
+
+	void VulkanContext::CreatePipelineCache()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		Utils::PipelineCacheFileHeader deviceHeader = Utils::GetDevicePipelineCacheHeader(s_Device->GetPhysicalDevice());
+		std::filesystem::path path = Utils::GetPipelineCachePath();
+
+		std::string cacheData;
+		if (std::filesystem::exists(path))
+		{
+			std::string file = Utils::Shader::ReadFile(path);
+
+			Utils::PipelineCacheFileHeader fileHeader{};
+			if (file.size() >= sizeof(fileHeader))
+				memcpy(&fileHeader, file.data(), sizeof(fileHeader));
+
+			if (file.size() < sizeof(fileHeader) || !Utils::IsPipelineCacheCompatible(fileHeader, deviceHeader))
+			{
+				PX_CORE_WARN("VulkanContext::CreatePipelineCache: '{0}' was written by another device or driver, starting with an empty cache.", path.string());
+			}
+			else if (file.size() - sizeof(fileHeader) != fileHeader.DataSize || XXH64(file.data() + sizeof(fileHeader), fileHeader.DataSize, 0) != fileHeader.DataHash)
+			{
+				PX_CORE_WARN("VulkanContext::CreatePipelineCache: '{0}' is corrupted, starting with an empty cache.", path.string());
+			}
+			else
+			{
+				cacheData = file.substr(sizeof(fileHeader));
+				PX_CORE_INFO("VulkanContext::CreatePipelineCache: Loaded {0} bytes from '{1}'.", cacheData.size(), path.string());
+			}
+		}
+
+		VkPipelineCacheCreateInfo info{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+		info.pNext = nullptr;
+		info.flags = 0;
+		info.initialDataSize = cacheData.size();
+		info.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+		PX_CORE_VK_ASSERT(vkCreatePipelineCache(s_Device->GetVulkanDevice(), &info, nullptr, &s_PipelineCache), VK_SUCCESS, "Failed to create PipelineCache!");
+	}
+
+	void VulkanContext::SavePipelineCache()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		VkDevice device = s_Device->GetVulkanDevice();
+
+		size_t dataSize = 0;
+		PX_CORE_VK_ASSERT(vkGetPipelineCacheData(device, s_PipelineCache, &dataSize, nullptr), VK_SUCCESS, "Failed to get PipelineCache size!");
+		if (dataSize == 0)
+			return;
+
+		std::vector<uint8_t> data(dataSize);
+		PX_CORE_VK_ASSERT(vkGetPipelineCacheData(device, s_PipelineCache, &dataSize, data.data()), VK_SUCCESS, "Failed to get PipelineCache data!");
+
+		Utils::PipelineCacheFileHeader header = Utils::GetDevicePipelineCacheHeader(s_Device->GetPhysicalDevice());
+		header.DataSize = dataSize;
+		header.DataHash = XXH64(data.data(), dataSize, 0);
+
+		Utils::Pipeline::CreateVKCacheDirectoryIfNeeded();
+		std::filesystem::path path = Utils::GetPipelineCachePath();
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+
+		// Written next to the cache first, an interrupted write never leaves a truncated cache behind
+		{
+			std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				PX_CORE_ERROR("VulkanContext::SavePipelineCache: Could not open '{0}'!", tempPath.string());
+				return;
+			}
+			out.write((const char*)&header, sizeof(header));
+			out.write((const char*)data.data(), dataSize);
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+			PX_CORE_ERROR("VulkanContext::SavePipelineCache: Could not replace '{0}': {1}", path.string(), error.message());
+		else
+			PX_CORE_INFO("VulkanContext::SavePipelineCache: Saved {0} bytes to '{1}'.", dataSize, path.string());
+	}
+
 	void VulkanContext::CreateInstance()
 	{
 		PX_CORE_INFO("VulkanContext::CreateInstance: Starting...");
@@ -248,18 +393,16 @@ namespace Povox {
 	//by Cherno
 	void VulkanContext::SubmitResourceFree(std::function<void()>&& func)
 	{
-		s_ResourceFreeQueue[Renderer::GetCurrentFrameIndex()].push_back(func);
+		s_ResourceFreeQueue.emplace_back(Renderer::GetCurrentFrameNumber(), std::move(func));
 	}
 
-	void VulkanContext::FreeFrameResources(uint32_t frameIndex)
+	void VulkanContext::FreeCompletedResources(uint64_t completedFrameNumber)
 	{
-		PX_CORE_ASSERT(frameIndex < s_ResourceFreeQueue.size(), "Invalid FrameIndex passed!");
-
-		vkDeviceWaitIdle(s_Device->GetVulkanDevice());
-		auto& queue = s_ResourceFreeQueue[frameIndex];
-		for (auto& func : queue)
-			func();
-		queue.clear();
+		while (!s_ResourceFreeQueue.empty() && s_ResourceFreeQueue.front().first <= completedFrameNumber)
+		{
+			s_ResourceFreeQueue.front().second();
+			s_ResourceFreeQueue.pop_front();
+		}
 	}
 
 }
@@ -20,6 +20,8 @@
 
 #include <glm/glm.hpp>
 
+#include <deque>
+
 
 
 namespace Povox {
@@ -38,10 +40,14 @@ namespace Povox {
 		static Ref<VulkanDescriptorAllocator> GetDescriptorAllocator() { return s_DescriptorAllocator; }
 		static Ref<VulkanDescriptorLayoutCache> GetDescriptorLayoutCache() { return s_DescriptorLayoutCache; }
 		static VmaAllocator GetAllocator() { return s_Allocator; }
-		static std::vector<std::vector<std::function<void()>>>& GetResourceFreeQueue() { return s_ResourceFreeQueue; }
+		// Shared by all graphics and compute pipelines, persisted in assets/cache/pipeline between runs
+		static VkPipelineCache GetPipelineCache() { return s_PipelineCache; }
+		static std::deque<std::pair<uint64_t, std::function<void()>>>& GetResourceFreeQueue() { return s_ResourceFreeQueue; }
 
+		// Runs func once the GPU completed the current frame, the last one that may still use the resource
 		static void SubmitResourceFree(std::function<void()>&& func);
-		static void FreeFrameResources(uint32_t frameIndex);
+		// Runs the frees of all frames up to and including completedFrameNumber
+		static void FreeCompletedResources(uint64_t completedFrameNumber);
 
 	private:
 	// stays here!
@@ -51,6 +57,10 @@ namespace Povox {
 		std::vector<const char*> GetRequiredExtensions();
 		void CheckRequiredExtensions(const std::vector<const char*>& glfwExtensions);
 
+		// PipelineCache
+		void CreatePipelineCache();
+		void SavePipelineCache();
+
 		// Debug
 		void SetupDebugMessenger();
 		void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
@@ -59,9 +69,11 @@ namespace Povox {
 		static Ref<VulkanDevice> s_Device;
 		static VkInstance s_Instance;
 		static VmaAllocator s_Allocator;
+		static VkPipelineCache s_PipelineCache;
 		
 		//by Cherno
-		static std::vector<std::vector<std::function<void()>>> s_ResourceFreeQueue;
+		// Frame number the free was submitted in and the free, in submission order
+		static std::deque<std::pair<uint64_t, std::function<void()>>> s_ResourceFreeQueue;
 
 		static Ref<VulkanDescriptorAllocator> s_DescriptorAllocator;
 		static Ref<VulkanDescriptorLayoutCache> s_DescriptorLayoutCache;
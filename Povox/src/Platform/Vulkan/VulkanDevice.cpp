@@ -69,12 +69,21 @@ namespace Povox {
 
 		shaderDrawParametersFeatures.shaderDrawParameters = VK_TRUE;
 
-		VkPhysicalDeviceHostQueryResetFeatures resetFeature{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES };
-		resetFeature.pNext = &shaderDrawParametersFeatures;
-		resetFeature.hostQueryReset = VK_TRUE;
+		// hostQueryReset has to live here, the standalone feature struct must not be chained together with the 1.2 features
+		VkPhysicalDeviceVulkan12Features device12Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		device12Features.pNext = &shaderDrawParametersFeatures;
+		device12Features.hostQueryReset = VK_TRUE;
+		device12Features.timelineSemaphore = VK_TRUE;
+		// Bindless texture array, see VulkanRenderer::CreateDescriptors
+		device12Features.descriptorIndexing = VK_TRUE;
+		device12Features.runtimeDescriptorArray = VK_TRUE;
+		device12Features.descriptorBindingPartiallyBound = VK_TRUE;
+		device12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		device12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		device12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
 
 		VkDeviceCreateInfo createInfo{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
-		createInfo.pNext = &resetFeature;
+		createInfo.pNext = &device12Features;
 		createInfo.flags = 0;
 
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
@@ -139,6 +148,19 @@ namespace Povox {
 		bool extensionSupported = CheckDeviceExtensionSupport(deviceExtensions, physicalDevice);
 		bool swapchainAdequat = extensionSupported ? QuerySwapchainSupport(physicalDevice).IsAdequat() : false;
 
+		VkPhysicalDeviceVulkan12Features supported12Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		VkPhysicalDeviceFeatures2 supportedFeatures2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+		supportedFeatures2.pNext = &supported12Features;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+		bool bindlessSupported = supported12Features.runtimeDescriptorArray && supported12Features.descriptorBindingPartiallyBound
+			&& supported12Features.descriptorBindingSampledImageUpdateAfterBind && supported12Features.descriptorBindingUpdateUnusedWhilePending
+			&& supported12Features.shaderSampledImageArrayNonUniformIndexing;
+		if (!bindlessSupported)
+		{
+			PX_CORE_WARN("Device '{0}' does not support descriptor indexing for bindless textures!", deviceProperties.deviceName);
+			return 0;
+		}
+
 
 		if (!FindQueueFamilies(physicalDevice).IsComplete() && extensionSupported && swapchainAdequat && supportedFeatures.samplerAnisotropy)
 		{
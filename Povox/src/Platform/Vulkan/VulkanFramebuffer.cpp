@@ -1,6 +1,8 @@
 #include "pxpch.h"
 #include "VulkanFramebuffer.h"
 
+#include "Platform/Vulkan/VulkanBarrierBatcher.h"
+#include "Platform/Vulkan/VulkanCommands.h"
 #include "Platform/Vulkan/VulkanContext.h"
 #include "Platform/Vulkan/VulkanDebug.h"
 #include "Platform/Vulkan/VulkanSwapchain.h"
@@ -66,6 +68,7 @@ namespace Povox {
 				imageSpec.Memory = MemoryUtils::MemoryUsage::GPU_ONLY;
 				imageSpec.MipLevels = 1;
 				imageSpec.Tiling = ImageTiling::OPTIMAL;
+				imageSpec.Transient = attachment.Transient;
 				if (Utils::IsDepthFormat(attachment.Format))
 				{
 					PX_CORE_ASSERT(!m_Specification.HasDepthAttachment, "VulkanFramebuffer: Only one Depth-Atachment allowed!");
@@ -76,7 +79,8 @@ namespace Povox {
 					std::dynamic_pointer_cast<VulkanImage2D>(m_DepthAttachment)->TransitionImageLayout(
 						VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
 						VK_PIPELINE_STAGE_2_NONE, 0,
-						VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+						VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+						true
 					);
 					PX_CORE_TRACE("FB: Creating DepthAttachment");
 					m_Specification.HasDepthAttachment = true;
@@ -89,7 +93,8 @@ namespace Povox {
 					std::dynamic_pointer_cast<VulkanImage2D>(colorImage)->TransitionImageLayout(
 						VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
 						VK_PIPELINE_STAGE_2_NONE, 0,
-						VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, VK_ACCESS_2_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR
+						VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, VK_ACCESS_2_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR,
+						true
 					);
 					m_ColorAttachments.emplace_back(colorImage);
 					m_Specification.ColorAttachmentCount++;
@@ -97,6 +102,9 @@ namespace Povox {
 				}
 			}
 			index++;
+
+			// All attachment transitions go out in one submit
+			VulkanCommandControl::GetBarrierBatcher()->SubmitImmediate();
 		}
 	}
 
@@ -235,6 +243,21 @@ namespace Povox {
 #endif // DEBUG
 	}
 
+	void VulkanFramebuffer::RecreateFramebuffer()
+	{
+		if (m_Framebuffer)
+		{
+			// Frames in flight may still use the old handle
+			VkFramebuffer framebuffer = m_Framebuffer;
+			VulkanContext::SubmitResourceFree([=]()
+				{
+					vkDestroyFramebuffer(VulkanContext::GetDevice()->GetVulkanDevice(), framebuffer, nullptr);
+				});
+			m_Framebuffer = VK_NULL_HANDLE;
+		}
+		CreateFramebuffer();
+	}
+
 	void VulkanFramebuffer::Recreate(uint32_t width, uint32_t height)
 	{	
 		PX_PROFILE_FUNCTION();
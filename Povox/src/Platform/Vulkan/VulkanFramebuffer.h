@@ -48,6 +48,8 @@ namespace Povox {
 		virtual ~VulkanFramebuffer();
 				
 		virtual void Recreate(uint32_t width = 0, uint32_t height = 0) override;
+		// Only the VkFramebuffer, after the attachment images got new views (e.g. placed in aliased memory by a RenderGraph)
+		void RecreateFramebuffer();
 		void Destroy();
 		
 		virtual inline const FramebufferSpecification& GetSpecification() const override { return m_Specification; };
@@ -1,10 +1,13 @@
 #include "pxpch.h"
 #include "VulkanImage2D.h"
 
+#include "Platform/Vulkan/VulkanBarrierBatcher.h"
 #include "Platform/Vulkan/VulkanCommands.h"
 #include "Platform/Vulkan/VulkanContext.h"
 #include "Platform/Vulkan/VulkanBuffer.h"
 #include "Platform/Vulkan/VulkanDebug.h"
+#include "Platform/Vulkan/VulkanTransferScheduler.h"
+#include "Platform/Vulkan/VulkanTransientAllocator.h"
 #include "Platform/Vulkan/VulkanUtilities.h"
 
 
@@ -52,33 +55,32 @@ namespace Povox {
 	{
 		PX_CORE_WARN("VulkanImage2D::Free Image {}", m_Specification.DebugName);
 
-		VulkanContext::SubmitResourceFree([=]()
+		// The handles are captured, the image may be gone by the time its last frame completed
+		VulkanContext::SubmitResourceFree([sampler = m_OwnsSampler ? m_Sampler : VK_NULL_HANDLE, view = m_View, allocation = m_Allocation, debugName = m_Specification.DebugName]()
 		{
 			VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-			PX_CORE_WARN("VulkanImage2D::Destroying Image {}", m_Specification.DebugName);
-
-			if (m_Sampler && m_OwnsSampler)
-			{
-				vkDestroySampler(device, m_Sampler, nullptr);
-				m_Sampler = VK_NULL_HANDLE;
-			}
-			if (m_View)
-			{
-				vkDestroyImageView(device, m_View, nullptr);
-				m_View = VK_NULL_HANDLE;
-			}
-			if (m_Allocation.Image)
-			{
-				vmaDestroyImage(VulkanContext::GetAllocator(), m_Allocation.Image, m_Allocation.Allocation);
-				m_Allocation.Image = VK_NULL_HANDLE;
-				m_Allocation.Allocation = VK_NULL_HANDLE;
-			}
-
+			PX_CORE_WARN("VulkanImage2D::Destroying Image {}", debugName);
+
+			if (sampler)
+				vkDestroySampler(device, sampler, nullptr);
+			if (view)
+				vkDestroyImageView(device, view, nullptr);
+			if (allocation.Image)
+				vmaDestroyImage(VulkanContext::GetAllocator(), allocation.Image, allocation.Allocation);
 		});
+		if (m_OwnsSampler)
+			m_Sampler = VK_NULL_HANDLE;
+		m_View = VK_NULL_HANDLE;
+		m_Allocation.Image = VK_NULL_HANDLE;
+		m_Allocation.Allocation = VK_NULL_HANDLE;
 		
 	}
 
-	AllocatedImage VulkanImage2D::CreateAllocation(VkExtent3D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memUsage, VkImageLayout initialLayout, QueueFamilyOwnership ownership, std::string debugName)
+	/**
+	 * With aliasedMemory the image is bound at aliasedOffset into that allocation instead of getting its own,
+	 * the returned Allocation is VK_NULL_HANDLE then and destroying the image leaves the memory alone.
+	 */
+	AllocatedImage VulkanImage2D::CreateAllocation(VkExtent3D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memUsage, VkImageLayout initialLayout, QueueFamilyOwnership ownership, std::string debugName, VmaAllocation aliasedMemory, VkDeviceSize aliasedOffset)
 	{
 		VkImageCreateInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -129,8 +131,16 @@ namespace Povox {
 
 
 		//allocation needs to be cleaned up later
-		AllocatedImage output;
-		PX_CORE_VK_ASSERT(vmaCreateImage(VulkanContext::GetAllocator(), &info, &allocationInfo, &output.Image, &output.Allocation, nullptr), VK_SUCCESS, "Failed to create Image!");
+		AllocatedImage output{};
+		if (aliasedMemory)
+		{
+			PX_CORE_VK_ASSERT(vmaCreateAliasingImage2(VulkanContext::GetAllocator(), aliasedMemory, aliasedOffset, &info, &output.Image), VK_SUCCESS, "Failed to create aliasing Image!");
+			output.Allocation = VK_NULL_HANDLE;
+		}
+		else
+		{
+			PX_CORE_VK_ASSERT(vmaCreateImage(VulkanContext::GetAllocator(), &info, &allocationInfo, &output.Image, &output.Allocation, nullptr), VK_SUCCESS, "Failed to create Image!");
+		}
 		
 #ifdef PX_DEBUG
 		if(!debugName.empty())
@@ -150,330 +160,59 @@ namespace Povox {
 
 	// TODO: image layout transitions should happen as often as possible in subpasses!
 	/**
-	 * Will automatically switch ownership to QFO_TRANSFER if finalLayout contains LAYOUT_TRANSFER_*_
+	 * Will automatically switch ownership to the queue that executes dstStage (QFO_TRANSFER for transfer stages).
+	 * The barrier is handed to the VulkanBarrierBatcher, with deferSubmit the caller flushes several transitions at once.
 	 */
 	void VulkanImage2D::TransitionImageLayout(
 		VkImageLayout initialLayout, VkImageLayout finalLayout, 
 		VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcMask, 
-		VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstMask)
+		VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstMask,
+		bool deferSubmit)
 	{
 		PX_PROFILE_FUNCTION();
 
-		QueueFamilyOwnership originalOwnership = m_Ownership;
 
-		auto& queueFamilies = VulkanContext::GetDevice()->GetQueueFamilies();
-		uint32_t currentIndex;
-		VulkanCommandControl::SubmitType submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_UNDEFINED;
-		QueueFamilyOwnership targetOwner = QueueFamilyOwnership::QFO_UNDEFINED;
-		/* If the image layout currently is in a transfer layout, it was target to a transfer command OR will likely switch from SRD to DST or vice versa
-		*  If the final layout is a transfer layout, it will be target to a transfer command and therefore always transfers ownership to TransferQueue, if its not already there and transfer is not an exclusive queue
-		*  For now, when changing the layout from transfer to something else, it will end up in the graphics queue and a separate ownership transfer is needed when the image is planned to be used in a different queue
+		/* The queue executing dstStage becomes the new owner. Stages no queue claims (e.g. HOST) keep the current owner.
+		*  Coming from QFO_UNDEFINED the contents are discarded anyway, so no ownership transfer is needed.
 		*/
-		switch (m_Ownership)
-		{
-			case QueueFamilyOwnership::QFO_UNDEFINED:
-			{
-				currentIndex = VK_QUEUE_FAMILY_IGNORED;
-				
-				if (VulkanUtils::IsGraphicsStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_GRAPHICS;
-					targetOwner = QueueFamilyOwnership::QFO_GRAPHICS;
-					break;
-				}
-				if (VulkanUtils::IsComputeStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_COMPUTE;
-					targetOwner = QueueFamilyOwnership::QFO_COMPUTE;
-
-					break;
-				}
-				if (VulkanUtils::IsTransferStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_TRANSFER;
-					targetOwner = QueueFamilyOwnership::QFO_TRANSFER;
-
-					break;
-				}
-
-				PX_CORE_ASSERT(true, "dstStage not caught yet!");
-				break;
-			}
-			case QueueFamilyOwnership::QFO_GRAPHICS:
-			{
-				currentIndex = queueFamilies.GraphicsFamilyIndex;
-				if (VulkanUtils::IsGraphicsStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_GRAPHICS;
-					targetOwner = QueueFamilyOwnership::QFO_GRAPHICS;
-
-					break;
-				}
-				if (VulkanUtils::IsComputeStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_COMPUTE;
-					targetOwner = QueueFamilyOwnership::QFO_COMPUTE;
-
-					break;
-				}
-				if (VulkanUtils::IsTransferStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_TRANSFER;
-					targetOwner = QueueFamilyOwnership::QFO_TRANSFER;
-
-					break;
-				}
-
-				PX_CORE_ASSERT(true, "dstStage not caught yet!");
-				break;				
-			}
-			case QueueFamilyOwnership::QFO_TRANSFER:
-			{
-				currentIndex = queueFamilies.TransferFamilyIndex;
-				if (VulkanUtils::IsGraphicsStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_GRAPHICS;
-					targetOwner = QueueFamilyOwnership::QFO_GRAPHICS;
-
-					break;
-				}
-				if (VulkanUtils::IsComputeStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_COMPUTE;
-					targetOwner = QueueFamilyOwnership::QFO_COMPUTE;
-
-					break;
-				}
-				if (VulkanUtils::IsTransferStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_TRANSFER;
-					targetOwner = QueueFamilyOwnership::QFO_TRANSFER;
-
-					break;
-				}
-
-				PX_CORE_ASSERT(true, "dstStage not caught yet!");
-				break;				
-			}
-			case QueueFamilyOwnership::QFO_COMPUTE:
-			{
-				currentIndex = queueFamilies.ComputeFamilyIndex;
-				if (VulkanUtils::IsGraphicsStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_GRAPHICS;
-					targetOwner = QueueFamilyOwnership::QFO_GRAPHICS;
-
-					break;
-				}
-				if (VulkanUtils::IsComputeStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_COMPUTE;
-					targetOwner = QueueFamilyOwnership::QFO_COMPUTE;
-
-					break;
-				}
-				if (VulkanUtils::IsTransferStage(dstStage))
-				{
-					submitType = VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_TRANSFER;
-					targetOwner = QueueFamilyOwnership::QFO_TRANSFER;
-
-					break;
-				}
-
-				PX_CORE_ASSERT(true, "dstStage not caught yet!");
-				break;				
-			}
-			default:
-			{
-				PX_CORE_ASSERT(true, "QueueFamilyOwnership not caught!");
-			}
-			break;
-		}			
-		
-		switch (submitType)
-		{
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_COMPUTE:
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_GRAPHICS:
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_TRANSFER:
-			{
-				VulkanCommandControl::ImmidiateSubmit(submitType, [=](VkCommandBuffer cmd)
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = currentIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.srcStageMask = srcStage;
-						barrier.srcAccessMask = srcMask;
-						barrier.dstStageMask = dstStage;
-						barrier.dstAccessMask = dstMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(cmd, &dependency);
-					});
-				m_CurrentLayout = finalLayout;
-				m_Ownership = targetOwner;
-				break;
-			}
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_GRAPHICS:
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_GRAPHICS:
-			{	
-				VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(submitType
-					, [=](VkCommandBuffer releaseCmd)				
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = queueFamilies.GraphicsFamilyIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.srcStageMask = srcStage;
-						barrier.srcAccessMask = srcMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(releaseCmd, &dependency);
-					}, [=](VkCommandBuffer acquireCmd) 
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = queueFamilies.GraphicsFamilyIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.dstStageMask = dstStage;
-						barrier.dstAccessMask = dstMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(acquireCmd, &dependency);
-					});
-				m_Ownership = QueueFamilyOwnership::QFO_GRAPHICS;
-				break;
-			}
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_TRANSFER:
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_TRANSFER:
-			{
-				VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(submitType
-					, [=](VkCommandBuffer releaseCmd)
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = queueFamilies.TransferFamilyIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.srcStageMask = srcStage;
-						barrier.srcAccessMask = srcMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(releaseCmd, &dependency);
-					}, [=](VkCommandBuffer acquireCmd)
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = queueFamilies.TransferFamilyIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.dstStageMask = dstStage;
-						barrier.dstAccessMask = dstMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(acquireCmd, &dependency);
-					});
-				m_Ownership = QueueFamilyOwnership::QFO_TRANSFER;
-				break;
-			}
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_TRANSFER_COMPUTE:
-			case VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_COMPUTE:
-			{
-				VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(submitType, [=](VkCommandBuffer releaseCmd)
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = queueFamilies.ComputeFamilyIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.srcStageMask = srcStage;
-						barrier.srcAccessMask = srcMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(releaseCmd, &dependency);
-					}, [=](VkCommandBuffer acquireCmd)
-					{
-						VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-						barrier.image = m_Allocation.Image;
-						barrier.oldLayout = initialLayout;
-						barrier.newLayout = finalLayout;
-						barrier.srcQueueFamilyIndex = currentIndex;
-						barrier.dstQueueFamilyIndex = queueFamilies.ComputeFamilyIndex;
-						barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
-						barrier.subresourceRange.baseMipLevel = 0;
-						barrier.subresourceRange.levelCount = 1;
-						barrier.subresourceRange.baseArrayLayer = 0;
-						barrier.subresourceRange.layerCount = 1;
-
-						barrier.dstStageMask = dstStage;
-						barrier.dstAccessMask = dstMask;
-
-						VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR };
-						dependency.imageMemoryBarrierCount = 1;
-						dependency.pImageMemoryBarriers = &barrier;
-						vkCmdPipelineBarrier2(acquireCmd, &dependency);
-					});
-				m_Ownership = QueueFamilyOwnership::QFO_COMPUTE;
-				break;
-			}			
-		}
+		QueueFamilyOwnership targetOwner = m_Ownership;
+		if (VulkanUtils::IsGraphicsStage(dstStage))
+			targetOwner = QueueFamilyOwnership::QFO_GRAPHICS;
+		else if (VulkanUtils::IsComputeStage(dstStage))
+			targetOwner = QueueFamilyOwnership::QFO_COMPUTE;
+		else if (VulkanUtils::IsTransferStage(dstStage))
+			targetOwner = QueueFamilyOwnership::QFO_TRANSFER;
+		if (targetOwner == QueueFamilyOwnership::QFO_UNDEFINED)
+			targetOwner = QueueFamilyOwnership::QFO_GRAPHICS;
+
+		VkImageMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+		barrier.pNext = nullptr;
+		barrier.image = m_Allocation.Image;
+		barrier.oldLayout = initialLayout;
+		barrier.newLayout = finalLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange.aspectMask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcMask;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstMask;
+
+		Ref<VulkanBarrierBatcher> batcher = VulkanCommandControl::GetBarrierBatcher();
+		if (m_Ownership == QueueFamilyOwnership::QFO_UNDEFINED || m_Ownership == targetOwner)
+			batcher->AddImageBarrier(targetOwner, barrier);
+		else
+			batcher->AddImageOwnershipTransfer(m_Ownership, targetOwner, barrier);
+
+		if (!deferSubmit)
+			batcher->SubmitImmediate();
+
+		m_Ownership = targetOwner;
 		m_CurrentLayout = finalLayout;
 		CreateDescriptorInfo();
 	}
@@ -526,6 +265,37 @@ namespace Povox {
 		vmaDestroyBuffer(VulkanContext::GetAllocator(), stagingBuffer.Buffer, stagingBuffer.Allocation);
 	}
 
+	UploadHandle VulkanImage2D::SetDataAsync(void* data)
+	{
+		Ref<VulkanTransferScheduler> scheduler = VulkanCommandControl::GetTransferScheduler();
+		if (!scheduler)
+		{
+			SetData(data);
+			return UploadHandle{};
+		}
+
+		VkImageLayout finalLayout;
+		if (m_Specification.Usages.ContainsUsage(ImageUsage::SAMPLED))
+		{
+			finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		else
+		{
+			finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+
+		size_t imageSize = m_Specification.Width * m_Specification.Height * m_Specification.ChannelCount;
+		VkExtent3D extent{ static_cast<uint32_t>(m_Specification.Width), static_cast<uint32_t>(m_Specification.Height), 1 };
+		UploadHandle handle = scheduler->UploadImage(m_Allocation.Image, VK_IMAGE_ASPECT_COLOR_BIT, extent, data, imageSize, finalLayout, QueueFamilyOwnership::QFO_GRAPHICS);
+
+		// Layout and ownership are what the image will have once the upload has been handed off
+		m_Ownership = QueueFamilyOwnership::QFO_GRAPHICS;
+		m_CurrentLayout = finalLayout;
+		CreateDescriptorInfo();
+
+		return handle;
+	}
+
 	int VulkanImage2D::ReadPixel(int posX, int posY)
 	{
 		// TODO: Check if the image I want to read from is readable (was downloaded from GPU after rendering)
@@ -580,7 +350,8 @@ namespace Povox {
 	{
 		m_Ownership = QueueFamilyOwnership::QFO_UNDEFINED;
 		m_Allocation = CreateAllocation({ m_Specification.Width, m_Specification.Height, 1 }, VulkanUtils::GetVulkanImageFormat(m_Specification.Format), VulkanUtils::GetVulkanTiling(m_Specification.Tiling),
-			VulkanUtils::GetVulkanImageUsages(m_Specification.Usages), VulkanUtils::GetVmaUsage(m_Specification.Memory), VK_IMAGE_LAYOUT_UNDEFINED, m_Ownership, m_Specification.DebugName);
+			VulkanUtils::GetVulkanImageUsages(m_Specification.Usages), VulkanUtils::GetVmaUsage(m_Specification.Memory), VK_IMAGE_LAYOUT_UNDEFINED, m_Ownership, m_Specification.DebugName,
+			m_AliasedMemory ? m_AliasedMemory->GetAllocation() : VK_NULL_HANDLE, m_AliasedOffset);
 
 #ifdef PX_DEBUG
 		VkDebugUtilsObjectNameInfoEXT nameInfo{};
@@ -594,6 +365,47 @@ namespace Povox {
 		PX_CORE_INFO("VulkanImage2D::CreateImage: Created Image {} with extent '{}, {}'", m_Specification.DebugName, m_Specification.Width, m_Specification.Height);
 	}
 
+	VkMemoryRequirements VulkanImage2D::GetMemoryRequirements() const
+	{
+		VkMemoryRequirements requirements{};
+		vkGetImageMemoryRequirements(VulkanContext::GetDevice()->GetVulkanDevice(), m_Allocation.Image, &requirements);
+		return requirements;
+	}
+
+	/**
+	 * Recreates image and view bound to the given memory, the contents and the layout are undefined afterwards.
+	 * Without memory the image gets its own allocation again. Descriptors written with the old view have to be written again.
+	 */
+	void VulkanImage2D::Alias(Ref<VulkanAliasedMemory> memory, VkDeviceSize offset)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		if (memory == m_AliasedMemory && offset == m_AliasedOffset)
+			return;
+
+		// Frames in flight may still use the old image, the memory it was bound to is kept alive until then
+		VkImageView view = m_View;
+		AllocatedImage allocation = m_Allocation;
+		Ref<VulkanAliasedMemory> previousMemory = m_AliasedMemory;
+		VulkanContext::SubmitResourceFree([=]()
+			{
+				vkDestroyImageView(VulkanContext::GetDevice()->GetVulkanDevice(), view, nullptr);
+				vmaDestroyImage(VulkanContext::GetAllocator(), allocation.Image, allocation.Allocation);
+				(void)previousMemory;
+			});
+
+		m_AliasedMemory = memory;
+		m_AliasedOffset = memory ? offset : 0;
+		CreateImage();
+		CreateImageView();
+
+		m_CurrentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		CreateDescriptorInfo();
+		if (m_DescriptorSet)
+			CreateDescriptorSet();
+	}
+
 	void VulkanImage2D::CreateImageView()
 	{
 		VkImageAspectFlags mask = VulkanUtils::GetAspectFlagsFromUsages(m_Specification.Usages);
@@ -754,7 +566,8 @@ namespace Povox {
 
 		PX_CORE_TRACE("Texture width : '{0}', height '{1}', RID: {2}", width, height, std::to_string(m_Handle).c_str());
 
-		SetData(pixels);
+		// Staged immediately, so the pixels can be freed right away. Until the upload is complete the texture is not ready to be sampled
+		m_Upload = SetDataAsync(pixels);
 		stbi_image_free(pixels);
 	}
 
@@ -767,5 +580,18 @@ namespace Povox {
 	void VulkanTexture2D::SetData(void* data)
 	{
 		m_Image->SetData(data);
+		m_Upload = UploadHandle{};
+	}
+
+	UploadHandle VulkanTexture2D::SetDataAsync(void* data)
+	{
+		m_Upload = m_Image->SetDataAsync(data);
+		return m_Upload;
+	}
+
+	bool VulkanTexture2D::IsReady() const
+	{
+		Ref<VulkanTransferScheduler> scheduler = VulkanCommandControl::GetTransferScheduler();
+		return !scheduler || scheduler->IsComplete(m_Upload);
 	}
 }
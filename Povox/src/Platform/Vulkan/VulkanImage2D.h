@@ -100,6 +100,8 @@ namespace Povox {
 		}
 	}
 
+	class VulkanAliasedMemory;
+
 	struct AllocatedImage
 	{
 		VkImage Image;
@@ -118,23 +120,31 @@ namespace Povox {
 
 		virtual const ImageSpecification& GetSpecification() const override { return m_Specification; }
 		virtual void SetData(void* data) override;
+		virtual UploadHandle SetDataAsync(void* data) override;
 
 		virtual void* GetDescriptorSet() override { return m_DescriptorSet; }
 		void SetDescriptorSet(VkDescriptorSet set) { m_DescriptorSet = set; }
 
 		virtual int ReadPixel(int posX, int posY) override;
 
-		static AllocatedImage CreateAllocation(VkExtent3D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memUsage, VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, QueueFamilyOwnership ownership = QueueFamilyOwnership::QFO_UNDEFINED, std::string debugName = std::string());
+		static AllocatedImage CreateAllocation(VkExtent3D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memUsage, VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, QueueFamilyOwnership ownership = QueueFamilyOwnership::QFO_UNDEFINED, std::string debugName = std::string(), VmaAllocation aliasedMemory = VK_NULL_HANDLE, VkDeviceSize aliasedOffset = 0);
+
+		VkMemoryRequirements GetMemoryRequirements() const;
+		void Alias(Ref<VulkanAliasedMemory> memory, VkDeviceSize offset = 0);
+		inline bool IsAliased() const { return m_AliasedMemory != nullptr; }
 
 		void TransitionImageLayout(
 			VkImageLayout initialLayout, VkImageLayout finalLayout,
 			VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcMask,
-			VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstMask);
+			VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstMask,
+			bool deferSubmit = false);
 
 		inline VkImageView GetImageView() const { return m_View; }
 		inline VkSampler GetSampler() const { return m_Sampler; }
 		inline VkImage GetImage() { return m_Allocation.Image; }
 		inline VkDescriptorImageInfo GetImageInfo() { return m_DescriptorInfo; }
+		inline VkImageLayout GetCurrentLayout() const { return m_CurrentLayout; }
+		inline QueueFamilyOwnership GetOwnership() const { return m_Ownership; }
 		
 
 		void CreateDescriptorSet();
@@ -166,6 +176,10 @@ namespace Povox {
 		VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
 
 		QueueFamilyOwnership m_Ownership = QueueFamilyOwnership::QFO_UNDEFINED;
+
+		// Set while the image lives in memory shared with other transient images
+		Ref<VulkanAliasedMemory> m_AliasedMemory = nullptr;
+		VkDeviceSize m_AliasedOffset = 0;
 	};
 
 
@@ -182,6 +196,8 @@ namespace Povox {
 		virtual inline uint32_t GetHeight() const override { return m_Image->GetSpecification().Height; };
 
 		virtual void SetData(void* data) override;
+		virtual UploadHandle SetDataAsync(void* data) override;
+		virtual bool IsReady() const override;
 
 		virtual const Ref<Image2D> GetImage() const override { return m_Image; }
 		virtual Ref<Image2D> GetImage() override { return m_Image; }
@@ -197,5 +213,6 @@ namespace Povox {
 		Ref<VulkanImage2D> m_Image = nullptr;
 
 		std::string m_Path = "";
+		UploadHandle m_Upload{};
 	};
 }
@@ -13,6 +13,51 @@ namespace Povox {
 
 	namespace VulkanUtils {
 
+		// Only constants the shader declares with a matching type are specialized, usedNames collects them across stages
+		static bool BuildSpecialization(const std::vector<ShaderSpecializationConstant>& constants, const SpecializationConstantMap& values, const std::string& debugName,
+			VulkanSpecialization& outSpecialization, std::set<std::string>& usedNames)
+		{
+			outSpecialization.Entries.clear();
+			outSpecialization.Data.clear();
+			for (const auto& constant : constants)
+			{
+				auto it = values.find(constant.Name);
+				if (it == values.end())
+					continue;
+
+				if (it->second.Type != constant.Type)
+				{
+					PX_CORE_WARN("Pipeline {0}: Specialization constant {1} is {2} in the shader but was given as {3}!", debugName, constant.Name,
+						ToStringUtility::ShaderDataTypeToString(constant.Type), ToStringUtility::ShaderDataTypeToString(it->second.Type));
+					continue;
+				}
+				usedNames.insert(constant.Name);
+
+				VkSpecializationMapEntry entry{};
+				entry.constantID = constant.ConstantID;
+				entry.offset = static_cast<uint32_t>(outSpecialization.Data.size() * sizeof(uint32_t));
+				entry.size = sizeof(uint32_t);
+				outSpecialization.Entries.push_back(entry);
+				outSpecialization.Data.push_back(it->second.Data);
+			}
+
+			VkSpecializationInfo& info = outSpecialization.Info;
+			info.mapEntryCount = static_cast<uint32_t>(outSpecialization.Entries.size());
+			info.pMapEntries = outSpecialization.Entries.data();
+			info.dataSize = outSpecialization.Data.size() * sizeof(uint32_t);
+			info.pData = outSpecialization.Data.data();
+			return !outSpecialization.Entries.empty();
+		}
+
+		static void WarnUnusedSpecializationConstants(const SpecializationConstantMap& values, const std::set<std::string>& usedNames, const std::string& debugName)
+		{
+			for (const auto& [name, value] : values)
+			{
+				if (usedNames.find(name) == usedNames.end())
+					PX_CORE_WARN("Pipeline {0}: Shader has no specialization constant {1}!", debugName, name);
+			}
+		}
+
 		static VkPrimitiveTopology GetVulkanPrimitiveTopology(PipelineUtils::PrimitiveTopology topo)
 		{
 			switch (topo)
@@ -122,19 +167,16 @@ namespace Povox {
 
 	void VulkanPipeline::Free()
 	{
+		// The handles are captured, the pipeline may be gone by the time its last frame completed
 		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-		VulkanContext::SubmitResourceFree([device, this]() {
-			if (m_Layout)
-			{
-				vkDestroyPipelineLayout(device, m_Layout, nullptr);
-				m_Layout = VK_NULL_HANDLE;
-			}
-			if (m_Pipeline)
-			{
-				vkDestroyPipeline(device, m_Pipeline, nullptr);
-				m_Pipeline = VK_NULL_HANDLE;
-			}
+		VulkanContext::SubmitResourceFree([device, layout = m_Layout, pipeline = m_Pipeline]() {
+			if (layout)
+				vkDestroyPipelineLayout(device, layout, nullptr);
+			if (pipeline)
+				vkDestroyPipeline(device, pipeline, nullptr);
 		});
+		m_Layout = VK_NULL_HANDLE;
+		m_Pipeline = VK_NULL_HANDLE;
 
 	}
 
@@ -172,19 +214,15 @@ namespace Povox {
 		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		layoutInfo.pNext = nullptr;
 
-		layoutInfo.pushConstantRangeCount = 0;		// optional
-		layoutInfo.pPushConstantRanges = nullptr;	// optional
 		layoutInfo.setLayoutCount = static_cast<uint32_t>(layouts.size());
 		PX_CORE_INFO("DescriptorSetLayout count = '{0}'", layoutInfo.setLayoutCount);
 		layoutInfo.pSetLayouts = layouts.data();
 
-		VkPushConstantRange pushConstant;
-		pushConstant.offset = 0;
-		pushConstant.size = sizeof(PushConstants);
-		pushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-		layoutInfo.pushConstantRangeCount = 1;
-		layoutInfo.pPushConstantRanges = &pushConstant;
+		// As reflected, hot reloads keep them unchanged so the layout stays valid
+		m_PushConstantRanges = shader->GetPushConstantRanges();
+		m_PushConstantBlocks = shader->GetPushConstantBlocks();
+		layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(m_PushConstantRanges.size());
+		layoutInfo.pPushConstantRanges = m_PushConstantRanges.data();
 		PX_CORE_VK_ASSERT(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &m_Layout), VK_SUCCESS, "Failed to create GraphicsPipelineLayout!");
 
 #ifdef PX_DEBUG
@@ -200,6 +238,32 @@ namespace Povox {
 	}
 
 
+	VkShaderStageFlags VulkanPipeline::GetPushConstantStages(uint32_t offset, uint32_t size) const
+	{
+		// Every range touching the bytes has to be named, and each of them has to contain all of the bytes
+		VkShaderStageFlags stages = 0;
+		for (const auto& range : m_PushConstantRanges)
+		{
+			if (offset >= range.offset + range.size || range.offset >= offset + size)
+				continue;
+			if (offset < range.offset || offset + size > range.offset + range.size)
+				return 0;
+			stages |= range.stageFlags;
+		}
+		return stages;
+	}
+
+	VkShaderStageFlags VulkanPipeline::GetPushConstantStages(const std::string& blockType, uint32_t offset, uint32_t size) const
+	{
+		for (size_t i = 0; i < m_PushConstantRanges.size() && i < m_PushConstantBlocks.size(); i++)
+		{
+			const VkPushConstantRange& range = m_PushConstantRanges[i];
+			if (m_PushConstantBlocks[i] == blockType && offset >= range.offset && offset + size <= range.offset + range.size)
+				return GetPushConstantStages(offset, size);
+		}
+		return 0;
+	}
+
 	void VulkanPipeline::CreatePipeline()
 	{
 		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
@@ -220,6 +284,11 @@ namespace Povox {
 			m_VertexInputStateInfo = info;
 		}
 
+		// Recreate runs through here again, the stages have to point at the current modules only
+		m_ShaderStageInfos.clear();
+		m_Specializations.clear();
+		std::set<std::string> usedSpecializationConstants;
+		const auto& specializationConstants = shader->GetSpecializationConstants();
 		for (auto& [stage, module] : shader->GetModules())
 		{
 			VkPipelineShaderStageCreateInfo info{};
@@ -229,8 +298,17 @@ namespace Povox {
 			info.stage = stage;
 			info.module = module;
 			info.pName = "main";
+
+			auto constants = specializationConstants.find(stage);
+			if (constants != specializationConstants.end())
+			{
+				VulkanSpecialization& specialization = m_Specializations[stage];
+				if (VulkanUtils::BuildSpecialization(constants->second, m_Specification.SpecializationConstants, m_Specification.DebugName, specialization, usedSpecializationConstants))
+					info.pSpecializationInfo = &specialization.Info;
+			}
 			m_ShaderStageInfos.push_back(info);
 		}
+		VulkanUtils::WarnUnusedSpecializationConstants(m_Specification.SpecializationConstants, usedSpecializationConstants, m_Specification.DebugName);
 		{
 			VkPipelineInputAssemblyStateCreateInfo info{};
 			info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -385,7 +463,7 @@ namespace Povox {
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;	// only used if VK_PIPELINE_CREATE_DERIVATIVE_BIT is specified under flags in VkGraphicsPipelineCreateInfo
 		pipelineInfo.basePipelineIndex = -1;
 
-		PX_CORE_VK_ASSERT(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_Pipeline), VK_SUCCESS, "Failed to create Graphics pipeline!");
+		PX_CORE_VK_ASSERT(vkCreateGraphicsPipelines(device, VulkanContext::GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_Pipeline), VK_SUCCESS, "Failed to create Graphics pipeline!");
 
 #ifdef PX_DEBUG
 		VkDebugUtilsObjectNameInfoEXT nameInfo{};
@@ -435,20 +513,16 @@ namespace Povox {
 
 	void VulkanComputePipeline::Free()
 	{
-		VulkanContext::SubmitResourceFree([=]() {
+		VulkanContext::SubmitResourceFree([layout = m_Layout, pipeline = m_Pipeline]() {
 
 			VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-			if (m_Layout)
-			{
-				vkDestroyPipelineLayout(device, m_Layout, nullptr);
-				m_Layout = VK_NULL_HANDLE;
-			}
-			if (m_Pipeline)
-			{
-				vkDestroyPipeline(device, m_Pipeline, nullptr);
-				m_Pipeline = VK_NULL_HANDLE;
-			}
+			if (layout)
+				vkDestroyPipelineLayout(device, layout, nullptr);
+			if (pipeline)
+				vkDestroyPipeline(device, pipeline, nullptr);
 			});
+		m_Layout = VK_NULL_HANDLE;
+		m_Pipeline = VK_NULL_HANDLE;
 	}
 
 	void VulkanComputePipeline::Recreate(bool forceRecreate/* = false*/)
@@ -489,19 +563,13 @@ namespace Povox {
 		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		layoutInfo.pNext = nullptr;
 
-		//layoutInfo.pushConstantRangeCount = 0;		// optional
-		//layoutInfo.pPushConstantRanges = nullptr;	// optional
 		layoutInfo.setLayoutCount = static_cast<uint32_t>(layouts.size());
 		PX_CORE_INFO("DescriptorSetLayout count = '{0}'", layoutInfo.setLayoutCount);
 		layoutInfo.pSetLayouts = layouts.data();
 
-// 		VkPushConstantRange pushConstant;
-// 		pushConstant.offset = 0;
-// 		pushConstant.size = sizeof(PushConstants);
-// 		pushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-// 
-// 		layoutInfo.pushConstantRangeCount = 1;
-// 		layoutInfo.pPushConstantRanges = &pushConstant;
+		const std::vector<VkPushConstantRange>& pushConstantRanges = shader->GetPushConstantRanges();
+		layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		layoutInfo.pPushConstantRanges = pushConstantRanges.data();
 		PX_CORE_VK_ASSERT(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &m_Layout), VK_SUCCESS, "Failed to create ComputePipelineLayout!");
 
 #ifdef PX_DEBUG
@@ -536,6 +604,25 @@ namespace Povox {
 			info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
 			info.module = modules.at(VK_SHADER_STAGE_COMPUTE_BIT);
 			info.pName = "main";
+
+			SpecializationConstantMap values = m_Specification.SpecializationConstants;
+			const uint32_t workGroupSize[3] = { m_Specification.WorkGroupSizeX, m_Specification.WorkGroupSizeY, m_Specification.WorkGroupSizeZ };
+			const char* workGroupSizeNames[3] = { "local_size_x", "local_size_y", "local_size_z" };
+			for (uint32_t dim = 0; dim < 3; dim++)
+			{
+				if (workGroupSize[dim] != 0)
+					values.emplace(workGroupSizeNames[dim], workGroupSize[dim]);
+			}
+
+			std::set<std::string> usedSpecializationConstants;
+			const auto& specializationConstants = shader->GetSpecializationConstants();
+			auto constants = specializationConstants.find(VK_SHADER_STAGE_COMPUTE_BIT);
+			if (constants != specializationConstants.end()
+				&& VulkanUtils::BuildSpecialization(constants->second, values, m_Specification.DebugName, m_Specialization, usedSpecializationConstants))
+			{
+				info.pSpecializationInfo = &m_Specialization.Info;
+			}
+			VulkanUtils::WarnUnusedSpecializationConstants(values, usedSpecializationConstants, m_Specification.DebugName);
 			m_ShaderStageInfo = info;
 		}
 
@@ -550,7 +637,7 @@ namespace Povox {
 		info.basePipelineHandle = VK_NULL_HANDLE;
 		info.basePipelineIndex = 0;
 
-		PX_CORE_VK_ASSERT(vkCreateComputePipelines(device, nullptr, 1, &info, nullptr, &m_Pipeline), VK_SUCCESS, "Failed to create ComputePipeline!");
+		PX_CORE_VK_ASSERT(vkCreateComputePipelines(device, VulkanContext::GetPipelineCache(), 1, &info, nullptr, &m_Pipeline), VK_SUCCESS, "Failed to create ComputePipeline!");
 
 #ifdef PX_DEBUG
 			VkDebugUtilsObjectNameInfoEXT nameInfo{};
@@ -7,6 +7,14 @@
 #include <vulkan/vulkan.h>
 namespace Povox {
 
+	// Owns everything a VkSpecializationInfo points to, rebuilt whenever the pipeline is (re)created
+	struct VulkanSpecialization
+	{
+		std::vector<VkSpecializationMapEntry> Entries;
+		std::vector<uint32_t> Data;
+		VkSpecializationInfo Info{};
+	};
+
 	class VulkanPipeline : public Pipeline
 	{
 	public:
@@ -18,6 +26,10 @@ namespace Povox {
 
 		inline VkPipeline GetVulkanObj() { return m_Pipeline; }
 		inline VkPipelineLayout GetLayout() { return m_Layout; }
+		// Stages vkCmdPushConstants has to name for this range, 0 if the range is not fully inside the blocks of the layout
+		VkShaderStageFlags GetPushConstantStages(uint32_t offset, uint32_t size) const;
+		// Same, but 0 unless one of the blocks was declared with blockType as its type name
+		VkShaderStageFlags GetPushConstantStages(const std::string& blockType, uint32_t offset, uint32_t size) const;
 		virtual inline  PipelineSpecification& GetSpecification() override { return m_Specification; }
 		virtual inline const std::unordered_map<std::string, Ref<ShaderResourceDescription>>& GetResourceDescriptions() const override;
 		virtual inline const std::string& GetDebugName() const override { return m_Specification.DebugName; }
@@ -32,9 +44,12 @@ namespace Povox {
 		VkPipeline m_Pipeline = VK_NULL_HANDLE;
 		VkPipelineLayout m_Layout = VK_NULL_HANDLE;
 		PipelineSpecification m_Specification{};
+		std::vector<VkPushConstantRange> m_PushConstantRanges;
+		std::vector<std::string> m_PushConstantBlocks;
 
 
 		std::vector<VkPipelineShaderStageCreateInfo> m_ShaderStageInfos;
+		std::unordered_map<VkShaderStageFlagBits, VulkanSpecialization> m_Specializations;
 		VkPipelineVertexInputStateCreateInfo m_VertexInputStateInfo;
 		VkPipelineInputAssemblyStateCreateInfo m_AssemblyStateInfo;
 		VkViewport m_Viewport;
@@ -79,6 +94,7 @@ namespace Povox {
 		std::unordered_map<std::string, std::pair<VkDescriptorSetLayout, VkDescriptorSet>> m_DescriptorSets;
 
 		VkPipelineShaderStageCreateInfo m_ShaderStageInfo;
+		VulkanSpecialization m_Specialization;
 	};
 
 }
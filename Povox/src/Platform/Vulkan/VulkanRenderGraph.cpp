@@ -0,0 +1,801 @@
+#include "pxpch.h"
+#include "VulkanRenderGraph.h"
+
+#include "Platform/Vulkan/VulkanBarrierBatcher.h"
+#include "Platform/Vulkan/VulkanBuffer.h"
+#include "Platform/Vulkan/VulkanCommands.h"
+#include "Platform/Vulkan/VulkanFramebuffer.h"
+#include "Platform/Vulkan/VulkanImage2D.h"
+#include "Platform/Vulkan/VulkanTransientAllocator.h"
+
+#include "Povox/Renderer/Renderer.h"
+
+
+namespace Povox {
+
+	namespace VulkanUtils {
+
+		static VkPipelineStageFlags2 ShaderStagesToPipelineStages(ShaderStage stages, PassType passType)
+		{
+			VkPipelineStageFlags2 out = VK_PIPELINE_STAGE_2_NONE;
+			if ((stages & ShaderStage::VERTEX) == ShaderStage::VERTEX)
+				out |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+			if ((stages & ShaderStage::TESSELLATION_CONTROL) == ShaderStage::TESSELLATION_CONTROL)
+				out |= VK_PIPELINE_STAGE_2_TESSELLATION_CONTROL_SHADER_BIT;
+			if ((stages & ShaderStage::TESSELLATION_EVALUATION) == ShaderStage::TESSELLATION_EVALUATION)
+				out |= VK_PIPELINE_STAGE_2_TESSELLATION_EVALUATION_SHADER_BIT;
+			if ((stages & ShaderStage::GEOMETRY) == ShaderStage::GEOMETRY)
+				out |= VK_PIPELINE_STAGE_2_GEOMETRY_SHADER_BIT;
+			if ((stages & ShaderStage::FRAGMENT) == ShaderStage::FRAGMENT)
+				out |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			if ((stages & ShaderStage::COMPUTE) == ShaderStage::COMPUTE)
+				out |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+			// Descriptions without reflected stages are assumed to be used everywhere in the pass
+			if (out == VK_PIPELINE_STAGE_2_NONE)
+				out = passType == PassType::COMPUTE ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+			return out;
+		}
+
+		static VkAccessFlags2 GetShaderAccessFlags(ShaderResourceType type, bool write)
+		{
+			switch (type)
+			{
+				case ShaderResourceType::UNIFORM_BUFFER:
+				case ShaderResourceType::UNIFORM_BUFFER_DYNAMIC:
+					return VK_ACCESS_2_UNIFORM_READ_BIT;
+				case ShaderResourceType::STORAGE_BUFFER:
+				case ShaderResourceType::STORAGE_BUFFER_DYNAMIC:
+				case ShaderResourceType::STORAGE_IMAGE:
+				case ShaderResourceType::STORAGE_TEXEL_BUFFER:
+					return write ? VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+				case ShaderResourceType::COMBINED_IMAGE_SAMPLER:
+				case ShaderResourceType::SAMPLED_IMAGE:
+				case ShaderResourceType::UNIFORM_TEXEL_BUFFER:
+					return VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+				case ShaderResourceType::INPUT_ATTACHMENT:
+					return VK_ACCESS_2_INPUT_ATTACHMENT_READ_BIT;
+				default:
+					return write ? VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT : VK_ACCESS_2_SHADER_READ_BIT;
+			}
+		}
+	}
+
+	VulkanRenderGraph::VulkanRenderGraph(const RenderGraphSpecification& spec)
+		: m_Specification(spec)
+	{
+	}
+
+	void VulkanRenderGraph::AddPass(Ref<GPUPass> pass, std::function<void()> record)
+	{
+		if (FindNode(pass))
+		{
+			PX_CORE_WARN("VulkanRenderGraph::AddPass: {0} already contains pass {1}!", m_Specification.DebugName, pass->GetDebugName());
+			return;
+		}
+
+		PassNode node{};
+		node.Pass = pass;
+		node.VkPass = std::dynamic_pointer_cast<VulkanPass>(pass);
+		node.Record = std::move(record);
+		PX_CORE_ASSERT(node.VkPass, "Pass is not a VulkanPass!");
+
+		m_Nodes.push_back(std::move(node));
+		m_Compiled = false;
+	}
+
+	void VulkanRenderGraph::MarkOutput(Ref<GPUPass> pass)
+	{
+		PassNode* node = FindNode(pass);
+		PX_CORE_ASSERT(node, "Pass has to be added before it can be marked as output!");
+
+		node->Output = true;
+		m_Compiled = false;
+	}
+
+	void VulkanRenderGraph::SetPassEnabled(Ref<GPUPass> pass, bool enabled)
+	{
+		PassNode* node = FindNode(pass);
+		PX_CORE_ASSERT(node, "Pass is not part of this RenderGraph!");
+
+		node->Enabled = enabled;
+	}
+
+	void VulkanRenderGraph::Compile()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		const uint32_t nodeCount = static_cast<uint32_t>(m_Nodes.size());
+
+		// Writers and readers of every resource, in the order their passes were added
+		std::unordered_map<ShaderResourceHandle, std::vector<uint32_t>> writers;
+		std::unordered_map<ShaderResourceHandle, std::vector<uint32_t>> readers;
+		auto collect = [](std::unordered_map<ShaderResourceHandle, std::vector<uint32_t>>& users, const Ref<ShaderResource>& resource, uint32_t index)
+			{
+				auto& passes = users[resource->GetID()];
+				if (passes.empty() || passes.back() != index)
+					passes.push_back(index);
+			};
+
+		m_WrittenResources.clear();
+		for (uint32_t index = 0; index < nodeCount; index++)
+		{
+			const Ref<VulkanPass>& pass = m_Nodes[index].VkPass;
+			for (const std::string& name : pass->GetInputs())
+			{
+				if (Ref<ShaderResource> resource = pass->GetBoundResource(name))
+					collect(readers, resource, index);
+			}
+			for (const std::string& name : pass->GetOutputs())
+			{
+				if (Ref<ShaderResource> resource = pass->GetBoundResource(name))
+				{
+					collect(writers, resource, index);
+					m_WrittenResources.insert(resource->GetID());
+				}
+			}
+		}
+
+		// A reader depends on every other writer of its resource, several writers of one resource keep the order they were added in
+		std::vector<std::set<uint32_t>> successors(nodeCount);
+		std::vector<std::set<uint32_t>> predecessors(nodeCount);
+		auto addEdge = [&](uint32_t from, uint32_t to)
+			{
+				if (from == to)
+					return;
+				successors[from].insert(to);
+				predecessors[to].insert(from);
+			};
+		for (const auto& [handle, resourceWriters] : writers)
+		{
+			for (size_t i = 1; i < resourceWriters.size(); i++)
+				addEdge(resourceWriters[i - 1], resourceWriters[i]);
+
+			auto readerIt = readers.find(handle);
+			if (readerIt == readers.end())
+				continue;
+			for (uint32_t writer : resourceWriters)
+			{
+				for (uint32_t reader : readerIt->second)
+					addEdge(writer, reader);
+			}
+		}
+
+		// Everything an output pass depends on survives, the rest has no consumer
+		std::vector<bool> live(nodeCount, false);
+		std::vector<uint32_t> stack;
+		for (uint32_t index = 0; index < nodeCount; index++)
+		{
+			if (m_Nodes[index].Output)
+			{
+				live[index] = true;
+				stack.push_back(index);
+			}
+		}
+		if (stack.empty())
+			PX_CORE_WARN("VulkanRenderGraph::Compile: {0} has no output pass, every pass gets culled!", m_Specification.DebugName);
+
+		while (!stack.empty())
+		{
+			uint32_t index = stack.back();
+			stack.pop_back();
+			for (uint32_t predecessor : predecessors[index])
+			{
+				if (live[predecessor])
+					continue;
+				live[predecessor] = true;
+				stack.push_back(predecessor);
+			}
+		}
+
+		// Kahn's algorithm, of all passes that are ready the one added first runs first
+		std::vector<uint32_t> pending(nodeCount, 0);
+		std::set<uint32_t> ready;
+		for (uint32_t index = 0; index < nodeCount; index++)
+		{
+			if (!live[index])
+			{
+				PX_CORE_INFO("VulkanRenderGraph::Compile: Culled pass {0}, nothing reads its outputs.", m_Nodes[index].Pass->GetDebugName());
+				continue;
+			}
+			for (uint32_t predecessor : predecessors[index])
+			{
+				if (live[predecessor])
+					pending[index]++;
+			}
+			if (pending[index] == 0)
+				ready.insert(index);
+		}
+
+		m_Order.clear();
+		while (!ready.empty())
+		{
+			uint32_t index = *ready.begin();
+			ready.erase(ready.begin());
+			m_Order.push_back(index);
+
+			for (uint32_t successor : successors[index])
+			{
+				if (live[successor] && --pending[successor] == 0)
+					ready.insert(successor);
+			}
+		}
+
+		for (uint32_t index = 0; index < nodeCount; index++)
+		{
+			if (live[index] && pending[index] > 0)
+			{
+				// Passes of a cycle write what the others read, the order they were added in is as good as any
+				PX_CORE_WARN("VulkanRenderGraph::Compile: Pass {0} is part of a dependency cycle, it runs in the order it was added!", m_Nodes[index].Pass->GetDebugName());
+				m_Order.push_back(index);
+			}
+		}
+
+		m_ExecutionOrder.clear();
+		for (uint32_t index : m_Order)
+			m_ExecutionOrder.push_back(m_Nodes[index].Pass);
+
+		// States are keyed by image pointers and buffer handles, recreated resources can reuse the key of one that is gone.
+		// Every resource starts over from the owner it reports on its first access after a compile
+		m_States.clear();
+
+		// Before the layouts below, aliasing recreates the images and leaves them UNDEFINED
+		bool transitioned = AllocateTransientImages();
+
+		// Each image gets the one layout all of its accesses can use, transitioned here instead of every frame
+		struct ImageUse
+		{
+			Ref<VulkanImage2D> Image = nullptr;
+			VkImageLayout Layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 Access = 0;
+		};
+		std::map<VulkanImage2D*, ImageUse> images;
+		uint32_t framesInFlight = Renderer::GetSpecification().MaxFramesInFlight;
+		for (uint32_t index : m_Order)
+		{
+			const PassNode& node = m_Nodes[index];
+			for (const std::vector<std::string>* names : { &node.VkPass->GetInputs(), &node.VkPass->GetOutputs() })
+			{
+				for (const std::string& name : *names)
+				{
+					Ref<ShaderResource> resource = node.VkPass->GetBoundResource(name);
+					Ref<ShaderResourceDescription> description = node.VkPass->GetResourceDescription(name);
+					if (!resource || !description || resource->GetType() != ShaderResourceType::STORAGE_IMAGE)
+						continue;
+
+					for (uint32_t frame = 0; frame < framesInFlight; frame++)
+					{
+						Ref<VulkanImage2D> image = std::dynamic_pointer_cast<VulkanImage2D>(std::dynamic_pointer_cast<StorageImage>(resource)->GetImage(frame));
+						auto [it, inserted] = images.try_emplace(image.get());
+						ImageUse& use = it->second;
+						if (inserted)
+						{
+							// The first access in the frame is the one waiting for the transition
+							use.Image = image;
+							use.Stages = VulkanUtils::ShaderStagesToPipelineStages(description->Stages, node.Pass->GetPassType());
+							use.Access = VulkanUtils::GetShaderAccessFlags(description->ResourceType, names == &node.VkPass->GetOutputs());
+						}
+						if (description->ResourceType == ShaderResourceType::STORAGE_IMAGE)
+							use.Layout = VK_IMAGE_LAYOUT_GENERAL;
+					}
+				}
+			}
+		}
+
+		for (auto& [pointer, use] : images)
+		{
+			VkImageLayout currentLayout = use.Image->GetCurrentLayout();
+			if (currentLayout == use.Layout)
+				continue;
+
+			use.Image->TransitionImageLayout(currentLayout, use.Layout,
+				VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT,
+				use.Stages, use.Access, true);
+			transitioned = true;
+		}
+		if (transitioned)
+		{
+			VulkanCommandControl::GetBarrierBatcher()->SubmitImmediate();
+
+			// Image descriptors carry the layout, sets whose resources did not change are skipped.
+			// Aliasing recreated the transient images, their new handles may equal the old ones
+			for (uint32_t index : m_Order)
+			{
+				if (m_TransientStatistics.ImageCount > 0)
+					m_Nodes[index].VkPass->InvalidateDescriptorSets();
+				m_Nodes[index].VkPass->Bake();
+			}
+		}
+
+		std::string order;
+		for (const Ref<GPUPass>& pass : m_ExecutionOrder)
+			order += (order.empty() ? "" : " -> ") + pass->GetDebugName();
+		PX_CORE_INFO("VulkanRenderGraph::Compile: {0}: {1}", m_Specification.DebugName, order);
+
+		m_Compiled = true;
+	}
+
+	void VulkanRenderGraph::Execute()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_ASSERT(m_Compiled, "RenderGraph has to be compiled before it is executed!");
+
+		uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
+		for (auto& [key, state] : m_States)
+			state.LastPass = -1;
+
+		// Every dispatch is a submit of its own signaling the next compute value, the graphics commands signal the frame's value at its end
+		Ref<VulkanBarrierBatcher> batcher = VulkanCommandControl::GetBarrierBatcher();
+		const uint64_t graphicsValue = batcher->GetQueueTimelineValue(QueueFamilyOwnership::QFO_GRAPHICS);
+		uint64_t computeValue = batcher->GetQueueTimelineValue(QueueFamilyOwnership::QFO_COMPUTE);
+		std::vector<uint64_t> signalValues(m_Order.size(), 0);
+
+		// Planned for the whole frame first, a compute pass has to know its releases before its command buffer is submitted
+		std::vector<std::vector<Transition>> acquires(m_Order.size());
+		std::vector<std::vector<Transition>> releases(m_Order.size());
+		for (uint32_t position = 0; position < m_Order.size(); position++)
+		{
+			const PassNode& node = m_Nodes[m_Order[position]];
+			if (!node.Enabled)
+				continue;
+
+			QueueFamilyOwnership queue = GetQueue(node);
+			signalValues[position] = queue == QueueFamilyOwnership::QFO_COMPUTE ? ++computeValue : graphicsValue;
+			for (const PassAccess& access : GatherAccesses(node, frameIndex))
+			{
+				if (!access.Tracked)
+					continue;
+
+				auto [it, inserted] = m_States.try_emplace(access.Target.GetKey());
+				ResourceState& state = it->second;
+				if (access.Target.Concurrent)
+				{
+					PlanConcurrentAccess(state, access, queue, position, signalValues[position], acquires[position]);
+					continue;
+				}
+				if (inserted)
+					state.Queue = access.Target.InitialOwner;
+
+				Transition transition{};
+				transition.Target = access.Target;
+				transition.Src = state.Queue;
+				transition.Dst = queue;
+				transition.SrcStages = state.Stages;
+				transition.SrcAccess = state.Written ? state.Access : 0;
+				transition.DstStages = access.Stages;
+				transition.DstAccess = access.Access;
+
+				bool queueChanged = state.Queue != queue;
+				if (queueChanged)
+				{
+					if (state.LastPass >= 0 && m_Nodes[m_Order[state.LastPass]].Pass->GetPassType() == PassType::COMPUTE)
+						releases[state.LastPass].push_back(transition);
+					else
+						acquires[position].push_back(transition);
+				}
+				else if ((state.Written || access.Write) && state.Stages != VK_PIPELINE_STAGE_2_NONE)
+				{
+					acquires[position].push_back(transition);
+				}
+
+				if (access.Write || queueChanged || state.Written)
+				{
+					state.Stages = access.Stages;
+					state.Access = access.Access;
+				}
+				else
+				{
+					state.Stages |= access.Stages;
+					state.Access |= access.Access;
+				}
+				state.Queue = queue;
+				state.Written = access.Write;
+				state.LastPass = static_cast<int32_t>(position);
+			}
+		}
+
+		std::unordered_set<VulkanImage2D*> discardedThisFrame;
+		for (uint32_t position = 0; position < m_Order.size(); position++)
+		{
+			PassNode& node = m_Nodes[m_Order[position]];
+			if (!node.Enabled)
+				continue;
+
+			// The first use of an aliased image this frame discards whatever the memory holds, its regular barrier is covered by that
+			std::unordered_set<VulkanImage2D*> discarded;
+			for (const TransientUse& use : m_TransientUses[position])
+			{
+				if (!discardedThisFrame.insert(use.Image.get()).second)
+					continue;
+
+				use.Image->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, use.Layout,
+					VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT,
+					use.Stages, use.Access, true);
+				discarded.insert(use.Image.get());
+			}
+
+			// Acquires and barriers are recorded when the pass begins, releases of a compute pass at the end of its command buffer
+			QueueTransitions(acquires[position], discarded);
+			QueueTransitions(releases[position]);
+
+			if (node.Pass->GetPassType() == PassType::COMPUTE)
+			{
+				if (node.Record)
+					node.Record();
+				Renderer::DispatchCompute(std::dynamic_pointer_cast<ComputePass>(node.Pass));
+				PX_CORE_ASSERT(batcher->GetQueueTimelineValue(QueueFamilyOwnership::QFO_COMPUTE) == signalValues[position], "Dispatch signaled another value than the one its accesses were planned with!");
+				continue;
+			}
+
+			Ref<RenderPass> renderPass = std::dynamic_pointer_cast<RenderPass>(node.Pass);
+			const RenderPassSpecification& spec = renderPass->GetSpecification();
+			if (spec.DoPerformanceQuery)
+				Renderer::StartTimestampQuery(spec.DebugName);
+			Renderer::BeginRenderPass(renderPass);
+
+			if (node.Record)
+				node.Record();
+
+			Renderer::EndRenderPass();
+			if (spec.DoPerformanceQuery)
+				Renderer::StopTimestampQuery(spec.DebugName);
+		}
+	}
+
+	std::vector<VulkanRenderGraph::PassAccess> VulkanRenderGraph::GatherAccesses(const PassNode& node, uint32_t frameIndex) const
+	{
+		std::vector<PassAccess> accesses;
+		auto gather = [&](const std::vector<std::string>& names, bool write)
+			{
+				for (const std::string& name : names)
+				{
+					Ref<ShaderResource> resource = node.VkPass->GetBoundResource(name);
+					Ref<ShaderResourceDescription> description = node.VkPass->GetResourceDescription(name);
+					if (!resource || !description)
+						continue;
+
+					AccessTarget target{};
+					if (!ResolveTarget(resource, name, frameIndex, target))
+						continue;
+
+					auto it = std::find_if(accesses.begin(), accesses.end(), [&](const PassAccess& access) { return access.Target.GetKey() == target.GetKey(); });
+					if (it == accesses.end())
+					{
+						it = accesses.emplace(accesses.end());
+						it->Target = target;
+						it->Tracked = m_WrittenResources.find(resource->GetID()) != m_WrittenResources.end();
+					}
+					it->Write |= write;
+					it->Stages |= VulkanUtils::ShaderStagesToPipelineStages(description->Stages, node.Pass->GetPassType());
+					it->Access |= VulkanUtils::GetShaderAccessFlags(description->ResourceType, write);
+				}
+			};
+
+		gather(node.VkPass->GetInputs(), false);
+		gather(node.VkPass->GetOutputs(), true);
+		return accesses;
+	}
+
+	bool VulkanRenderGraph::ResolveTarget(const Ref<ShaderResource>& resource, const std::string& name, uint32_t frameIndex, AccessTarget& outTarget)
+	{
+		Ref<BufferSuballocation> suballocation = nullptr;
+		switch (resource->GetType())
+		{
+			case ShaderResourceType::STORAGE_IMAGE:
+			{
+				outTarget.Image = std::dynamic_pointer_cast<VulkanImage2D>(std::dynamic_pointer_cast<StorageImage>(resource)->GetImage(frameIndex));
+				outTarget.InitialOwner = outTarget.Image->GetOwnership();
+				return true;
+			}
+			case ShaderResourceType::UNIFORM_BUFFER:
+			{
+				suballocation = std::dynamic_pointer_cast<UniformBuffer>(resource)->GetSuballocation(frameIndex);
+				break;
+			}
+			case ShaderResourceType::STORAGE_BUFFER:
+			{
+				suballocation = std::dynamic_pointer_cast<StorageBuffer>(resource)->GetSuballocation(frameIndex);
+				break;
+			}
+			case ShaderResourceType::STORAGE_BUFFER_DYNAMIC:
+			{
+				// Tracked on the range the descriptor points at this frame, so the In and Out halves of a swapped buffer do not depend on each other
+				Ref<StorageBufferDynamic> dynamic = std::dynamic_pointer_cast<StorageBufferDynamic>(resource);
+				if (!dynamic->HasDescriptor(name))
+					return false;
+
+				Ref<VulkanBuffer> buffer = std::dynamic_pointer_cast<VulkanBuffer>(dynamic->GetBuffer(name));
+				outTarget.Buffer = buffer->GetAllocation().Buffer;
+				outTarget.Offset = dynamic->GetOffset(name, frameIndex);
+				outTarget.Size = dynamic->GetDescriptorInfo(name).Suballocation->Range;
+				outTarget.InitialOwner = buffer->GetOwnership();
+				outTarget.Concurrent = buffer->IsConcurrent();
+				break;
+			}
+			default:
+				return false;
+		}
+
+		if (suballocation)
+		{
+			Ref<VulkanBuffer> buffer = std::dynamic_pointer_cast<VulkanBuffer>(suballocation->Buffer);
+			outTarget.Buffer = buffer->GetAllocation().Buffer;
+			outTarget.Offset = suballocation->Offset;
+			outTarget.Size = suballocation->Range;
+			outTarget.InitialOwner = buffer->GetOwnership();
+			outTarget.Concurrent = buffer->IsConcurrent();
+		}
+
+		// Exclusive buffers without an owner were created for the graphics family
+		if (outTarget.InitialOwner == QueueFamilyOwnership::QFO_UNDEFINED)
+			outTarget.InitialOwner = QueueFamilyOwnership::QFO_GRAPHICS;
+		return outTarget.Buffer != VK_NULL_HANDLE;
+	}
+
+	void VulkanRenderGraph::QueueTransitions(const std::vector<Transition>& transitions, const std::unordered_set<VulkanImage2D*>& skippedImages)
+	{
+		Ref<VulkanBarrierBatcher> batcher = VulkanCommandControl::GetBarrierBatcher();
+		for (const Transition& transition : transitions)
+		{
+			if (transition.Target.Image)
+			{
+				if (skippedImages.find(transition.Target.Image.get()) != skippedImages.end())
+					continue;
+
+				// Keeps the image's own ownership tracking up to date, the layout stays the one chosen in Compile
+				VkImageLayout layout = transition.Target.Image->GetCurrentLayout();
+				transition.Target.Image->TransitionImageLayout(layout, layout, transition.SrcStages, transition.SrcAccess, transition.DstStages, transition.DstAccess, true);
+				continue;
+			}
+
+			VkBufferMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+			barrier.pNext = nullptr;
+			barrier.srcStageMask = transition.SrcStages;
+			barrier.srcAccessMask = transition.SrcAccess;
+			barrier.dstStageMask = transition.DstStages;
+			barrier.dstAccessMask = transition.DstAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.buffer = transition.Target.Buffer;
+			barrier.offset = transition.Target.Offset;
+			barrier.size = transition.Target.Size;
+
+			if (transition.Src == transition.Dst)
+				batcher->AddBufferBarrier(transition.Dst, barrier);
+			else if (transition.Target.Concurrent)
+				batcher->AddBufferQueueDependency(transition.Src, transition.Dst, transition.WaitValue, barrier);
+			else
+				batcher->AddBufferOwnershipTransfer(transition.Src, transition.Dst, barrier);
+		}
+	}
+
+	void VulkanRenderGraph::PlanConcurrentAccess(ResourceState& state, const PassAccess& access, QueueFamilyOwnership queue, uint32_t position, uint64_t signalValue, std::vector<Transition>& outTransitions) const
+	{
+		const uint32_t slot = static_cast<uint32_t>(queue);
+		const bool firstAccess = state.Queues[slot].Stages == VK_PIPELINE_STAGE_2_NONE;
+		for (uint32_t other = 0; other < state.Queues.size(); other++)
+		{
+			const ResourceState::QueueAccess& previous = state.Queues[other];
+			if (previous.Stages == VK_PIPELINE_STAGE_2_NONE)
+				continue;
+
+			// Reads of different queues run side by side. The first access of a queue still waits on the others,
+			// so what they waited on before (e.g. the upload handed to them) is visible to it as well
+			bool sameQueue = other == slot;
+			if (!previous.Written && !access.Write && (sameQueue || !firstAccess))
+				continue;
+
+			Transition transition{};
+			transition.Target = access.Target;
+			transition.Src = static_cast<QueueFamilyOwnership>(other);
+			transition.Dst = queue;
+			transition.SrcStages = previous.Stages;
+			transition.SrcAccess = previous.Written ? previous.Access : 0;
+			transition.DstStages = access.Stages;
+			transition.DstAccess = access.Access;
+			// A write waits until every access of the other queue is done, a read only on the write it reads.
+			// E.g. reading the half of a swapped buffer the previous frame's dispatch wrote waits on exactly that dispatch
+			if (access.Write)
+				transition.WaitValue = previous.LastValue;
+			else
+				transition.WaitValue = previous.Written ? previous.WriteValue : previous.FirstValue;
+
+			if (!sameQueue && queue == QueueFamilyOwnership::QFO_COMPUTE && transition.Src == QueueFamilyOwnership::QFO_GRAPHICS
+				&& transition.WaitValue >= VulkanCommandControl::GetBarrierBatcher()->GetQueueTimelineValue(QueueFamilyOwnership::QFO_GRAPHICS))
+			{
+				PX_CORE_WARN("VulkanRenderGraph::Execute: {0} waits on graphics work of the same frame, which is only submitted at its end!", m_Nodes[m_Order[position]].Pass->GetDebugName());
+			}
+			outTransitions.push_back(transition);
+		}
+
+		// A write waited on everything before it, only the writer is left to wait on
+		ResourceState::QueueAccess& own = state.Queues[slot];
+		if (access.Write)
+		{
+			state.Queues = {};
+			own.Written = true;
+			own.WriteValue = signalValue;
+		}
+		if (own.Stages == VK_PIPELINE_STAGE_2_NONE)
+			own.FirstValue = signalValue;
+		own.Stages |= access.Stages;
+		own.Access |= access.Access;
+		own.LastValue = signalValue;
+	}
+
+	bool VulkanRenderGraph::AllocateTransientImages()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		struct Lifetime
+		{
+			Ref<VulkanImage2D> Image = nullptr;
+			uint32_t FirstUse = 0;
+			uint32_t LastUse = 0;
+			bool FirstUseWrites = false;
+			QueueFamilyOwnership Queue = QueueFamilyOwnership::QFO_UNDEFINED;
+			bool SingleQueue = true;
+			// Attachments are transitioned here, storage images together with all other images in Compile
+			bool Attachment = false;
+		};
+		std::map<VulkanImage2D*, Lifetime> lifetimes;
+		std::vector<Ref<VulkanFramebuffer>> framebuffers;
+
+		m_TransientUses.assign(m_Order.size(), {});
+		auto addUse = [&](const Ref<VulkanImage2D>& image, uint32_t position, bool write, bool attachment, const TransientUse& use)
+			{
+				if (!image || !image->GetSpecification().Transient)
+					return;
+
+				QueueFamilyOwnership queue = GetQueue(m_Nodes[m_Order[position]]);
+				auto [it, inserted] = lifetimes.try_emplace(image.get());
+				Lifetime& lifetime = it->second;
+				if (inserted)
+				{
+					lifetime.Image = image;
+					lifetime.FirstUse = position;
+					lifetime.Queue = queue;
+				}
+				if (lifetime.FirstUse == position)
+					lifetime.FirstUseWrites |= write;
+				lifetime.LastUse = position;
+				lifetime.SingleQueue &= lifetime.Queue == queue;
+				lifetime.Attachment |= attachment;
+
+				auto& uses = m_TransientUses[position];
+				auto useIt = std::find_if(uses.begin(), uses.end(), [&](const TransientUse& other) { return other.Image == image; });
+				if (useIt == uses.end())
+				{
+					uses.push_back(use);
+					return;
+				}
+				useIt->Stages |= use.Stages;
+				useIt->Access |= use.Access;
+			};
+
+		uint32_t framesInFlight = Renderer::GetSpecification().MaxFramesInFlight;
+		for (uint32_t position = 0; position < m_Order.size(); position++)
+		{
+			const PassNode& node = m_Nodes[m_Order[position]];
+			for (const std::vector<std::string>* names : { &node.VkPass->GetInputs(), &node.VkPass->GetOutputs() })
+			{
+				bool write = names == &node.VkPass->GetOutputs();
+				for (const std::string& name : *names)
+				{
+					Ref<ShaderResource> resource = node.VkPass->GetBoundResource(name);
+					Ref<ShaderResourceDescription> description = node.VkPass->GetResourceDescription(name);
+					if (!resource || !description || resource->GetType() != ShaderResourceType::STORAGE_IMAGE)
+						continue;
+
+					TransientUse use{};
+					use.Layout = VK_IMAGE_LAYOUT_GENERAL;
+					use.Stages = VulkanUtils::ShaderStagesToPipelineStages(description->Stages, node.Pass->GetPassType());
+					use.Access = VulkanUtils::GetShaderAccessFlags(description->ResourceType, write);
+					for (uint32_t frame = 0; frame < framesInFlight; frame++)
+					{
+						use.Image = std::dynamic_pointer_cast<VulkanImage2D>(std::dynamic_pointer_cast<StorageImage>(resource)->GetImage(frame));
+						addUse(use.Image, position, write, false, use);
+					}
+				}
+			}
+
+			if (node.Pass->GetPassType() != PassType::GRAPHICS)
+				continue;
+
+			// Attachments are cleared when the render pass begins, so every use of them counts as a write
+			Ref<VulkanFramebuffer> framebuffer = std::dynamic_pointer_cast<VulkanFramebuffer>(std::dynamic_pointer_cast<RenderPass>(node.Pass)->GetSpecification().TargetFramebuffer);
+			if (!framebuffer)
+				continue;
+
+			bool hasTransientAttachment = false;
+			for (const Ref<Image2D>& attachment : framebuffer->GetColorAttachments())
+			{
+				TransientUse use{};
+				use.Image = std::dynamic_pointer_cast<VulkanImage2D>(attachment);
+				use.Layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+				use.Stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+				use.Access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+				addUse(use.Image, position, true, true, use);
+				hasTransientAttachment |= attachment->GetSpecification().Transient;
+			}
+			if (Ref<Image2D> attachment = framebuffer->GetDepthAttachment())
+			{
+				TransientUse use{};
+				use.Image = std::dynamic_pointer_cast<VulkanImage2D>(attachment);
+				use.Layout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+				use.Stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+				use.Access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+				addUse(use.Image, position, true, true, use);
+				hasTransientAttachment |= attachment->GetSpecification().Transient;
+			}
+			if (hasTransientAttachment && std::find(framebuffers.begin(), framebuffers.end(), framebuffer) == framebuffers.end())
+				framebuffers.push_back(framebuffer);
+		}
+
+		VulkanTransientAllocator allocator(m_Specification.DebugName);
+		uint32_t unaliasedImageCount = 0;
+		uint64_t unaliasedBytes = 0;
+		for (auto& [pointer, lifetime] : lifetimes)
+		{
+			if (!lifetime.FirstUseWrites || !lifetime.SingleQueue)
+			{
+				PX_CORE_WARN("VulkanRenderGraph::Compile: Transient image {0} keeps its own memory, its first use {1}!", lifetime.Image->GetDebugName(),
+					!lifetime.FirstUseWrites ? "reads contents of an earlier frame" : "is on another queue than its later uses");
+				lifetime.Image->Alias(nullptr);
+				unaliasedImageCount++;
+				unaliasedBytes += lifetime.Image->GetMemoryRequirements().size;
+				continue;
+			}
+			allocator.AddImage(lifetime.Image, lifetime.FirstUse, lifetime.LastUse, static_cast<uint32_t>(lifetime.Queue));
+		}
+		allocator.Allocate();
+		m_TransientStatistics = allocator.GetStatistics();
+		m_TransientStatistics.UnaliasedImageCount = unaliasedImageCount;
+		m_TransientStatistics.UnaliasedBytes = unaliasedBytes;
+
+		if (lifetimes.empty())
+			return false;
+
+		for (auto& [pointer, lifetime] : lifetimes)
+		{
+			if (!lifetime.Attachment || lifetime.Image->GetCurrentLayout() != VK_IMAGE_LAYOUT_UNDEFINED)
+				continue;
+
+			const auto& uses = m_TransientUses[lifetime.FirstUse];
+			const TransientUse& use = *std::find_if(uses.begin(), uses.end(), [&](const TransientUse& other) { return other.Image.get() == pointer; });
+			lifetime.Image->TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, use.Layout, VK_PIPELINE_STAGE_2_NONE, 0, use.Stages, use.Access, true);
+		}
+		for (const Ref<VulkanFramebuffer>& framebuffer : framebuffers)
+			framebuffer->RecreateFramebuffer();
+
+		// Only aliased images need their contents discarded
+		for (auto& uses : m_TransientUses)
+			uses.erase(std::remove_if(uses.begin(), uses.end(), [](const TransientUse& use) { return !use.Image->IsAliased(); }), uses.end());
+
+		PX_CORE_INFO("VulkanRenderGraph::Compile: {0}: {1} transient images share {2} allocations, {3:.2f} MiB instead of {4:.2f} MiB, {5} unaliased ones take {6:.2f} MiB",
+			m_Specification.DebugName, m_TransientStatistics.ImageCount, m_TransientStatistics.AllocationCount,
+			m_TransientStatistics.AllocatedBytes / (1024.0 * 1024.0), m_TransientStatistics.RequiredBytes / (1024.0 * 1024.0),
+			m_TransientStatistics.UnaliasedImageCount, m_TransientStatistics.UnaliasedBytes / (1024.0 * 1024.0));
+		return true;
+	}
+
+	VulkanRenderGraph::PassNode* VulkanRenderGraph::FindNode(const Ref<GPUPass>& pass)
+	{
+		for (PassNode& node : m_Nodes)
+		{
+			if (node.Pass == pass)
+				return &node;
+		}
+		return nullptr;
+	}
+
+	QueueFamilyOwnership VulkanRenderGraph::GetQueue(const PassNode& node)
+	{
+		return node.Pass->GetPassType() == PassType::COMPUTE ? QueueFamilyOwnership::QFO_COMPUTE : QueueFamilyOwnership::QFO_GRAPHICS;
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include "Platform/Vulkan/VulkanRenderPass.h"
+#include "Platform/Vulkan/VulkanUtilities.h"
+
+#include "Povox/Renderer/RenderGraph.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <map>
+#include <unordered_set>
+
+namespace Povox {
+
+	class VulkanImage2D;
+
+	/**
+	 * Synchronization is derived per frame from the last access of every resource, carried over from the previous frame:
+	 * - Read after read on the same queue needs nothing, writes and reads after writes get one buffer/image barrier
+	 * - Accesses on another queue transfer the ownership. If the releasing pass is a compute pass of the same frame, the release
+	 *   is recorded at the end of its command buffer and its submit signals the consumer. Otherwise (e.g. graphics -> next frame's compute)
+	 *   the releases go out in one batched submit right before the consumer.
+	 * Only resources written by a pass of the graph are tracked, read-only inputs are synchronized by their uploads.
+	 * Concurrent buffers are tracked per queue instead and never transferred. A queue waits on another queue's timeline only where their accesses
+	 * to the same range conflict, and only up to the value of the submit that made the conflicting access. So e.g. compute can write one half
+	 * of a swapped buffer while graphics reads the other half, waiting on the dispatch of the previous frame that wrote it.
+	 * A compute pass can only wait on graphics work of earlier frames, the graphics commands of a frame are submitted as a whole at its end.
+	 * Every image keeps a single layout (GENERAL if any pass uses it as storage image, SHADER_READ_ONLY_OPTIMAL otherwise),
+	 * it is transitioned once in Compile, so the descriptors written by the passes stay valid.
+	 *
+	 * Transient storage images and framebuffer attachments are placed in shared memory by a VulkanTransientAllocator, if their first use
+	 * in the frame writes them and all their uses are on one queue. Their contents are discarded (UNDEFINED -> layout) at that first use every frame,
+	 * waiting on everything before it on that queue, as another image in the same memory may have been used in between.
+	 */
+	class VulkanRenderGraph : public RenderGraph
+	{
+	public:
+		VulkanRenderGraph(const RenderGraphSpecification& spec);
+		virtual ~VulkanRenderGraph() = default;
+
+		virtual void AddPass(Ref<GPUPass> pass, std::function<void()> record = nullptr) override;
+		virtual void MarkOutput(Ref<GPUPass> pass) override;
+		virtual void SetPassEnabled(Ref<GPUPass> pass, bool enabled) override;
+
+		virtual void Compile() override;
+		virtual void Execute() override;
+
+		virtual inline const std::vector<Ref<GPUPass>>& GetExecutionOrder() const override { return m_ExecutionOrder; }
+		virtual inline const TransientMemoryStatistics& GetTransientMemoryStatistics() const override { return m_TransientStatistics; }
+
+	private:
+		struct PassNode
+		{
+			Ref<GPUPass> Pass = nullptr;
+			Ref<VulkanPass> VkPass = nullptr;
+			std::function<void()> Record;
+
+			bool Output = false;
+			bool Enabled = true;
+		};
+
+		// The Vulkan object an access ends up at in one frame, ranges of pooled buffers are tracked on their own
+		struct AccessTarget
+		{
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			size_t Offset = 0;
+			size_t Size = VK_WHOLE_SIZE;
+			QueueFamilyOwnership InitialOwner = QueueFamilyOwnership::QFO_UNDEFINED;
+			bool Concurrent = false;
+
+			Ref<VulkanImage2D> Image = nullptr;
+
+			inline std::pair<uint64_t, size_t> GetKey() const { return Image ? std::make_pair((uint64_t)Image.get(), (size_t)0) : std::make_pair((uint64_t)Buffer, Offset); }
+		};
+
+		// All bindings of one pass to the same target merged into one access
+		struct PassAccess
+		{
+			AccessTarget Target;
+			bool Write = false;
+			bool Tracked = false;
+			VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 Access = 0;
+		};
+
+		struct ResourceState
+		{
+			QueueFamilyOwnership Queue = QueueFamilyOwnership::QFO_UNDEFINED;
+			VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 Access = 0;
+			// Readers following the last write are merged into Stages and Access, so the next write waits on all of them
+			bool Written = false;
+			// Position in this frame's order of the pass that accessed it last, -1 if that happened in an earlier frame
+			int32_t LastPass = -1;
+
+			// Concurrent buffers only, the accesses of every queue since the last write, indexed by QueueFamilyOwnership.
+			// The values are the ones the submits containing the accesses signal on the queue's timeline
+			struct QueueAccess
+			{
+				VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE;
+				VkAccessFlags2 Access = 0;
+				bool Written = false;
+				// Readers of another queue wait on the write
+				uint64_t WriteValue = 0;
+				// The first access of another queue waits on what this queue waited on before its first access
+				uint64_t FirstValue = 0;
+				// Writers of another queue wait on every access
+				uint64_t LastValue = 0;
+			};
+			std::array<QueueAccess, 4> Queues{};
+		};
+
+		struct Transition
+		{
+			AccessTarget Target;
+			QueueFamilyOwnership Src = QueueFamilyOwnership::QFO_UNDEFINED;
+			QueueFamilyOwnership Dst = QueueFamilyOwnership::QFO_UNDEFINED;
+			VkPipelineStageFlags2 SrcStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 SrcAccess = 0;
+			VkPipelineStageFlags2 DstStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 DstAccess = 0;
+			// Concurrent buffers, the value of Src's timeline Dst waits on
+			uint64_t WaitValue = 0;
+		};
+
+		// Access of a pass to an aliased image
+		struct TransientUse
+		{
+			Ref<VulkanImage2D> Image = nullptr;
+			VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags2 Stages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 Access = 0;
+		};
+
+		std::vector<PassAccess> GatherAccesses(const PassNode& node, uint32_t frameIndex) const;
+		static bool ResolveTarget(const Ref<ShaderResource>& resource, const std::string& name, uint32_t frameIndex, AccessTarget& outTarget);
+		// signalValue is the value the submit recording the pass signals on its queue's timeline
+		void PlanConcurrentAccess(ResourceState& state, const PassAccess& access, QueueFamilyOwnership queue, uint32_t position, uint64_t signalValue, std::vector<Transition>& outTransitions) const;
+		void QueueTransitions(const std::vector<Transition>& transitions, const std::unordered_set<VulkanImage2D*>& skippedImages = {});
+		// Returns true if images got new handles or layouts
+		bool AllocateTransientImages();
+
+		PassNode* FindNode(const Ref<GPUPass>& pass);
+		static QueueFamilyOwnership GetQueue(const PassNode& node);
+
+	private:
+		RenderGraphSpecification m_Specification;
+
+		std::vector<PassNode> m_Nodes;
+		// Indices into m_Nodes, culled passes are left out
+		std::vector<uint32_t> m_Order;
+		std::vector<Ref<GPUPass>> m_ExecutionOrder;
+		// ShaderResources written by any pass of the graph
+		std::unordered_set<ShaderResourceHandle> m_WrittenResources;
+
+		std::map<std::pair<uint64_t, size_t>, ResourceState> m_States;
+
+		// Per position in m_Order
+		std::vector<std::vector<TransientUse>> m_TransientUses;
+		TransientMemoryStatistics m_TransientStatistics{};
+		bool m_Compiled = false;
+	};
+}
@@ -14,6 +14,8 @@
 #include "Povox/Core/Application.h"
 #include "Povox/Core/Log.h"
 
+#include "xxHash.h"
+
 namespace Povox {
 
 	VulkanPass::VulkanPass()
@@ -21,6 +23,20 @@ namespace Povox {
 
 	}
 
+	VulkanPass::~VulkanPass()
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		std::vector<VkDescriptorUpdateTemplate> updateTemplates;
+		for (auto& [hash, updateTemplate] : m_UpdateTemplates)
+			updateTemplates.push_back(updateTemplate);
+
+		VulkanContext::SubmitResourceFree([device, updateTemplates]()
+			{
+				for (VkDescriptorUpdateTemplate updateTemplate : updateTemplates)
+					vkDestroyDescriptorUpdateTemplate(device, updateTemplate, nullptr);
+			});
+	}
+
 	void VulkanPass::CreateDescriptorSets(const std::map<uint32_t, VkDescriptorSetLayout>& layoutMap)
 	{
 		const std::unordered_map<uint32_t, std::string> setNames = {
@@ -47,10 +63,8 @@ namespace Povox {
 			set.SetNumber = setNumber;
 			set.Bindings = 0; // TODO:
 			set.Layout = layout;
-			if (setNumber != 1)
-				set.Sets.resize(framesInFlight);
-			else
-				set.Sets.resize(1);
+			// Every set is per frame, per frame storage buffers in set 1 would otherwise only ever see the range of frame 0
+			set.Sets.resize(framesInFlight);
 
 			for (uint32_t frame = 0; frame < set.Sets.size(); frame++)
 			{
@@ -86,172 +100,38 @@ namespace Povox {
 
 	void VulkanPass::Bake()
 	{
-		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-
-		std::vector<VkWriteDescriptorSet> writes;
-		std::vector<VkDescriptorBufferInfo> bufferInfos;
-		std::vector<VkDescriptorImageInfo> imageInfos;
-
-		uint32_t framesInFlight = Application::Get()->GetSpecification().MaxFramesInFlight;
-		writes.reserve(m_AllShaderResourceDescs.size() * framesInFlight);
-		bufferInfos.reserve(m_AllShaderResourceDescs.size() * framesInFlight);
-		imageInfos.reserve(m_AllShaderResourceDescs.size() * framesInFlight);
-
-
-		for (const auto [name, description] : m_AllShaderResourceDescs)
+		for (const auto& [name, description] : m_AllShaderResourceDescs)
 		{
-			ShaderResourceType type = description->ResourceType;
-
-			VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			write.pNext = nullptr;
-			write.descriptorCount = description->Count;
-			write.dstBinding = description->Binding;
+			if (description->ResourceType == ShaderResourceType::UNIFORM_BUFFER_DYNAMIC || description->ResourceType == ShaderResourceType::STORAGE_BUFFER_DYNAMIC)
+				m_DynamicDescriptors[description->Set][description->Binding] = name;
+		}
 
-			switch (type)
+		for (auto& [setNumber, set] : m_DescriptorSets)
+		{
+			if (m_Baked)
 			{
-				case ShaderResourceType::NONE:
-				{
-
-				}
-				case ShaderResourceType::SAMPLER:
-				{
-
-				}
-				case ShaderResourceType::COMBINED_IMAGE_SAMPLER:
-				{
-
-
-					break;
-				}
-				case ShaderResourceType::SAMPLED_IMAGE:
-				{
-
-					break;
-				}
-				case ShaderResourceType::STORAGE_IMAGE:
-				{					
-					write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-
-					auto& sets = m_DescriptorSets.at(description->Set);
-					for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-					{
-						VkDescriptorImageInfo tempInfo = (std::dynamic_pointer_cast<VulkanImage2D>(std::dynamic_pointer_cast<StorageImage>(m_BoundResources.at(name))->GetImage(frame)))->GetImageInfo();
-						imageInfos.push_back(std::move(tempInfo));
-						write.pImageInfo = &(tempInfo);
-
-						write.dstSet = sets.Sets[frame];
-						writes.push_back(write);
-					}
-
-
-					break;
-				}
-				case ShaderResourceType::UNIFORM_TEXEL_BUFFER:
-				{
-
-					break;
-				}
-				case ShaderResourceType::STORAGE_TEXEL_BUFFER:
-				{
-
-					break;
-				}
-				case ShaderResourceType::UNIFORM_BUFFER:
-				{					
-					write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-
-					auto& sets = m_DescriptorSets.at(description->Set);
-					for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-					{
-						VkDescriptorBufferInfo& info = bufferInfos.emplace_back((std::dynamic_pointer_cast<VulkanBuffer>(std::dynamic_pointer_cast<UniformBuffer>(m_BoundResources.at(name))->GetBuffer(frame)))->GetBufferInfo());
-						write.pBufferInfo = &info;
-
-						write.dstSet = sets.Sets[frame];
-						writes.push_back(write);
-					}
-
-					break;
-				}
-				case ShaderResourceType::UNIFORM_BUFFER_DYNAMIC:
-				{
-					m_DynamicDescriptors[description->Set][description->Binding] = name;
-
-					break;
-				}
-				case ShaderResourceType::STORAGE_BUFFER:
-				{
-
-					Ref<ShaderResource> resource = m_BoundResources.at(name);
-					if (resource == nullptr)
-						break;
-										
-					write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-
-					auto& sets = m_DescriptorSets.at(description->Set);
-					for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-					{
-						VkDescriptorBufferInfo tempInfo = (std::dynamic_pointer_cast<VulkanBuffer>(std::dynamic_pointer_cast<StorageBuffer>(resource)->GetBuffer(frame)))->GetBufferInfo();
-						bufferInfos.push_back(std::move(tempInfo));
-						write.pBufferInfo = &(tempInfo);
-
-						write.dstSet = sets.Sets[frame];
-						writes.push_back(write);
-					}
-
-					break;
-				}
-				case ShaderResourceType::STORAGE_BUFFER_DYNAMIC:
-				{
-					m_DynamicDescriptors[description->Set][description->Binding] = name;
-
-					auto& descInfo = (std::dynamic_pointer_cast<StorageBufferDynamic>(m_BoundResources.at(name)))->GetDescriptorInfo(name);
-					if (!descInfo.Suballocation)
-					{
-						m_InvalidResources[name] = m_BoundResources.at(name);
-						break;
-					}
-					Ref<BufferSuballocation> suballocation = descInfo.Suballocation;
-					Ref<VulkanBuffer> buffer = std::dynamic_pointer_cast<VulkanBuffer>(suballocation->Buffer);
-										
-					write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-
-					VkDescriptorBufferInfo tempInfo = buffer->GetBufferInfo(0, suballocation->Range);
-					bufferInfos.push_back(std::move(tempInfo));
-					write.pBufferInfo = &(tempInfo);
-
-					auto& sets = m_DescriptorSets.at(description->Set);
-					for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-					{
-						write.dstSet = sets.Sets[frame];
-						writes.push_back(write);
-					}
-
-					break;
-				}
-				case ShaderResourceType::INPUT_ATTACHMENT:
-				{
-
-					break;
-				}
-				case ShaderResourceType::ACCELERATION_STRUCTURE:
-				{
-
-					break;
-				}
-				case ShaderResourceType::PUSH_CONSTANT:
-				{
-
-					break;
-				}
-				default:
-				{
-
-					break;
-				}
+				WriteDescriptorSets(set);
+				continue;
 			}
+			for (uint32_t frame = 0; frame < set.Sets.size(); frame++)
+				WriteDescriptorSet(set, frame);
+		}
+		m_Baked = true;
+	}
+
+	void VulkanPass::WritePendingDescriptorSets(uint32_t frame)
+	{
+		for (auto& [setNumber, set] : m_DescriptorSets)
+		{
+			if (frame < set.PendingWrites.size() && set.PendingWrites[frame])
+				WriteDescriptorSet(set, frame);
 		}
+	}
 
-		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	void VulkanPass::InvalidateDescriptorSets()
+	{
+		for (auto& [setNumber, set] : m_DescriptorSets)
+			std::fill(set.WrittenHashes.begin(), set.WrittenHashes.end(), 0);
 	}
 
 	void VulkanPass::Validate()
@@ -262,145 +142,165 @@ namespace Povox {
 	void VulkanPass::UpdateDescriptor(const std::string& name)
 	{
 		PX_CORE_ASSERT(m_AllShaderResourceDescs.find(name) != m_AllShaderResourceDescs.end(), "Descriptor not contained in Renderpass");
-		PX_CORE_ASSERT(m_InvalidResources.find(name) != m_InvalidResources.end(), "Descriptor not contained in Invalid Resources!");
-
-		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-		uint32_t framesInFlight = Application::Get()->GetSpecification().MaxFramesInFlight;
-
 
-		Ref<ShaderResourceDescription> description = m_AllShaderResourceDescs[name];
-
-		VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-		write.pNext = nullptr;
-		write.descriptorCount = description->Count;
-		write.dstBinding = description->Binding;
+		// The resource may have been recreated with a handle of the one it replaces, so no frame is skipped as unchanged
+		m_InvalidResources.erase(name);
+		auto& set = m_DescriptorSets.at(m_AllShaderResourceDescs.at(name)->Set);
+		std::fill(set.WrittenHashes.begin(), set.WrittenHashes.end(), 0);
+		WriteDescriptorSets(set);
+	}
 
-		ShaderResourceType type = description->ResourceType;
-		switch (type)
+	void VulkanPass::WriteDescriptorSets(DescriptorSet& set)
+	{
+		// Sets of other frames may still be read by the GPU, updating them without UPDATE_AFTER_BIND would be invalid
+		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
+		set.PendingWrites.resize(set.Sets.size(), false);
+		for (uint32_t frame = 0; frame < set.Sets.size(); frame++)
 		{
-			case ShaderResourceType::NONE:
-			{
-
-				break;
-			}
-			case ShaderResourceType::SAMPLER:
-			{
-
-				break;
-			}
-			case ShaderResourceType::COMBINED_IMAGE_SAMPLER:
-			{
-
+			if (frame == currentFrame)
+				WriteDescriptorSet(set, frame);
+			else
+				set.PendingWrites[frame] = true;
+		}
+	}
 
-				break;
-			}
-			case ShaderResourceType::SAMPLED_IMAGE:
-			{
+	bool VulkanPass::GetDescriptorWrite(const std::string& name, const ShaderResourceDescription& description, uint32_t frame, VkDescriptorType& outType, DescriptorWriteData& outData)
+	{
+		auto resourceIt = m_BoundResources.find(name);
+		if (resourceIt == m_BoundResources.end() || !resourceIt->second)
+			return false;
+		const Ref<ShaderResource>& resource = resourceIt->second;
 
-				break;
-			}
+		switch (description.ResourceType)
+		{
 			case ShaderResourceType::STORAGE_IMAGE:
 			{
-				write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-
-				for (uint32_t frame = 0; frame < framesInFlight; frame++)
-				{
-					write.pImageInfo = &((std::dynamic_pointer_cast<VulkanImage2D>(std::dynamic_pointer_cast<StorageImage>(m_BoundResources.at(name))->GetImage(frame)))->GetImageInfo());
-					write.dstSet = m_DescriptorSets.at(description->Set).Sets[frame];
-				}
-
-
-				break;
-			}
-			case ShaderResourceType::UNIFORM_TEXEL_BUFFER:
-			{
-
-				break;
-			}
-			case ShaderResourceType::STORAGE_TEXEL_BUFFER:
-			{
-
-				break;
+				outType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+				outData.Image = std::dynamic_pointer_cast<VulkanImage2D>(std::dynamic_pointer_cast<StorageImage>(resource)->GetImage(frame))->GetImageInfo();
+				return true;
 			}
 			case ShaderResourceType::UNIFORM_BUFFER:
-			{				
-				write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-
-				auto& sets = m_DescriptorSets.at(description->Set);
-				for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-				{
-					write.pBufferInfo = &((std::dynamic_pointer_cast<VulkanBuffer>(std::dynamic_pointer_cast<UniformBuffer>(m_BoundResources.at(name))->GetBuffer(frame)))->GetBufferInfo());
-					write.dstSet = sets.Sets[frame];
-				}
-
-				break;
-			}
-			case ShaderResourceType::STORAGE_BUFFER:
 			{
-				write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-
-				auto& sets = m_DescriptorSets.at(description->Set);
-				for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-				{
-					write.pBufferInfo = &((std::dynamic_pointer_cast<VulkanBuffer>(std::dynamic_pointer_cast<StorageBuffer>(m_BoundResources.at(name))->GetBuffer(frame)))->GetBufferInfo());
-					write.dstSet = sets.Sets[frame];
-				}
-
-				break;
+				outType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				Ref<BufferSuballocation> suballocation = std::dynamic_pointer_cast<UniformBuffer>(resource)->GetSuballocation(frame);
+				outData.Buffer = std::dynamic_pointer_cast<VulkanBuffer>(suballocation->Buffer)->GetBufferInfo(suballocation->Offset, suballocation->Range);
+				return true;
 			}
-			case ShaderResourceType::UNIFORM_BUFFER_DYNAMIC:
+			case ShaderResourceType::STORAGE_BUFFER:
 			{
-
-				break;
+				outType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				Ref<BufferSuballocation> suballocation = std::dynamic_pointer_cast<StorageBuffer>(resource)->GetSuballocation(frame);
+				outData.Buffer = std::dynamic_pointer_cast<VulkanBuffer>(suballocation->Buffer)->GetBufferInfo(suballocation->Offset, suballocation->Range);
+				return true;
 			}
 			case ShaderResourceType::STORAGE_BUFFER_DYNAMIC:
 			{
-				Ref<StorageBufferDynamic> resource = std::dynamic_pointer_cast<StorageBufferDynamic>(m_BoundResources.at(name));
-				auto& descriptorInfo = resource->GetDescriptorInfo(name);
-
+				auto descriptorInfo = std::dynamic_pointer_cast<StorageBufferDynamic>(resource)->GetDescriptorInfo(name);
 				if (!descriptorInfo.Suballocation)
 				{
-					PX_CORE_ERROR("Resource {} still not ready to use!");
-					break;
+					m_InvalidResources[name] = resource;
+					return false;
 				}
 
-				write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				outType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				outData.Buffer = std::dynamic_pointer_cast<VulkanBuffer>(descriptorInfo.Suballocation->Buffer)->GetBufferInfo(0, descriptorInfo.Suballocation->Range);
+				return true;
+			}
+			// Written elsewhere (bindless textures) or not supported by passes yet
+			default:
+				return false;
+		}
+	}
 
-				write.pBufferInfo = &((std::dynamic_pointer_cast<VulkanBuffer>(resource->GetBuffer(name)))
-					->GetBufferInfo(0, descriptorInfo.Suballocation->Range));
+	void VulkanPass::WriteDescriptorSet(DescriptorSet& set, uint32_t frame)
+	{
+		// Entries only for bindings that can be written right now, resources that are not ready yet change the template once they are
+		struct BindingWrite
+		{
+			VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			DescriptorWriteData Data{};
+			uint32_t Count = 1;
+		};
+		std::map<uint32_t, BindingWrite> bindings;
+		for (const auto& [name, description] : m_AllShaderResourceDescs)
+		{
+			if (description->Set != set.SetNumber)
+				continue;
 
-				//TODO: remove framed
-				auto& sets = m_DescriptorSets.at(description->Set);
-				for (uint32_t frame = 0; frame < sets.Sets.size(); frame++)
-				{
-					write.dstSet = sets.Sets[frame];
-				}
-				m_InvalidResources.erase(name);
-				break;
-			}
-			case ShaderResourceType::INPUT_ATTACHMENT:
-			{
+			VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			DescriptorWriteData data{};
+			if (GetDescriptorWrite(name, *description, frame, type, data))
+				bindings[description->Binding] = { type, data, std::max(description->Count, 1u) };
+		}
+		set.PendingWrites.resize(set.Sets.size(), false);
+		set.PendingWrites[frame] = false;
+		if (bindings.empty())
+			return;
 
-				break;
-			}
-			case ShaderResourceType::ACCELERATION_STRUCTURE:
-			{
+		// Only the fields below are hashed, padding of the entries and the unused bytes of the union are not deterministic
+		std::vector<VkDescriptorUpdateTemplateEntry> entries;
+		std::vector<DescriptorWriteData> writeData;
+		entries.reserve(bindings.size());
+		writeData.reserve(bindings.size());
+		XXH3_state_t* state = XXH3_createState();
+		XXH3_64bits_reset(state);
+		XXH3_64bits_update(state, &set.Layout, sizeof(set.Layout));
+		for (const auto& [binding, write] : bindings)
+		{
+			VkDescriptorUpdateTemplateEntry entry{};
+			entry.dstBinding = binding;
+			entry.dstArrayElement = 0;
+			entry.descriptorCount = write.Count;
+			entry.descriptorType = write.Type;
+			entry.offset = writeData.size() * sizeof(DescriptorWriteData);
+			entry.stride = sizeof(DescriptorWriteData);
+			entries.push_back(entry);
+			// A bound resource is a single descriptor, arrays get it in every element so the template never reads past the data
+			writeData.insert(writeData.end(), write.Count, write.Data);
+
+			XXH3_64bits_update(state, &entry.dstBinding, sizeof(entry.dstBinding));
+			XXH3_64bits_update(state, &entry.descriptorCount, sizeof(entry.descriptorCount));
+			XXH3_64bits_update(state, &entry.descriptorType, sizeof(entry.descriptorType));
+		}
+		const uint64_t templateHash = XXH3_64bits_digest(state);
 
-				break;
-			}
-			case ShaderResourceType::PUSH_CONSTANT:
+		for (const auto& [binding, write] : bindings)
+		{
+			if (write.Type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
 			{
-
-				break;
+				XXH3_64bits_update(state, &write.Data.Image.sampler, sizeof(write.Data.Image.sampler));
+				XXH3_64bits_update(state, &write.Data.Image.imageView, sizeof(write.Data.Image.imageView));
+				XXH3_64bits_update(state, &write.Data.Image.imageLayout, sizeof(write.Data.Image.imageLayout));
 			}
-			default:
+			else
 			{
-
-				break;
+				XXH3_64bits_update(state, &write.Data.Buffer.buffer, sizeof(write.Data.Buffer.buffer));
+				XXH3_64bits_update(state, &write.Data.Buffer.offset, sizeof(write.Data.Buffer.offset));
+				XXH3_64bits_update(state, &write.Data.Buffer.range, sizeof(write.Data.Buffer.range));
 			}
 		}
+		const uint64_t writeHash = XXH3_64bits_digest(state);
+		XXH3_freeState(state);
+
+		set.WrittenHashes.resize(set.Sets.size(), 0);
+		if (set.WrittenHashes[frame] == writeHash)
+			return;
+
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		VkDescriptorUpdateTemplate& updateTemplate = m_UpdateTemplates[templateHash];
+		if (updateTemplate == VK_NULL_HANDLE)
+		{
+			VkDescriptorUpdateTemplateCreateInfo info{ VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO };
+			info.pNext = nullptr;
+			info.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+			info.pDescriptorUpdateEntries = entries.data();
+			info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+			info.descriptorSetLayout = set.Layout;
+			PX_CORE_VK_ASSERT(vkCreateDescriptorUpdateTemplate(device, &info, nullptr, &updateTemplate), VK_SUCCESS, "Failed to create DescriptorUpdateTemplate!");
+		}
 
-		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+		vkUpdateDescriptorSetWithTemplate(device, set.Sets[frame], updateTemplate, writeData.data());
+		set.WrittenHashes[frame] = writeHash;
 	}
 
 	std::vector<uint32_t> VulkanPass::GetDynamicOffsets(uint32_t currentFrameIndex)
@@ -443,15 +343,16 @@ namespace Povox {
 	}
 
 
-	const std::vector<std::string> VulkanPass::GetBoundResourceNames()
+	Ref<ShaderResource> VulkanPass::GetBoundResource(const std::string& name) const
 	{
-		std::vector<std::string> descriptorNames;
-		descriptorNames.reserve(m_BoundResources.size());
-		for (const auto& [name, descr] : m_BoundResources)
-		{
-			descriptorNames.push_back(name);
-		}
-		return descriptorNames;
+		auto it = m_BoundResources.find(name);
+		return it != m_BoundResources.end() ? it->second : nullptr;
+	}
+
+	Ref<ShaderResourceDescription> VulkanPass::GetResourceDescription(const std::string& name) const
+	{
+		auto it = m_AllShaderResourceDescs.find(name);
+		return it != m_AllShaderResourceDescs.end() ? it->second : nullptr;
 	}
 
 // RenderPass
@@ -503,114 +404,6 @@ namespace Povox {
 		PX_CORE_INFO("VulkanRenderpass::Recreate: Recreated Renderpass with AttachmentExtent of '{0}, {1}'", width, height);		
 	}	
 
-	void VulkanRenderPass::UpdateResourceOwnership(uint32_t frameIndex)
-	{
-		if (!m_PredecessorPass)
-		{
-			PX_CORE_INFO("VulkanRenderPass::UpdateResourceOwnership: This Graphics pass has no previous compute. No ownership transfer needed!");
-			return;
-		}
-
-		if (m_PredecessorPass->GetPassType() == PassType::GRAPHICS)
-			return;
-
-		Ref<VulkanComputePass> computePass = std::dynamic_pointer_cast<VulkanComputePass>(m_PredecessorPass);
-
-		uint32_t graphicsQueue = VulkanContext::GetDevice()->GetQueueFamilies().GraphicsFamilyIndex;
-		uint32_t computeQueue = VulkanContext::GetDevice()->GetQueueFamilies().ComputeFamilyIndex;
-
-		//Now find all resources that are used in the previous compute and this graphics pass. Ownership from Compute to Graphics queue
-
-		std::vector<std::string> prevDescriptorNames = computePass->GetBoundResourceNames();
-		
-		VkBuffer buffer = nullptr;
-		size_t offset = 0;
-		size_t range = 0;
-		for (const std::string& prevName : prevDescriptorNames)
-		{
-			if (m_BoundResources.find(prevName) == m_BoundResources.end())
-				continue;
-			Ref<ShaderResource> sharedResource = m_BoundResources.at(prevName);
-			
-			switch (sharedResource->GetType())
-			{
-				case ShaderResourceType::UNIFORM_BUFFER:
-				{
-					break;
-				}
-				case ShaderResourceType::STORAGE_BUFFER:
-				{	
-					//Ref<VulkanBuffer> vkBuffer = std::dynamic_pointer_cast<VulkanBuffer>(std::dynamic_pointer_cast<StorageBuffer>(m_BoundResources.at(prevName))->GetBuffer(frameIndex));
-					break;
-				}
-				case ShaderResourceType::UNIFORM_BUFFER_DYNAMIC:
-				{
-					break;
-				}
-				case ShaderResourceType::STORAGE_BUFFER_DYNAMIC:
-				{
-					Ref<StorageBufferDynamic> storageBuf = std::dynamic_pointer_cast<StorageBufferDynamic>(m_BoundResources.at(prevName));
-					auto& descriptorInfo = storageBuf->GetDescriptorInfo(prevName);
-
-					if (!descriptorInfo.Suballocation)
-					{
-						PX_CORE_WARN("This Dynamic storage buffer does not contain any suballocations");
-						break;
-					}
-
-					buffer = std::dynamic_pointer_cast<VulkanBuffer>(descriptorInfo.Suballocation->Buffer)->GetAllocation().Buffer;
-					offset = descriptorInfo.Suballocation->Offset;
-					range = descriptorInfo.Suballocation->Range;
-
-					VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(VulkanCommandControl::SubmitType::SUBMIT_TYPE_COMPUTE_GRAPHICS
-						, [=](VkCommandBuffer releaseCmd)
-						{
-							VkBufferMemoryBarrier2 bufBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-							bufBarrier.pNext = nullptr;
-							bufBarrier.srcQueueFamilyIndex = computeQueue;
-							bufBarrier.dstQueueFamilyIndex = graphicsQueue;
-
-							bufBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
-							bufBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-
-							bufBarrier.buffer = buffer;
-							bufBarrier.offset = offset;
-							bufBarrier.size = range;
-
-							VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-							dependency.pNext = nullptr;
-							dependency.bufferMemoryBarrierCount = 1;
-							dependency.pBufferMemoryBarriers = &bufBarrier;
-							vkCmdPipelineBarrier2(releaseCmd, &dependency);
-						}
-						, [=](VkCommandBuffer acquireCmd)
-							{
-								VkBufferMemoryBarrier2 bufBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-								bufBarrier.pNext = nullptr;
-								bufBarrier.srcQueueFamilyIndex = computeQueue;
-								bufBarrier.dstQueueFamilyIndex = graphicsQueue;
-
-								bufBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
-								bufBarrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
-
-								bufBarrier.buffer = buffer;
-								bufBarrier.offset = offset;
-								bufBarrier.size = range;
-
-								VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-								dependency.pNext = nullptr;
-								dependency.bufferMemoryBarrierCount = 1;
-								dependency.pBufferMemoryBarriers = &bufBarrier;
-								vkCmdPipelineBarrier2(acquireCmd, &dependency);
-							});
-					break;
-				}
-			}
-		}			
-	}
-
-
-
 // Compute
 
 	VulkanComputePass::VulkanComputePass(const ComputePassSpecification& spec)
@@ -648,111 +441,4 @@ namespace Povox {
 	{
 
 	}
-
-	void VulkanComputePass::UpdateResourceOwnership(uint32_t frameIndex)
-	{
-		if (!m_PredecessorPass)
-		{
-			PX_CORE_INFO("VulkanRenderPass::UpdateResourceOwnership: This Graphics pass has no previous compute. No ownership transfer needed!");
-			return;
-		}
-
-		if (m_PredecessorPass->GetPassType() == PassType::COMPUTE)
-			return;
-
-		Ref<VulkanRenderPass> graphicsPass = std::dynamic_pointer_cast<VulkanRenderPass>(m_PredecessorPass);
-
-		uint32_t graphicsQueue = VulkanContext::GetDevice()->GetQueueFamilies().GraphicsFamilyIndex;
-		uint32_t computeQueue = VulkanContext::GetDevice()->GetQueueFamilies().ComputeFamilyIndex;
-
-		//Now find all resources that are used in the previous compute and this graphics pass. Ownership from Compute to Graphics queue
-
-		std::vector<std::string> prevDescriptorNames = graphicsPass->GetBoundResourceNames();
-
-		VkBuffer buffer = nullptr;
-		size_t offset = 0;
-		size_t range = 0;
-		for (const std::string& prevName : prevDescriptorNames)
-		{
-			if (m_BoundResources.find(prevName) == m_BoundResources.end())
-				continue;
-			Ref<ShaderResource> sharedResource = m_BoundResources.at(prevName);
-
-			switch (sharedResource->GetType())
-			{
-				case ShaderResourceType::UNIFORM_BUFFER:
-				{
-					break;
-				}
-				case ShaderResourceType::STORAGE_BUFFER:
-				{
-					//Ref<VulkanBuffer> vkBuffer = std::dynamic_pointer_cast<VulkanBuffer>(std::dynamic_pointer_cast<StorageBuffer>(m_BoundResources.at(prevName))->GetBuffer(frameIndex));
-					break;
-				}
-				case ShaderResourceType::UNIFORM_BUFFER_DYNAMIC:
-				{
-					break;
-				}
-				case ShaderResourceType::STORAGE_BUFFER_DYNAMIC:
-				{
-					Ref<StorageBufferDynamic> storageBuf = std::dynamic_pointer_cast<StorageBufferDynamic>(m_BoundResources.at(prevName));
-					auto& descriptorInfo = storageBuf->GetDescriptorInfo(prevName);
-
-					if (!descriptorInfo.Suballocation)
-					{
-						PX_CORE_WARN("This Dynamic storage buffer does not contain any suballocations");
-						break;
-					}
-
-					buffer = std::dynamic_pointer_cast<VulkanBuffer>(descriptorInfo.Suballocation->Buffer)->GetAllocation().Buffer;
-					offset = descriptorInfo.Suballocation->Offset;
-					range = descriptorInfo.Suballocation->Range;
-
-					VulkanCommandControl::ImmidiateSubmitOwnershipTransfer(VulkanCommandControl::SubmitType::SUBMIT_TYPE_GRAPHICS_COMPUTE
-						, [=](VkCommandBuffer releaseCmd)
-						{
-							VkBufferMemoryBarrier2 bufBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-							bufBarrier.pNext = nullptr;
-							bufBarrier.srcQueueFamilyIndex = graphicsQueue;
-							bufBarrier.dstQueueFamilyIndex = computeQueue;
-
-							bufBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
-							bufBarrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-
-							bufBarrier.buffer = buffer;
-							bufBarrier.offset = offset;
-							bufBarrier.size = range;
-
-							VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-							dependency.pNext = nullptr;
-							dependency.bufferMemoryBarrierCount = 1;
-							dependency.pBufferMemoryBarriers = &bufBarrier;
-							vkCmdPipelineBarrier2(releaseCmd, &dependency);
-						}
-						, [=](VkCommandBuffer acquireCmd)
-							{
-								VkBufferMemoryBarrier2 bufBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-								bufBarrier.pNext = nullptr;
-								bufBarrier.srcQueueFamilyIndex = graphicsQueue;
-								bufBarrier.dstQueueFamilyIndex = computeQueue;
-
-								bufBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
-								bufBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-
-								bufBarrier.buffer = buffer;
-								bufBarrier.offset = offset;
-								bufBarrier.size = range;
-
-								VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-								dependency.pNext = nullptr;
-								dependency.bufferMemoryBarrierCount = 1;
-								dependency.pBufferMemoryBarriers = &bufBarrier;
-								vkCmdPipelineBarrier2(acquireCmd, &dependency);
-							});
-					break;
-				}
-			}
-		}
-	}
-
 }
@@ -11,46 +11,68 @@ namespace Povox {
 		uint32_t Bindings = 0;
 		std::vector<VkDescriptorSet> Sets;
 		VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+		// Hash of what was last written into each of the Sets, writes of unchanged resources are skipped
+		std::vector<uint64_t> WrittenHashes;
+		// Sets that may still be read by a frame in flight, they are written once their frame begins the pass again
+		std::vector<bool> PendingWrites;
 	};
 
 	class VulkanPass : public virtual GPUPass
 	{
 	public:
 		VulkanPass();
-		virtual ~VulkanPass() = default;
+		virtual ~VulkanPass();
 
 		virtual void BindInput(const std::string& name, Ref<ShaderResource>) override;
 		virtual void BindOutput(const std::string& name, Ref<ShaderResource>) override;
 
 
+		// Rewrites the set containing name, e.g. once a resource that was not ready during Bake is or was recreated
 		virtual void UpdateDescriptor(const std::string& name) override;
 		/**
-		 * Writes the bound ShaderResources to the bound pipeline descriptor sets
+		 * Writes the bound ShaderResources to the bound pipeline descriptor sets through update templates built from the reflected bindings.
+		 * Sets whose resources did not change since their last write are skipped, so calling it again after a resize is cheap.
+		 * After the first Bake only the current frame's sets are written right away, the others once their frame begins the pass
 		 */
 		virtual void Bake() override;		
 
-		virtual inline void SetPredecessor(Ref<GPUPass> predecessor) override { m_PredecessorPass = predecessor; }
-		virtual void SetSuccessor(Ref<GPUPass> successor) override { m_SuccessorPass = successor; }
+		// Called when the pass begins on frame, before its sets are bound
+		void WritePendingDescriptorSets(uint32_t frame);
+		// Recreated resources can get the handles of the ones they replace, every set is written again on its next write
+		void InvalidateDescriptorSets();
+
+		virtual inline const std::vector<std::string>& GetInputs() const override { return m_Inputs; }
+		virtual inline const std::vector<std::string>& GetOutputs() const override { return m_Outputs; }
 
 		virtual PassType GetPassType() override { return m_Type; }
 
 		inline const std::map<uint32_t, DescriptorSet>& GetDescriptorSets() const { return m_DescriptorSets; }
 		std::vector<uint32_t> GetDynamicOffsets(uint32_t currentFrameIndex);
-		//Temp
-		const std::vector<std::string> GetBoundResourceNames();
+
+		// nullptr if name is not bound or not used by the pipeline
+		Ref<ShaderResource> GetBoundResource(const std::string& name) const;
+		Ref<ShaderResourceDescription> GetResourceDescription(const std::string& name) const;
 
 	protected:
 		void CreateDescriptorSets(const std::map<uint32_t, VkDescriptorSetLayout>& layoutMap);
 
 		//minor bake, that checks and writes previously invalid descriptors
 		void Validate();
+
+	private:
+		union DescriptorWriteData
+		{
+			VkDescriptorImageInfo Image;
+			VkDescriptorBufferInfo Buffer;
+		};
+
+		bool GetDescriptorWrite(const std::string& name, const ShaderResourceDescription& description, uint32_t frame, VkDescriptorType& outType, DescriptorWriteData& outData);
+		void WriteDescriptorSets(DescriptorSet& set);
+		void WriteDescriptorSet(DescriptorSet& set, uint32_t frame);
 			
 	protected:
 		PassType m_Type = PassType::UNDEFINED;
 
-		Ref<GPUPass> m_PredecessorPass = nullptr;
-		Ref<GPUPass> m_SuccessorPass = nullptr;
-
 		std::string m_DebugName = "VulkanPass_Debug";
 
 		// Resources needed by the bound shaders of this renderpass/pipeline
@@ -63,10 +85,15 @@ namespace Povox {
 		//Temp here -> to me moved in DescriptorManager
 		std::map<uint32_t, DescriptorSet> m_DescriptorSets;
 		std::map<uint32_t, std::map<uint32_t, std::string>> m_DynamicDescriptors;
+		// No set is in use before the first Bake, it writes every frame at once
+		bool m_Baked = false;
 
 		// Resources that are not available during bake time
 		std::unordered_map<std::string, Ref<ShaderResource>> m_InvalidResources;
 
+		// Keyed by set layout and entries, shared by all frames and by sets with the same bindings
+		std::unordered_map<uint64_t, VkDescriptorUpdateTemplate> m_UpdateTemplates;
+
 		std::vector<std::string> m_Inputs;
 		std::vector<std::string> m_Outputs;
 
@@ -87,8 +114,6 @@ namespace Povox {
 		virtual inline RenderPassSpecification& GetSpecification() override { return m_Specification; }
 		virtual inline const std::string& GetDebugName() const override { return m_Specification.DebugName; }
 
-		void UpdateResourceOwnership(uint32_t frameIndex);
-
 		inline VkRenderPass GetRenderPass() const { return m_RenderPass; }
 
 	private:
@@ -113,8 +138,6 @@ namespace Povox {
 		virtual inline const std::string& GetDebugName() const override { return m_Specification.DebugName; }
 		
 		//virtual Ref<Image2D> GetFinalImage(uint32_t index) override;
-		
-		void UpdateResourceOwnership(uint32_t frameIndex);
 
 	private:
 		ComputePassSpecification m_Specification{};
@@ -1,10 +1,13 @@
 #include "pxpch.h"
 #include "Platform/Vulkan/VulkanRenderer.h"
 
+#include "Platform/Vulkan/VulkanBarrierBatcher.h"
 #include "Platform/Vulkan/VulkanContext.h"
 #include "Platform/Vulkan/VulkanDebug.h"
 #include "Platform/Vulkan/VulkanFramebuffer.h"
 #include "Platform/Vulkan/VulkanQueryManager.h"
+#include "Platform/Vulkan/VulkanStagingRing.h"
+#include "Platform/Vulkan/VulkanTransferScheduler.h"
 
 #include "Povox/Systems/TextureSystem.h"
 
@@ -19,6 +22,12 @@ namespace Povox {
 
 	Scope<VulkanImGui> VulkanRenderer::m_ImGui = nullptr;
 	static constexpr uint32_t MAX_OBJECTS = 10000;
+	static constexpr size_t STAGING_RING_FRAME_SIZE = 32 * 1024 * 1024;
+	static constexpr size_t TRANSFER_STAGING_BLOCK_SIZE = 16 * 1024 * 1024;
+	static constexpr size_t BUFFER_POOL_BLOCK_SIZE = 8 * 1024 * 1024;
+
+	// Secondary command buffer the calling thread is recording between Begin- and EndSecondaryCommandBuffer
+	static thread_local VkCommandBuffer s_SecondaryCommandBuffer = VK_NULL_HANDLE;
 
 	VulkanRenderer::VulkanRenderer(const RendererSpecification& specs)
 		:m_Specification(specs)
@@ -45,6 +54,13 @@ namespace Povox {
 
 		InitCommandControl();		
 		InitFrameData();
+		InitTimelineSemaphores();
+
+		PX_CORE_INFO("Creating BufferPool...");
+
+		m_BufferPool = CreateRef<VulkanBufferPool>(m_Specification.MaxFramesInFlight, BUFFER_POOL_BLOCK_SIZE);
+
+		PX_CORE_INFO("Completed BufferPool creation.");
 
 
 		PX_CORE_INFO("Creating QueryManager...");
@@ -117,6 +133,8 @@ namespace Povox {
 
 		PX_CORE_INFO("Completed TextureSystem shutdown.");
 
+		m_BufferPool->Destroy();
+
 		PX_CORE_INFO("Started destruction of performance pools...");
 
 
@@ -130,17 +148,20 @@ namespace Povox {
 			vkDestroySemaphore(m_Device, m_Frames[i].Semaphores.PresentSemaphore, nullptr);
 			vkDestroySemaphore(m_Device, m_Frames[i].Semaphores.RenderSemaphore, nullptr);
 
-			vkDestroySemaphore(m_Device, m_Frames[i].Semaphores.ComputeFinishedSemaphore, nullptr);
-
-			vkDestroyFence(m_Device, m_Frames[i].RenderFence, nullptr);
-			vkDestroyFence(m_Device, m_Frames[i].ComputeFence, nullptr);
-
 			vkDestroyCommandPool(m_Device, m_Frames[i].Commands.Pool, nullptr);
+			for (auto& secondary : m_Frames[i].Commands.SecondaryPools)
+				vkDestroyCommandPool(m_Device, secondary.Pool, nullptr);
 
 			vmaDestroyBuffer(VulkanContext::GetAllocator(), m_Frames[i].CamUniformBuffer.Buffer, m_Frames[i].CamUniformBuffer.Allocation);
 			vmaDestroyBuffer(VulkanContext::GetAllocator(), m_Frames[i].ObjectBuffer.Buffer, m_Frames[i].ObjectBuffer.Allocation);
 		}
 		m_Frames.clear();
+		m_PendingFrames.clear();
+
+		vkDestroySemaphore(m_Device, m_ComputeFinishedSemaphore, nullptr);
+		m_ComputeFinishedSemaphore = VK_NULL_HANDLE;
+		vkDestroySemaphore(m_Device, m_RenderFinishedSemaphore, nullptr);
+		m_RenderFinishedSemaphore = VK_NULL_HANDLE;
 
 		PX_CORE_INFO("Completed FrameObjects (Synch, Commands, UBOs) destruction for {0} frames...", m_Frames.size());
 		PX_CORE_WARN("Started destruction of leftovers and other things...");
@@ -156,6 +177,7 @@ namespace Povox {
 		m_FinalImages.clear();
 
 
+		vkDestroyDescriptorPool(m_Device, m_BindlessDescriptorPool, nullptr);
 		vkDestroySampler(m_Device, m_TextureSampler, nullptr);
 
 		
@@ -172,58 +194,119 @@ namespace Povox {
 	//FrameData
 	bool VulkanRenderer::PrepareRenderFrame()
 	{
-		vkWaitForFences(m_Device, 1, &GetCurrentFrame().RenderFence, VK_TRUE, UINT64_MAX);
+		// The slot's last frame is done once the graphics timeline reached its number and the compute timeline its last dispatch.
+		// Only this slot is waited on, the CPU records up to MaxFramesInFlight frames ahead of the GPU
+		VkSemaphore timelines[] = { m_RenderFinishedSemaphore, m_ComputeFinishedSemaphore };
+		uint64_t values[] = { GetCurrentFrame().FrameNumber, GetCurrentFrame().ComputeFinishedValue };
+		VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.pNext = nullptr;
+		waitInfo.flags = 0;
+		waitInfo.semaphoreCount = 2;
+		waitInfo.pSemaphores = timelines;
+		waitInfo.pValues = values;
+		vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX);
+
 		vkResetCommandPool(m_Device, GetCurrentFrame().Commands.Pool, 0);
+		for (auto& secondary : GetCurrentFrame().Commands.SecondaryPools)
+		{
+			vkResetCommandPool(m_Device, secondary.Pool, 0);
+			secondary.NextBuffer = 0;
+		}
 		
 		m_SwapchainFrame = m_Swapchain->AcquireNextImageIndex(GetCurrentFrame().Semaphores.PresentSemaphore);
 		if (!m_SwapchainFrame)
 			return false;
-		vkResetFences(m_Device, 1, &GetCurrentFrame().RenderFence);
 
 		m_Specification.State.CurrentSwapchainImageIndex = m_CurrentSwapchainImageIndex = m_SwapchainFrame->CurrentImageIndex;
-		m_SwapchainFrame->CurrentFence = GetCurrentFrame().RenderFence;
 		m_SwapchainFrame->WaitSemaphores.clear();
+		m_SwapchainFrame->WaitStages.clear();
+		m_SwapchainFrame->WaitValues.clear();
 		m_SwapchainFrame->WaitSemaphores.push_back(GetCurrentFrame().Semaphores.PresentSemaphore);
+		m_SwapchainFrame->WaitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+		m_SwapchainFrame->WaitValues.push_back(0);
 		m_SwapchainFrame->RenderSemaphore = GetCurrentFrame().Semaphores.RenderSemaphore;
+		// Only counted once the image was acquired, a skipped frame must not leave a value behind nobody signals.
+		// The acquire and present semaphores stay binary, the swapchain does not take timeline semaphores
+		GetCurrentFrame().FrameNumber = ++m_CurrentFrameNumber;
+		m_SwapchainFrame->TimelineSemaphore = m_RenderFinishedSemaphore;
+		m_SwapchainFrame->TimelineValue = m_CurrentFrameNumber;
+
+		return true;
 	}
 
 	bool VulkanRenderer::PrepareComputeFrame()
 	{
-		vkWaitForFences(m_Device, 1, &GetCurrentFrame().ComputeFence, VK_TRUE, UINT64_MAX);		
+		// The dispatches recorded from this slot's pool were waited on in PrepareRenderFrame. The graphics work does not wait on compute as a whole,
+		// the RenderGraph makes it wait on the compute timeline where the two share data
 		vkResetCommandPool(m_Device, GetCurrentFrame().Commands.ComputePool, 0);
-		
-		vkResetFences(m_Device, 1, &GetCurrentFrame().ComputeFence);
-		//vkResetCommandBuffer(GetCurrentFrame().Commands.ComputeBuffer, 0);
-
-		//m_SwapchainFrame->WaitSemaphores.push_back(GetCurrentFrame().Semaphores.ComputeFinishedSemaphore);
 
 		return true;
 	}
 
 	/**
-	 * Clears resources form last frames garbage collection.
-	 * Queries performance results form last Frame.
+	 * Waits until the frame slot's last frame completed on the GPU.
+	 * Frees the resources retired in completed frames.
+	 * Releases the texture slots of unregistered textures nothing references anymore.
+	 * Reads back the performance results of the slot's last frame.
 	 * Prepares preProcess ComputeResources.
 	 */
 	bool VulkanRenderer::BeginFrame()
 	{
 		PX_PROFILE_FUNCTION();
 
+		if (!PrepareRenderFrame() || !PrepareComputeFrame())
+			return false;
+
+		UpdateCompletedFrame();
+		VulkanContext::FreeCompletedResources(m_CompletedFrameNumber);
+		m_TextureSystem->ReleaseUnreferencedTextures();
+
+		// The queries were written MaxFramesInFlight frames ago, their results are available now that the frame completed
+		if (GetCurrentFrame().QueryResultsPending)
+		{
+			GetQueryResults(m_CurrentFrameIndex);
+			GetCurrentFrame().QueryResultsPending = false;
+		}
 		m_QueryManager->ResetTimestampQueryPool(m_CurrentFrameIndex);
 		m_QueryManager->ResetPipelineQueryPools(m_CurrentFrameIndex);
-		//VulkanContext::FreeFrameResources(m_CurrentFrameIndex);
 
-		return PrepareRenderFrame() && PrepareComputeFrame();
+		m_StagingRing->BeginFrame(m_CurrentFrameIndex);
+		m_BarrierBatcher->BeginFrame(m_CurrentFrameIndex);
+		m_BarrierBatcher->SetQueueTimelineValue(QueueFamilyOwnership::QFO_GRAPHICS, m_SwapchainFrame->TimelineValue);
+		// Kicks off last frame's async uploads and hands finished ones to their queues before anything else is submitted
+		m_TransferScheduler->Update(m_CurrentFrameIndex);
+		m_BufferPool->BeginFrame(m_CurrentFrameIndex);
+		return true;
 	}
 	void VulkanRenderer::EndFrame()
 	{
-		GetQueryResults(m_CurrentFrameIndex);
+		// Uploads recorded during this frame have to execute before any of the frame's render commands
+		VkCommandBuffer uploadCmd = m_StagingRing->EndFrame();
+		if (uploadCmd != VK_NULL_HANDLE)
+			m_SwapchainFrame->Commands.insert(m_SwapchainFrame->Commands.begin(), uploadCmd);
+
+		GetCurrentFrame().QueryResultsPending = true;
+		m_PendingFrames.emplace_back(m_CurrentFrameNumber, m_ComputeFinishedValue);
+
 		m_Specification.State.LastFrameIndex = m_LastFrameIndex = m_CurrentFrameIndex;
 		m_Specification.State.CurrentFrameIndex = m_CurrentFrameIndex = (++m_CurrentFrameIndex) % m_Specification.MaxFramesInFlight;
 		m_Specification.State.TotalFrames++;
 	}
+
+	void VulkanRenderer::UpdateCompletedFrame()
+	{
+		uint64_t renderValue = 0, computeValue = 0;
+		vkGetSemaphoreCounterValue(m_Device, m_RenderFinishedSemaphore, &renderValue);
+		vkGetSemaphoreCounterValue(m_Device, m_ComputeFinishedSemaphore, &computeValue);
+
+		while (!m_PendingFrames.empty() && m_PendingFrames.front().first <= renderValue && m_PendingFrames.front().second <= computeValue)
+		{
+			m_CompletedFrameNumber = m_PendingFrames.front().first;
+			m_PendingFrames.pop_front();
+		}
+	}
 	
-	void VulkanRenderer::Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless)
+	void VulkanRenderer::Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless, int32_t vertexOffset)
 	{
 		PX_PROFILE_FUNCTION();
 
@@ -263,47 +346,21 @@ namespace Povox {
 
 		// only bind material descriptor sets here -> better store them all in one descriptor set and pass the offsets
 		
+		VkCommandBuffer cmd = GetRecordingCommandBuffer();
+		bool secondary = cmd != m_ActiveCommandBuffer;
 		if (!textureless)
 		{
-			VkWriteDescriptorSet samplerWrite{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			samplerWrite.dstBinding = 0;
-			samplerWrite.dstArrayElement = 0;
-			samplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-			samplerWrite.descriptorCount = 1;
-			samplerWrite.dstSet = GetCurrentFrame().TextureDescriptorSet;
-
-			VkDescriptorImageInfo samplerInfo{};
-			samplerInfo.sampler = m_TextureSampler;
-			samplerWrite.pImageInfo = &samplerInfo;
-
-			auto& activeTextures = m_TextureSystem->GetActiveTextures();
-			//TODO: Get maxImageSlots from config as const
-			std::array<VkDescriptorImageInfo, 32> imageInfos;
-			for (uint32_t i = 0; i < activeTextures.size(); i++)
-			{
-				imageInfos[i] = std::dynamic_pointer_cast<VulkanImage2D>(activeTextures[i]->GetImage())->GetImageInfo();
-			}
-			VkWriteDescriptorSet setWrites{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			setWrites.dstBinding = 1;
-			setWrites.dstArrayElement = 0;
-			setWrites.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			setWrites.descriptorCount = imageInfos.size();
-			setWrites.pBufferInfo = 0;
-			setWrites.dstSet = GetCurrentFrame().TextureDescriptorSet;
-			setWrites.pImageInfo = imageInfos.data();
-
-
-			VkWriteDescriptorSet writes[2] = { samplerWrite, setWrites };
-
-			vkUpdateDescriptorSets(m_Device, 2, writes, 0, nullptr);
+			// Only textures registered since the last draw need their descriptors written, secondary buffers get them in ExecuteSecondaryCommandBuffers
+			if (!secondary)
+				UpdateTextureDescriptors();
 
 			vkCmdBindDescriptorSets(
-				m_ActiveCommandBuffer,
+				cmd,
 				VK_PIPELINE_BIND_POINT_GRAPHICS,
 				m_ActivePipeline->GetLayout(),
 				2,
 				1,
-				&GetCurrentFrame().TextureDescriptorSet,
+				&m_TextureDescriptorSet,
 				0,
 				nullptr
 			);
@@ -313,12 +370,33 @@ namespace Povox {
 		VkBuffer vertexBuffer = std::dynamic_pointer_cast<VulkanBuffer>(vertices)->GetAllocation().Buffer;
 		VkBuffer indexBuffer = std::dynamic_pointer_cast<VulkanBuffer>(indices)->GetAllocation().Buffer;
 		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(m_ActiveCommandBuffer, 0, 1, &vertexBuffer, offsets);
-		vkCmdBindIndexBuffer(m_ActiveCommandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, offsets);
+		vkCmdBindIndexBuffer(cmd, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+		vkCmdDrawIndexed(cmd, indexCount, 1, 0, vertexOffset, 0);
+
+		if (!secondary)
+			m_QueryManager->EndPipelineQuery("PipelineQueryPool", m_ActiveCommandBuffer, m_CurrentFrameIndex);
+	}
+
+	void VulkanRenderer::DrawInstanced(Ref<Material> material, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance, bool textureless)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		VkCommandBuffer cmd = GetRecordingCommandBuffer();
+		bool secondary = cmd != m_ActiveCommandBuffer;
+		if (!textureless)
+		{
+			if (!secondary)
+				UpdateTextureDescriptors();
+			vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetLayout(), 2, 1, &m_TextureDescriptorSet, 0, nullptr);
+		}
 
-		vkCmdDrawIndexed(m_ActiveCommandBuffer, indexCount, 1, 0, 0, 0);
+		vkCmdDraw(cmd, vertexCount, instanceCount, 0, firstInstance);
 
-		m_QueryManager->EndPipelineQuery("PipelineQueryPool", m_ActiveCommandBuffer, m_CurrentFrameIndex);
+		if (!secondary)
+			m_QueryManager->EndPipelineQuery("PipelineQueryPool", m_ActiveCommandBuffer, m_CurrentFrameIndex);
 	}
 
 	void VulkanRenderer::DrawRenderable(const Renderable& renderable)
@@ -351,44 +429,34 @@ namespace Povox {
 
 		vkCmdBindDescriptorSets(m_ActiveCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetLayout(), 0, 1, &GetCurrentFrame().GlobalDescriptorSet, 1, &camUniformOffset);
 				
-		/* Instead of using memcpy here, we are doing a different trick. It is possible to cast the void* from mapping the buffer into another type, and write into it normally.
-		* This will work completely fine, and makes it easier to write complex types into a buffer.
-		**/
-		//mapping of model data into the SSBO object buffer
-		uint32_t objectUniformOffset = PadUniformBuffer(sizeof(ObjectUniform), VulkanContext::GetDevice()->GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment) * (size_t)frameIndex;
-		
 		ObjectUniform objectUniform;
 		//objectUniform.ModelMatrix = renderable.ModelMatrix;
 		objectUniform.TexID = renderable.Material.TexID;
 		objectUniform.TilingFactor = renderable.Material.TilingFactor;
 
-		void* data;
-		vmaMapMemory(VulkanContext::GetAllocator(), GetCurrentFrame().ObjectBuffer.Allocation, &data);
-		memcpy(data, &objectUniform, sizeof(ObjectUniform));
-		vmaUnmapMemory(VulkanContext::GetAllocator(), GetCurrentFrame().ObjectBuffer.Allocation);
-		
-		vkCmdBindDescriptorSets(m_ActiveCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetLayout(), 1, 1, &GetCurrentFrame().ObjectDescriptorSet, 0, &objectUniformOffset);
+		// Shaders declaring an ObjectUniform push constant block get the object data through the command buffer, other blocks at offset 0 mean something else
+		VkShaderStageFlags pushConstantStages = m_ActivePipeline->GetPushConstantStages("ObjectUniform", 0, sizeof(ObjectUniform));
+		if (pushConstantStages != 0)
+		{
+			vkCmdPushConstants(m_ActiveCommandBuffer, m_ActivePipeline->GetLayout(), pushConstantStages, 0, sizeof(ObjectUniform), &objectUniform);
+		}
+		else
+		{
+			//mapping of model data into the SSBO object buffer
+			uint32_t objectUniformOffset = PadUniformBuffer(sizeof(ObjectUniform), VulkanContext::GetDevice()->GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment) * (size_t)frameIndex;
+
+			void* data;
+			vmaMapMemory(VulkanContext::GetAllocator(), GetCurrentFrame().ObjectBuffer.Allocation, &data);
+			memcpy(data, &objectUniform, sizeof(ObjectUniform));
+			vmaUnmapMemory(VulkanContext::GetAllocator(), GetCurrentFrame().ObjectBuffer.Allocation);
+
+			vkCmdBindDescriptorSets(m_ActiveCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetLayout(), 1, 1, &GetCurrentFrame().ObjectDescriptorSet, 0, &objectUniformOffset);
+		}
 
 		if (renderable.Material.Texture)
-		{		
-			auto& activeTextures = m_TextureSystem->GetActiveTextures(); 
-			//TODO: Get maxImageSlots form config as const
-			std::array<VkDescriptorImageInfo, 32> imageInfos;
-			for (uint32_t i = 0; i < activeTextures.size(); i++)
-			{
-				imageInfos[i] = std::dynamic_pointer_cast<VulkanImage2D>(activeTextures[i]->GetImage())->GetImageInfo(); 
-			}
-			VkWriteDescriptorSet setWrites{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
-			setWrites.dstBinding = 1;
-			setWrites.dstArrayElement = 0;
-			setWrites.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			setWrites.descriptorCount = imageInfos.size();
-			setWrites.pBufferInfo = 0;
-			setWrites.dstSet = GetCurrentFrame().TextureDescriptorSet;
-			setWrites.pImageInfo = imageInfos.data();
-
-			vkUpdateDescriptorSets(m_Device, 1, &setWrites, 0, nullptr);
-			vkCmdBindDescriptorSets(m_ActiveCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetLayout(), 2, 1, &GetCurrentFrame().TextureDescriptorSet, 0, nullptr);
+		{
+			UpdateTextureDescriptors();
+			vkCmdBindDescriptorSets(m_ActiveCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetLayout(), 2, 1, &m_TextureDescriptorSet, 0, nullptr);
 		}
 		
 		VkBuffer vertexBuffer = std::dynamic_pointer_cast<VulkanBuffer>(renderable.MeshData.VertexBuffer)->GetAllocation().Buffer;
@@ -432,19 +500,8 @@ namespace Povox {
 			{
 				PX_CORE_VK_ASSERT(vkCreateSemaphore(m_Device, &createSemaphoreInfo, nullptr, &m_Frames[i].Semaphores.RenderSemaphore), VK_SUCCESS, "Failed to create RenderSemaphore!");
 				PX_CORE_VK_ASSERT(vkCreateSemaphore(m_Device, &createSemaphoreInfo, nullptr, &m_Frames[i].Semaphores.PresentSemaphore), VK_SUCCESS, "Failed to create PresentSemaphore!");
-				
-				PX_CORE_VK_ASSERT(vkCreateSemaphore(m_Device, &createSemaphoreInfo, nullptr, &m_Frames[i].Semaphores.ComputeFinishedSemaphore), VK_SUCCESS, "Failed to create ComputeFinishedSemaphore!");
-			}
-			//Fences
-			VkFenceCreateInfo createFenceInfo{};
-			createFenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-			createFenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-			for (size_t i = 0; i < maxFrames; i++)
-			{
-				PX_CORE_VK_ASSERT(vkCreateFence(m_Device, &createFenceInfo, nullptr, &m_Frames[i].RenderFence), VK_SUCCESS, "Failed to create Render Fence!");
-
-				PX_CORE_VK_ASSERT(vkCreateFence(m_Device, &createFenceInfo, nullptr, &m_Frames[i].ComputeFence), VK_SUCCESS, "Failed to create Compute Fence!");
 			}
+			// No fences, the frames are waited on through the timelines created in InitTimelineSemaphores
 
 			PX_CORE_INFO("Completed Synchronization objects creation for {0} frames.", maxFrames);
 			PX_CORE_INFO("Creating Command objects for {0} frames...", maxFrames);
@@ -478,6 +535,23 @@ namespace Povox {
 				bufferci.commandPool = m_Frames[i].Commands.Pool;
 				PX_CORE_VK_ASSERT(vkAllocateCommandBuffers(m_Device, &bufferci, &m_Frames[i].Commands.RenderBuffer), VK_SUCCESS, "Failed to create Render CommandBuffer!");
 
+				// Secondary buffers are allocated on demand
+				m_Frames[i].Commands.SecondaryPools.resize(m_Specification.MaxRecordingThreads);
+				for (uint32_t thread = 0; thread < m_Specification.MaxRecordingThreads; thread++)
+				{
+					VkCommandPool& secondaryPool = m_Frames[i].Commands.SecondaryPools[thread].Pool;
+					PX_CORE_VK_ASSERT(vkCreateCommandPool(m_Device, &poolci, nullptr, &secondaryPool), VK_SUCCESS, "Failed to create secondary command pool!");
+
+#ifdef PX_DEBUG
+					VkDebugUtilsObjectNameInfoEXT secondaryNameInfo{};
+					secondaryNameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+					secondaryNameInfo.objectType = VK_OBJECT_TYPE_COMMAND_POOL;
+					secondaryNameInfo.objectHandle = (uint64_t)secondaryPool;
+					std::string secondaryDebugName = "FrameSecondaryPool_Frame" + std::to_string(i) + "_Thread" + std::to_string(thread);
+					secondaryNameInfo.pObjectName = secondaryDebugName.c_str();
+					NameVkObject(VulkanContext::GetDevice()->GetVulkanDevice(), secondaryNameInfo);
+#endif // DEBUG
+				}
 			}
 			poolci.queueFamilyIndex = VulkanContext::GetDevice()->GetQueueFamilies().ComputeFamilyIndex;
 			for (uint32_t i = 0; i < maxFrames; i++)
@@ -729,6 +803,87 @@ namespace Povox {
 		PX_CORE_VK_ASSERT(vkEndCommandBuffer(m_ActiveCommandBuffer), VK_SUCCESS, "Failed to record graphics command buffer!");
 		m_ActiveCommandBuffer = VK_NULL_HANDLE;
 	}
+
+	/**
+	 * Begins a secondary command buffer from the pool of threadIndex, which continues the active parallel render pass.
+	 * The pipeline and the render pass' descriptor sets are bound already. Following draws of the calling thread are recorded into it.
+	 * Different threads have to use different thread indices.
+	 */
+	const void* VulkanRenderer::BeginSecondaryCommandBuffer(uint32_t threadIndex)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_ASSERT(m_ActiveRenderPass && m_ParallelRenderPass, "Secondary command buffers have to be recorded inside a parallel render pass!");
+		PX_CORE_ASSERT(threadIndex < m_Specification.MaxRecordingThreads, "Thread index exceeds MaxRecordingThreads!");
+		PX_CORE_ASSERT(s_SecondaryCommandBuffer == VK_NULL_HANDLE, "This thread is already recording a secondary command buffer!");
+
+		auto& pool = GetCurrentFrame().Commands.SecondaryPools[threadIndex];
+		if (pool.NextBuffer == pool.Buffers.size())
+		{
+			VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			allocInfo.pNext = nullptr;
+			allocInfo.commandPool = pool.Pool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer buffer = VK_NULL_HANDLE;
+			PX_CORE_VK_ASSERT(vkAllocateCommandBuffers(m_Device, &allocInfo, &buffer), VK_SUCCESS, "Failed to allocate secondary command buffer!");
+			pool.Buffers.push_back(buffer);
+		}
+		VkCommandBuffer cmd = pool.Buffers[pool.NextBuffer++];
+
+		Ref<VulkanFramebuffer> fb = std::dynamic_pointer_cast<VulkanFramebuffer>(m_ActiveRenderPass->GetSpecification().TargetFramebuffer);
+
+		VkCommandBufferInheritanceInfo inheritance{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+		inheritance.pNext = nullptr;
+		inheritance.renderPass = m_ActiveRenderPass->GetRenderPass();
+		inheritance.subpass = 0;
+		inheritance.framebuffer = fb->GetFramebuffer();
+
+		VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.pNext = nullptr;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritance;
+		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(cmd, &beginInfo), VK_SUCCESS, "Failed to begin secondary command buffer!");
+
+		s_SecondaryCommandBuffer = cmd;
+
+		RecordPipelineBind(cmd, m_ActivePipeline);
+		BindRenderPassDescriptorSets(cmd);
+
+		return (const void*)cmd;
+	}
+	void VulkanRenderer::EndSecondaryCommandBuffer()
+	{
+		PX_CORE_ASSERT(s_SecondaryCommandBuffer != VK_NULL_HANDLE, "This thread is not recording a secondary command buffer!");
+
+		PX_CORE_VK_ASSERT(vkEndCommandBuffer(s_SecondaryCommandBuffer), VK_SUCCESS, "Failed to record secondary command buffer!");
+		s_SecondaryCommandBuffer = VK_NULL_HANDLE;
+	}
+	void VulkanRenderer::ExecuteSecondaryCommandBuffers(const std::vector<const void*>& commandBuffers)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		if (commandBuffers.empty())
+			return;
+
+		// Descriptor writes are not thread safe, textures bound while recording are written here. The set is update after bind
+		UpdateTextureDescriptors();
+
+		std::vector<VkCommandBuffer> secondaries;
+		secondaries.reserve(commandBuffers.size());
+		for (const void* cmd : commandBuffers)
+			secondaries.push_back((VkCommandBuffer)cmd);
+
+		vkCmdExecuteCommands(m_ActiveCommandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+	}
+
+	VkCommandBuffer VulkanRenderer::GetRecordingCommandBuffer() const
+	{
+		return s_SecondaryCommandBuffer != VK_NULL_HANDLE ? s_SecondaryCommandBuffer : m_ActiveCommandBuffer;
+	}
 	
 	void VulkanRenderer::InitCommandControl()
 	{
@@ -743,6 +898,13 @@ namespace Povox {
 		m_UploadContext = m_CommandControl->CreateUploadContext();
 		PX_CORE_ASSERT(m_UploadContext, "Failed to get UploadContext!");		
 
+		m_StagingRing = m_CommandControl->CreateStagingRing(m_Specification.MaxFramesInFlight, STAGING_RING_FRAME_SIZE);
+		PX_CORE_ASSERT(m_StagingRing, "Failed to create StagingRing!");
+		m_BarrierBatcher = m_CommandControl->CreateBarrierBatcher(m_Specification.MaxFramesInFlight);
+		PX_CORE_ASSERT(m_BarrierBatcher, "Failed to create BarrierBatcher!");
+		m_TransferScheduler = m_CommandControl->CreateTransferScheduler(m_Specification.MaxFramesInFlight, TRANSFER_STAGING_BLOCK_SIZE);
+		PX_CORE_ASSERT(m_TransferScheduler, "Failed to create TransferScheduler!");
+
 		PX_CORE_INFO("VulkanRenderer::InitCommandControl: Completed.");
 	}
 
@@ -751,7 +913,32 @@ namespace Povox {
 	{
 		PX_PROFILE_FUNCTION();
 		
+
+		RecordRenderPassBegin(renderPass, VK_SUBPASS_CONTENTS_INLINE);
+
+		// Bind pipeline. TODO: Behaviour if multiple pipelines are used during one renderpass (logic not supported yet)
+		BindPipeline(renderPass->GetSpecification().Pipeline);
+		BindRenderPassDescriptorSets(m_ActiveCommandBuffer);
+	}
+	/**
+	 * The render pass' contents have to come from secondary command buffers (BeginSecondaryCommandBuffer) now,
+	 * the primary buffer only takes ExecuteSecondaryCommandBuffers until EndRenderPass.
+	 */
+	void VulkanRenderer::BeginParallelRenderPass(Ref<RenderPass> renderPass)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		RecordRenderPassBegin(renderPass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		// Every secondary buffer binds the pipeline itself, nothing but vkCmdExecuteCommands may go into the primary one
+		m_ActivePipeline = std::dynamic_pointer_cast<VulkanPipeline>(renderPass->GetSpecification().Pipeline);
+		m_ParallelRenderPass = true;
+	}
+	void VulkanRenderer::RecordRenderPassBegin(Ref<RenderPass> renderPass, VkSubpassContents contents)
+	{
 		m_ActiveRenderPass = std::dynamic_pointer_cast<VulkanRenderPass>(renderPass);
+		m_ActiveRenderPass->WritePendingDescriptorSets(m_CurrentFrameIndex);
 		Ref<VulkanFramebuffer> fb = std::dynamic_pointer_cast<VulkanFramebuffer>(m_ActiveRenderPass->GetSpecification().TargetFramebuffer);
 
 
@@ -771,43 +958,52 @@ namespace Povox {
 		info.clearValueCount = static_cast<uint32_t>(clearColor.size());
 		info.pClearValues = clearColor.data();
 
-		vkCmdBeginRenderPass(m_ActiveCommandBuffer, &info, VK_SUBPASS_CONTENTS_INLINE);
-
-		// Bind pipeline. TODO: Behaviour if multiple pipelines are used during one renderpass (logic not supported yet)
-		BindPipeline(renderPass->GetSpecification().Pipeline);
-
+		// Ownership acquires have to be recorded outside of the render pass. Compute releases that were not recorded by a compute pass go out in one submit the frame waits on
+		m_BarrierBatcher->SubmitReleases(QueueFamilyOwnership::QFO_COMPUTE);
 
-		m_ActiveRenderPass->UpdateResourceOwnership(m_CurrentFrameIndex);
+		std::vector<VkSemaphore> ownershipSemaphores;
+		std::vector<uint64_t> ownershipValues;
+		m_BarrierBatcher->RecordAcquires(QueueFamilyOwnership::QFO_GRAPHICS, m_ActiveCommandBuffer, ownershipSemaphores, ownershipValues);
+		for (size_t i = 0; i < ownershipSemaphores.size(); i++)
+		{
+			// Acquires are chained to the wait through ALL_COMMANDS, fragment and compute consumers are covered as well
+			m_SwapchainFrame->WaitSemaphores.push_back(ownershipSemaphores[i]);
+			m_SwapchainFrame->WaitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			m_SwapchainFrame->WaitValues.push_back(ownershipValues[i]);
+		}
 
-		auto& descriptors = m_ActiveRenderPass->GetDescriptorSets();
-		auto& dynamicOffsets = m_ActiveRenderPass->GetDynamicOffsets(m_CurrentFrameIndex);
+		vkCmdBeginRenderPass(m_ActiveCommandBuffer, &info, contents);
 
-		std::vector<VkDescriptorSet> descriptorSets;
-		for (auto& [number, set] : descriptors)
+		// Collected once, so secondary buffers recorded on other threads only read them
+		m_RenderPassDescriptorSets.clear();
+		for (auto& [number, set] : m_ActiveRenderPass->GetDescriptorSets())
 		{
 			// Now bind global descriptor sets (all sets 0-2)
 			if (number < 3)
 			{
-				descriptorSets.push_back(set.Sets[m_CurrentFrameIndex % (set.Sets.size())]);
+				m_RenderPassDescriptorSets.push_back(set.Sets[m_CurrentFrameIndex % (set.Sets.size())]);
 			}
 		}
-
+		m_RenderPassDynamicOffsets = m_ActiveRenderPass->GetDynamicOffsets(m_CurrentFrameIndex);
+	}
+	void VulkanRenderer::BindRenderPassDescriptorSets(VkCommandBuffer cmd)
+	{
 		// TODO: catch dynamic descriptor sets and there offset
 		vkCmdBindDescriptorSets(
-			m_ActiveCommandBuffer, 
+			cmd, 
 			VK_PIPELINE_BIND_POINT_GRAPHICS, 
 			m_ActivePipeline->GetLayout(), 
 			0,
-			static_cast<uint32_t>(descriptorSets.size()), 
-			descriptorSets.data(), 
-			static_cast<uint32_t>(dynamicOffsets.size()),
-			dynamicOffsets.data());
-
+			static_cast<uint32_t>(m_RenderPassDescriptorSets.size()), 
+			m_RenderPassDescriptorSets.data(), 
+			static_cast<uint32_t>(m_RenderPassDynamicOffsets.size()),
+			m_RenderPassDynamicOffsets.data());
 	}
 	void VulkanRenderer::EndRenderPass()
 	{
 		vkCmdEndRenderPass(m_ActiveCommandBuffer);
 		m_ActiveRenderPass = nullptr;
+		m_ParallelRenderPass = false;
 	}
 
 	// Pipeline
@@ -817,7 +1013,25 @@ namespace Povox {
 
 
 		m_ActivePipeline = std::dynamic_pointer_cast<VulkanPipeline>(pipeline);
-		
+
+		m_QueryManager->BeginPipelineQuery("PipelineQueryPool", m_ActiveCommandBuffer, m_CurrentFrameIndex);
+		RecordPipelineBind(m_ActiveCommandBuffer, m_ActivePipeline);
+	}
+
+	void VulkanRenderer::PushConstants(Ref<Pipeline> pipeline, const void* data, uint32_t size, uint32_t offset)
+	{
+		Ref<VulkanPipeline> vkPipeline = std::dynamic_pointer_cast<VulkanPipeline>(pipeline);
+		VkShaderStageFlags stages = vkPipeline->GetPushConstantStages(offset, size);
+		if (stages == 0)
+		{
+			PX_CORE_WARN("VulkanRenderer::PushConstants: Pipeline {0} has no push constant block containing [{1}, {2})!", vkPipeline->GetDebugName(), offset, offset + size);
+			return;
+		}
+
+		vkCmdPushConstants(GetRecordingCommandBuffer(), vkPipeline->GetLayout(), stages, offset, size, data);
+	}
+	void VulkanRenderer::RecordPipelineBind(VkCommandBuffer cmd, Ref<VulkanPipeline> pipeline)
+	{
 		if (pipeline->GetSpecification().DynamicViewAndScissors)
 		{
 			uint32_t width = m_ViewportWidth;
@@ -829,16 +1043,15 @@ namespace Povox {
 			viewport.height = -static_cast<float>(height);
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
-			vkCmdSetViewport(m_ActiveCommandBuffer, 0, 1, &viewport);
+			vkCmdSetViewport(cmd, 0, 1, &viewport);
 
 			VkRect2D scissor{};
 			scissor.offset = { 0, 0 };
 			scissor.extent = { width, height };
-			vkCmdSetScissor(m_ActiveCommandBuffer, 0, 1, &scissor);
+			vkCmdSetScissor(cmd, 0, 1, &scissor);
 		}
 
-		m_QueryManager->BeginPipelineQuery("PipelineQueryPool", m_ActiveCommandBuffer, m_CurrentFrameIndex);
-		vkCmdBindPipeline(m_ActiveCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ActivePipeline->GetVulkanObj());
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->GetVulkanObj());
 	}
 
 	// Compute
@@ -848,6 +1061,7 @@ namespace Povox {
 
 		Ref<VulkanComputePass> vkComputePass = std::static_pointer_cast<VulkanComputePass>(computePass);
 		m_ActiveComputePass = vkComputePass;
+		m_ActiveComputePass->WritePendingDescriptorSets(m_CurrentFrameIndex);
 
 		VkCommandBuffer computeCmd = GetCurrentFrame().Commands.ComputeBuffer;
 
@@ -879,7 +1093,17 @@ namespace Povox {
 		uint32_t computeFamIndex = VulkanContext::GetDevice()->GetQueueFamilies().ComputeFamilyIndex;
 		uint32_t graphicsFamIndex = VulkanContext::GetDevice()->GetQueueFamilies().GraphicsFamilyIndex;
 		
-		vkComputePass->UpdateResourceOwnership(m_CurrentFrameIndex);
+		// Graphics releases go out in one submit, the acquires are the first thing in this command buffer
+		m_BarrierBatcher->SubmitReleases(QueueFamilyOwnership::QFO_GRAPHICS);
+
+		std::vector<VkSemaphore> waitSemaphores;
+		std::vector<uint64_t> waitValues;
+		m_BarrierBatcher->RecordAcquires(QueueFamilyOwnership::QFO_COMPUTE, computeCmd, waitSemaphores, waitValues);
+
+		// Graphics passes later in the frame wait on this value where they read what this dispatch writes
+		uint64_t signalValue = ++m_ComputeFinishedValue;
+		m_BarrierBatcher->SetQueueTimelineValue(QueueFamilyOwnership::QFO_COMPUTE, signalValue);
+		GetCurrentFrame().ComputeFinishedValue = signalValue;
 		
 		if (passSpecs.DoPerformanceQuery)
 			m_QueryManager->BeginPipelineQuery(passSpecs.DebugName, computeCmd, m_CurrentFrameIndex);
@@ -913,24 +1137,58 @@ namespace Povox {
 			m_QueryManager->RecordTimestamp(passSpecs.DebugName, m_CurrentFrameIndex, computeCmd);
 		}
 
+		// Releases to later passes of the frame (queued by the RenderGraph) end this buffer instead of getting their own submit
+		std::vector<VkSemaphore> signalSemaphores;
+		m_BarrierBatcher->RecordReleases(QueueFamilyOwnership::QFO_COMPUTE, computeCmd, signalSemaphores);
+		std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+		signalSemaphores.push_back(m_ComputeFinishedSemaphore);
+		signalValues.push_back(signalValue);
+
 		PX_CORE_VK_ASSERT(vkEndCommandBuffer(computeCmd), VK_SUCCESS, "Failed to end ComputeCommandbuffer!");
 
+		// Compute is submitted before the frame's graphics commands, so uploads it depends on have to go out first
+		VkSemaphore uploadSemaphore = m_StagingRing->Flush();
+		if (uploadSemaphore != VK_NULL_HANDLE)
+		{
+			waitSemaphores.push_back(uploadSemaphore);
+			waitValues.push_back(0);
+		}
+		// Same stage as the src scope of the acquire barriers, so they are chained to the waits
+		std::vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+		timelineInfo.pNext = nullptr;
+		timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
 		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-		submitInfo.pNext = nullptr;
+		submitInfo.pNext = &timelineInfo;
 
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &computeCmd;
-		submitInfo.signalSemaphoreCount = 0;
-		submitInfo.pSignalSemaphores = nullptr;
-		submitInfo.waitSemaphoreCount = 0;
-		submitInfo.pWaitSemaphores = nullptr;
-		submitInfo.pWaitDstStageMask = {};
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+		submitInfo.pWaitSemaphores = waitSemaphores.data();
+		submitInfo.pWaitDstStageMask = waitStages.data();
 
 
-		PX_CORE_VK_ASSERT(vkQueueSubmit(VulkanContext::GetDevice()->GetQueueFamilies().Queues.ComputeQueue, 1, &submitInfo, GetCurrentFrame().ComputeFence), VK_SUCCESS, "Failed to submit compute pass");	
+		PX_CORE_VK_ASSERT(vkQueueSubmit(VulkanContext::GetDevice()->GetQueueFamilies().Queues.ComputeQueue, 1, &submitInfo, VK_NULL_HANDLE), VK_SUCCESS, "Failed to submit compute pass");	
 		
 	}
 
+	// Uploads
+	bool VulkanRenderer::IsUploadComplete(UploadHandle handle) const
+	{
+		return m_TransferScheduler->IsComplete(handle);
+	}
+	void VulkanRenderer::WaitForUpload(UploadHandle handle)
+	{
+		m_TransferScheduler->Wait(handle);
+	}
+
 	// GUI
 	void VulkanRenderer::BeginGUIRenderPass()
 	{
@@ -1101,9 +1359,9 @@ namespace Povox {
 
 		PX_CORE_INFO("Completed Particle DescriptorLayouts creation. ");
 
-		PX_CORE_INFO("Creating TextureArray DescriptorLayouts... ");
+		PX_CORE_INFO("Creating bindless TextureArray DescriptorLayouts... ");
 
-		//TextureDescriptorLayoutCreation
+		// One set for all frames: descriptors are written once when their texture gets registered and never touched again while in use
 		VkDescriptorSetLayoutBinding samplerBinding{};
 		VkDescriptorSetLayoutBinding textureArrayBinding{};
 		{
@@ -1116,55 +1374,121 @@ namespace Povox {
 
 			textureArrayBinding.binding = 1;
 			textureArrayBinding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			textureArrayBinding.descriptorCount = m_TextureSystem->GetConfig().MaxTextureSlots;
+			textureArrayBinding.descriptorCount = m_TextureSystem->GetConfig().MaxTextures;
 			textureArrayBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 			textureArrayBinding.pImmutableSamplers = nullptr;
 
 			std::vector<VkDescriptorSetLayoutBinding> textureBindings = { samplerBinding, textureArrayBinding };
 
+			std::array<VkDescriptorBindingFlags, 2> bindingFlags = {
+				0,
+				VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+			};
+			VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+			bindingFlagsInfo.pNext = nullptr;
+			bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+			bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
 			VkDescriptorSetLayoutCreateInfo textureInfo{};
 			textureInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-			textureInfo.pNext = nullptr;
+			textureInfo.pNext = &bindingFlagsInfo;
 
-			textureInfo.flags = 0;
+			textureInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
 			textureInfo.bindingCount = static_cast<uint32_t>(textureBindings.size());
 			textureInfo.pBindings = textureBindings.data();
 
-			m_TextureDescriptorSetLayout = VulkanContext::GetDescriptorLayoutCache()->CreateDescriptorLayout(&textureInfo, "Textures");
+			// Shaders declaring a runtime texture array pick this layout up by name during reflection
+			m_TextureDescriptorSetLayout = VulkanContext::GetDescriptorLayoutCache()->CreateDescriptorLayout(&textureInfo, "BindlessTextures");
 		}
 
-		auto& activeTextures = m_TextureSystem->GetActiveTextures();
-		//TODO: Get maxImageSlots from config as const
-		std::vector<VkDescriptorImageInfo> imageInfos;	
-		imageInfos.resize(m_TextureSystem->GetConfig().MaxTextureSlots);
-		for (uint32_t i = 0; i < imageInfos.size(); i++)
+		// Update after bind sets can only be allocated from pools created with the matching flag
 		{
-			Ref<Image2D> image = activeTextures[i]->GetImage();
-			//TODO: Define BindImages for arrays of image infos!
-			Ref<VulkanImage2D> vkimage = std::dynamic_pointer_cast<VulkanImage2D>(activeTextures[i]->GetImage());
-			imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfos[i].imageView = vkimage->GetImageView();
-			imageInfos[i].sampler = nullptr;
+			std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+				{ VK_DESCRIPTOR_TYPE_SAMPLER, 1 },
+				{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_TextureSystem->GetConfig().MaxTextures }
+			} };
+
+			VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+			poolInfo.pNext = nullptr;
+			poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+			poolInfo.maxSets = 1;
+			poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+			poolInfo.pPoolSizes = poolSizes.data();
+			PX_CORE_VK_ASSERT(vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_BindlessDescriptorPool), VK_SUCCESS, "Failed to create bindless DescriptorPool!");
+
+			VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+			allocInfo.pNext = nullptr;
+			allocInfo.descriptorPool = m_BindlessDescriptorPool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &m_TextureDescriptorSetLayout;
+			PX_CORE_VK_ASSERT(vkAllocateDescriptorSets(m_Device, &allocInfo, &m_TextureDescriptorSet), VK_SUCCESS, "Failed to allocate bindless TextureDescriptorSet!");
+
+#ifdef PX_DEBUG
+			VkDebugUtilsObjectNameInfoEXT nameInfo{};
+			nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+			nameInfo.objectType = VK_OBJECT_TYPE_DESCRIPTOR_SET;
+			nameInfo.objectHandle = (uint64_t)m_TextureDescriptorSet;
+			nameInfo.pObjectName = "BindlessTextureDS";
+			NameVkObject(m_Device, nameInfo);
+#endif // DEBUG
 		}
 
-		for (uint32_t i = 0; i < m_Specification.MaxFramesInFlight; i++)
-		{	
-			VulkanDescriptorBuilder builder = VulkanDescriptorBuilder::Begin(VulkanContext::GetDescriptorLayoutCache(), VulkanContext::GetDescriptorAllocator());
+		VkDescriptorImageInfo samplerInfo{};
+		samplerInfo.sampler = m_TextureSampler;
 
-			VkDescriptorImageInfo samplerInfo{};
-			samplerInfo.sampler = m_TextureSampler;
+		VkWriteDescriptorSet samplerWrite{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		samplerWrite.pNext = nullptr;
+		samplerWrite.dstSet = m_TextureDescriptorSet;
+		samplerWrite.dstBinding = 0;
+		samplerWrite.dstArrayElement = 0;
+		samplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		samplerWrite.descriptorCount = 1;
+		samplerWrite.pImageInfo = &samplerInfo;
+		vkUpdateDescriptorSets(m_Device, 1, &samplerWrite, 0, nullptr);
 
-			builder.BindImage(samplerBinding, &samplerInfo);
-			builder.BindImage(textureArrayBinding, imageInfos.data());
+		// Textures registered before the set existed
+		UpdateTextureDescriptors();
 
-			builder.Build(m_Frames[i].TextureDescriptorSet, m_TextureDescriptorSetLayout, "TextureArrayDS");
-		}
 
+		PX_CORE_INFO("Completed bindless TextureArray DescriptorLayouts creation. ");
+		PX_CORE_INFO("VulkanRenderer::CreateDescriptors: Completed.");
+	}
 
+	void VulkanRenderer::UpdateTextureDescriptors()
+	{
+		if (!m_TextureSystem->HasPendingWrites())
+			return;
 
+		PX_PROFILE_FUNCTION();
 
-		PX_CORE_INFO("Completed textureArray DescriptorLayouts creation. ");
-		PX_CORE_INFO("VulkanRenderer::CreateDescriptors: Completed.");
+
+		std::vector<uint32_t> pending = m_TextureSystem->ConsumePendingWrites();
+
+		std::vector<VkDescriptorImageInfo> imageInfos(pending.size());
+		std::vector<VkWriteDescriptorSet> writes;
+		writes.reserve(pending.size());
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			// Slots unregistered before their first draw are simply left unwritten
+			const Ref<Texture>& texture = m_TextureSystem->GetSlotTexture(pending[i]);
+			if (!texture)
+				continue;
+
+			Ref<VulkanImage2D> vkImage = std::dynamic_pointer_cast<VulkanImage2D>(texture->GetImage());
+			imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			imageInfos[i].imageView = vkImage->GetImageView();
+			imageInfos[i].sampler = VK_NULL_HANDLE;
+
+			VkWriteDescriptorSet& write = writes.emplace_back(VkWriteDescriptorSet{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET });
+			write.pNext = nullptr;
+			write.dstSet = m_TextureDescriptorSet;
+			write.dstBinding = 1;
+			write.dstArrayElement = pending[i];
+			write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			write.descriptorCount = 1;
+			write.pImageInfo = &imageInfos[i];
+		}
+		vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 	}
 
 	void* VulkanRenderer::GetGUIDescriptorSet(Ref<Image2D> image) const
@@ -1238,21 +1562,40 @@ namespace Povox {
 	}
 			
 
-	void VulkanRenderer::ComputeSubmit()
+	void VulkanRenderer::InitTimelineSemaphores()
 	{
 		PX_PROFILE_FUNCTION();
 
 
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		VkSemaphoreTypeCreateInfo typeInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		typeInfo.pNext = nullptr;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
 
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &GetCurrentFrame().Commands.ComputeBuffer;
+		VkSemaphoreCreateInfo semaInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		semaInfo.pNext = &typeInfo;
+		semaInfo.flags = 0;
+		PX_CORE_VK_ASSERT(vkCreateSemaphore(m_Device, &semaInfo, nullptr, &m_ComputeFinishedSemaphore), VK_SUCCESS, "Failed to create ComputeFinishedSemaphore!");
+		PX_CORE_VK_ASSERT(vkCreateSemaphore(m_Device, &semaInfo, nullptr, &m_RenderFinishedSemaphore), VK_SUCCESS, "Failed to create RenderFinishedSemaphore!");
+		m_ComputeFinishedValue = 0;
+		m_CurrentFrameNumber = 0;
+		m_CompletedFrameNumber = 0;
 
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &GetCurrentFrame().Semaphores.ComputeFinishedSemaphore;
+#ifdef PX_DEBUG
+		VkDebugUtilsObjectNameInfoEXT nameInfo{};
+		nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+		nameInfo.objectType = VK_OBJECT_TYPE_SEMAPHORE;
+		nameInfo.objectHandle = (uint64_t)m_ComputeFinishedSemaphore;
+		nameInfo.pObjectName = "ComputeFinishedTimeline";
+		NameVkObject(m_Device, nameInfo);
+
+		nameInfo.objectHandle = (uint64_t)m_RenderFinishedSemaphore;
+		nameInfo.pObjectName = "RenderFinishedTimeline";
+		NameVkObject(m_Device, nameInfo);
+#endif // DEBUG
 
-		PX_CORE_VK_ASSERT(vkQueueSubmit(VulkanContext::GetDevice()->GetQueueFamilies().Queues.ComputeQueue, 1, &submitInfo, GetCurrentFrame().ComputeFence), VK_SUCCESS, "Failed to submit compute commands!");
+		m_BarrierBatcher->SetQueueTimeline(QueueFamilyOwnership::QFO_COMPUTE, m_ComputeFinishedSemaphore);
+		m_BarrierBatcher->SetQueueTimeline(QueueFamilyOwnership::QFO_GRAPHICS, m_RenderFinishedSemaphore);
 	}
 
 	// Debugging and Performance
@@ -1,4 +1,5 @@
 #pragma once
+#include "Platform/Vulkan/VulkanBufferPool.h"
 #include "Platform/Vulkan/VulkanCommands.h"
 
 #include "Platform/Vulkan/VulkanImGui.h"
@@ -22,6 +23,8 @@
 
 #include "Povox/Systems/TextureSystem.h"
 
+#include <deque>
+
 
 
 
@@ -33,12 +36,12 @@ namespace Povox {
 		{
 			VkSemaphore RenderSemaphore;
 			VkSemaphore PresentSemaphore;
-
-			VkSemaphore ComputeFinishedSemaphore;
 		};
 		FrameSemaphores Semaphores;
-		VkFence RenderFence;
-		VkFence ComputeFence;
+		// Number of the frame that used this slot last, the graphics timeline reaches it once the frame's graphics submit finished
+		uint64_t FrameNumber = 0;
+		// Value of the compute timeline the frame's last dispatch signals, its ComputePool can be reset once that is reached
+		uint64_t ComputeFinishedValue = 0;
 
 		struct FrameCommandBuffer
 		{
@@ -47,9 +50,21 @@ namespace Povox {
 
 			VkCommandPool ComputePool;
 			VkCommandBuffer ComputeBuffer;
+
+			// One pool per recording thread, buffers are reused after the pool reset of the frame
+			struct SecondaryPool
+			{
+				VkCommandPool Pool = VK_NULL_HANDLE;
+				std::vector<VkCommandBuffer> Buffers;
+				uint32_t NextBuffer = 0;
+			};
+			std::vector<SecondaryPool> SecondaryPools;
 		};
 		FrameCommandBuffer Commands;
 
+		// The slot's query pools hold results of FrameNumber, read back once it completed
+		bool QueryResultsPending = false;
+
 		AllocatedBuffer CamUniformBuffer;
 		VkDescriptorSet GlobalDescriptorSet;
 
@@ -58,8 +73,6 @@ namespace Povox {
 
 		AllocatedBuffer ParticleBuffer;
 		VkDescriptorSet ParticleDescriptorSet;
-
-		VkDescriptorSet TextureDescriptorSet;
 	};
 
 	class VulkanQueryManager;
@@ -77,11 +90,14 @@ namespace Povox {
 
 		// FrameData
 		virtual bool BeginFrame() override;
-		virtual void Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless) override;
+		virtual void Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless, int32_t vertexOffset) override;
+		virtual void DrawInstanced(Ref<Material> material, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance, bool textureless) override;
 		virtual void DrawRenderable(const Renderable& renderable) override;
 		virtual void EndFrame() override;
 		virtual inline uint32_t GetCurrentFrameIndex() const override { return m_CurrentFrameIndex; }		
 		virtual inline uint32_t GetLastFrameIndex() const override { return m_LastFrameIndex; }		
+		virtual inline uint64_t GetCurrentFrameNumber() const override { return m_CurrentFrameNumber; }
+		virtual inline uint64_t GetCompletedFrameNumber() const override { return m_CompletedFrameNumber; }
 
 		virtual void PrepareSwapchainImage(Ref<Image2D> finalImage) override;
 		virtual void CreateFinalImage(Ref<Image2D> finalImage) override;
@@ -96,17 +112,26 @@ namespace Povox {
 		virtual void BeginCommandBuffer(const void* cmd) override;
 		virtual void EndCommandBuffer() override;
 		virtual inline const void* GetCommandBuffer(uint32_t index) override { return (const void*)GetFrame(index).Commands.RenderBuffer; }
+		virtual const void* BeginSecondaryCommandBuffer(uint32_t threadIndex) override;
+		virtual void EndSecondaryCommandBuffer() override;
+		virtual void ExecuteSecondaryCommandBuffers(const std::vector<const void*>& commandBuffers) override;
 		
 		//Renderpass
 		virtual void BeginRenderPass(Ref<RenderPass> renderPass) override;
+		virtual void BeginParallelRenderPass(Ref<RenderPass> renderPass) override;
 		virtual void EndRenderPass() override;
 
 		// Pipeline
 		virtual void BindPipeline(Ref<Pipeline> pipeline) override;
+		virtual void PushConstants(Ref<Pipeline> pipeline, const void* data, uint32_t size, uint32_t offset) override;
 
 		// Compute
 		virtual void DispatchCompute(Ref<ComputePass> computePass) override;
 
+		// Uploads
+		virtual bool IsUploadComplete(UploadHandle handle) const override;
+		virtual void WaitForUpload(UploadHandle handle) override;
+
 		// GUI
 		virtual void BeginGUIRenderPass() override;
 		virtual void DrawGUI() override;
@@ -131,6 +156,7 @@ namespace Povox {
 		virtual inline Ref<TextureSystem> GetTextureSystem() const override { return m_TextureSystem; }
 		virtual inline Ref<MaterialSystem> GetMaterialSystem() const override { return m_MaterialSystem; }
 		virtual inline Ref<ShaderResourceSystem> GetShaderResourceSystem() const override { return m_ShaderResourceSystem; }
+		virtual inline Ref<BufferPool> GetBufferPool() const override { return m_BufferPool; }
 		virtual inline Ref<Image2D> GetFinalImage(uint32_t frameIndex) const override;
 
 		virtual inline const RendererStatistics& GetStatistics() const override { return m_Statistics; }
@@ -144,6 +170,15 @@ namespace Povox {
 		FrameData& GetFrame(uint32_t index);
 		bool PrepareRenderFrame();
 		bool PrepareComputeFrame();
+		// Polls both timelines and advances m_CompletedFrameNumber past every frame whose graphics and compute work finished
+		void UpdateCompletedFrame();
+
+		// Commands
+		// The secondary command buffer the calling thread is recording, the active primary one otherwise
+		VkCommandBuffer GetRecordingCommandBuffer() const;
+		void RecordRenderPassBegin(Ref<RenderPass> renderPass, VkSubpassContents contents);
+		void BindRenderPassDescriptorSets(VkCommandBuffer cmd);
+		void RecordPipelineBind(VkCommandBuffer cmd, Ref<VulkanPipeline> pipeline);
 
 		// Resources
 		void InitCommandControl();
@@ -153,11 +188,12 @@ namespace Povox {
 		// Descriptors -> move to descriptor system
 		void CreateDescriptors();
 		void CreateSamplers();
+		void UpdateTextureDescriptors();
 		size_t PadUniformBuffer(size_t inputSize, size_t minGPUBufferOffsetAlignment);
 		// TEMP_END
 
 		// Compute
-		void ComputeSubmit();
+		void InitTimelineSemaphores();
 
 		// Debugging and Performance
 		void InitPerformanceQueryPools();
@@ -171,6 +207,9 @@ namespace Povox {
 		VkCommandBuffer m_ActiveCommandBuffer = VK_NULL_HANDLE;
 		Ref<VulkanRenderPass> m_ActiveRenderPass = nullptr;
 		Ref<VulkanPipeline> m_ActivePipeline = nullptr;
+		bool m_ParallelRenderPass = false;
+		std::vector<VkDescriptorSet> m_RenderPassDescriptorSets;
+		std::vector<uint32_t> m_RenderPassDynamicOffsets;
 		
 		Ref<VulkanComputePass> m_ActiveComputePass = nullptr;
 
@@ -185,11 +224,25 @@ namespace Povox {
 		uint32_t m_CurrentFrameIndex = 0;
 		uint32_t m_LastFrameIndex = 0;
 		uint32_t m_CurrentSwapchainImageIndex = 0;
+
+		// Signaled by every compute submit and every frame's graphics submit, the graphics timeline counts frame numbers.
+		// The CPU waits on them instead of fences, and the compute work of a frame can overlap its graphics work, see VulkanBarrierBatcher::AddBufferQueueDependency
+		VkSemaphore m_ComputeFinishedSemaphore = VK_NULL_HANDLE;
+		uint64_t m_ComputeFinishedValue = 0;
+		VkSemaphore m_RenderFinishedSemaphore = VK_NULL_HANDLE;
+		uint64_t m_CurrentFrameNumber = 0;
+		uint64_t m_CompletedFrameNumber = 0;
+		// Submitted frames that have not completed yet, their number and the compute value they end at
+		std::deque<std::pair<uint64_t, uint64_t>> m_PendingFrames;
 				
 
 		// Resources
 		Scope<VulkanCommandControl> m_CommandControl = nullptr;
 		Ref<UploadContext> m_UploadContext = nullptr;
+		Ref<VulkanStagingRing> m_StagingRing = nullptr;
+		Ref<VulkanBarrierBatcher> m_BarrierBatcher = nullptr;
+		Ref<VulkanTransferScheduler> m_TransferScheduler = nullptr;
+		Ref<VulkanBufferPool> m_BufferPool = nullptr;
 
 		Ref<ShaderManager> m_ShaderManager = nullptr;
 		Ref<TextureSystem> m_TextureSystem = nullptr;
@@ -208,6 +261,8 @@ namespace Povox {
 		VkDescriptorSetLayout m_GlobalDescriptorSetLayout = VK_NULL_HANDLE;
 		VkDescriptorSetLayout m_ObjectDescriptorSetLayout = VK_NULL_HANDLE;
 		VkDescriptorSetLayout m_TextureDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool m_BindlessDescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet m_TextureDescriptorSet = VK_NULL_HANDLE;
 
 		VkDescriptorSetLayout m_ParticleDescriptorSetLayout = VK_NULL_HANDLE;
 
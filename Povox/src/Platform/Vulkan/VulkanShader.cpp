@@ -4,15 +4,20 @@
 #include "Platform/Vulkan/VulkanContext.h"
 #include "Platform/Vulkan/VulkanDebug.h"
 #include "Platform/Vulkan/VulkanPipeline.h"
+#include "Platform/Vulkan/VulkanShaderCache.h"
 
+#include "Povox/Core/Application.h"
 #include "Povox/Core/Time.h"
+#include "Povox/Renderer/Renderer.h"
 #include "Povox/Utils/FileUtility.h"
 #include "Povox/Utils/ShaderResource.h"
 
 #include <cstdint>
 #include <fstream>
+#include <sstream>
 
 #include <shaderc/shaderc.hpp>
+#include <spirv-tools/optimizer.hpp>
 #include <spirv_cross/spirv_cross.hpp>
 #include <spirv_cross/spirv_common.hpp>
 #include <spirv_reflect.h>
@@ -48,6 +53,60 @@ namespace Povox {
 			return "";
 		}
 
+		static uint32_t CountSPIRVInstructions(const std::vector<uint32_t>& binary)
+		{
+			// 5 word header, every instruction starts with its word count in the upper 16 bits
+			uint32_t count = 0;
+			for (size_t word = 5; word < binary.size(); word += std::max<uint32_t>(binary[word] >> 16, 1))
+				count++;
+			return count;
+		}
+
+		static bool RunSPIRVOptimizer(const std::vector<uint32_t>& binary, const std::vector<std::string>& flags, const std::string& debugName, std::vector<uint32_t>& outBinary)
+		{
+			spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_3);
+			optimizer.SetMessageConsumer([&debugName](spv_message_level_t level, const char*, const spv_position_t& position, const char* message)
+				{
+					if (level <= SPV_MSG_ERROR)
+						PX_CORE_ERROR("spirv-opt: {0} (word {1}): {2}", debugName, position.index, message);
+				});
+			if (!optimizer.RegisterPassesFromFlags(flags))
+			{
+				PX_CORE_ERROR("VulkanShader: {0} has an invalid spirv-opt pass list!", debugName);
+				return false;
+			}
+			return optimizer.Run(binary.data(), binary.size(), &outBinary);
+		}
+
+		static std::vector<std::string> GetOptimizerFlags(const ShaderOptimizationSettings& settings)
+		{
+			std::vector<std::string> flags;
+			switch (settings.Level)
+			{
+				case ShaderOptimizationLevel::Size: flags.push_back("-Os"); break;
+				case ShaderOptimizationLevel::Performance: flags.push_back("-O"); break;
+				default: break;
+			}
+			flags.insert(flags.end(), settings.Passes.begin(), settings.Passes.end());
+			return flags;
+		}
+
+		// Everything CompileOrGetStageBinary sets on the compile options apart from the defines
+		static std::string GetOptionsFingerprint(const ShaderOptimizationSettings& settings)
+		{
+			std::stringstream fingerprint;
+			fingerprint << "env:" << shaderc_target_env_vulkan << "/" << shaderc_env_version_vulkan_1_3 << ";spirv:" << shaderc_spirv_version_1_6 << ";";
+			for (const auto& flag : GetOptimizerFlags(settings))
+				fingerprint << "opt:" << flag << ";";
+			return fingerprint.str();
+		}
+
+		// Build configurations compile with different options, each keeps its own entries in the shared cache directory
+		static std::string GetCacheEntryName(const std::string& debugName, const ShaderOptimizationSettings& settings)
+		{
+			return debugName + "_" + VulkanShaderCache::GetOptionsKey(GetOptionsFingerprint(settings));
+		}
+
 		static shaderc_shader_kind VKShaderStageToShaderC(VkShaderStageFlagBits stage)
 		{
 			switch (stage)
@@ -128,6 +187,21 @@ namespace Povox {
 
 	namespace SpirvUtils {
 
+		// Destroys a reflection module on every path out of the scope it was created in
+		class ReflectModuleGuard
+		{
+		public:
+			ReflectModuleGuard(SpvReflectShaderModule& module)
+				: m_Module(module) {}
+			~ReflectModuleGuard() { spvReflectDestroyShaderModule(&m_Module); }
+
+			ReflectModuleGuard(const ReflectModuleGuard&) = delete;
+			ReflectModuleGuard& operator=(const ReflectModuleGuard&) = delete;
+
+		private:
+			SpvReflectShaderModule& m_Module;
+		};
+
 		static std::string ReflectErrorToString(SpvReflectResult result)
 		{
 			switch (result)
@@ -267,6 +341,18 @@ namespace Povox {
 			}
 		}
 
+		static ShaderDataType SpirvTypeToShaderDataType(spirv_cross::SPIRType::BaseType type)
+		{
+			switch (type)
+			{
+				case spirv_cross::SPIRType::Boolean: return ShaderDataType::Bool;
+				case spirv_cross::SPIRType::Int: return ShaderDataType::Int;
+				case spirv_cross::SPIRType::UInt: return ShaderDataType::UInt;
+				case spirv_cross::SPIRType::Float: return ShaderDataType::Float;
+			}
+			return ShaderDataType::None;
+		}
+
 		VkDescriptorType IsDynamic(VkDescriptorType type, uint32_t set)
 		{
 			if (set != 1)
@@ -292,6 +378,8 @@ namespace Povox {
 		PX_PROFILE_FUNCTION();
 
 
+		Utils::Shader::CreateVKCacheDirectoryIfNeeded();
+
 		auto shaderSourceCodeMap = PreProcess(sources);
 		{
 			Timer timer;
@@ -301,14 +389,7 @@ namespace Povox {
 			PX_CORE_WARN("Shader compilation+reflection took {0}ms", timer.ElapsedMilliseconds());
 		}
 
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		for (auto& [stage, data] : m_SourceCodes)
-		{
-			createInfo.codeSize = data.size() * sizeof(uint32_t);
-			createInfo.pCode = data.data();
-			PX_CORE_VK_ASSERT(vkCreateShaderModule(VulkanContext::GetDevice()->GetVulkanDevice(), &createInfo, nullptr, &m_Modules[stage]), VK_SUCCESS, "Failed to create shader module!");
-		}
+		CreateModules();
 	}
 	VulkanShader::VulkanShader(const std::filesystem::path& filePath)
 	{
@@ -336,28 +417,118 @@ namespace Povox {
 			PX_CORE_WARN("Shader compilation+reflection took {0}ms", timer.ElapsedMilliseconds());
 		}
 
+		CreateModules();
+	}
+
+	VulkanShader::VulkanShader(const std::string& debugName, std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>&& binaries, std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>&& moduleBinaries,
+		const std::string& cacheKey, const ShaderDefines& defines/* = {}*/)
+		: m_DebugName(debugName), m_Defines(defines), m_CacheKey(cacheKey), m_SourceCodes(std::move(binaries)), m_ModuleCodes(std::move(moduleBinaries))
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		Reflect();
+		CreateModules();
+	}
+
+	VulkanShader::VulkanShader(const std::string& debugName, const ShaderDefines& defines)
+		: m_DebugName(debugName), m_Defines(defines)
+	{
+		Utils::Shader::CreateVKCacheDirectoryIfNeeded();
+	}
+
+	std::vector<Ref<Shader>> VulkanShader::CreateBatch(const std::vector<ShaderSource>& shaderSources)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		Utils::Shader::CreateVKCacheDirectoryIfNeeded();
+
+		struct StageTask
+		{
+			size_t ShaderIndex = 0;
+			VkShaderStageFlagBits Stage = VK_SHADER_STAGE_VERTEX_BIT;
+			std::string Code;
+			StageCompileResult Result{};
+			bool Success = false;
+		};
+
+		// Flattened, so a shader with many stages does not hold up the others
+		std::vector<StageTask> tasks;
+		for (size_t i = 0; i < shaderSources.size(); i++)
+		{
+			for (auto&& [stage, code] : PreProcess(shaderSources[i].Sources))
+				tasks.push_back(StageTask{ i, stage, std::move(code) });
+		}
+
+		Timer timer;
+		const ShaderOptimizationSettings& settings = Renderer::GetSpecification().ShaderOptimization;
+		Application::Get()->GetThreadPool().ParallelFor(static_cast<uint32_t>(tasks.size()), [&](uint32_t taskIndex)
+			{
+				StageTask& task = tasks[taskIndex];
+				task.Success = CompileOrGetStageBinary(task.Code, task.Stage, shaderSources[task.ShaderIndex].DebugName, shaderSources[task.ShaderIndex].Defines, settings, task.Result);
+			});
+		PX_CORE_INFO("VulkanShader::CreateBatch: Compiled {0} stages of {1} shaders in {2}ms", tasks.size(), shaderSources.size(), timer.ElapsedMilliseconds());
+
+		// Reflection and the descriptor layout cache are not thread safe, merge back in input order to keep layout creation deterministic
+		std::vector<std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>> binaries(shaderSources.size());
+		std::vector<std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>> moduleBinaries(shaderSources.size());
+		std::vector<std::map<VkShaderStageFlagBits, std::string>> stageKeys(shaderSources.size());
+		std::vector<ShaderCompileStatistics> statistics(shaderSources.size());
+		std::vector<bool> failed(shaderSources.size(), false);
+		for (auto& task : tasks)
+		{
+			if (!task.Success)
+				failed[task.ShaderIndex] = true;
+			binaries[task.ShaderIndex][task.Stage] = std::move(task.Result.Binary);
+			moduleBinaries[task.ShaderIndex][task.Stage] = std::move(task.Result.ModuleBinary);
+			stageKeys[task.ShaderIndex][task.Stage] = std::move(task.Result.CacheKey);
+			statistics[task.ShaderIndex].Stages[VulkanUtils::VKShaderStageToString(task.Stage)] = task.Result.Statistics;
+		}
+
+		std::vector<Ref<Shader>> shaders(shaderSources.size(), nullptr);
+		for (size_t i = 0; i < shaderSources.size(); i++)
+		{
+			if (failed[i])
+			{
+				PX_CORE_ERROR("VulkanShader::CreateBatch: Failed to compile shader {0}!", shaderSources[i].DebugName);
+				continue;
+			}
+			Ref<VulkanShader> shader = CreateRef<VulkanShader>(shaderSources[i].DebugName, std::move(binaries[i]), std::move(moduleBinaries[i]), VulkanShaderCache::CombineStageKeys(stageKeys[i]), shaderSources[i].Defines);
+			shader->m_CompileStatistics = std::move(statistics[i]);
+			shaders[i] = shader;
+		}
+		return shaders;
+	}
+
+	void VulkanShader::CreateModules()
+	{
 		VkShaderModuleCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 		for (auto& [stage, data] : m_SourceCodes)
 		{
-			createInfo.codeSize = data.size() * sizeof(uint32_t);
-			createInfo.pCode = data.data();
+			// Reflection needs the names, so only the copy the driver gets is stripped, see LoadOrStripModuleBinary
+			auto stripped = m_ModuleCodes.find(stage);
+			const std::vector<uint32_t>& moduleData = stripped != m_ModuleCodes.end() && !stripped->second.empty() ? stripped->second : data;
+			createInfo.codeSize = moduleData.size() * sizeof(uint32_t);
+			createInfo.pCode = moduleData.data();
 			PX_CORE_VK_ASSERT(vkCreateShaderModule(VulkanContext::GetDevice()->GetVulkanDevice(), &createInfo, nullptr, &m_Modules[stage]), VK_SUCCESS, "Failed to create shader module!");
 		}
 	}
 
 	void VulkanShader::Free()
 	{
-		VulkanContext::SubmitResourceFree([=]()
+		VulkanContext::SubmitResourceFree([modules = m_Modules]()
 			{
-				for (auto& module : m_Modules)
+				for (auto& module : modules)
 				{
 					vkDestroyShaderModule(VulkanContext::GetDevice()->GetVulkanDevice(), module.second, nullptr);
 				}
-				m_Modules.clear();
-				m_SourceCodes.clear();
-				m_Handle = 0;
 			});
+		m_Modules.clear();
+		m_SourceCodes.clear();
+		m_ModuleCodes.clear();
+		m_Handle = 0;
 	}
 
 	bool VulkanShader::Recompile(const std::string& sources)
@@ -365,35 +536,82 @@ namespace Povox {
 		PX_PROFILE_FUNCTION();
 
 
-		auto shaderSourceCodeMap = PreProcess(sources);
+		return PrepareRecompile(sources) && ApplyPendingRecompile();
+	}
+
+	bool VulkanShader::PrepareRecompile(const std::string& sources)
+	{
+		Timer timer;
+		const std::string debugName = m_DebugName;
+		const ShaderOptimizationSettings& settings = Renderer::GetSpecification().ShaderOptimization;
+
+		Scope<PendingRecompile> pending = CreateScope<PendingRecompile>();
+		std::map<VkShaderStageFlagBits, std::string> stageKeys;
+		for (auto&& [stage, code] : PreProcess(sources))
 		{
-			Timer timer;
-			bool success = CompileOrGetVulkanBinaries(shaderSourceCodeMap, true);
-			if(!success)
+			StageCompileResult result{};
+			if (!CompileOrGetStageBinary(code, stage, debugName, m_Defines, settings, result))
 			{
-				PX_CORE_WARN("VulkanShader::Recompile: Failed to compile binaries!");
+				PX_CORE_WARN("VulkanShader::PrepareRecompile: Failed to compile {0}!", debugName);
 				return false;
 			}
-			float compilationTime = timer.ElapsedMilliseconds();
-			PX_CORE_WARN("VulkanShader:Recompile: (Re)compilation took {0}ms", compilationTime);
-			success = Reflect();
-			if(!success)
-			{
-				PX_CORE_WARN("VulkanShader::Recompile: Reflection lead to problems! Canceling recompilation!");
-				return false;
-			}
-			PX_CORE_WARN("VulkanShader:Recompile: Reflection took {0}ms", timer.ElapsedMilliseconds() - compilationTime);
+
+			pending->Binaries[stage] = std::move(result.Binary);
+			pending->ModuleBinaries[stage] = std::move(result.ModuleBinary);
+			stageKeys[stage] = std::move(result.CacheKey);
+			pending->Statistics.Stages[VulkanUtils::VKShaderStageToString(stage)] = result.Statistics;
 		}
+		pending->CacheKey = VulkanShaderCache::CombineStageKeys(stageKeys);
 
-		VkShaderModuleCreateInfo createInfo{};
-		m_Modules.clear();
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		for (auto& [stage, data] : m_SourceCodes)
+		if (!LoadOrReflect(debugName, pending->CacheKey, settings, pending->Binaries, pending->Reflection))
 		{
-			createInfo.codeSize = data.size() * sizeof(uint32_t);
-			createInfo.pCode = data.data();
-			PX_CORE_VK_ASSERT(vkCreateShaderModule(VulkanContext::GetDevice()->GetVulkanDevice(), &createInfo, nullptr, &m_Modules[stage]), VK_SUCCESS, "Failed to create shader module!");
+			PX_CORE_WARN("VulkanShader::PrepareRecompile: Reflection of {0} failed!", debugName);
+			return false;
+		}
+
+		PX_CORE_INFO("VulkanShader::PrepareRecompile: Recompiled {0} in {1}ms", debugName, timer.ElapsedMilliseconds());
+
+		std::scoped_lock<std::mutex> lock(m_PendingRecompileMutex);
+		m_PendingRecompile = std::move(pending);
+		return true;
+	}
+
+	bool VulkanShader::ApplyPendingRecompile()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		Scope<PendingRecompile> pending;
+		{
+			std::scoped_lock<std::mutex> lock(m_PendingRecompileMutex);
+			pending = std::move(m_PendingRecompile);
 		}
+		if (!pending)
+			return false;
+
+		// Pipeline layouts and vertex input states are not rebuilt, only binaries matching the current ones can be swapped in
+		ReflectedLayout layout{};
+		BuildLayout(pending->Reflection, layout);
+		if (!IsLayoutCompatible(layout))
+		{
+			PX_CORE_WARN("VulkanShader::ApplyPendingRecompile: {0} does not match its previous layout anymore, keeping the old version!", m_DebugName);
+			return false;
+		}
+
+		// Deferred shaders get their layout with the first binaries, afterwards it is fixed.
+		// Specialization constants are not part of it, pipelines rebuild their specialization info on Recreate
+		if (!m_Reflected)
+			CommitLayout(layout);
+		else
+			m_SpecializationConstants = std::move(layout.SpecializationConstants);
+
+		std::unordered_map<VkShaderStageFlagBits, VkShaderModule> oldModules = std::move(m_Modules);
+		m_Modules.clear();
+		m_SourceCodes = std::move(pending->Binaries);
+		m_ModuleCodes = std::move(pending->ModuleBinaries);
+		m_CacheKey = std::move(pending->CacheKey);
+		m_CompileStatistics = std::move(pending->Statistics);
+		CreateModules();
 
 		if (m_Pipeline)
 			m_Pipeline->Recreate(true);
@@ -401,6 +619,14 @@ namespace Povox {
 		if (m_ComputePipeline)
 			m_ComputePipeline->Recreate(true);
 
+		// Frames in flight may still use pipelines built from the old modules
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		VulkanContext::SubmitResourceFree([device, oldModules]()
+			{
+				for (auto& [stage, module] : oldModules)
+					vkDestroyShaderModule(device, module, nullptr);
+			});
+
 		return true;
 	}
 
@@ -409,19 +635,52 @@ namespace Povox {
 	//Creates a DescriptorSetLayout by reflecting the shader and allocates it from the Pool in the Context
 	bool VulkanShader::Reflect()
 	{
-		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
-		VkPhysicalDeviceProperties physicalProps = VulkanContext::GetDevice()->GetPhysicalDeviceProperties();
-		bool debug = true;
+		PX_PROFILE_FUNCTION();
+
+
+		ShaderReflectionData reflection{};
+		if (!LoadOrReflect(m_DebugName, m_CacheKey, Renderer::GetSpecification().ShaderOptimization, m_SourceCodes, reflection))
+			return false;
+
+		ReflectedLayout layout{};
+		BuildLayout(reflection, layout);
+		if (!IsLayoutCompatible(layout))
+			return false;
+
+		CommitLayout(layout);
+		return true;
+	}
+
+	bool VulkanShader::LoadOrReflect(const std::string& debugName, const std::string& cacheKey, const ShaderOptimizationSettings& settings, const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& binaries, ShaderReflectionData& outReflection)
+	{
+		// Same key as the binaries, a cached record can only belong to exactly these binaries
+		static const std::string extension = ".cached_vulkan.refl";
+		const std::string entryName = VulkanUtils::GetCacheEntryName(debugName, settings);
+		std::filesystem::path cachedPath = std::filesystem::path(Utils::Shader::GetVKCacheDirectory()) / (entryName + "_" + cacheKey + extension);
+		if (!cacheKey.empty() && VulkanShaderCache::ReadReflection(cachedPath, outReflection))
+			return true;
 
-		
-		std::map<uint32_t, DescriptorLayoutInfo> setToLayoutInfos;
+		if (!ReflectModules(binaries, outReflection))
+			return false;
 
-		for (auto&& [stage, data] : m_SourceCodes)
+		if (!cacheKey.empty())
+		{
+			VulkanShaderCache::WriteReflection(cachedPath, outReflection);
+			VulkanShaderCache::RemoveStaleEntries(cachedPath, entryName, extension);
+		}
+		return true;
+	}
+
+	bool VulkanShader::ReflectModules(const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& binaries, ShaderReflectionData& outReflection)
+	{
+		bool debug = true;
+
+		for (auto&& [stage, data] : binaries)
 		{
 			if (stage == SPV_REFLECT_SHADER_STAGE_VERTEX_BIT)
 			{
-				if (!ReflectVertexStage(&data, debug))
-					return false;				
+				if (!ReflectVertexStage(&data, outReflection, debug))
+					return false;
 			}
 
 			SpvReflectShaderModule module{};
@@ -432,6 +691,10 @@ namespace Povox {
 				PX_CORE_ERROR("ReflectionModule creation failed!");
 				return false;
 			}
+			SpirvUtils::ReflectModuleGuard moduleGuard(module);
+
+			ShaderReflectionData::Stage& stageReflection = outReflection.Stages.emplace_back();
+			stageReflection.Stage = stage;
 
 		// DesciptorSets
 			uint32_t count = 0;
@@ -442,20 +705,6 @@ namespace Povox {
 				return false;
 			}
 
-			if (m_LayoutInfoHashes.find(stage) != m_LayoutInfoHashes.end())
-			{
-				if (m_LayoutInfoHashes.at(stage).size() != count)
-				{
-					PX_CORE_WARN("Shader::Reflect: Shader {0} - Stage {1} previously contained {2} descriptor sets, now {3}", 
-						m_DebugName, 
-						VulkanUtils::VKShaderStageToString(stage),
-						m_LayoutInfoHashes.at(stage).size(), 
-						count
-					);
-					return false;
-				}
-			}
-
 			std::vector<SpvReflectDescriptorSet*> reflSets(count);
 			result = spvReflectEnumerateDescriptorSets(&module, &count, reflSets.data());
 			if (result != SPV_REFLECT_RESULT_SUCCESS)
@@ -464,67 +713,88 @@ namespace Povox {
 				return false;
 			}
 
-			//For every set in shaderStage
 			for (size_t i = 0; i < reflSets.size(); i++)
 			{
 				const SpvReflectDescriptorSet& reflSet = *(reflSets[i]);
+				stageReflection.Sets.push_back(reflSet.set);
 
-				// abuse operator[] -> if not existant, creates an returns new. I therefor just need to check the bindings -> add binding if not existant, or update stage flag if existant
-				DescriptorLayoutInfo& currentSetLayout = setToLayoutInfos[reflSet.set];
 				for (size_t j = 0; j < reflSet.binding_count; j++)
 				{
 					const SpvReflectDescriptorBinding& reflBinding = *(reflSet.bindings[j]);
 
-					const char* name;
-					if (VulkanUtils::IsImageBinding(static_cast<VkDescriptorType>(reflBinding.descriptor_type)))
-						name = reflBinding.name;
-					else
-						name = reflBinding.type_description->type_name;
-
-					//check if binding is already in Set
-					auto it = std::find_if(currentSetLayout.Bindings.begin(), currentSetLayout.Bindings.end(),
-						[=](const VkDescriptorSetLayoutBinding& binding) {return binding.binding == reflBinding.binding; });
-					if (it == currentSetLayout.Bindings.end())
+					ShaderReflectionData::Binding& binding = stageReflection.Bindings.emplace_back();
+					binding.Set = reflSet.set;
+					binding.Binding = reflBinding.binding;
+					binding.Type = static_cast<VkDescriptorType>(reflBinding.descriptor_type);
+					binding.Count = 1;
+					for (uint32_t dim = 0; dim < reflBinding.array.dims_count; dim++)
 					{
-						//Not found -> add new binding
-						VkDescriptorSetLayoutBinding binding{};
-						binding.binding = reflBinding.binding;
-						binding.descriptorType = SpirvUtils::IsDynamic(static_cast<VkDescriptorType>(reflBinding.descriptor_type), reflSet.set);
-						binding.descriptorCount = 1;
-						for (uint32_t dim = 0; dim < reflBinding.array.dims_count; dim++)
-						{
-							binding.descriptorCount *= reflBinding.array.dims[dim];
-						}
-						binding.stageFlags |= static_cast<VkShaderStageFlagBits>(module.shader_stage);
+						binding.Count *= reflBinding.array.dims[dim];
+					}
+					// Runtime sized arrays (dimension 0) are only used for the renderers bindless texture set
+					binding.RuntimeArray = reflBinding.array.dims_count > 0 && binding.Count == 0;
 
-						currentSetLayout.Bindings.push_back(binding);
+					if (VulkanUtils::IsImageBinding(binding.Type))
+						binding.Name = reflBinding.name;
+					else
+						binding.Name = reflBinding.type_description->type_name;
+				}
+			}
 
-						Ref<ShaderResourceDescription> resource = CreateRef<ShaderResourceDescription>();
-						resource->Set = reflSet.set;
-						resource->Binding = reflBinding.binding;
-						resource->Count = binding.descriptorCount;
-						resource->Name = name;
-						resource->ResourceType = VulkanUtils::VulkanDescriptorTypeToShaderResourceType(SpirvUtils::IsDynamic(static_cast<VkDescriptorType>(reflBinding.descriptor_type), reflSet.set));
-						resource->Stages |= SpirvUtils::ReflectShaderStageToStage(module.shader_stage);
+		// SpecializationConstants
+			{
+				spirv_cross::Compiler compiler(data);
+				spirv_cross::SpecializationConstant workGroupSize[3];
+				compiler.get_work_group_size_specialization_constants(workGroupSize[0], workGroupSize[1], workGroupSize[2]);
+				const char* workGroupSizeNames[3] = { "local_size_x", "local_size_y", "local_size_z" };
 
-						m_ShaderResourceDescriptions[name] = std::move(resource);
-					}
-					else
-					{						
-						auto index = std::distance(currentSetLayout.Bindings.begin(), it);
-						currentSetLayout.Bindings[index].stageFlags |= static_cast<VkShaderStageFlagBits>(module.shader_stage);
-						
-						m_ShaderResourceDescriptions[name]->Stages |= SpirvUtils::ReflectShaderStageToStage(module.shader_stage);
+				for (const spirv_cross::SpecializationConstant& reflConstant : compiler.get_specialization_constants())
+				{
+					const spirv_cross::SPIRConstant& value = compiler.get_constant(reflConstant.id);
+					ShaderSpecializationConstant& constant = stageReflection.SpecializationConstants.emplace_back();
+					constant.ConstantID = reflConstant.constant_id;
+					constant.Type = SpirvUtils::SpirvTypeToShaderDataType(compiler.get_type(value.constant_type).basetype);
+					constant.Name = compiler.get_name(reflConstant.id);
+					for (uint32_t dim = 0; dim < 3; dim++)
+					{
+						if (workGroupSize[dim].id == reflConstant.id)
+							constant.Name = workGroupSizeNames[dim];
 					}
 
-					SortLayoutInfoBindings(currentSetLayout);
-					m_LayoutInfoHashes[stage][reflSet.set] = currentSetLayout.hash();
+					if (constant.Type == ShaderDataType::None)
+						PX_CORE_WARN("VulkanShader::ReflectModules: Specialization constant {0} ({1}) has an unsupported type!", constant.Name, constant.ConstantID);
 				}
+			}
+
+		// PushConstants
+			count = 0;
+			result = spvReflectEnumeratePushConstantBlocks(&module, &count, nullptr);
+			if (result != SPV_REFLECT_RESULT_SUCCESS)
+			{
+				PX_CORE_ERROR("PushConstantBlocks enumeration failed!");
+				return false;
+			}
+
+			std::vector<SpvReflectBlockVariable*> pushConstants(count);
+			result = spvReflectEnumeratePushConstantBlocks(&module, &count, pushConstants.data());
+			if (result != SPV_REFLECT_RESULT_SUCCESS)
+			{
+				PX_CORE_ERROR("PushConstantBlocks querying failed!");
+				return false;
+			}
 
-				if(!CheckDescriptorHash(stage, reflSet.set, setToLayoutInfos.at(reflSet.set)))
+			for (const SpvReflectBlockVariable* block : pushConstants)
+			{
+				// Stages sharing a block share the range
+				auto it = std::find_if(outReflection.PushConstantRanges.begin(), outReflection.PushConstantRanges.end(),
+					[=](const VkPushConstantRange& range) { return range.offset == block->offset && range.size == block->size; });
+				if (it != outReflection.PushConstantRanges.end())
+					it->stageFlags |= stage;
+				else
 				{
-					PX_CORE_WARN("Shader::Reflect: Shader: {}, Stage: {} - DescriptorSet {} does not match previous layout!", m_DebugName, VulkanUtils::VKShaderStageToString(stage), reflSet.set);
-					return false;
+					outReflection.PushConstantRanges.push_back(VkPushConstantRange{ static_cast<VkShaderStageFlags>(stage), block->offset, block->size });
+					const char* typeName = block->type_description ? block->type_description->type_name : nullptr;
+					outReflection.PushConstantBlocks.push_back(typeName ? typeName : "");
 				}
 			}
 
@@ -543,7 +813,7 @@ namespace Povox {
 					{
 						PX_CORE_INFO("Layout(Set = {}, Binding = {}) {} {}", reflSet->bindings[i_bindings]->set, reflSet->bindings[i_bindings]->binding,
 							SpirvUtils::ReflectDescriptorTypeToString(reflSet->bindings[i_bindings]->descriptor_type).c_str(),	reflSet->bindings[i_bindings]->name);
-						
+
 
 						//Array
 						if (reflSet->bindings[i_bindings]->array.dims_count > 0)
@@ -564,14 +834,150 @@ namespace Povox {
 							);
 						}
 					}
-				}//for-end DescriptorSet-debug 	
+				}//for-end DescriptorSet-debug
+
+				for (const SpvReflectBlockVariable* block : pushConstants)
+					PX_CORE_INFO("PushConstant {} (Offset = {}, Size = {})", block->name ? block->name : "", block->offset, block->size);
 			}
 			#endif
-
-			spvReflectDestroyShaderModule(&module);
 		}//for-end stages
 
-		
+		return true;
+	}
+
+	void VulkanShader::BuildLayout(const ShaderReflectionData& reflection, ReflectedLayout& outLayout)
+	{
+		for (const auto& stageReflection : reflection.Stages)
+		{
+			const VkShaderStageFlagBits stage = stageReflection.Stage;
+			const ShaderStage shaderStage = SpirvUtils::ReflectShaderStageToStage(static_cast<SpvReflectShaderStageFlagBits>(stage));
+
+			//For every set in shaderStage
+			for (uint32_t set : stageReflection.Sets)
+			{
+				// abuse operator[] -> if not existant, creates an returns new. I therefor just need to check the bindings -> add binding if not existant, or update stage flag if existant
+				DescriptorLayoutInfo& currentSetLayout = outLayout.SetLayouts[set];
+				for (const auto& reflBinding : stageReflection.Bindings)
+				{
+					if (reflBinding.Set != set)
+						continue;
+
+					//check if binding is already in Set
+					auto it = std::find_if(currentSetLayout.Bindings.begin(), currentSetLayout.Bindings.end(),
+						[=](const VkDescriptorSetLayoutBinding& binding) {return binding.binding == reflBinding.Binding; });
+					if (it == currentSetLayout.Bindings.end())
+					{
+						//Not found -> add new binding
+						VkDescriptorSetLayoutBinding binding{};
+						binding.binding = reflBinding.Binding;
+						binding.descriptorType = SpirvUtils::IsDynamic(reflBinding.Type, set);
+						binding.descriptorCount = reflBinding.Count;
+						if (reflBinding.RuntimeArray)
+							outLayout.BindlessSets.insert(set);
+						binding.stageFlags |= stage;
+
+						currentSetLayout.Bindings.push_back(binding);
+
+						Ref<ShaderResourceDescription> resource = CreateRef<ShaderResourceDescription>();
+						resource->Set = set;
+						resource->Binding = reflBinding.Binding;
+						resource->Count = binding.descriptorCount;
+						resource->Name = reflBinding.Name;
+						resource->ResourceType = VulkanUtils::VulkanDescriptorTypeToShaderResourceType(binding.descriptorType);
+						resource->Stages |= shaderStage;
+
+						outLayout.Resources[reflBinding.Name] = std::move(resource);
+					}
+					else
+					{
+						auto index = std::distance(currentSetLayout.Bindings.begin(), it);
+						currentSetLayout.Bindings[index].stageFlags |= stage;
+
+						outLayout.Resources[reflBinding.Name]->Stages |= shaderStage;
+					}
+				}
+				SortLayoutInfoBindings(currentSetLayout);
+			}
+		}
+
+		for (const auto& [set, setLayout] : outLayout.SetLayouts)
+			outLayout.SetLayoutHashes[set] = setLayout.hash();
+
+		outLayout.PushConstantRanges = reflection.PushConstantRanges;
+		outLayout.PushConstantBlocks = reflection.PushConstantBlocks;
+		for (const auto& stageReflection : reflection.Stages)
+			outLayout.SpecializationConstants[stageReflection.Stage] = stageReflection.SpecializationConstants;
+
+		// Vertex input, sorted by location and tightly packed into binding 0
+		VertexInputDescription& vertexInput = outLayout.VertexInput;
+		vertexInput.Attributes = reflection.VertexAttributes;
+		std::sort(std::begin(vertexInput.Attributes), std::end(vertexInput.Attributes), [](const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b)
+			{
+				return a.location < b.location;
+			});
+
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = 0;
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		for (auto& attribute : vertexInput.Attributes)
+		{
+			uint32_t formatSize = VulkanUtils::FormatSize(attribute.format);
+			attribute.offset = bindingDescription.stride;
+			bindingDescription.stride += formatSize;
+		}
+		// Shaders that only use built-ins (vertex pulling) have no vertex buffer binding at all
+		if (!vertexInput.Attributes.empty())
+			vertexInput.Bindings.push_back(bindingDescription);
+	}
+
+	bool VulkanShader::IsLayoutCompatible(const ReflectedLayout& layout) const
+	{
+		if (!m_Reflected)
+			return true;
+
+		if (layout.SetLayoutHashes != m_SetLayoutHashes)
+		{
+			PX_CORE_WARN("VulkanShader::IsLayoutCompatible: Shader: {} - DescriptorSets do not match previous layout ({} sets, previously {})!", m_DebugName, layout.SetLayoutHashes.size(), m_SetLayoutHashes.size());
+			return false;
+		}
+
+		const auto& attributes = layout.VertexInput.Attributes;
+		const auto& previousAttributes = m_VertexInputDescription.Attributes;
+		bool sameAttributes = attributes.size() == previousAttributes.size()
+			&& std::equal(attributes.begin(), attributes.end(), previousAttributes.begin(), [](const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b)
+				{
+					return a.location == b.location && a.format == b.format && a.offset == b.offset;
+				});
+		if (!sameAttributes)
+		{
+			PX_CORE_WARN("VulkanShader::IsLayoutCompatible: Shader: {} InputAttributes({}) do not match with previous compilation ({})!", m_DebugName, attributes.size(), previousAttributes.size());
+			return false;
+		}
+
+		const auto& ranges = layout.PushConstantRanges;
+		bool samePushConstants = ranges.size() == m_PushConstantRanges.size()
+			&& std::equal(ranges.begin(), ranges.end(), m_PushConstantRanges.begin(), [](const VkPushConstantRange& a, const VkPushConstantRange& b)
+				{
+					return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+				})
+			&& layout.PushConstantBlocks == m_PushConstantBlocks;
+		if (!samePushConstants)
+		{
+			PX_CORE_WARN("VulkanShader::IsLayoutCompatible: Shader: {} PushConstantRanges({}) do not match with previous compilation ({})!", m_DebugName, ranges.size(), m_PushConstantRanges.size());
+			return false;
+		}
+		return true;
+	}
+
+	void VulkanShader::CommitLayout(ReflectedLayout& layout)
+	{
+		m_SetLayoutHashes = layout.SetLayoutHashes;
+		m_ShaderResourceDescriptions = std::move(layout.Resources);
+		m_VertexInputDescription = std::move(layout.VertexInput);
+		m_PushConstantRanges = layout.PushConstantRanges;
+		m_PushConstantBlocks = layout.PushConstantBlocks;
+		m_SpecializationConstants = std::move(layout.SpecializationConstants);
 
 		// TODO: Hardcoded here. Put these in a file in the future as some lookup-table or something
 		const std::unordered_map<uint32_t, std::string> setNames = {
@@ -580,14 +986,18 @@ namespace Povox {
 			{2, "Textures"},
 			{3, "ObjectMaterials"}
 		};
-		for (auto const& [key, setLayout] : setToLayoutInfos)
+		for (auto const& [key, setLayout] : layout.SetLayouts)
 		{
-			m_DescriptorSetLayouts[key] = (VulkanContext::GetDescriptorLayoutCache()->CreateDescriptorLayout(setLayout, setNames.at(key)));
+			// The pipeline layout has to use the exact layout the bindless set was allocated with
+			if (layout.BindlessSets.find(key) != layout.BindlessSets.end())
+				m_DescriptorSetLayouts[key] = VulkanContext::GetDescriptorLayoutCache()->GetLayout("BindlessTextures");
+			else
+				m_DescriptorSetLayouts[key] = (VulkanContext::GetDescriptorLayoutCache()->CreateDescriptorLayout(setLayout, setNames.at(key)));
 		}
-		return true;
+		m_Reflected = true;
 	}
 
-	bool VulkanShader::ReflectVertexStage(const std::vector<uint32_t>* moduleData, bool printDebug/* = false*/)
+	bool VulkanShader::ReflectVertexStage(const std::vector<uint32_t>* moduleData, ShaderReflectionData& outReflection, bool printDebug/* = false*/)
 	{
 		SpvReflectShaderModule module{};
 		SpvReflectResult result = spvReflectCreateShaderModule(sizeof(uint32_t) * moduleData->size(), moduleData->data(), &module);
@@ -597,6 +1007,7 @@ namespace Povox {
 			PX_CORE_ERROR("ReflectionModule creation failed!");
 			return false;
 		}
+		SpirvUtils::ReflectModuleGuard moduleGuard(module);
 
 		uint32_t count = 0;
 		result = spvReflectEnumerateInputVariables(&module, &count, nullptr);
@@ -606,17 +1017,6 @@ namespace Povox {
 			return false;
 		}
 
-		if(count == 0 && m_VertexInputDescription.Attributes.size() != count)
-		{
-			PX_CORE_WARN("VulkanShader::ReflectVertexStage: Shader: {} InputAttributes({}) do not match with previous compilation ({})!", m_DebugName, count, m_VertexInputDescription.Attributes.size());
-			return false;
-		}
-		if(count == m_VertexInputDescription.Attributes.size())
-		{
-			PX_CORE_INFO("VulkanShader::ReflectVertexStage: Shader: {} InputAttributes already done ({}/{})!", m_DebugName, count, m_VertexInputDescription.Attributes.size());
-			return true;
-		}
-
 		std::vector<SpvReflectInterfaceVariable*> inputVars(count);
 		result = spvReflectEnumerateInputVariables(&module, &count, inputVars.data());
 		if (result != SPV_REFLECT_RESULT_SUCCESS)
@@ -641,12 +1041,8 @@ namespace Povox {
 			return false;
 		}
 
-		VkVertexInputBindingDescription bindingDescription{};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = 0;
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		m_VertexInputDescription.Attributes.reserve(inputVars.size());
+		outReflection.VertexInputCount = static_cast<uint32_t>(inputVars.size());
+		outReflection.VertexAttributes.reserve(inputVars.size());
 		for (size_t i = 0; i < inputVars.size(); i++)
 		{
 			const SpvReflectInterfaceVariable& reflectVar = *(inputVars[i]);
@@ -655,24 +1051,11 @@ namespace Povox {
 				continue;
 			VkVertexInputAttributeDescription attributeDescription{};
 			attributeDescription.location = reflectVar.location;
-			attributeDescription.binding = bindingDescription.binding;
+			attributeDescription.binding = 0;
 			attributeDescription.format = static_cast<VkFormat>(reflectVar.format);
-			attributeDescription.offset = 0; //Later 
-			m_VertexInputDescription.Attributes.push_back(attributeDescription);
-		}
-		//sort ascending
-		std::sort(std::begin(m_VertexInputDescription.Attributes), std::end(m_VertexInputDescription.Attributes), [](const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b)
-			{
-				return a.location < b.location;
-			});
-		//calculate offset
-		for (auto& attribute : m_VertexInputDescription.Attributes)
-		{
-			uint32_t formatSize = VulkanUtils::FormatSize(attribute.format);
-			attribute.offset = bindingDescription.stride;
-			bindingDescription.stride += formatSize;
+			attributeDescription.offset = 0; //Later
+			outReflection.VertexAttributes.push_back(attributeDescription);
 		}
-		m_VertexInputDescription.Bindings.push_back(bindingDescription);
 
 		//Debug Print Input and outputs
 #ifdef PX_DEBUG
@@ -695,9 +1078,11 @@ namespace Povox {
 			}
 
 			PX_CORE_INFO("Input Variables: ");
-			for (size_t i = 0; i < m_VertexInputDescription.Attributes.size(); i++)
+			for (size_t i = 0; i < inputVars.size(); i++)
 			{
 				SpvReflectInterfaceVariable* var = inputVars[i];
+				if (var->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN)
+					continue;
 				PX_CORE_INFO("layout(location = {}) in {} {}",
 					var->location,
 					SpirvUtils::ReflectDecorationTypeDescriptionToString(*var->type_description).c_str(),
@@ -741,22 +1126,6 @@ namespace Povox {
 			layoutInfo.SortBindings();
 	}
 
-	bool VulkanShader::CheckDescriptorHash(VkShaderStageFlagBits stage, uint32_t set, const DescriptorLayoutInfo& layoutInfo)
-	{
-		if (m_LayoutInfoHashes.find(stage) == m_LayoutInfoHashes.end())
-		{
-			PX_CORE_WARN("VulkanShader::CheckDescriptorHash: Shader: {} - Stage {} not contained in previous shader reflection!", m_DebugName, VulkanUtils::VKShaderStageToString(stage));
-			return false;
-		}
-		auto& sets = m_LayoutInfoHashes.at(stage);
-		if (sets.find(set) == sets.end())
-		{
-			PX_CORE_WARN("VulkanShader::CheckDescriptorHash: Shader: {}, Stage {} - Set {} not contained in previous shader reflection!", m_DebugName, VulkanUtils::VKShaderStageToString(stage), set);
-			return false;
-		}
-		return sets.at(set) == layoutInfo.hash();
-	}
-
 	//From Chernos GL code
 	std::unordered_map<VkShaderStageFlagBits, std::string> VulkanShader::PreProcess(const std::string& sources)
 	{
@@ -792,66 +1161,122 @@ namespace Povox {
 		return shaderSources;
 	}
 
-	bool VulkanShader::CompileOrGetVulkanBinaries(std::unordered_map<VkShaderStageFlagBits, std::string> sources, bool forceRecompile/* = false*/)
+	bool VulkanShader::CompileOrGetVulkanBinaries(std::unordered_map<VkShaderStageFlagBits, std::string> sources)
 	{
 		PX_PROFILE_FUNCTION();
 
 
-		shaderc::Compiler compiler;
+		const ShaderOptimizationSettings& settings = Renderer::GetSpecification().ShaderOptimization;
+
+		auto& shaderData = m_SourceCodes;
+		shaderData.clear();
+		m_ModuleCodes.clear();
+		m_CompileStatistics.Stages.clear();
+		std::map<VkShaderStageFlagBits, std::string> stageKeys;
+		for (auto&& [stage, code] : sources)
+		{
+			StageCompileResult result{};
+			if (!CompileOrGetStageBinary(code, stage, m_DebugName, m_Defines, settings, result))
+				return false;
+
+			shaderData[stage] = std::move(result.Binary);
+			m_ModuleCodes[stage] = std::move(result.ModuleBinary);
+			stageKeys[stage] = std::move(result.CacheKey);
+			m_CompileStatistics.Stages[VulkanUtils::VKShaderStageToString(stage)] = result.Statistics;
+		}
+		m_CacheKey = VulkanShaderCache::CombineStageKeys(stageKeys);
+		return true;
+	}
+
+	bool VulkanShader::CompileOrGetStageBinary(const std::string& code, VkShaderStageFlagBits stage, const std::string& debugName, const ShaderDefines& defines,
+		const ShaderOptimizationSettings& settings, StageCompileResult& outResult)
+	{
+		Timer timer;
 		shaderc::CompileOptions options;
 
+		// Everything set on the options has to end up in the fingerprint as well, it is part of the cache key, see VulkanUtils::GetOptionsFingerprint
+		std::stringstream fingerprint;
+		fingerprint << VulkanUtils::GetOptionsFingerprint(settings);
+
 		options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
 		options.SetTargetSpirv(shaderc_spirv_version_1_6);
 
-		const bool optimize = false;
-
-#ifdef PX_DEBUG
+		// Optimization is left to spirv-opt, so the unoptimized instruction count is known without compiling twice
 		options.SetOptimizationLevel(shaderc_optimization_level_zero);
-#else
-		if (optimize)
-			options.SetOptimizationLevel(shaderc_optimization_level_performance);
-#endif
-		std::filesystem::path cacheDirectory = Utils::Shader::GetVKCacheDirectory();
-		
+		const std::vector<std::string> optimizerFlags = VulkanUtils::GetOptimizerFlags(settings);
 
-		auto& shaderData = m_SourceCodes;
-		shaderData.clear();
-		for (auto&& [stage, code] : sources)
+		for (const auto& [name, value] : defines)
 		{
-			std::filesystem::path cachedPath = cacheDirectory / (m_DebugName + VulkanUtils::VKShaderStageCachedVulkanFileExtension(stage));
+			options.AddMacroDefinition(name, value);
+			fingerprint << "def:" << name << "=" << value << ";";
+		}
 
-			std::ifstream in(cachedPath, std::ios::in | std::ios::binary);
-			if (in.is_open() && !forceRecompile) // happens if cache path exists
-			{
-				in.seekg(0, std::ios::end);				// places pointer to end of file
-				auto size = in.tellg();					// position of pointer equals size
-				in.seekg(0, std::ios::beg);				// places pointer back to start
+		outResult.CacheKey = VulkanShaderCache::GetStageKey(code, stage, fingerprint.str());
+		const std::string entryName = VulkanUtils::GetCacheEntryName(debugName, settings);
+		std::filesystem::path cachedPath = std::filesystem::path(Utils::Shader::GetVKCacheDirectory()) / (entryName + "_" + outResult.CacheKey + VulkanUtils::VKShaderStageCachedVulkanFileExtension(stage));
 
-				auto& data = shaderData[stage];			// gets a vector of uint32_t
-				data.resize(size / sizeof(uint32_t));	// sets the size of the vector
-				in.read((char*)data.data(), size);		// reads in and writes to data I guess
-			}
-			else
-			{
- 				shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(code, VulkanUtils::VKShaderStageToShaderC(stage), m_DebugName.c_str(), options);
- 				if (module.GetCompilationStatus() != shaderc_compilation_status_success)
- 				{
- 					PX_CORE_ERROR(module.GetErrorMessage());
-					return false;
- 				}
+		ShaderStageStatistics& stats = outResult.Statistics;
+		if (VulkanShaderCache::ReadBinary(cachedPath, outResult.Binary))
+		{
+			stats.Cached = true;
+			stats.InstructionsAfter = VulkanUtils::CountSPIRVInstructions(outResult.Binary);
+			stats.SizeAfter = outResult.Binary.size() * sizeof(uint32_t);
+			stats.CompileTimeMs = timer.ElapsedMilliseconds();
+			if (settings.StripDebugInfo)
+				LoadOrStripModuleBinary(cachedPath, entryName, stage, debugName, outResult);
+			return true;
+		}
 
-				shaderData[stage] = std::vector<uint32_t>(module.cbegin(), module.cend());
+		shaderc::Compiler compiler;
+		shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(code, VulkanUtils::VKShaderStageToShaderC(stage), debugName.c_str(), options);
+		if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+		{
+			PX_CORE_ERROR(module.GetErrorMessage());
+			return false;
+		}
 
-				std::ofstream out(cachedPath, std::ios::out | std::ios::binary | std::ofstream::trunc);
-				if (out.is_open())
-				{
-					auto& data = shaderData[stage];
-					out.write((char*)data.data(), data.size() * sizeof(uint32_t));
-					out.flush();
-					out.close();
-				}
+		outResult.Binary = std::vector<uint32_t>(module.cbegin(), module.cend());
+		stats.InstructionsBefore = VulkanUtils::CountSPIRVInstructions(outResult.Binary);
+		stats.SizeBefore = outResult.Binary.size() * sizeof(uint32_t);
+
+		if (!optimizerFlags.empty())
+		{
+			std::vector<uint32_t> optimized;
+			if (!VulkanUtils::RunSPIRVOptimizer(outResult.Binary, optimizerFlags, debugName, optimized))
+			{
+				PX_CORE_ERROR("VulkanShader: Optimizing {0} ({1}) failed!", debugName, VulkanUtils::VKShaderStageToString(stage));
+				return false;
 			}
+			outResult.Binary = std::move(optimized);
 		}
+
+		stats.InstructionsAfter = VulkanUtils::CountSPIRVInstructions(outResult.Binary);
+		stats.SizeAfter = outResult.Binary.size() * sizeof(uint32_t);
+		stats.CompileTimeMs = timer.ElapsedMilliseconds();
+
+		// Every older build of this stage is superseded now, the cache would otherwise keep one file per edit forever
+		VulkanShaderCache::WriteBinary(cachedPath, outResult.Binary);
+		VulkanShaderCache::RemoveStaleEntries(cachedPath, entryName, VulkanUtils::VKShaderStageCachedVulkanFileExtension(stage));
+		if (settings.StripDebugInfo)
+			LoadOrStripModuleBinary(cachedPath, entryName, stage, debugName, outResult);
 		return true;
 	}
+
+	void VulkanShader::LoadOrStripModuleBinary(const std::filesystem::path& cachedPath, const std::string& entryName, VkShaderStageFlagBits stage, const std::string& debugName, StageCompileResult& outResult)
+	{
+		// Stripped once when the stage is first cached, later runs load the stripped copy as it is
+		const std::string extension = std::string(VulkanUtils::VKShaderStageCachedVulkanFileExtension(stage)) + ".stripped";
+		std::filesystem::path strippedPath = cachedPath;
+		strippedPath += ".stripped";
+		if (VulkanShaderCache::ReadBinary(strippedPath, outResult.ModuleBinary))
+			return;
+
+		if (!VulkanUtils::RunSPIRVOptimizer(outResult.Binary, { "--strip-debug" }, debugName, outResult.ModuleBinary))
+		{
+			outResult.ModuleBinary.clear();
+			return;
+		}
+		VulkanShaderCache::WriteBinary(strippedPath, outResult.ModuleBinary);
+		VulkanShaderCache::RemoveStaleEntries(strippedPath, entryName, extension);
+	}
 }
@@ -1,11 +1,14 @@
 #pragma once
 #include "Povox/Renderer/Shader.h"
 
+#include "Platform/Vulkan/VulkanShaderCache.h"
 #include "Platform/Vulkan/VulkanUtilities.h"
 
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 
+#include <mutex>
+
 namespace Povox {
 
 	struct GPUBufferObject
@@ -33,16 +36,32 @@ namespace Povox {
 	public:
 		VulkanShader(const std::string& sources, const std::string& debugName = "Shader");
 		VulkanShader(const std::filesystem::path& filepath);
+		// Takes already compiled stages, only reflection and module creation are left, see CreateBatch
+		VulkanShader(const std::string& debugName, std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>&& binaries, std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>&& moduleBinaries,
+			const std::string& cacheKey, const ShaderDefines& defines = {});
+		// Empty until PrepareRecompile and ApplyPendingRecompile ran, see Shader::CreateDeferred
+		VulkanShader(const std::string& debugName, const ShaderDefines& defines);
 		virtual ~VulkanShader() = default;
 
+		// Compiles every stage of every shader concurrently on the application's ThreadPool, the shaders are then reflected and created in input order on the calling thread
+		static std::vector<Ref<Shader>> CreateBatch(const std::vector<ShaderSource>& shaderSources);
+
 		virtual void Free() override;
 		virtual bool Recompile(const std::string& sources) override;
+		virtual bool PrepareRecompile(const std::string& sources) override;
+		virtual bool ApplyPendingRecompile() override;
 
 		virtual const std::unordered_map<std::string, Ref<ShaderResourceDescription>>& GetResourceDescriptions() const override { return m_ShaderResourceDescriptions; }
+		virtual const ShaderCompileStatistics& GetCompileStatistics() const override { return m_CompileStatistics; }
+		virtual const ShaderDefines& GetDefines() const override { return m_Defines; }
 		inline const std::map<uint32_t, VkDescriptorSetLayout>& GetDescriptorSetLayouts() const { return m_DescriptorSetLayouts; }
 		inline std::map<uint32_t, VkDescriptorSetLayout>& GetDescriptorSetLayouts() { return m_DescriptorSetLayouts; }
 		inline VertexInputDescription& GetVertexInputDescription() { return m_VertexInputDescription; }
 		inline const VertexInputDescription& GetVertexInputDescription() const { return m_VertexInputDescription; }
+		inline const std::vector<VkPushConstantRange>& GetPushConstantRanges() const { return m_PushConstantRanges; }
+		// Type names of the push constant blocks, parallel to GetPushConstantRanges
+		inline const std::vector<std::string>& GetPushConstantBlocks() const { return m_PushConstantBlocks; }
+		inline const std::unordered_map<VkShaderStageFlagBits, std::vector<ShaderSpecializationConstant>>& GetSpecializationConstants() const { return m_SpecializationConstants; }
 		inline const std::unordered_map<VkShaderStageFlagBits, VkShaderModule>& VulkanShader::GetModules() { return m_Modules; }
 
 		virtual inline void AddPipeline(Ref<Pipeline> pipeline) override { m_Pipeline = pipeline; };
@@ -56,29 +75,85 @@ namespace Povox {
 		virtual bool operator==(const Shader& other) const override { return m_Handle == ((VulkanShader&)other).m_Handle; }
 
 	private:
-		std::unordered_map<VkShaderStageFlagBits, std::string> PreProcess(const std::string& sources);
-		bool CompileOrGetVulkanBinaries(std::unordered_map<VkShaderStageFlagBits, std::string> sources, bool forceRecompile = false);
-
-		bool CheckDescriptorHash(VkShaderStageFlagBits stage, uint32_t set, const DescriptorLayoutInfo& layoutInfo);
-		
-		void SortLayoutInfoBindings(DescriptorLayoutInfo& layoutInfo);
-
+		struct StageCompileResult
+		{
+			std::vector<uint32_t> Binary;
+			// Stripped copy the module is created from, empty if the debug info is kept
+			std::vector<uint32_t> ModuleBinary;
+			std::string CacheKey;
+			ShaderStageStatistics Statistics{};
+		};
+
+		static std::unordered_map<VkShaderStageFlagBits, std::string> PreProcess(const std::string& sources);
+		// Thread safe, uses its own compiler and optimizer and only touches the cache file of this stage
+		static bool CompileOrGetStageBinary(const std::string& code, VkShaderStageFlagBits stage, const std::string& debugName, const ShaderDefines& defines,
+			const ShaderOptimizationSettings& settings, StageCompileResult& outResult);
+		// The stripped copy is cached next to the full binary, which reflection still needs
+		static void LoadOrStripModuleBinary(const std::filesystem::path& cachedPath, const std::string& entryName, VkShaderStageFlagBits stage, const std::string& debugName, StageCompileResult& outResult);
+		// Binaries are cached per stage under a hash of the stage source, compile options and defines, see Utils::Shader::GetVKCacheDirectory
+		bool CompileOrGetVulkanBinaries(std::unordered_map<VkShaderStageFlagBits, std::string> sources);
+
+		// Layout state built from a reflection record, kept apart from the shader until it is known to fit the existing pipelines
+		struct ReflectedLayout
+		{
+			std::map<uint32_t, DescriptorLayoutInfo> SetLayouts;
+			std::set<uint32_t> BindlessSets;
+			std::map<uint32_t, size_t> SetLayoutHashes;
+			std::unordered_map<std::string, Ref<ShaderResourceDescription>> Resources;
+			VertexInputDescription VertexInput{};
+			std::vector<VkPushConstantRange> PushConstantRanges;
+			std::vector<std::string> PushConstantBlocks;
+			std::unordered_map<VkShaderStageFlagBits, std::vector<ShaderSpecializationConstant>> SpecializationConstants;
+		};
+
+		// Result of a PrepareRecompile, waiting for ApplyPendingRecompile on the main thread
+		struct PendingRecompile
+		{
+			std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>> Binaries;
+			std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>> ModuleBinaries;
+			std::string CacheKey;
+			ShaderReflectionData Reflection{};
+			ShaderCompileStatistics Statistics{};
+		};
+
+		static void SortLayoutInfoBindings(DescriptorLayoutInfo& layoutInfo);
+
+		// Uses the reflection record cached under m_CacheKey if there is one, SPIRV-Reflect is only run on a miss
 		bool Reflect();
-		bool ReflectVertexStage(const std::vector<uint32_t>* moduleData, bool printDebug = false);
-
+		static bool LoadOrReflect(const std::string& debugName, const std::string& cacheKey, const ShaderOptimizationSettings& settings, const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& binaries, ShaderReflectionData& outReflection);
+		static bool ReflectModules(const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& binaries, ShaderReflectionData& outReflection);
+		static bool ReflectVertexStage(const std::vector<uint32_t>* moduleData, ShaderReflectionData& outReflection, bool printDebug = false);
+		static void BuildLayout(const ShaderReflectionData& reflection, ReflectedLayout& outLayout);
+		// Descriptor sets and vertex input have to stay the same once the shader is used by pipelines
+		bool IsLayoutCompatible(const ReflectedLayout& layout) const;
+		void CommitLayout(ReflectedLayout& layout);
+		void CreateModules();
 
 	private:
 		ShaderHandle m_Handle;
 		const std::filesystem::path m_SPVPath = "";
 		std::string m_DebugName;
+		ShaderDefines m_Defines;
+		// Combined key of all stage binaries, empty if the shader was not compiled through the cache
+		std::string m_CacheKey;
 		Ref<Pipeline> m_Pipeline = nullptr;
 		Ref<ComputePipeline> m_ComputePipeline = nullptr;
-		std::unordered_map<VkShaderStageFlagBits, std::map<uint32_t, size_t>> m_LayoutInfoHashes;
+		std::map<uint32_t, size_t> m_SetLayoutHashes;
+		bool m_Reflected = false;
 
 		std::unordered_map<std::string, Ref<ShaderResourceDescription>> m_ShaderResourceDescriptions;
 		std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>> m_SourceCodes;
+		// Stripped per stage if ShaderOptimizationSettings::StripDebugInfo is set, see CreateModules
+		std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>> m_ModuleCodes;
 		std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_Modules;
 		std::map<uint32_t, VkDescriptorSetLayout> m_DescriptorSetLayouts;
 		VertexInputDescription m_VertexInputDescription{};
+		ShaderCompileStatistics m_CompileStatistics{};
+		std::vector<VkPushConstantRange> m_PushConstantRanges;
+		std::vector<std::string> m_PushConstantBlocks;
+		std::unordered_map<VkShaderStageFlagBits, std::vector<ShaderSpecializationConstant>> m_SpecializationConstants;
+
+		std::mutex m_PendingRecompileMutex;
+		Scope<PendingRecompile> m_PendingRecompile;
 	};
 }
@@ -0,0 +1,339 @@
+#include "pxpch.h"
+#include "VulkanShaderCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <type_traits>
+
+#include "xxHash.h"
+
+
+namespace Povox {
+
+	namespace VulkanShaderCache {
+
+		// Bump whenever the way binaries are compiled or reflected changes without the keys noticing
+		static constexpr uint32_t CacheVersion = 4;
+		static constexpr uint32_t SPIRVMagicNumber = 0x07230203;
+		static constexpr uint32_t ReflectionMagicNumber = 0x46525850; // "PXRF"
+
+		// Held while a finished file is moved into the cache directory and while stale entries are pruned from it
+		static std::mutex s_DirectoryMutex;
+
+		static std::string HashToString(XXH128_hash_t hash)
+		{
+			std::stringstream key;
+			key << std::hex << std::setfill('0') << std::setw(16) << hash.high64 << std::setw(16) << hash.low64;
+			return key.str();
+		}
+
+		static bool ReadFile(const std::filesystem::path& path, std::string& outData)
+		{
+			std::ifstream in(path, std::ios::in | std::ios::binary);
+			if (!in.is_open())
+				return false;
+
+			in.seekg(0, std::ios::end);
+			outData.resize(static_cast<size_t>(in.tellg()));
+			in.seekg(0, std::ios::beg);
+			in.read(outData.data(), outData.size());
+			return in.good();
+		}
+
+		static void WriteFile(const std::filesystem::path& path, const char* data, size_t size)
+		{
+			// Written next to the final file first, a crashed or concurrent write never leaves a truncated file behind
+			std::filesystem::path tempPath = path;
+			tempPath += ".tmp";
+			{
+				std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ofstream::trunc);
+				if (!out.is_open())
+				{
+					PX_CORE_WARN("VulkanShaderCache: Could not write '{0}'!", tempPath.string());
+					return;
+				}
+				out.write(data, size);
+			}
+
+			std::error_code error;
+			std::scoped_lock<std::mutex> lock(s_DirectoryMutex);
+			std::filesystem::rename(tempPath, path, error);
+			if (error)
+				PX_CORE_WARN("VulkanShaderCache: Could not write '{0}': {1}", path.string(), error.message());
+		}
+
+		class CacheWriter
+		{
+		public:
+			template<typename T>
+			void Write(const T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written directly!");
+				m_Data.append((const char*)&value, sizeof(T));
+			}
+
+			void WriteString(const std::string& string)
+			{
+				Write(static_cast<uint32_t>(string.size()));
+				m_Data.append(string);
+			}
+
+			inline const std::string& GetData() const { return m_Data; }
+
+		private:
+			std::string m_Data;
+		};
+
+		class CacheReader
+		{
+		public:
+			CacheReader(const std::string& data)
+				: m_Data(data) {}
+
+			template<typename T>
+			bool Read(T& value)
+			{
+				static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read directly!");
+				if (m_Offset + sizeof(T) > m_Data.size())
+					return false;
+				memcpy(&value, m_Data.data() + m_Offset, sizeof(T));
+				m_Offset += sizeof(T);
+				return true;
+			}
+
+			bool ReadString(std::string& string)
+			{
+				uint32_t size = 0;
+				if (!Read(size) || m_Offset + size > m_Data.size())
+					return false;
+				string.assign(m_Data.data() + m_Offset, size);
+				m_Offset += size;
+				return true;
+			}
+
+			// Reads an element count and checks that elements of at least minElementSize bytes each can still be in the data, before anything is sized from it
+			bool ReadCount(uint32_t& count, size_t minElementSize)
+			{
+				return Read(count) && (size_t)count * minElementSize <= m_Data.size() - m_Offset;
+			}
+
+			inline bool IsAtEnd() const { return m_Offset == m_Data.size(); }
+
+		private:
+			const std::string& m_Data;
+			size_t m_Offset = 0;
+		};
+
+
+		std::string GetStageKey(const std::string& source, VkShaderStageFlagBits stage, const std::string& optionsFingerprint)
+		{
+			XXH3_state_t* state = XXH3_createState();
+			XXH3_128bits_reset(state);
+			XXH3_128bits_update(state, &CacheVersion, sizeof(CacheVersion));
+			XXH3_128bits_update(state, &stage, sizeof(stage));
+			XXH3_128bits_update(state, optionsFingerprint.data(), optionsFingerprint.size());
+			XXH3_128bits_update(state, source.data(), source.size());
+			XXH128_hash_t hash = XXH3_128bits_digest(state);
+			XXH3_freeState(state);
+
+			return HashToString(hash);
+		}
+
+		std::string CombineStageKeys(const std::map<VkShaderStageFlagBits, std::string>& stageKeys)
+		{
+			std::string combined;
+			for (const auto& [stage, key] : stageKeys)
+				combined += key;
+
+			return HashToString(XXH3_128bits(combined.data(), combined.size()));
+		}
+
+		std::string GetOptionsKey(const std::string& optionsFingerprint)
+		{
+			std::stringstream key;
+			key << std::hex << std::setfill('0') << std::setw(16) << XXH3_64bits(optionsFingerprint.data(), optionsFingerprint.size());
+			return key.str();
+		}
+
+		bool ReadBinary(const std::filesystem::path& path, std::vector<uint32_t>& outData)
+		{
+			std::string file;
+			if (!ReadFile(path, file))
+				return false;
+			if (file.size() < sizeof(uint32_t) || file.size() % sizeof(uint32_t) != 0)
+				return false;
+
+			outData.resize(file.size() / sizeof(uint32_t));
+			memcpy(outData.data(), file.data(), file.size());
+			return outData[0] == SPIRVMagicNumber;
+		}
+
+		void WriteBinary(const std::filesystem::path& path, const std::vector<uint32_t>& data)
+		{
+			WriteFile(path, (const char*)data.data(), data.size() * sizeof(uint32_t));
+		}
+
+		bool ReadReflection(const std::filesystem::path& path, ShaderReflectionData& outData)
+		{
+			std::string file;
+			if (!ReadFile(path, file))
+				return false;
+
+			CacheReader reader(file);
+			uint32_t magic = 0, version = 0;
+			if (!reader.Read(magic) || !reader.Read(version) || magic != ReflectionMagicNumber || version != CacheVersion)
+				return false;
+
+			ShaderReflectionData data{};
+			// Smallest serialized size of each element, counts of a corrupt file can not make the vectors below larger than the file
+			constexpr size_t stageSize = sizeof(VkShaderStageFlagBits) + 3 * sizeof(uint32_t);
+			constexpr size_t bindingSize = 4 * sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+			constexpr size_t constantSize = sizeof(uint32_t) + sizeof(ShaderDataType) + sizeof(uint32_t);
+			constexpr size_t pushConstantSize = sizeof(VkPushConstantRange) + sizeof(uint32_t);
+
+			uint32_t stageCount = 0;
+			if (!reader.ReadCount(stageCount, stageSize))
+				return false;
+			data.Stages.resize(stageCount);
+			for (auto& stage : data.Stages)
+			{
+				uint32_t setCount = 0, bindingCount = 0;
+				if (!reader.Read(stage.Stage) || !reader.ReadCount(setCount, sizeof(uint32_t)))
+					return false;
+				stage.Sets.resize(setCount);
+				for (auto& set : stage.Sets)
+				{
+					if (!reader.Read(set))
+						return false;
+				}
+
+				if (!reader.ReadCount(bindingCount, bindingSize))
+					return false;
+				stage.Bindings.resize(bindingCount);
+				for (auto& binding : stage.Bindings)
+				{
+					uint8_t runtimeArray = 0;
+					if (!reader.Read(binding.Set) || !reader.Read(binding.Binding) || !reader.Read(binding.Type) || !reader.Read(binding.Count)
+						|| !reader.Read(runtimeArray) || !reader.ReadString(binding.Name))
+						return false;
+					binding.RuntimeArray = runtimeArray != 0;
+				}
+
+				uint32_t constantCount = 0;
+				if (!reader.ReadCount(constantCount, constantSize))
+					return false;
+				stage.SpecializationConstants.resize(constantCount);
+				for (auto& constant : stage.SpecializationConstants)
+				{
+					if (!reader.Read(constant.ConstantID) || !reader.Read(constant.Type) || !reader.ReadString(constant.Name))
+						return false;
+				}
+			}
+
+			uint32_t attributeCount = 0, pushConstantCount = 0;
+			if (!reader.Read(data.VertexInputCount) || !reader.ReadCount(attributeCount, sizeof(VkVertexInputAttributeDescription)))
+				return false;
+			data.VertexAttributes.resize(attributeCount);
+			for (auto& attribute : data.VertexAttributes)
+			{
+				if (!reader.Read(attribute))
+					return false;
+			}
+
+			if (!reader.ReadCount(pushConstantCount, pushConstantSize))
+				return false;
+			data.PushConstantRanges.resize(pushConstantCount);
+			data.PushConstantBlocks.resize(pushConstantCount);
+			for (uint32_t i = 0; i < pushConstantCount; i++)
+			{
+				if (!reader.Read(data.PushConstantRanges[i]) || !reader.ReadString(data.PushConstantBlocks[i]))
+					return false;
+			}
+
+			if (!reader.IsAtEnd())
+				return false;
+
+			outData = std::move(data);
+			return true;
+		}
+
+		void WriteReflection(const std::filesystem::path& path, const ShaderReflectionData& data)
+		{
+			CacheWriter writer;
+			writer.Write(ReflectionMagicNumber);
+			writer.Write(CacheVersion);
+
+			writer.Write(static_cast<uint32_t>(data.Stages.size()));
+			for (const auto& stage : data.Stages)
+			{
+				writer.Write(stage.Stage);
+				writer.Write(static_cast<uint32_t>(stage.Sets.size()));
+				for (uint32_t set : stage.Sets)
+					writer.Write(set);
+
+				writer.Write(static_cast<uint32_t>(stage.Bindings.size()));
+				for (const auto& binding : stage.Bindings)
+				{
+					writer.Write(binding.Set);
+					writer.Write(binding.Binding);
+					writer.Write(binding.Type);
+					writer.Write(binding.Count);
+					writer.Write(static_cast<uint8_t>(binding.RuntimeArray));
+					writer.WriteString(binding.Name);
+				}
+
+				writer.Write(static_cast<uint32_t>(stage.SpecializationConstants.size()));
+				for (const auto& constant : stage.SpecializationConstants)
+				{
+					writer.Write(constant.ConstantID);
+					writer.Write(constant.Type);
+					writer.WriteString(constant.Name);
+				}
+			}
+
+			writer.Write(data.VertexInputCount);
+			writer.Write(static_cast<uint32_t>(data.VertexAttributes.size()));
+			for (const auto& attribute : data.VertexAttributes)
+				writer.Write(attribute);
+
+			writer.Write(static_cast<uint32_t>(data.PushConstantRanges.size()));
+			for (size_t i = 0; i < data.PushConstantRanges.size(); i++)
+			{
+				writer.Write(data.PushConstantRanges[i]);
+				writer.WriteString(data.PushConstantBlocks[i]);
+			}
+
+			const std::string& file = writer.GetData();
+			WriteFile(path, file.data(), file.size());
+		}
+
+		void RemoveStaleEntries(const std::filesystem::path& path, const std::string& entryName, const std::string& extension)
+		{
+			// Entries of one shader only differ in their key, which always has the same length. Variants add their own suffix to the name, so they never match
+			const std::string keptName = path.filename().string();
+			const std::string prefix = entryName + "_";
+			if (keptName.size() < prefix.size() + extension.size())
+				return;
+			const size_t keyLength = keptName.size() - prefix.size() - extension.size();
+
+			std::scoped_lock<std::mutex> lock(s_DirectoryMutex);
+			std::error_code error;
+			for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error))
+			{
+				const std::string name = entry.path().filename().string();
+				if (name == keptName || name.size() != keptName.size() || name.compare(0, prefix.size(), prefix) != 0 || name.compare(prefix.size() + keyLength, extension.size(), extension) != 0)
+					continue;
+
+				const std::string key = name.substr(prefix.size(), keyLength);
+				if (key.find_first_not_of("0123456789abcdef") != std::string::npos)
+					continue;
+
+				std::error_code removeError;
+				if (std::filesystem::remove(entry.path(), removeError))
+					PX_CORE_TRACE("VulkanShaderCache: Removed stale entry '{0}'", name);
+			}
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Povox/Renderer/Shader.h"
+
+#include <vulkan/vulkan.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Povox {
+
+	/**
+	 * Everything VulkanShader takes from SPIRV-Reflect, in the order it was reflected.
+	 * Serialized next to the cached SPIR-V, a cache hit rebuilds resource descriptions and descriptor layouts from this without touching SPIRV-Reflect.
+	 */
+	struct ShaderReflectionData
+	{
+		struct Binding
+		{
+			uint32_t Set = 0;
+			uint32_t Binding = 0;
+			// As reflected, dynamic types are derived from the set when the layout is built
+			VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+			uint32_t Count = 1;
+			bool RuntimeArray = false;
+			std::string Name;
+		};
+
+		struct Stage
+		{
+			VkShaderStageFlagBits Stage = VK_SHADER_STAGE_VERTEX_BIT;
+			std::vector<uint32_t> Sets;
+			std::vector<Binding> Bindings;
+			std::vector<ShaderSpecializationConstant> SpecializationConstants;
+		};
+
+		std::vector<Stage> Stages;
+
+		// Including built-ins, attributes only contain the user defined inputs with location and format set
+		uint32_t VertexInputCount = 0;
+		std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+
+		std::vector<VkPushConstantRange> PushConstantRanges;
+		// Type name of the block each range was declared with, e.g. ObjectUniform
+		std::vector<std::string> PushConstantBlocks;
+	};
+
+	namespace VulkanShaderCache {
+
+		// Names a cached stage binary after everything that goes into it, a changed source or option set simply misses the cache
+		std::string GetStageKey(const std::string& source, VkShaderStageFlagBits stage, const std::string& optionsFingerprint);
+		// Key of a whole shader, reflection data is cached under it
+		std::string CombineStageKeys(const std::map<VkShaderStageFlagBits, std::string>& stageKeys);
+		// Short hash of the compile options, part of every entry's name so entries of other option sets are never pruned
+		std::string GetOptionsKey(const std::string& optionsFingerprint);
+
+		bool ReadBinary(const std::filesystem::path& path, std::vector<uint32_t>& outData);
+		void WriteBinary(const std::filesystem::path& path, const std::vector<uint32_t>& data);
+
+		bool ReadReflection(const std::filesystem::path& path, ShaderReflectionData& outData);
+		void WriteReflection(const std::filesystem::path& path, const ShaderReflectionData& data);
+
+		// Deletes the files next to path that were cached for the same entry name and extension under another key, called after a new key was written.
+		// The entry name is the shader's name followed by its options key. Serialized with the writes, stages are compiled and cached concurrently
+		void RemoveStaleEntries(const std::filesystem::path& path, const std::string& entryName, const std::string& extension);
+	}
+}
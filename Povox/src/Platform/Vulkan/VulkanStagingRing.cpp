@@ -0,0 +1,243 @@
+#include "pxpch.h"
+#include "VulkanStagingRing.h"
+
+#include "Platform/Vulkan/VulkanContext.h"
+#include "Platform/Vulkan/VulkanDebug.h"
+
+
+namespace Povox {
+
+	VulkanStagingRing::VulkanStagingRing(uint32_t framesInFlight, size_t frameCapacity)
+		: m_FrameCapacity(frameCapacity)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_INFO("VulkanStagingRing: Creating {0} staging frames with {1} bytes each...", framesInFlight, frameCapacity);
+
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		const auto& limits = VulkanContext::GetDevice()->GetPhysicalDeviceProperties().limits;
+		m_Alignment = std::max<size_t>(m_Alignment, limits.optimalBufferCopyOffsetAlignment);
+
+		VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		bufferInfo.pNext = nullptr;
+		bufferInfo.size = m_FrameCapacity;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationCreateInfo vmaAllocInfo{};
+		vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+		vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		poolInfo.pNext = nullptr;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = VulkanContext::GetDevice()->GetQueueFamilies().GraphicsFamilyIndex;
+
+		m_Frames.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++)
+		{
+			StagingFrame& frame = m_Frames[i];
+
+			VmaAllocationInfo allocInfo{};
+			PX_CORE_VK_ASSERT(vmaCreateBuffer(VulkanContext::GetAllocator(), &bufferInfo, &vmaAllocInfo, &frame.Staging.Buffer, &frame.Staging.Allocation, &allocInfo), VK_SUCCESS, "Failed to create staging ring buffer!");
+			frame.Mapped = allocInfo.pMappedData;
+			PX_CORE_ASSERT(frame.Mapped, "Staging ring buffer is not persistently mapped!");
+
+			PX_CORE_VK_ASSERT(vkCreateCommandPool(device, &poolInfo, nullptr, &frame.Pool), VK_SUCCESS, "Failed to create staging ring command pool!");
+
+#ifdef PX_DEBUG
+			VkDebugUtilsObjectNameInfoEXT bufInfo{};
+			bufInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+			bufInfo.objectType = VK_OBJECT_TYPE_BUFFER;
+			bufInfo.objectHandle = (uint64_t)frame.Staging.Buffer;
+			std::string bufferName = "StagingRing_Frame" + std::to_string(i);
+			bufInfo.pObjectName = bufferName.c_str();
+			NameVkObject(device, bufInfo);
+
+			VkDebugUtilsObjectNameInfoEXT poolNameInfo{};
+			poolNameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+			poolNameInfo.objectType = VK_OBJECT_TYPE_COMMAND_POOL;
+			poolNameInfo.objectHandle = (uint64_t)frame.Pool;
+			std::string poolName = "StagingRingPool_Frame" + std::to_string(i);
+			poolNameInfo.pObjectName = poolName.c_str();
+			NameVkObject(device, poolNameInfo);
+#endif // DEBUG
+		}
+
+		PX_CORE_INFO("VulkanStagingRing: Completed creation.");
+	}
+
+	void VulkanStagingRing::Destroy()
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		VmaAllocator allocator = VulkanContext::GetAllocator();
+
+		for (auto& frame : m_Frames)
+		{
+			for (VkSemaphore semaphore : frame.FlushSemaphores)
+				vkDestroySemaphore(device, semaphore, nullptr);
+			vkDestroyCommandPool(device, frame.Pool, nullptr);
+			vmaDestroyBuffer(allocator, frame.Staging.Buffer, frame.Staging.Allocation);
+		}
+		m_Frames.clear();
+		m_Recording = false;
+	}
+
+	void VulkanStagingRing::BeginFrame(uint32_t frameIndex)
+	{
+		PX_CORE_ASSERT(frameIndex < m_Frames.size(), "Frame index out of range!");
+
+		m_CurrentFrameIndex = frameIndex;
+		StagingFrame& frame = m_Frames[frameIndex];
+
+		// The frame slot's previous frame has completed on the GPU, so it is done with this staging range, its command buffers and semaphores
+		PX_CORE_VK_ASSERT(vkResetCommandPool(VulkanContext::GetDevice()->GetVulkanDevice(), frame.Pool, 0), VK_SUCCESS, "Failed to reset staging ring command pool!");
+		frame.Head = 0;
+		frame.NextUploadBuffer = 0;
+		frame.NextFlushSemaphore = 0;
+		frame.ActiveUploadBuffer = VK_NULL_HANDLE;
+
+		m_Recording = true;
+	}
+
+	VkCommandBuffer VulkanStagingRing::EndFrame()
+	{
+		m_Recording = false;
+
+		StagingFrame& frame = m_Frames[m_CurrentFrameIndex];
+		VkCommandBuffer uploadBuffer = frame.ActiveUploadBuffer;
+		if (uploadBuffer == VK_NULL_HANDLE)
+			return VK_NULL_HANDLE;
+
+		EndUploadCommands();
+		return uploadBuffer;
+	}
+
+	VkSemaphore VulkanStagingRing::Flush()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		if (!m_Recording)
+			return VK_NULL_HANDLE;
+
+		StagingFrame& frame = m_Frames[m_CurrentFrameIndex];
+		VkCommandBuffer uploadBuffer = frame.ActiveUploadBuffer;
+		if (uploadBuffer == VK_NULL_HANDLE)
+			return VK_NULL_HANDLE;
+
+		EndUploadCommands();
+
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		if (frame.NextFlushSemaphore == frame.FlushSemaphores.size())
+		{
+			VkSemaphoreCreateInfo semaInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			VkSemaphore semaphore;
+			PX_CORE_VK_ASSERT(vkCreateSemaphore(device, &semaInfo, nullptr, &semaphore), VK_SUCCESS, "Failed to create staging ring flush semaphore!");
+			frame.FlushSemaphores.push_back(semaphore);
+		}
+		VkSemaphore signalSemaphore = frame.FlushSemaphores[frame.NextFlushSemaphore++];
+
+		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.pNext = nullptr;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &uploadBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signalSemaphore;
+
+		// No fence, the frame's timeline signal is submitted later on the same queue and covers this batch
+		PX_CORE_VK_ASSERT(vkQueueSubmit(VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE), VK_SUCCESS, "Failed to submit staging ring upload buffer!");
+
+		return signalSemaphore;
+	}
+
+	bool VulkanStagingRing::RecordBufferUpload(VkBuffer dstBuffer, size_t dstOffset, const void* data, size_t size)
+	{
+		if (!m_Recording)
+			return false;
+
+		StagingFrame& frame = m_Frames[m_CurrentFrameIndex];
+		size_t offset = (frame.Head + m_Alignment - 1) & ~(m_Alignment - 1);
+		if (offset + size > m_FrameCapacity)
+		{
+			PX_CORE_WARN("VulkanStagingRing::RecordBufferUpload: Ring is full ({0} of {1} bytes used), falling back to immediate upload!", frame.Head, m_FrameCapacity);
+			return false;
+		}
+
+		if (frame.ActiveUploadBuffer == VK_NULL_HANDLE)
+			BeginUploadCommands();
+
+		memcpy((char*)frame.Mapped + offset, data, size);
+		frame.Head = offset + size;
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = offset;
+		copyRegion.dstOffset = dstOffset;
+		copyRegion.size = size;
+		vkCmdCopyBuffer(frame.ActiveUploadBuffer, frame.Staging.Buffer, dstBuffer, 1, &copyRegion);
+
+		return true;
+	}
+
+	void VulkanStagingRing::BeginUploadCommands()
+	{
+		StagingFrame& frame = m_Frames[m_CurrentFrameIndex];
+
+		if (frame.NextUploadBuffer == frame.UploadBuffers.size())
+		{
+			VkCommandBufferAllocateInfo bufferAllocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			bufferAllocateInfo.pNext = nullptr;
+			bufferAllocateInfo.commandPool = frame.Pool;
+			bufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			bufferAllocateInfo.commandBufferCount = 1;
+
+			VkCommandBuffer cmd;
+			PX_CORE_VK_ASSERT(vkAllocateCommandBuffers(VulkanContext::GetDevice()->GetVulkanDevice(), &bufferAllocateInfo, &cmd), VK_SUCCESS, "Failed to create staging ring upload CommandBuffer!");
+			frame.UploadBuffers.push_back(cmd);
+		}
+		frame.ActiveUploadBuffer = frame.UploadBuffers[frame.NextUploadBuffer++];
+
+		VkCommandBufferBeginInfo cmdBeginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		cmdBeginInfo.pNext = nullptr;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cmdBeginInfo.pInheritanceInfo = nullptr;
+		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(frame.ActiveUploadBuffer, &cmdBeginInfo), VK_SUCCESS, "Failed to begin staging ring upload buffer!");
+
+		// Frames still in flight may read the destinations, copies must not overtake them (WAR, execution dependency only)
+		VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+		barrier.pNext = nullptr;
+		barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		barrier.srcAccessMask = 0;
+		barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		barrier.dstAccessMask = 0;
+
+		VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		dependency.memoryBarrierCount = 1;
+		dependency.pMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(frame.ActiveUploadBuffer, &dependency);
+	}
+
+	void VulkanStagingRing::EndUploadCommands()
+	{
+		StagingFrame& frame = m_Frames[m_CurrentFrameIndex];
+
+		// Make all copies recorded into this buffer visible to every consumer in one go
+		VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+		barrier.pNext = nullptr;
+		barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		barrier.dstStageMask = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT
+			| VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		barrier.dstAccessMask = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT
+			| VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+
+		VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		dependency.memoryBarrierCount = 1;
+		dependency.pMemoryBarriers = &barrier;
+		vkCmdPipelineBarrier2(frame.ActiveUploadBuffer, &dependency);
+
+		PX_CORE_VK_ASSERT(vkEndCommandBuffer(frame.ActiveUploadBuffer), VK_SUCCESS, "Failed to end staging ring upload buffer!");
+		frame.ActiveUploadBuffer = VK_NULL_HANDLE;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Platform/Vulkan/VulkanBuffer.h"
+
+#include <vulkan/vulkan.h>
+
+namespace Povox {
+
+	/**
+	 * Persistently mapped staging memory, one linear ring per frame in flight.
+	 * Copies are recorded into a per-frame upload command buffer which is submitted in front of the frame's render commands,
+	 * so the frame's graphics timeline value protects both the staging memory and the command buffer. No CPU waits on the hot path.
+	 */
+	class VulkanStagingRing
+	{
+	public:
+		VulkanStagingRing(uint32_t framesInFlight, size_t frameCapacity);
+		~VulkanStagingRing() = default;
+
+		void Destroy();
+
+		// Has to be called after the frame slot's previous frame has completed
+		void BeginFrame(uint32_t frameIndex);
+		// Returns the recorded upload command buffer or VK_NULL_HANDLE if nothing was uploaded this frame
+		VkCommandBuffer EndFrame();
+		// Submits pending uploads to the graphics queue ahead of time for consumers that are submitted before the frame (compute).
+		// Returns the semaphore signaled by that submit or VK_NULL_HANDLE if nothing was pending
+		VkSemaphore Flush();
+
+		// Returns false if no frame is recording or the ring has no space left, caller has to fall back to an immediate upload
+		bool RecordBufferUpload(VkBuffer dstBuffer, size_t dstOffset, const void* data, size_t size);
+
+		inline bool IsRecording() const { return m_Recording; }
+		inline size_t GetFrameCapacity() const { return m_FrameCapacity; }
+		inline size_t GetUsedBytes(uint32_t frameIndex) const { return m_Frames[frameIndex].Head; }
+
+	private:
+		void BeginUploadCommands();
+		void EndUploadCommands();
+
+	private:
+		struct StagingFrame
+		{
+			AllocatedBuffer Staging{};
+			void* Mapped = nullptr;
+			size_t Head = 0;
+
+			VkCommandPool Pool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> UploadBuffers;
+			uint32_t NextUploadBuffer = 0;
+			VkCommandBuffer ActiveUploadBuffer = VK_NULL_HANDLE;
+
+			std::vector<VkSemaphore> FlushSemaphores;
+			uint32_t NextFlushSemaphore = 0;
+		};
+		std::vector<StagingFrame> m_Frames;
+
+		size_t m_FrameCapacity = 0;
+		size_t m_Alignment = 16;
+		uint32_t m_CurrentFrameIndex = 0;
+		bool m_Recording = false;
+	};
+}
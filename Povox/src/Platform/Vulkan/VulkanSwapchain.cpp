@@ -405,21 +405,38 @@ namespace Povox {
 		PX_PROFILE_FUNCTION();
 
 
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		PX_CORE_ASSERT(m_CurrentFrame.WaitSemaphores.size() == m_CurrentFrame.WaitStages.size(), "Every wait semaphore needs a wait stage!");
+		PX_CORE_ASSERT(m_CurrentFrame.WaitSemaphores.size() == m_CurrentFrame.WaitValues.size(), "Every wait semaphore needs a wait value!");
+
+		std::vector<VkSemaphore> signalSemaphores = { m_CurrentFrame.RenderSemaphore };
+		std::vector<uint64_t> signalValues = { 0 };
+		if (m_CurrentFrame.TimelineSemaphore != VK_NULL_HANDLE)
+		{
+			signalSemaphores.push_back(m_CurrentFrame.TimelineSemaphore);
+			signalValues.push_back(m_CurrentFrame.TimelineValue);
+		}
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+		timelineInfo.pNext = nullptr;
+		timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(m_CurrentFrame.WaitValues.size());
+		timelineInfo.pWaitSemaphoreValues = m_CurrentFrame.WaitValues.data();
+		timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
 		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-		submitInfo.pNext = nullptr;
+		submitInfo.pNext = &timelineInfo;
 		
 		submitInfo.commandBufferCount = static_cast<uint32_t>(m_CurrentFrame.Commands.size());
 		submitInfo.pCommandBuffers = m_CurrentFrame.Commands.data();
 
-		submitInfo.pWaitDstStageMask = waitStages;		
+		submitInfo.pWaitDstStageMask = m_CurrentFrame.WaitStages.data();
 		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(m_CurrentFrame.WaitSemaphores.size());
 		submitInfo.pWaitSemaphores = m_CurrentFrame.WaitSemaphores.data();
 
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &m_CurrentFrame.RenderSemaphore;
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
 
-		PX_CORE_VK_ASSERT(vkQueueSubmit(VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue, 1, &submitInfo, m_CurrentFrame.CurrentFence), VK_SUCCESS, "Failed to submit draw render buffer!");
+		PX_CORE_VK_ASSERT(vkQueueSubmit(VulkanContext::GetDevice()->GetQueueFamilies().Queues.GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE), VK_SUCCESS, "Failed to submit draw render buffer!");
 	}
 
 	void VulkanSwapchain::Present()
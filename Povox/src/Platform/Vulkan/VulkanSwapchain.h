@@ -15,9 +15,13 @@ namespace Povox {
 		VkImage CurrentImage = VK_NULL_HANDLE;
 		VkImageView CurrentImageView = VK_NULL_HANDLE;
 
-		VkFence CurrentFence = VK_NULL_HANDLE;
 		std::vector<VkSemaphore> WaitSemaphores;
+		std::vector<VkPipelineStageFlags> WaitStages; // One per WaitSemaphore
+		std::vector<uint64_t> WaitValues; // One per WaitSemaphore, 0 for binary semaphores
 		VkSemaphore RenderSemaphore = VK_NULL_HANDLE;
+		// Signaled with TimelineValue once the frame's graphics commands finished, other queues and the CPU wait on it
+		VkSemaphore TimelineSemaphore = VK_NULL_HANDLE;
+		uint64_t TimelineValue = 0;
 
 		std::vector<VkCommandBuffer> Commands;
 	};
@@ -0,0 +1,596 @@
+#include "pxpch.h"
+#include "VulkanTransferScheduler.h"
+
+#include "Platform/Vulkan/VulkanContext.h"
+#include "Platform/Vulkan/VulkanDebug.h"
+
+
+namespace Povox {
+
+	VulkanTransferScheduler::VulkanTransferScheduler(uint32_t framesInFlight, size_t stagingBlockSize)
+		: m_StagingBlockSize(stagingBlockSize)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_INFO("VulkanTransferScheduler: Creating transfer timeline and acquire resources for {0} frames...", framesInFlight);
+
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		const auto& limits = VulkanContext::GetDevice()->GetPhysicalDeviceProperties().limits;
+		m_Alignment = std::max<size_t>(m_Alignment, limits.optimalBufferCopyOffsetAlignment);
+
+		VkSemaphoreTypeCreateInfo typeInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		typeInfo.pNext = nullptr;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		semaInfo.pNext = &typeInfo;
+		PX_CORE_VK_ASSERT(vkCreateSemaphore(device, &semaInfo, nullptr, &m_TransferTimeline), VK_SUCCESS, "Failed to create transfer timeline semaphore!");
+		PX_CORE_VK_ASSERT(vkCreateSemaphore(device, &semaInfo, nullptr, &m_AcquireTimeline), VK_SUCCESS, "Failed to create transfer acquire timeline semaphore!");
+
+		VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		poolInfo.pNext = nullptr;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		m_AcquireFrames.resize(framesInFlight);
+		for (uint32_t i = 0; i < framesInFlight; i++)
+		{
+			for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+			{
+				poolInfo.queueFamilyIndex = GetFamilyIndex(slot);
+				PX_CORE_VK_ASSERT(vkCreateCommandPool(device, &poolInfo, nullptr, &m_AcquireFrames[i].Pools[slot]), VK_SUCCESS, "Failed to create transfer acquire command pool!");
+			}
+		}
+
+#ifdef PX_DEBUG
+		VkDebugUtilsObjectNameInfoEXT nameInfo{};
+		nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+		nameInfo.objectType = VK_OBJECT_TYPE_SEMAPHORE;
+		nameInfo.objectHandle = (uint64_t)m_TransferTimeline;
+		nameInfo.pObjectName = "TransferTimeline";
+		NameVkObject(device, nameInfo);
+
+		nameInfo.objectHandle = (uint64_t)m_AcquireTimeline;
+		nameInfo.pObjectName = "TransferAcquireTimeline";
+		NameVkObject(device, nameInfo);
+#endif // DEBUG
+
+		PX_CORE_INFO("VulkanTransferScheduler: Completed creation.");
+	}
+
+	void VulkanTransferScheduler::Destroy()
+	{
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		VmaAllocator allocator = VulkanContext::GetAllocator();
+
+		// Nothing recorded after this point is ever consumed, the open batch only has to be ended
+		if (m_HasOpenBatch)
+		{
+			vkEndCommandBuffer(m_OpenBatch.Cmd);
+			m_FreeBatches.push_back(std::move(m_OpenBatch));
+			m_HasOpenBatch = false;
+		}
+
+		std::array<VkSemaphore, 2> semaphores = { m_TransferTimeline, m_AcquireTimeline };
+		std::array<uint64_t, 2> values = { m_SubmittedValue, m_AcquireValue };
+		VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.pNext = nullptr;
+		waitInfo.flags = 0;
+		waitInfo.semaphoreCount = static_cast<uint32_t>(semaphores.size());
+		waitInfo.pSemaphores = semaphores.data();
+		waitInfo.pValues = values.data();
+		vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+
+		while (!m_SubmittedBatches.empty())
+		{
+			m_FreeBatches.push_back(std::move(m_SubmittedBatches.front()));
+			m_SubmittedBatches.pop_front();
+		}
+		for (auto& batch : m_FreeBatches)
+		{
+			for (auto& block : batch.StagingBlocks)
+				vmaDestroyBuffer(allocator, block.Buffer, block.Allocation);
+			vkDestroyCommandPool(device, batch.Pool, nullptr);
+		}
+		m_FreeBatches.clear();
+
+		for (auto& block : m_FreeBlocks)
+			vmaDestroyBuffer(allocator, block.Buffer, block.Allocation);
+		m_FreeBlocks.clear();
+
+		for (auto& frame : m_AcquireFrames)
+		{
+			for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+				vkDestroyCommandPool(device, frame.Pools[slot], nullptr);
+		}
+		m_AcquireFrames.clear();
+
+		vkDestroySemaphore(device, m_TransferTimeline, nullptr);
+		vkDestroySemaphore(device, m_AcquireTimeline, nullptr);
+		m_TransferTimeline = VK_NULL_HANDLE;
+		m_AcquireTimeline = VK_NULL_HANDLE;
+	}
+
+	UploadHandle VulkanTransferScheduler::UploadBuffer(VkBuffer dstBuffer, size_t dstOffset, const void* data, size_t size, QueueFamilyOwnership consumer, bool concurrent)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		TransferBatch& batch = GetOpenBatch();
+
+		size_t srcOffset = 0;
+		VkBuffer staging = AllocateStaging(batch, data, size, srcOffset);
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = srcOffset;
+		copyRegion.dstOffset = dstOffset;
+		copyRegion.size = size;
+		vkCmdCopyBuffer(batch.Cmd, staging, dstBuffer, 1, &copyRegion);
+
+		uint32_t slot = GetSlot(consumer);
+		uint32_t srcFamily = GetFamilyIndex(static_cast<uint32_t>(QueueFamilyOwnership::QFO_TRANSFER));
+		uint32_t dstFamily = GetFamilyIndex(slot);
+		batch.Consumers[slot] = true;
+
+		// Within one family or for concurrent buffers the timeline wait of the hand off makes the copy visible, only a QFOT needs barriers
+		if (srcFamily != dstFamily && !concurrent)
+		{
+			VkBufferMemoryBarrier2 release{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+			release.pNext = nullptr;
+			release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+			release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+			release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+			release.dstAccessMask = 0;
+			release.srcQueueFamilyIndex = srcFamily;
+			release.dstQueueFamilyIndex = dstFamily;
+			release.buffer = dstBuffer;
+			release.offset = dstOffset;
+			release.size = size;
+			batch.BufferReleases.push_back(release);
+
+			VkBufferMemoryBarrier2 acquire = release;
+			acquire.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquire.srcAccessMask = 0;
+			acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+			batch.BufferAcquires[slot].push_back(acquire);
+		}
+
+		return UploadHandle{ batch.Value };
+	}
+
+	UploadHandle VulkanTransferScheduler::UploadImage(VkImage dstImage, VkImageAspectFlags aspect, VkExtent3D extent, const void* data, size_t size, VkImageLayout finalLayout, QueueFamilyOwnership consumer)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		TransferBatch& batch = GetOpenBatch();
+
+		size_t srcOffset = 0;
+		VkBuffer staging = AllocateStaging(batch, data, size, srcOffset);
+
+		VkImageMemoryBarrier2 toTransfer{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+		toTransfer.pNext = nullptr;
+		toTransfer.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+		toTransfer.srcAccessMask = 0;
+		toTransfer.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		toTransfer.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.image = dstImage;
+		toTransfer.subresourceRange.aspectMask = aspect;
+		toTransfer.subresourceRange.baseMipLevel = 0;
+		toTransfer.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+		toTransfer.subresourceRange.baseArrayLayer = 0;
+		toTransfer.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+		VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		dependency.pNext = nullptr;
+		dependency.imageMemoryBarrierCount = 1;
+		dependency.pImageMemoryBarriers = &toTransfer;
+		vkCmdPipelineBarrier2(batch.Cmd, &dependency);
+
+		VkBufferImageCopy copyRegion{};
+		copyRegion.bufferOffset = srcOffset;
+		copyRegion.bufferRowLength = 0;
+		copyRegion.bufferImageHeight = 0;
+		copyRegion.imageSubresource.aspectMask = aspect;
+		copyRegion.imageSubresource.mipLevel = 0;
+		copyRegion.imageSubresource.baseArrayLayer = 0;
+		copyRegion.imageSubresource.layerCount = 1;
+		copyRegion.imageOffset = { 0, 0, 0 };
+		copyRegion.imageExtent = extent;
+		vkCmdCopyBufferToImage(batch.Cmd, staging, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+		uint32_t slot = GetSlot(consumer);
+		uint32_t srcFamily = GetFamilyIndex(static_cast<uint32_t>(QueueFamilyOwnership::QFO_TRANSFER));
+		uint32_t dstFamily = GetFamilyIndex(slot);
+		batch.Consumers[slot] = true;
+
+		// The layout transition is part of the release, or a plain barrier at the end of the batch if no QFOT is needed
+		VkImageMemoryBarrier2 release = toTransfer;
+		release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		release.newLayout = finalLayout;
+		if (srcFamily == dstFamily)
+		{
+			release.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			release.dstAccessMask = 0;
+			batch.ImageReleases.push_back(release);
+		}
+		else
+		{
+			release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+			release.dstAccessMask = 0;
+			release.srcQueueFamilyIndex = srcFamily;
+			release.dstQueueFamilyIndex = dstFamily;
+			batch.ImageReleases.push_back(release);
+
+			VkImageMemoryBarrier2 acquire = release;
+			acquire.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquire.srcAccessMask = 0;
+			acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+			batch.ImageAcquires[slot].push_back(acquire);
+		}
+
+		return UploadHandle{ batch.Value };
+	}
+
+	void VulkanTransferScheduler::Submit()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		if (!m_HasOpenBatch)
+			return;
+
+		TransferBatch& batch = m_OpenBatch;
+		if (!batch.BufferReleases.empty() || !batch.ImageReleases.empty())
+		{
+			VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+			dependency.pNext = nullptr;
+			dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(batch.BufferReleases.size());
+			dependency.pBufferMemoryBarriers = batch.BufferReleases.data();
+			dependency.imageMemoryBarrierCount = static_cast<uint32_t>(batch.ImageReleases.size());
+			dependency.pImageMemoryBarriers = batch.ImageReleases.data();
+			vkCmdPipelineBarrier2(batch.Cmd, &dependency);
+		}
+		PX_CORE_VK_ASSERT(vkEndCommandBuffer(batch.Cmd), VK_SUCCESS, "Failed to end transfer batch!");
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+		timelineInfo.pNext = nullptr;
+		timelineInfo.waitSemaphoreValueCount = 0;
+		timelineInfo.pWaitSemaphoreValues = nullptr;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &batch.Value;
+
+		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.Cmd;
+		submitInfo.waitSemaphoreCount = 0;
+		submitInfo.pWaitSemaphores = nullptr;
+		submitInfo.pWaitDstStageMask = nullptr;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &m_TransferTimeline;
+
+		PX_CORE_VK_ASSERT(vkQueueSubmit(GetQueue(static_cast<uint32_t>(QueueFamilyOwnership::QFO_TRANSFER)), 1, &submitInfo, VK_NULL_HANDLE), VK_SUCCESS, "Failed to submit transfer batch!");
+
+		m_SubmittedValue = batch.Value;
+		batch.BufferReleases.clear();
+		batch.ImageReleases.clear();
+		m_SubmittedBatches.push_back(std::move(m_OpenBatch));
+		m_OpenBatch = TransferBatch{};
+		m_HasOpenBatch = false;
+	}
+
+	void VulkanTransferScheduler::Update(uint32_t frameIndex)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_ASSERT(frameIndex < m_AcquireFrames.size(), "Frame index out of range!");
+
+		m_CurrentFrameIndex = frameIndex;
+		AcquireFrame& frame = m_AcquireFrames[frameIndex];
+
+		// Usually finished long ago, the frame's own fences do not cover hand offs on queues it did not submit to
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		if (frame.LastAcquireValue > 0)
+		{
+			VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+			waitInfo.pNext = nullptr;
+			waitInfo.flags = 0;
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &m_AcquireTimeline;
+			waitInfo.pValues = &frame.LastAcquireValue;
+			vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+		}
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			PX_CORE_VK_ASSERT(vkResetCommandPool(device, frame.Pools[slot], 0), VK_SUCCESS, "Failed to reset transfer acquire command pool!");
+			frame.NextBuffer[slot] = 0;
+		}
+
+		Submit();
+		HandOffCompleted();
+	}
+
+	bool VulkanTransferScheduler::IsComplete(UploadHandle handle) const
+	{
+		return handle.IsSynchronous() || handle.Value <= m_HandedOffValue;
+	}
+
+	void VulkanTransferScheduler::Wait(UploadHandle handle)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		if (IsComplete(handle))
+			return;
+
+		if (handle.Value > m_SubmittedValue)
+			Submit();
+
+		VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.pNext = nullptr;
+		waitInfo.flags = 0;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_TransferTimeline;
+		waitInfo.pValues = &handle.Value;
+		vkWaitSemaphores(VulkanContext::GetDevice()->GetVulkanDevice(), &waitInfo, UINT64_MAX);
+
+		HandOffCompleted();
+	}
+
+	VulkanTransferScheduler::TransferBatch& VulkanTransferScheduler::GetOpenBatch()
+	{
+		if (m_HasOpenBatch)
+			return m_OpenBatch;
+
+		VkDevice device = VulkanContext::GetDevice()->GetVulkanDevice();
+		if (!m_FreeBatches.empty())
+		{
+			m_OpenBatch = std::move(m_FreeBatches.back());
+			m_FreeBatches.pop_back();
+			PX_CORE_VK_ASSERT(vkResetCommandPool(device, m_OpenBatch.Pool, 0), VK_SUCCESS, "Failed to reset transfer batch command pool!");
+		}
+		else
+		{
+			VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+			poolInfo.pNext = nullptr;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			poolInfo.queueFamilyIndex = GetFamilyIndex(static_cast<uint32_t>(QueueFamilyOwnership::QFO_TRANSFER));
+			PX_CORE_VK_ASSERT(vkCreateCommandPool(device, &poolInfo, nullptr, &m_OpenBatch.Pool), VK_SUCCESS, "Failed to create transfer batch command pool!");
+
+			VkCommandBufferAllocateInfo bufferAllocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			bufferAllocateInfo.pNext = nullptr;
+			bufferAllocateInfo.commandPool = m_OpenBatch.Pool;
+			bufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			bufferAllocateInfo.commandBufferCount = 1;
+			PX_CORE_VK_ASSERT(vkAllocateCommandBuffers(device, &bufferAllocateInfo, &m_OpenBatch.Cmd), VK_SUCCESS, "Failed to create transfer batch CommandBuffer!");
+		}
+		m_OpenBatch.Value = m_SubmittedValue + 1;
+
+		VkCommandBufferBeginInfo cmdBeginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		cmdBeginInfo.pNext = nullptr;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cmdBeginInfo.pInheritanceInfo = nullptr;
+		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(m_OpenBatch.Cmd, &cmdBeginInfo), VK_SUCCESS, "Failed to begin transfer batch!");
+
+		m_HasOpenBatch = true;
+		return m_OpenBatch;
+	}
+
+	VkBuffer VulkanTransferScheduler::AllocateStaging(TransferBatch& batch, const void* data, size_t size, size_t& outOffset)
+	{
+		size_t offset = (batch.BlockHead + m_Alignment - 1) & ~(m_Alignment - 1);
+		if (batch.BlockMapped == nullptr || offset + size > batch.BlockSize)
+		{
+			// Oversized uploads get a dedicated block which is freed with the batch instead of being recycled
+			AllocatedBuffer block{};
+			size_t blockSize = std::max(size, m_StagingBlockSize);
+			if (blockSize == m_StagingBlockSize && !m_FreeBlocks.empty())
+			{
+				block = m_FreeBlocks.back();
+				m_FreeBlocks.pop_back();
+			}
+			else
+			{
+				VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+				bufferInfo.pNext = nullptr;
+				bufferInfo.size = blockSize;
+				bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+				VmaAllocationCreateInfo vmaAllocInfo{};
+				vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+				vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+				PX_CORE_VK_ASSERT(vmaCreateBuffer(VulkanContext::GetAllocator(), &bufferInfo, &vmaAllocInfo, &block.Buffer, &block.Allocation, nullptr), VK_SUCCESS, "Failed to create transfer staging block!");
+			}
+
+			VmaAllocationInfo allocInfo{};
+			vmaGetAllocationInfo(VulkanContext::GetAllocator(), block.Allocation, &allocInfo);
+			PX_CORE_ASSERT(allocInfo.pMappedData, "Transfer staging block is not persistently mapped!");
+
+			batch.StagingBlocks.push_back(block);
+			batch.BlockMapped = allocInfo.pMappedData;
+			batch.BlockSize = blockSize;
+			batch.BlockHead = 0;
+			offset = 0;
+		}
+
+		memcpy((char*)batch.BlockMapped + offset, data, size);
+		VkBuffer buffer = batch.StagingBlocks.back().Buffer;
+		vmaFlushAllocation(VulkanContext::GetAllocator(), batch.StagingBlocks.back().Allocation, offset, size);
+
+		batch.BlockHead = offset + size;
+		outOffset = offset;
+		return buffer;
+	}
+
+	void VulkanTransferScheduler::RecycleBatch(TransferBatch& batch)
+	{
+		VmaAllocator allocator = VulkanContext::GetAllocator();
+		for (auto& block : batch.StagingBlocks)
+		{
+			VmaAllocationInfo allocInfo{};
+			vmaGetAllocationInfo(allocator, block.Allocation, &allocInfo);
+			if (allocInfo.size == m_StagingBlockSize)
+				m_FreeBlocks.push_back(block);
+			else
+				vmaDestroyBuffer(allocator, block.Buffer, block.Allocation);
+		}
+		batch.StagingBlocks.clear();
+		batch.BlockMapped = nullptr;
+		batch.BlockHead = 0;
+		batch.BlockSize = 0;
+
+		for (uint32_t slot = 0; slot < QueueSlotCount; slot++)
+		{
+			batch.BufferAcquires[slot].clear();
+			batch.ImageAcquires[slot].clear();
+			batch.Consumers[slot] = false;
+		}
+		m_FreeBatches.push_back(std::move(batch));
+	}
+
+	void VulkanTransferScheduler::HandOffCompleted()
+	{
+		if (m_SubmittedBatches.empty())
+			return;
+
+		uint64_t completedValue = 0;
+		PX_CORE_VK_ASSERT(vkGetSemaphoreCounterValue(VulkanContext::GetDevice()->GetVulkanDevice(), m_TransferTimeline, &completedValue), VK_SUCCESS, "Failed to query transfer timeline!");
+		if (m_SubmittedBatches.front().Value > completedValue)
+			return;
+
+		std::array<bool, QueueSlotCount> consumers{};
+		std::array<std::vector<VkBufferMemoryBarrier2>, QueueSlotCount> bufferAcquires;
+		std::array<std::vector<VkImageMemoryBarrier2>, QueueSlotCount> imageAcquires;
+		uint64_t handOffValue = m_HandedOffValue;
+		while (!m_SubmittedBatches.empty() && m_SubmittedBatches.front().Value <= completedValue)
+		{
+			TransferBatch& batch = m_SubmittedBatches.front();
+			for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+			{
+				consumers[slot] |= batch.Consumers[slot];
+				bufferAcquires[slot].insert(bufferAcquires[slot].end(), batch.BufferAcquires[slot].begin(), batch.BufferAcquires[slot].end());
+				imageAcquires[slot].insert(imageAcquires[slot].end(), batch.ImageAcquires[slot].begin(), batch.ImageAcquires[slot].end());
+			}
+			handOffValue = batch.Value;
+
+			RecycleBatch(batch);
+			m_SubmittedBatches.pop_front();
+		}
+
+		AcquireFrame& frame = m_AcquireFrames[m_CurrentFrameIndex];
+		for (uint32_t slot = 1; slot < QueueSlotCount; slot++)
+		{
+			if (!consumers[slot])
+				continue;
+
+			VkCommandBuffer cmd = BeginAcquireCommands(frame, slot);
+			if (!bufferAcquires[slot].empty() || !imageAcquires[slot].empty())
+			{
+				VkDependencyInfo dependency{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+				dependency.pNext = nullptr;
+				dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferAcquires[slot].size());
+				dependency.pBufferMemoryBarriers = bufferAcquires[slot].data();
+				dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageAcquires[slot].size());
+				dependency.pImageMemoryBarriers = imageAcquires[slot].data();
+				vkCmdPipelineBarrier2(cmd, &dependency);
+			}
+			PX_CORE_VK_ASSERT(vkEndCommandBuffer(cmd), VK_SUCCESS, "Failed to end transfer acquire buffer!");
+
+			// The transfer already finished, the wait only orders the acquire and makes the copies visible on this queue
+			uint64_t signalValue = ++m_AcquireValue;
+			VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+			VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+			timelineInfo.pNext = nullptr;
+			timelineInfo.waitSemaphoreValueCount = 1;
+			timelineInfo.pWaitSemaphoreValues = &handOffValue;
+			timelineInfo.signalSemaphoreValueCount = 1;
+			timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+			VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+			submitInfo.pNext = &timelineInfo;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &cmd;
+			submitInfo.waitSemaphoreCount = 1;
+			submitInfo.pWaitSemaphores = &m_TransferTimeline;
+			submitInfo.pWaitDstStageMask = &waitStage;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &m_AcquireTimeline;
+
+			PX_CORE_VK_ASSERT(vkQueueSubmit(GetQueue(slot), 1, &submitInfo, VK_NULL_HANDLE), VK_SUCCESS, "Failed to submit transfer acquire buffer!");
+			frame.LastAcquireValue = signalValue;
+		}
+
+		m_HandedOffValue = handOffValue;
+	}
+
+	VkCommandBuffer VulkanTransferScheduler::BeginAcquireCommands(AcquireFrame& frame, uint32_t slot)
+	{
+		auto& buffers = frame.Buffers[slot];
+		uint32_t& next = frame.NextBuffer[slot];
+		if (next == buffers.size())
+		{
+			VkCommandBufferAllocateInfo bufferAllocateInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+			bufferAllocateInfo.pNext = nullptr;
+			bufferAllocateInfo.commandPool = frame.Pools[slot];
+			bufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			bufferAllocateInfo.commandBufferCount = 1;
+
+			VkCommandBuffer cmd;
+			PX_CORE_VK_ASSERT(vkAllocateCommandBuffers(VulkanContext::GetDevice()->GetVulkanDevice(), &bufferAllocateInfo, &cmd), VK_SUCCESS, "Failed to create transfer acquire CommandBuffer!");
+			buffers.push_back(cmd);
+		}
+		VkCommandBuffer cmd = buffers[next++];
+
+		VkCommandBufferBeginInfo cmdBeginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		cmdBeginInfo.pNext = nullptr;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cmdBeginInfo.pInheritanceInfo = nullptr;
+		PX_CORE_VK_ASSERT(vkBeginCommandBuffer(cmd, &cmdBeginInfo), VK_SUCCESS, "Failed to begin transfer acquire CommandBuffer!");
+
+		return cmd;
+	}
+
+	uint32_t VulkanTransferScheduler::GetSlot(QueueFamilyOwnership consumer)
+	{
+		// Resources without an owner yet are consumed by graphics
+		if (consumer == QueueFamilyOwnership::QFO_UNDEFINED || consumer == QueueFamilyOwnership::QFO_TRANSFER)
+			return static_cast<uint32_t>(QueueFamilyOwnership::QFO_GRAPHICS);
+		return static_cast<uint32_t>(consumer);
+	}
+
+	uint32_t VulkanTransferScheduler::GetFamilyIndex(uint32_t slot)
+	{
+		auto& families = VulkanContext::GetDevice()->GetQueueFamilies();
+		switch (static_cast<QueueFamilyOwnership>(slot))
+		{
+			case QueueFamilyOwnership::QFO_TRANSFER: return families.TransferFamilyIndex;
+			case QueueFamilyOwnership::QFO_COMPUTE: return families.ComputeFamilyIndex;
+			default: return families.GraphicsFamilyIndex;
+		}
+	}
+
+	VkQueue VulkanTransferScheduler::GetQueue(uint32_t slot)
+	{
+		auto& queues = VulkanContext::GetDevice()->GetQueueFamilies().Queues;
+		switch (static_cast<QueueFamilyOwnership>(slot))
+		{
+			case QueueFamilyOwnership::QFO_TRANSFER: return queues.TransferQueue;
+			case QueueFamilyOwnership::QFO_COMPUTE: return queues.ComputeQueue;
+			default: return queues.GraphicsQueue;
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "Platform/Vulkan/VulkanBuffer.h"
+#include "Platform/Vulkan/VulkanUtilities.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <deque>
+
+namespace Povox {
+
+	/**
+	 * Asynchronous uploads on the transfer queue. Uploads are recorded into a batch which is submitted once per frame (or when waited on)
+	 * and signals a timeline semaphore. Finished batches are handed to their consumer queues in the frame after completion:
+	 * one small submit per queue waits on the timeline and acquires all resources with a single barrier, so neither the CPU nor the
+	 * consumer queue ever blocks on an upload that is still running.
+	 * Destination ranges must not be in use by the GPU while their upload is in flight.
+	 */
+	class VulkanTransferScheduler
+	{
+	public:
+		VulkanTransferScheduler(uint32_t framesInFlight, size_t stagingBlockSize);
+		~VulkanTransferScheduler() = default;
+
+		void Destroy();
+
+		// Concurrently shared buffers skip the ownership transfer, the consumer's wait on the timeline is all they need
+		UploadHandle UploadBuffer(VkBuffer dstBuffer, size_t dstOffset, const void* data, size_t size, QueueFamilyOwnership consumer, bool concurrent = false);
+		UploadHandle UploadImage(VkImage dstImage, VkImageAspectFlags aspect, VkExtent3D extent, const void* data, size_t size, VkImageLayout finalLayout, QueueFamilyOwnership consumer);
+
+		// Submits the open batch to the transfer queue
+		void Submit();
+		// Submits the open batch and hands finished batches to their consumers. Has to be called before any other submit of the frame
+		void Update(uint32_t frameIndex);
+
+		// True once the upload is visible to its consumer queue
+		bool IsComplete(UploadHandle handle) const;
+		void Wait(UploadHandle handle);
+
+		inline VkSemaphore GetTimelineSemaphore() const { return m_TransferTimeline; }
+
+	private:
+		static constexpr uint32_t QueueSlotCount = 4; // Indexed by QueueFamilyOwnership
+
+		struct TransferBatch
+		{
+			uint64_t Value = 0; // Transfer timeline value signaled when the batch finished
+			VkCommandPool Pool = VK_NULL_HANDLE;
+			VkCommandBuffer Cmd = VK_NULL_HANDLE;
+
+			std::vector<AllocatedBuffer> StagingBlocks;
+			void* BlockMapped = nullptr;
+			size_t BlockHead = 0;
+			size_t BlockSize = 0;
+
+			std::vector<VkBufferMemoryBarrier2> BufferReleases;
+			std::vector<VkImageMemoryBarrier2> ImageReleases;
+			std::array<std::vector<VkBufferMemoryBarrier2>, QueueSlotCount> BufferAcquires;
+			std::array<std::vector<VkImageMemoryBarrier2>, QueueSlotCount> ImageAcquires;
+			std::array<bool, QueueSlotCount> Consumers{};
+		};
+
+		struct AcquireFrame
+		{
+			std::array<VkCommandPool, QueueSlotCount> Pools{};
+			std::array<std::vector<VkCommandBuffer>, QueueSlotCount> Buffers;
+			std::array<uint32_t, QueueSlotCount> NextBuffer{};
+			uint64_t LastAcquireValue = 0;
+		};
+
+		TransferBatch& GetOpenBatch();
+		VkBuffer AllocateStaging(TransferBatch& batch, const void* data, size_t size, size_t& outOffset);
+		void RecycleBatch(TransferBatch& batch);
+		void HandOffCompleted();
+		VkCommandBuffer BeginAcquireCommands(AcquireFrame& frame, uint32_t slot);
+
+		static uint32_t GetSlot(QueueFamilyOwnership consumer);
+		static uint32_t GetFamilyIndex(uint32_t slot);
+		static VkQueue GetQueue(uint32_t slot);
+
+	private:
+		size_t m_StagingBlockSize = 0;
+		size_t m_Alignment = 16;
+
+		TransferBatch m_OpenBatch;
+		bool m_HasOpenBatch = false;
+		std::deque<TransferBatch> m_SubmittedBatches;
+		std::vector<TransferBatch> m_FreeBatches;
+		std::vector<AllocatedBuffer> m_FreeBlocks;
+
+		VkSemaphore m_TransferTimeline = VK_NULL_HANDLE;
+		uint64_t m_SubmittedValue = 0;
+		uint64_t m_HandedOffValue = 0;
+
+		VkSemaphore m_AcquireTimeline = VK_NULL_HANDLE;
+		uint64_t m_AcquireValue = 0;
+		std::vector<AcquireFrame> m_AcquireFrames;
+		uint32_t m_CurrentFrameIndex = 0;
+	};
+}
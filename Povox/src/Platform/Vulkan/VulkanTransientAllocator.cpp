@@ -0,0 +1,109 @@
+#include "pxpch.h"
+#include "VulkanTransientAllocator.h"
+
+#include "Platform/Vulkan/VulkanContext.h"
+
+
+namespace Povox {
+
+	VulkanAliasedMemory::VulkanAliasedMemory(const VkMemoryRequirements& requirements, const std::string& debugName)
+		: m_Size(requirements.size)
+	{
+		VmaAllocationCreateInfo allocationInfo{};
+		allocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		allocationInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		PX_CORE_VK_ASSERT(vmaAllocateMemory(VulkanContext::GetAllocator(), &requirements, &allocationInfo, &m_Allocation, nullptr), VK_SUCCESS, "Failed to allocate aliased memory!");
+#ifdef PX_DEBUG
+		vmaSetAllocationName(VulkanContext::GetAllocator(), m_Allocation, debugName.c_str());
+#endif // DEBUG
+	}
+
+	VulkanAliasedMemory::~VulkanAliasedMemory()
+	{
+		VmaAllocation allocation = m_Allocation;
+		VulkanContext::SubmitResourceFree([=]()
+			{
+				vmaFreeMemory(VulkanContext::GetAllocator(), allocation);
+			});
+	}
+
+
+	VulkanTransientAllocator::VulkanTransientAllocator(const std::string& debugName)
+		: m_DebugName(debugName)
+	{
+	}
+
+	void VulkanTransientAllocator::AddImage(Ref<VulkanImage2D> image, uint32_t firstUse, uint32_t lastUse, uint32_t group)
+	{
+		TransientImage& transient = m_Images.emplace_back();
+		transient.Image = image;
+		transient.Requirements = image->GetMemoryRequirements();
+		transient.FirstUse = firstUse;
+		transient.LastUse = lastUse;
+		transient.Group = group;
+	}
+
+	void VulkanTransientAllocator::Allocate()
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		std::vector<uint32_t> order(m_Images.size());
+		for (uint32_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return m_Images[a].Requirements.size > m_Images[b].Requirements.size; });
+
+		std::vector<Block> blocks;
+		for (uint32_t index : order)
+		{
+			const TransientImage& image = m_Images[index];
+			auto it = std::find_if(blocks.begin(), blocks.end(), [&](const Block& block) { return Fits(block, image); });
+			if (it == blocks.end())
+			{
+				it = blocks.emplace(blocks.end());
+				it->Requirements = image.Requirements;
+				it->Group = image.Group;
+			}
+			else
+			{
+				// The largest image came first, so only the alignment can still grow the block
+				it->Requirements.alignment = std::max(it->Requirements.alignment, image.Requirements.alignment);
+				it->Requirements.memoryTypeBits &= image.Requirements.memoryTypeBits;
+			}
+			it->Images.push_back(index);
+		}
+
+		m_Statistics = TransientMemoryStatistics{};
+		for (uint32_t i = 0; i < blocks.size(); i++)
+		{
+			const Block& block = blocks[i];
+			Ref<VulkanAliasedMemory> memory = CreateRef<VulkanAliasedMemory>(block.Requirements, m_DebugName + "-TransientBlock " + std::to_string(i));
+			for (uint32_t index : block.Images)
+			{
+				m_Images[index].Image->Alias(memory, 0);
+				m_Statistics.RequiredBytes += m_Images[index].Requirements.size;
+			}
+
+			m_Statistics.AllocatedBytes += block.Requirements.size;
+			m_Statistics.AllocationCount++;
+		}
+		m_Statistics.ImageCount = static_cast<uint32_t>(m_Images.size());
+	}
+
+	bool VulkanTransientAllocator::Fits(const Block& block, const TransientImage& image) const
+	{
+		if (block.Group != image.Group || (block.Requirements.memoryTypeBits & image.Requirements.memoryTypeBits) == 0)
+			return false;
+		if (block.Requirements.size < image.Requirements.size)
+			return false;
+
+		for (uint32_t index : block.Images)
+		{
+			const TransientImage& other = m_Images[index];
+			if (image.FirstUse <= other.LastUse && other.FirstUse <= image.LastUse)
+				return false;
+		}
+		return true;
+	}
+}
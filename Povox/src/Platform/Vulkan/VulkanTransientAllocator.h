@@ -0,0 +1,71 @@
+#pragma once
+#include "Platform/Vulkan/VulkanImage2D.h"
+
+#include "Povox/Renderer/RenderGraph.h"
+
+#include <vulkan/vulkan.h>
+
+namespace Povox {
+
+	// One VMA allocation several images are bound into, freed once the last of them is destroyed or moved elsewhere
+	class VulkanAliasedMemory
+	{
+	public:
+		VulkanAliasedMemory(const VkMemoryRequirements& requirements, const std::string& debugName);
+		~VulkanAliasedMemory();
+
+		inline VmaAllocation GetAllocation() const { return m_Allocation; }
+		inline VkDeviceSize GetSize() const { return m_Size; }
+
+	private:
+		VmaAllocation m_Allocation = VK_NULL_HANDLE;
+		VkDeviceSize m_Size = 0;
+	};
+
+	/**
+	 * Places transient images whose lifetimes within a frame do not overlap into shared memory.
+	 * Lifetimes are the first and last position in the execution order of the passes using an image.
+	 * Images are only aliased with images of the same group (e.g. the queue using them), accesses of different groups could run concurrently.
+	 *
+	 * Images are placed largest first, each into the first block of its group none of whose images overlap its lifetime,
+	 * a block is as large as the largest image it holds. Every block is one allocation all its images are bound to at offset 0.
+	 */
+	class VulkanTransientAllocator
+	{
+	public:
+		VulkanTransientAllocator(const std::string& debugName);
+		~VulkanTransientAllocator() = default;
+
+		void AddImage(Ref<VulkanImage2D> image, uint32_t firstUse, uint32_t lastUse, uint32_t group);
+
+		// Binds all added images into their blocks, recreating their image handles and views
+		void Allocate();
+
+		inline const TransientMemoryStatistics& GetStatistics() const { return m_Statistics; }
+
+	private:
+		struct TransientImage
+		{
+			Ref<VulkanImage2D> Image = nullptr;
+			VkMemoryRequirements Requirements{};
+			uint32_t FirstUse = 0;
+			uint32_t LastUse = 0;
+			uint32_t Group = 0;
+		};
+
+		struct Block
+		{
+			std::vector<uint32_t> Images;
+			VkMemoryRequirements Requirements{};
+			uint32_t Group = 0;
+		};
+
+		bool Fits(const Block& block, const TransientImage& image) const;
+
+	private:
+		std::string m_DebugName;
+
+		std::vector<TransientImage> m_Images;
+		TransientMemoryStatistics m_Statistics{};
+	};
+}
@@ -29,6 +29,7 @@ namespace Povox {
 			case MemoryUtils::MemoryUsage::UPLOAD:		return VMA_MEMORY_USAGE_CPU_TO_GPU;
 			case MemoryUtils::MemoryUsage::DOWNLOAD:	return VMA_MEMORY_USAGE_GPU_TO_CPU;
 			case MemoryUtils::MemoryUsage::CPU_COPY:	return VMA_MEMORY_USAGE_CPU_COPY;
+			case MemoryUtils::MemoryUsage::DIRECT_WRITE:	return VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
 			}
 		}
 
@@ -34,6 +34,7 @@
 #include "Povox/Renderer/Renderer2D.h"
 
 #include "Povox/Renderer/Renderable.h"
+#include "Povox/Math/QuadTransform.h"
 
 #include "Povox/Utils/ShaderResource.h"
 #include "Povox/Resources/ShaderManager.h"
@@ -41,6 +42,7 @@
 #include "Povox/Renderer/Buffer.h"
 #include "Povox/Renderer/Framebuffer.h"
 #include "Povox/Renderer/RenderPass.h"
+#include "Povox/Renderer/RenderGraph.h"
 #include "Povox/Renderer/Pipeline.h"
 
 #include "Povox/Renderer/Shader.h"
@@ -24,6 +24,12 @@ namespace Povox {
 		PX_CORE_ASSERT(!s_Instance, "Application already exists!");
 		s_Instance = this;
 
+		// Everything sized per frame in flight reads it from here, so it is clamped once before anything gets created
+		uint32_t framesInFlight = std::clamp(specs.MaxFramesInFlight, 1u, 3u);
+		if (framesInFlight != specs.MaxFramesInFlight)
+			PX_CORE_WARN("Application::Application: MaxFramesInFlight {0} is not supported, using {1}.", specs.MaxFramesInFlight, framesInFlight);
+		m_Specification.MaxFramesInFlight = framesInFlight;
+
 		/* Correct order to initialize the core :
 		 *
 		 * - First set the correct RendererAPI
@@ -33,6 +39,8 @@ namespace Povox {
 
 		RendererAPI::SetAPI(specs.UseAPI);
 
+		m_ThreadPool = CreateScope<ThreadPool>(specs.WorkerThreadCount);
+
 		WindowSpecification windowSpecs{};
 		windowSpecs.Title = "Povosom";
 		windowSpecs.Width = 1600;
@@ -51,7 +59,8 @@ namespace Povox {
 		rendererSpecs.State.ViewportHeight = windowSpecs.Height;
 
 		rendererSpecs.MaxSceneObjects = 20000;
-		rendererSpecs.MaxFramesInFlight = specs.MaxFramesInFlight;		
+		rendererSpecs.MaxFramesInFlight = m_Specification.MaxFramesInFlight;		
+		rendererSpecs.MaxRecordingThreads = m_ThreadPool->GetThreadCount() + 1;
 		m_Specification.State.RendererInitialized = Renderer::Init(rendererSpecs);
 
 		PX_CORE_INFO("Completed Renderer initialization.");
@@ -5,6 +5,7 @@
 #include "Povox/Events/Event.h"
 #include "Povox/Events/ApplicationEvent.h"
 #include "Povox/Core/LayerStack.h"
+#include "Povox/Core/ThreadPool.h"
 #include "Povox/Renderer/RendererAPI.h"
 
 #include "Povox/ImGui/ImGuiLayer.h"
@@ -30,7 +31,10 @@ namespace Povox {
 
 		std::filesystem::path ShaderFilePath = std::filesystem::current_path().string() + "/assets/shaders/";
 
-		uint32_t MaxFramesInFlight = 1;
+		// Frames the CPU may record ahead of the GPU, clamped to [1, 3]
+		uint32_t MaxFramesInFlight = 2;
+		// 0: one less than the hardware threads
+		uint32_t WorkerThreadCount = 0;
 	};
 
 	class Application
@@ -54,6 +58,7 @@ namespace Povox {
 		ImGuiVulkanLayer* GetImGuiVulkanLayer() { return m_ImGuiVulkanLayer; }
 
 		inline Window& GetWindow() { return *m_Window; }
+		inline ThreadPool& GetThreadPool() { return *m_ThreadPool; }
 		inline static Application* Get() {	return s_Instance; }
 		inline ApplicationSpecification& GetSpecification() { return m_Specification; }
 
@@ -67,6 +72,7 @@ namespace Povox {
 		ApplicationSpecification m_Specification;
 
 		Scope<Window> m_Window;
+		Scope<ThreadPool> m_ThreadPool;
 		ImGuiLayer* m_ImGuiLayer;
 		ImGuiVulkanLayer* m_ImGuiVulkanLayer;
 		bool m_Running = true;
@@ -0,0 +1,92 @@
+#include "pxpch.h"
+#include "Povox/Core/ThreadPool.h"
+
+
+namespace Povox {
+
+	// Pool the current thread works for, nullptr outside of any WorkerLoop
+	static thread_local const ThreadPool* s_WorkerPool = nullptr;
+
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		PX_CORE_INFO("ThreadPool: Starting {0} worker threads...", threadCount);
+
+		m_Workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+			m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Condition.notify_all();
+
+		for (auto& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::ParallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& func)
+	{
+		if (taskCount == 0)
+			return;
+
+		if (IsWorkerThread())
+		{
+			for (uint32_t i = 0; i < taskCount; i++)
+				func(i);
+			return;
+		}
+
+		std::vector<std::future<void>> results;
+		results.reserve(taskCount - 1);
+		for (uint32_t i = 1; i < taskCount; i++)
+			results.push_back(Submit([&func, i]() { func(i); }));
+
+		func(0);
+
+		for (auto& result : results)
+			result.get();
+	}
+
+	bool ThreadPool::IsWorkerThread() const
+	{
+		return s_WorkerPool == this;
+	}
+
+	void ThreadPool::Enqueue(std::function<void()> job)
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Jobs.push_back(std::move(job));
+		}
+		m_Condition.notify_one();
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		s_WorkerPool = this;
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+				if (m_Stopping && m_Jobs.empty())
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+			job();
+		}
+	}
+}
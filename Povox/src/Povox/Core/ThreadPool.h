@@ -0,0 +1,55 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Povox {
+
+	/**
+	 * Fixed set of worker threads pulling jobs from a single queue.
+	 * ParallelFor runs its first task on the calling thread, so n workers give n + 1 way parallelism.
+	 * Called from one of the pool's own workers it runs every task inline instead, a worker blocking on queued tasks could wait on itself.
+	 */
+	class ThreadPool
+	{
+	public:
+		// 0 picks one worker less than the hardware threads, the calling thread does work as well
+		ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool();
+
+		template<typename Func>
+		std::future<std::invoke_result_t<Func>> Submit(Func&& func)
+		{
+			using ResultType = std::invoke_result_t<Func>;
+
+			auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Func>(func));
+			std::future<ResultType> result = task->get_future();
+			Enqueue([task]() { (*task)(); });
+			return result;
+		}
+
+		// Calls func(taskIndex) for every task index and returns once all of them finished
+		void ParallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& func);
+
+		inline uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+		// True if called from one of this pool's worker threads
+		bool IsWorkerThread() const;
+
+	private:
+		void Enqueue(std::function<void()> job);
+		void WorkerLoop();
+
+	private:
+		std::vector<std::thread> m_Workers;
+
+		std::deque<std::function<void()>> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping = false;
+	};
+}
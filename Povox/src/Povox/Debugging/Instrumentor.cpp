@@ -0,0 +1,262 @@
+#include "pxpch.h"
+#include "Povox/Debugging/Instrumentor.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+
+
+namespace Povox {
+
+	namespace Utils {
+
+		static constexpr char TraceMagic[4] = { 'P', 'X', 'T', 'R' };
+		static constexpr uint32_t TraceFileVersion = 1;
+		static constexpr auto WriterInterval = std::chrono::milliseconds(10);
+
+		enum class TraceRecordType : uint8_t
+		{
+			Name = 0,	// followed by the ID, the length and the characters of the name
+			Scope = 1	// followed by a TraceScopeRecord
+		};
+
+		struct TraceScopeRecord
+		{
+			uint32_t NameID;
+			uint32_t ThreadIndex;
+			int64_t Start;
+			int64_t Duration;
+		};
+		static_assert(sizeof(TraceScopeRecord) == 24, "TraceScopeRecord must not be padded!");
+
+		static std::string GetTracePath(const std::string& filepath)
+		{
+			return std::filesystem::path(filepath).replace_extension(".pxtrace").string();
+		}
+
+		static void Append(std::vector<char>& buffer, const void* data, size_t size)
+		{
+			const char* bytes = static_cast<const char*>(data);
+			buffer.insert(buffer.end(), bytes, bytes + size);
+		}
+	}
+
+	thread_local Instrumentor::ThreadBuffer* Instrumentor::t_Buffer = nullptr;
+
+	Instrumentor::~Instrumentor()
+	{
+		EndSession();
+	}
+
+	void Instrumentor::BeginSession(const std::string& name, const std::string& filepath)
+	{
+		std::lock_guard lock(m_SessionMutex);
+		if (m_CurrentSession)			// checks, if there is already a Instrumentor session running, if so, end it
+		{
+			if (Log::GetCoreLogger())	// In the case, the Instrumentor is initialized before Log
+			{
+				PX_CORE_ERROR("Instrumentor::Beginsession: '{0}', while '{1}' session already opend", name, m_CurrentSession->Name);
+			}
+
+			InternalEndSession();
+		}
+
+		std::string tracePath = Utils::GetTracePath(filepath);
+		m_TraceStream.open(tracePath, std::ios::binary | std::ios::trunc);
+		if (!m_TraceStream.is_open())
+		{
+			if (Log::GetCoreLogger())
+			{
+				PX_CORE_ERROR("Instrumentor could not open trace file '{0}'!", tracePath);
+			}
+			return;
+		}
+
+		m_CurrentSession = std::make_unique<InstrumentationSession>(InstrumentationSession{ name, filepath, ++m_SessionCount });
+		m_NameIDs.clear();
+		m_WriteBuffer.clear();
+		m_TraceStream.write(Utils::TraceMagic, sizeof(Utils::TraceMagic));
+		m_TraceStream.write(reinterpret_cast<const char*>(&Utils::TraceFileVersion), sizeof(Utils::TraceFileVersion));
+
+		m_WriterStopping = false;
+		m_Writer = std::thread(&Instrumentor::WriterLoop, this);
+
+		m_ActiveSession.store(m_CurrentSession->ID, std::memory_order_release);
+	}
+
+	void Instrumentor::EndSession()
+	{
+		std::lock_guard lock(m_SessionMutex);
+		InternalEndSession();
+	}
+
+	void Instrumentor::InternalEndSession()
+	{
+		if (!m_CurrentSession)
+			return;
+
+		// Scopes ending from here on are not recorded anymore, the writer drains what is left before it stops
+		m_ActiveSession.store(0, std::memory_order_relaxed);
+		{
+			std::lock_guard lock(m_WriterMutex);
+			m_WriterStopping = true;
+		}
+		m_WriterCondition.notify_all();
+		m_Writer.join();
+		m_TraceStream.close();
+
+		uint64_t dropped = 0;
+		{
+			std::lock_guard lock(m_BuffersMutex);
+			for (auto& buffer : m_Buffers)
+				dropped += buffer->Dropped.exchange(0, std::memory_order_relaxed);
+		}
+
+		std::string tracePath = Utils::GetTracePath(m_CurrentSession->Filepath);
+		bool converted = ConvertToChromeJson(tracePath, m_CurrentSession->Filepath);
+		if (converted)
+			std::filesystem::remove(tracePath);
+
+		if (Log::GetCoreLogger())
+		{
+			if (!converted)
+				PX_CORE_ERROR("Instrumentor could not convert trace '{0}' to '{1}'!", tracePath, m_CurrentSession->Filepath);
+			if (dropped > 0)
+				PX_CORE_WARN("Instrumentor: Session '{0}' dropped {1} scopes, the thread buffers were full.", m_CurrentSession->Name, dropped);
+		}
+
+		m_CurrentSession = nullptr;
+	}
+
+	Instrumentor::ThreadBuffer* Instrumentor::RegisterThread()
+	{
+		std::lock_guard lock(m_BuffersMutex);
+		m_Buffers.push_back(std::make_unique<ThreadBuffer>());
+		m_Buffers.back()->ThreadIndex = static_cast<uint32_t>(m_Buffers.size() - 1);
+		t_Buffer = m_Buffers.back().get();
+		return t_Buffer;
+	}
+
+	void Instrumentor::WriterLoop()
+	{
+		std::unique_lock lock(m_WriterMutex);
+		while (!m_WriterStopping)
+		{
+			m_WriterCondition.wait_for(lock, Utils::WriterInterval, [this]() { return m_WriterStopping; });
+
+			lock.unlock();
+			Drain();
+			lock.lock();
+		}
+		lock.unlock();
+
+		// The session may have ended before the loop ran once
+		Drain();
+	}
+
+	void Instrumentor::Drain()
+	{
+		uint32_t session = m_CurrentSession->ID;
+		{
+			std::lock_guard lock(m_BuffersMutex);
+			for (auto& buffer : m_Buffers)
+			{
+				uint64_t tail = buffer->Tail.load(std::memory_order_relaxed);
+				uint64_t head = buffer->Head.load(std::memory_order_acquire);
+				for (; tail != head; tail++)
+				{
+					const ProfileEvent& event = buffer->Events[tail & (ThreadBuffer::Capacity - 1)];
+					// Left over from an earlier session
+					if (event.Session != session)
+						continue;
+
+					auto [it, inserted] = m_NameIDs.try_emplace(event.Name, static_cast<uint32_t>(m_NameIDs.size()));
+					if (inserted)
+					{
+						Utils::TraceRecordType type = Utils::TraceRecordType::Name;
+						uint32_t length = static_cast<uint32_t>(std::strlen(event.Name));
+						Utils::Append(m_WriteBuffer, &type, sizeof(type));
+						Utils::Append(m_WriteBuffer, &it->second, sizeof(it->second));
+						Utils::Append(m_WriteBuffer, &length, sizeof(length));
+						Utils::Append(m_WriteBuffer, event.Name, length);
+					}
+
+					Utils::TraceRecordType type = Utils::TraceRecordType::Scope;
+					Utils::TraceScopeRecord record{ it->second, buffer->ThreadIndex, event.Start, event.Duration };
+					Utils::Append(m_WriteBuffer, &type, sizeof(type));
+					Utils::Append(m_WriteBuffer, &record, sizeof(record));
+				}
+				buffer->Tail.store(tail, std::memory_order_release);
+			}
+		}
+
+		if (m_WriteBuffer.empty())
+			return;
+		m_TraceStream.write(m_WriteBuffer.data(), m_WriteBuffer.size());
+		m_WriteBuffer.clear();
+	}
+
+	bool Instrumentor::ConvertToChromeJson(const std::string& tracePath, const std::string& jsonPath)
+	{
+		std::ifstream trace(tracePath, std::ios::binary);
+		if (!trace.is_open())
+			return false;
+
+		char magic[sizeof(Utils::TraceMagic)];
+		uint32_t version = 0;
+		trace.read(magic, sizeof(magic));
+		trace.read(reinterpret_cast<char*>(&version), sizeof(version));
+		if (!trace || std::memcmp(magic, Utils::TraceMagic, sizeof(magic)) != 0 || version != Utils::TraceFileVersion)
+			return false;
+
+		std::ofstream json(jsonPath);
+		if (!json.is_open())
+			return false;
+
+		json << std::setprecision(3) << std::fixed;
+		json << "{\"otherData\": {},\"traceEvents\":[{}";
+
+		std::vector<std::string> names;
+		Utils::TraceRecordType type;
+		while (trace.read(reinterpret_cast<char*>(&type), sizeof(type)))
+		{
+			if (type == Utils::TraceRecordType::Name)
+			{
+				uint32_t id = 0, length = 0;
+				trace.read(reinterpret_cast<char*>(&id), sizeof(id));
+				trace.read(reinterpret_cast<char*>(&length), sizeof(length));
+				std::string name(length, '\0');
+				trace.read(name.data(), length);
+				std::replace(name.begin(), name.end(), '"', '\'');
+
+				if (names.size() <= id)
+					names.resize(id + 1);
+				names[id] = std::move(name);
+			}
+			else if (type == Utils::TraceRecordType::Scope)
+			{
+				Utils::TraceScopeRecord record{};
+				trace.read(reinterpret_cast<char*>(&record), sizeof(record));
+				if (!trace || record.NameID >= names.size())
+					return false;
+
+				json << ",{";
+				json << "\"cat\":\"function\",";
+				json << "\"dur\":" << record.Duration / 1000.0 << ',';
+				json << "\"name\":\"" << names[record.NameID] << "\",";
+				json << "\"ph\":\"X\",";
+				json << "\"pid\":0,";
+				json << "\"tid\":" << record.ThreadIndex << ",";
+				json << "\"ts\":" << record.Start / 1000.0;
+				json << "}";
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		json << "]}";
+		return true;
+	}
+}
@@ -1,98 +1,62 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <string>
+#include <condition_variable>
 #include <fstream>
-#include <thread>
-#include <iomanip>
-#include <algorithm>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace Povox {
 
-	using FloatingPointMicroseconds = std::chrono::duration<double, std::micro>;
-
-	struct ProfileResult
+	// One profiled scope as it is recorded on the hot path, Name has to point to a string with static storage duration
+	struct ProfileEvent
 	{
-		std::string Name;
-
-		FloatingPointMicroseconds Start;
-		std::chrono::microseconds ElapsedTime;
-		std::thread::id ThreadID;
+		const char* Name = nullptr;
+		int64_t Start = 0; // steady_clock nanoseconds
+		int64_t Duration = 0; // nanoseconds
+		uint32_t Session = 0;
 	};
 
 	struct InstrumentationSession
 	{
 		std::string Name;
+		std::string Filepath;
+		uint32_t ID = 0;
 	};
 
+	/**
+	 * Every thread records its scopes into its own ring buffer of ProfileEvents, without locks or allocations.
+	 * A background thread drains the buffers every few milliseconds and appends them in one write to a binary trace next to the
+	 * session's file (.pxtrace). EndSession converts that trace to the Chrome tracing JSON at the session's filepath.
+	 * A full buffer drops events instead of blocking the recording thread, the count is logged at the end of the session.
+	 */
 	class Instrumentor
 	{
 	public:
 		Instrumentor(const Instrumentor&) = delete;
 		Instrumentor(Instrumentor&&) = delete;
 
-		void BeginSession(const std::string& name, const std::string& filepath = "results.json")
-		{
-			std::lock_guard lock(m_Mutex);		// lock_guard is a scoped mutex logging function
-			if (m_CurrentSession)			// checks, if there is already a Instrumentor session running, if so, end it
-			{
-				if (Log::GetCoreLogger())	// In the case, the Instrumentor is initialized before Log
-				{
-					PX_CORE_ERROR("Instrumentor::Beginsession: '{0}', while '{1}' session already opend", name, m_CurrentSession->Name);
-				}
-
-				InternalEndSession();
-			}
-
-			m_OutputStream.open(filepath);
-
-			if (m_OutputStream.is_open())
-			{
-				m_CurrentSession = new InstrumentationSession({ name });
-				WriteHeader();
-			}
-			else
-			{
-				if (Log::GetCoreLogger())	// In the case, the Instrumentor is initialized before Log
-				{
-					PX_CORE_ERROR("Instrumentor could not open results file '{0}'!", filepath);
-				}
-			}
-		}
+		void BeginSession(const std::string& name, const std::string& filepath = "results.json");
+		void EndSession();
 
-		void EndSession()
+		inline void WriteProfile(const char* name, int64_t start, int64_t duration)
 		{
-			std::lock_guard lock(m_Mutex);
-			InternalEndSession();
-		}
+			uint32_t session = m_ActiveSession.load(std::memory_order_relaxed);
+			if (session == 0)
+				return;
 
-		void WriteProfile(const ProfileResult& result)
-		{
-			std::stringstream json;
-
-			std::string name = result.Name;
-			std::replace(name.begin(), name.end(), '"', '\'');
-
-			json << std::setprecision(3) << std::fixed;
-			json << ",{";
-			json << "\"cat\":\"function\",";
-			json << "\"dur\":" << (result.ElapsedTime.count()) << ',';
-			json << "\"name\":\"" << name << "\",";
-			json << "\"ph\":\"X\",";
-			json << "\"pid\":0,";
-			json << "\"tid\":" << result.ThreadID << ",";
-			json << "\"ts\":" << result.Start.count();
-			json << "}";
-
-			std::lock_guard lock(m_Mutex);
-			if (m_CurrentSession)
-			{
-				m_OutputStream << json.str();
-				m_OutputStream.flush();
-			}
+			ThreadBuffer* buffer = t_Buffer ? t_Buffer : RegisterThread();
+			buffer->Push({ name, start, duration, session });
 		}
 
+		// Converts a binary trace written during a session to Chrome tracing JSON, returns false if it could not be read
+		static bool ConvertToChromeJson(const std::string& tracePath, const std::string& jsonPath);
+
 		static Instrumentor& Get()
 		{
 			static Instrumentor instance;
@@ -100,44 +64,69 @@ namespace Povox {
 		}
 
 	private:
-		Instrumentor()
-			:m_CurrentSession(nullptr)
+		// Single producer (the owning thread), single consumer (the writer thread)
+		struct ThreadBuffer
 		{
-		}
+			static constexpr uint64_t Capacity = 1 << 14;
 
-		~Instrumentor()
-		{
-			EndSession();
-		}
+			inline void Push(const ProfileEvent& event)
+			{
+				uint64_t head = Head.load(std::memory_order_relaxed);
+				if (head - CachedTail >= Capacity)
+				{
+					CachedTail = Tail.load(std::memory_order_acquire);
+					if (head - CachedTail >= Capacity)
+					{
+						Dropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+				}
+				Events[head & (Capacity - 1)] = event;
+				Head.store(head + 1, std::memory_order_release);
+			}
 
-		void WriteHeader()
-		{
-			m_OutputStream << "{\"otherData\": {},\"traceEvents\":[{}"; 
-			m_OutputStream.flush();
-		}
+			ProfileEvent Events[Capacity];
+			alignas(64) std::atomic<uint64_t> Head{ 0 };
+			// The producer's last read of Tail, so it only touches the consumer's cache line once the buffer looks full
+			uint64_t CachedTail = 0;
+			alignas(64) std::atomic<uint64_t> Tail{ 0 };
+			std::atomic<uint64_t> Dropped{ 0 };
+			uint32_t ThreadIndex = 0;
+		};
 
-		void WriteFooter()
-		{
-			m_OutputStream << "]}";
-			m_OutputStream.flush();
-		}
+		Instrumentor() = default;
+		~Instrumentor();
 
-		//note: you must already own lock on m_Mutex before calling InternelEndSession
-		void InternalEndSession()
-		{
-			if (m_CurrentSession)
-			{
-				WriteFooter();
-				m_OutputStream.close();
-				delete m_CurrentSession;
-				m_CurrentSession = nullptr;
-			}
-		}
+		ThreadBuffer* RegisterThread();
+		void WriterLoop();
+		// Appends the events of the current session from all buffers to the trace
+		void Drain();
+		//note: you must already own lock on m_SessionMutex before calling InternalEndSession
+		void InternalEndSession();
 
 	private:
-		std::ofstream m_OutputStream;
-		InstrumentationSession* m_CurrentSession;
-		std::mutex m_Mutex;
+		static thread_local ThreadBuffer* t_Buffer;
+
+		std::unique_ptr<InstrumentationSession> m_CurrentSession = nullptr;
+		// ID of the running session, 0 while none is running. Checked on every scope
+		std::atomic<uint32_t> m_ActiveSession{ 0 };
+		uint32_t m_SessionCount = 0;
+		std::mutex m_SessionMutex;
+
+		// Owned here, so the events of threads that exited are still written
+		std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+		std::mutex m_BuffersMutex;
+
+		std::thread m_Writer;
+		std::mutex m_WriterMutex;
+		std::condition_variable m_WriterCondition;
+		bool m_WriterStopping = false;
+
+		// Only touched by the writer thread while a session runs
+		std::ofstream m_TraceStream;
+		std::vector<char> m_WriteBuffer;
+		// Names are written to the trace once, scopes refer to them by ID
+		std::unordered_map<const char*, uint32_t> m_NameIDs;
 	};
 
 
@@ -160,10 +149,10 @@ namespace Povox {
 		{
 			auto endTimePoint = std::chrono::steady_clock::now();
 
-			auto highResStart = FloatingPointMicroseconds{ m_StartTimepoint.time_since_epoch()};
-			auto elapsedTime = std::chrono::time_point_cast<std::chrono::microseconds>(endTimePoint).time_since_epoch() - std::chrono::time_point_cast<std::chrono::microseconds>(m_StartTimepoint).time_since_epoch();
+			int64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(m_StartTimepoint.time_since_epoch()).count();
+			int64_t elapsedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(endTimePoint - m_StartTimepoint).count();
 
-			Instrumentor::Get().WriteProfile({ m_Name, highResStart, elapsedTime, std::this_thread::get_id() });
+			Instrumentor::Get().WriteProfile(m_Name, start, elapsedTime);
 
 
 			m_Stopped = true;
@@ -231,7 +220,7 @@ namespace Povox {
 
 #define PX_PROFILE_BEGIN_SESSION(name, filepath) ::Povox::Instrumentor::Get().BeginSession(name, filepath)
 #define PX_PROFILE_END_SESSION() ::Povox::Instrumentor::Get().EndSession()
-#define PX_PROFILE_SCOPE_LINE2(name, line) constexpr auto fixedName##line = ::Povox::InstrumentorUtils::CleanupOutputString(name, "__cdecl ");\
+#define PX_PROFILE_SCOPE_LINE2(name, line) static constexpr auto fixedName##line = ::Povox::InstrumentorUtils::CleanupOutputString(name, "__cdecl ");\
 											   ::Povox::InstrumentationTimer timer##line(fixedName##line.Data)
 #define PX_PROFILE_SCOPE_LINE(name, line) PX_PROFILE_SCOPE_LINE2(name, line)
 #define PX_PROFILE_SCOPE(name) PX_PROFILE_SCOPE_LINE(name, __LINE__)
@@ -0,0 +1,362 @@
+#include "pxpch.h"
+#include "QuadTransform.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define PX_SIMD_X86 1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define PX_TARGET_AVX2
+	#else
+		#define PX_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define PX_SIMD_X86 0
+#endif
+
+namespace Povox::Math {
+
+	// Vertices are written as raw floats: [x y z r | g b a u | v texID]
+	static_assert(sizeof(QuadVertex) == 10 * sizeof(float), "TransformQuads2D expects a tightly packed QuadVertex!");
+	static constexpr size_t FloatsPerVertex = 10;
+	// The AVX2 writer loads a quad as [Position Rotation Size Color] floats
+	static_assert(sizeof(Quad2D) == 10 * sizeof(float), "TransformQuads2D expects a tightly packed Quad2D!");
+
+	namespace Utils {
+
+		// Half axes of the quad's 2D affine transform, the corners are Translation -+ AxisX -+ AxisY
+		struct QuadAxes
+		{
+			float Xx, Xy, Yx, Yy;
+		};
+
+		static inline QuadAxes ComputeAxesScalar(const Quad2D& quad)
+		{
+			float c = 1.0f, s = 0.0f;
+			if (quad.Rotation != 0.0f)
+			{
+				c = std::cos(quad.Rotation);
+				s = std::sin(quad.Rotation);
+			}
+			float hx = 0.5f * quad.Size.x;
+			float hy = 0.5f * quad.Size.y;
+			return { hx * c, hx * s, -hy * s, hy * c };
+		}
+
+		static void TransformQuadsScalar(const Quad2D* quads, size_t count, float texID, QuadVertex* outVertices)
+		{
+			constexpr glm::vec2 textureCoords[4] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+			constexpr float signX[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+			constexpr float signY[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+
+			for (size_t i = 0; i < count; i++)
+			{
+				const Quad2D& quad = quads[i];
+				QuadAxes axes = ComputeAxesScalar(quad);
+
+				QuadVertex* vertex = outVertices + i * 4;
+				for (uint32_t corner = 0; corner < 4; corner++)
+				{
+					vertex->Position.x = quad.Position.x + signX[corner] * axes.Xx + signY[corner] * axes.Yx;
+					vertex->Position.y = quad.Position.y + signX[corner] * axes.Xy + signY[corner] * axes.Yy;
+					vertex->Position.z = quad.Position.z;
+					vertex->Color = quad.Color;
+					vertex->TexCoord = textureCoords[corner];
+					vertex->TexID = texID;
+					vertex++;
+				}
+			}
+		}
+
+#if PX_SIMD_X86
+		// One 16 byte store per position (carrying Color.r in w), one for Color.gba + u and an 8 byte store for v + texID
+		static inline void WriteQuadSSE(const Quad2D& quad, const QuadAxes& axes, __m128 texCoordV0, __m128 texCoordV1, float* dst)
+		{
+			const glm::vec4& color = quad.Color;
+			__m128 translation = _mm_set_ps(color.r, quad.Position.z, quad.Position.y, quad.Position.x);
+			__m128 axisX = _mm_set_ps(0.0f, 0.0f, axes.Xy, axes.Xx);
+			__m128 axisY = _mm_set_ps(0.0f, 0.0f, axes.Yy, axes.Yx);
+			__m128 colorU0 = _mm_set_ps(0.0f, color.a, color.b, color.g);
+			__m128 colorU1 = _mm_set_ps(1.0f, color.a, color.b, color.g);
+
+			__m128 minusX = _mm_sub_ps(translation, axisX);
+			__m128 plusX = _mm_add_ps(translation, axisX);
+
+			_mm_storeu_ps(dst + 0 * FloatsPerVertex, _mm_sub_ps(minusX, axisY));
+			_mm_storeu_ps(dst + 0 * FloatsPerVertex + 4, colorU0);
+			_mm_storel_pi((__m64*)(dst + 0 * FloatsPerVertex + 8), texCoordV0);
+
+			_mm_storeu_ps(dst + 1 * FloatsPerVertex, _mm_sub_ps(plusX, axisY));
+			_mm_storeu_ps(dst + 1 * FloatsPerVertex + 4, colorU1);
+			_mm_storel_pi((__m64*)(dst + 1 * FloatsPerVertex + 8), texCoordV0);
+
+			_mm_storeu_ps(dst + 2 * FloatsPerVertex, _mm_add_ps(plusX, axisY));
+			_mm_storeu_ps(dst + 2 * FloatsPerVertex + 4, colorU1);
+			_mm_storel_pi((__m64*)(dst + 2 * FloatsPerVertex + 8), texCoordV1);
+
+			_mm_storeu_ps(dst + 3 * FloatsPerVertex, _mm_add_ps(minusX, axisY));
+			_mm_storeu_ps(dst + 3 * FloatsPerVertex + 4, colorU0);
+			_mm_storel_pi((__m64*)(dst + 3 * FloatsPerVertex + 8), texCoordV1);
+		}
+
+		// Cephes style sin/cos: reduction to [-pi/4, pi/4] in three steps and a minimax polynomial for each, accurate for |x| < 8192
+		static inline void SinCosSSE(__m128 x, __m128& outSin, __m128& outCos)
+		{
+			const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+			__m128 signSin = _mm_and_ps(x, signMask);
+			x = _mm_andnot_ps(signMask, x);
+
+			__m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f))); // 4 / pi
+			octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+			__m128 y = _mm_cvtepi32_ps(octant);
+
+			__m128 swapSignSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+			__m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+			__m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+			signSin = _mm_xor_ps(signSin, swapSignSin);
+
+			x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+			x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+			x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+			__m128 z = _mm_mul_ps(x, x);
+
+			__m128 cosPoly = _mm_set1_ps(2.443315711809948e-5f);
+			cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(-1.388731625493765e-3f));
+			cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(4.166664568298827e-2f));
+			cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+			cosPoly = _mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+			cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+			__m128 sinPoly = _mm_set1_ps(-1.9515295891e-4f);
+			sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(8.3321608736e-3f));
+			sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(-1.6666654611e-1f));
+			sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), x), x);
+
+			__m128 sinResult = _mm_or_ps(_mm_and_ps(polyMask, sinPoly), _mm_andnot_ps(polyMask, cosPoly));
+			__m128 cosResult = _mm_or_ps(_mm_and_ps(polyMask, cosPoly), _mm_andnot_ps(polyMask, sinPoly));
+			outSin = _mm_xor_ps(sinResult, signSin);
+			outCos = _mm_xor_ps(cosResult, signCos);
+		}
+
+		static void TransformQuadsSSE(const Quad2D* quads, size_t count, float texID, QuadVertex* outVertices)
+		{
+			__m128 texCoordV0 = _mm_set_ps(0.0f, 0.0f, texID, 0.0f);
+			__m128 texCoordV1 = _mm_set_ps(0.0f, 0.0f, texID, 1.0f);
+			float* dst = reinterpret_cast<float*>(outVertices);
+
+			alignas(16) float xx[4], xy[4], yx[4], yy[4];
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				const Quad2D* q = quads + i;
+				__m128 rotation = _mm_set_ps(q[3].Rotation, q[2].Rotation, q[1].Rotation, q[0].Rotation);
+				__m128 halfX = _mm_mul_ps(_mm_set_ps(q[3].Size.x, q[2].Size.x, q[1].Size.x, q[0].Size.x), _mm_set1_ps(0.5f));
+				__m128 halfY = _mm_mul_ps(_mm_set_ps(q[3].Size.y, q[2].Size.y, q[1].Size.y, q[0].Size.y), _mm_set1_ps(0.5f));
+
+				__m128 s, c;
+				SinCosSSE(rotation, s, c);
+				_mm_store_ps(xx, _mm_mul_ps(halfX, c));
+				_mm_store_ps(xy, _mm_mul_ps(halfX, s));
+				_mm_store_ps(yx, _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(halfY, s)));
+				_mm_store_ps(yy, _mm_mul_ps(halfY, c));
+
+				for (uint32_t j = 0; j < 4; j++)
+					WriteQuadSSE(q[j], { xx[j], xy[j], yx[j], yy[j] }, texCoordV0, texCoordV1, dst + (i + j) * 4 * FloatsPerVertex);
+			}
+			for (; i < count; i++)
+				WriteQuadSSE(quads[i], ComputeAxesScalar(quads[i]), texCoordV0, texCoordV1, dst + i * 4 * FloatsPerVertex);
+		}
+
+		// Same as SinCosSSE for 8 lanes, the integer octant math is what needs AVX2
+		PX_TARGET_AVX2 static inline void SinCosAVX2(__m256 x, __m256& outSin, __m256& outCos)
+		{
+			const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+			__m256 signSin = _mm256_and_ps(x, signMask);
+			x = _mm256_andnot_ps(signMask, x);
+
+			__m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(1.27323954473516f)));
+			octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+			__m256 y = _mm256_cvtepi32_ps(octant);
+
+			__m256 swapSignSin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+			__m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+			__m256 signCos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+			signSin = _mm256_xor_ps(signSin, swapSignSin);
+
+			x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(-0.78515625f)));
+			x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(-2.4187564849853515625e-4f)));
+			x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(-3.77489497744594108e-8f)));
+			__m256 z = _mm256_mul_ps(x, x);
+
+			__m256 cosPoly = _mm256_set1_ps(2.443315711809948e-5f);
+			cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(-1.388731625493765e-3f));
+			cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(4.166664568298827e-2f));
+			cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+			cosPoly = _mm256_sub_ps(cosPoly, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+			cosPoly = _mm256_add_ps(cosPoly, _mm256_set1_ps(1.0f));
+
+			__m256 sinPoly = _mm256_set1_ps(-1.9515295891e-4f);
+			sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(8.3321608736e-3f));
+			sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(-1.6666654611e-1f));
+			sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinPoly, z), x), x);
+
+			outSin = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, polyMask), signSin);
+			outCos = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, polyMask), signCos);
+		}
+
+		// The 40 floats of a quad's vertices, written as five 32 byte stores. Each store blends the corner positions, the quad's
+		// [Position.z Rotation Size Color] and the constant tex coords. Only 256 bit intrinsics are used, so MSVC (which cannot target
+		// a single function) emits VEX encoded instructions here as well and the loop does not switch between SSE and AVX state
+		struct QuadWriterAVX2
+		{
+			__m256 Constants[5];
+			__m256i CornerIndices[5];
+			__m256i QuadIndices[5];
+		};
+
+		PX_TARGET_AVX2 static inline QuadWriterAVX2 CreateQuadWriterAVX2(float texID)
+		{
+			QuadWriterAVX2 writer;
+			writer.Constants[0] = _mm256_setzero_ps();
+			writer.Constants[1] = _mm256_setr_ps(0.0f, texID, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+			writer.Constants[2] = _mm256_setr_ps(0.0f, 1.0f, 0.0f, texID, 0.0f, 0.0f, 0.0f, 0.0f);
+			writer.Constants[3] = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, texID, 0.0f, 0.0f);
+			writer.Constants[4] = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, texID);
+
+			// Corners are [x0 y0 x1 y1 x2 y2 x3 y3], the quad is [Position.z Rotation Size.x Size.y r g b a]
+			writer.CornerIndices[0] = _mm256_setr_epi32(0, 1, 0, 0, 0, 0, 0, 0);
+			writer.CornerIndices[1] = _mm256_setr_epi32(0, 0, 2, 3, 0, 0, 0, 0);
+			writer.CornerIndices[2] = _mm256_setr_epi32(0, 0, 0, 0, 4, 5, 0, 0);
+			writer.CornerIndices[3] = _mm256_setr_epi32(0, 0, 0, 0, 0, 0, 6, 7);
+			writer.CornerIndices[4] = _mm256_setzero_si256();
+			writer.QuadIndices[0] = _mm256_setr_epi32(0, 0, 0, 4, 5, 6, 7, 0);
+			writer.QuadIndices[1] = _mm256_setr_epi32(0, 0, 0, 0, 0, 4, 5, 6);
+			writer.QuadIndices[2] = _mm256_setr_epi32(7, 0, 0, 0, 0, 0, 0, 4);
+			writer.QuadIndices[3] = _mm256_setr_epi32(5, 6, 7, 0, 0, 0, 0, 0);
+			writer.QuadIndices[4] = _mm256_setr_epi32(0, 4, 5, 6, 7, 0, 0, 0);
+			return writer;
+		}
+
+		// axisX holds [Xx Xy] and axisY [Yx Yy] in every pair of lanes
+		PX_TARGET_AVX2 static inline void WriteQuadAVX2(const Quad2D& quad, __m256 axisX, __m256 axisY, const QuadWriterAVX2& writer, float* dst)
+		{
+			const __m256 signX = _mm256_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f);
+			const __m256 signY = _mm256_setr_ps(-1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+
+			const float* source = &quad.Position.x;
+			__m256 translation = _mm256_permutevar8x32_ps(_mm256_loadu_ps(source), _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1));
+			__m256 data = _mm256_loadu_ps(source + 2);
+			__m256 corners = _mm256_add_ps(translation, _mm256_add_ps(_mm256_mul_ps(axisX, signX), _mm256_mul_ps(axisY, signY)));
+
+			_mm256_storeu_ps(dst + 0, _mm256_blend_ps(_mm256_blend_ps(writer.Constants[0], _mm256_permutevar8x32_ps(data, writer.QuadIndices[0]), 0x7C),
+				_mm256_permutevar8x32_ps(corners, writer.CornerIndices[0]), 0x03));
+			_mm256_storeu_ps(dst + 8, _mm256_blend_ps(_mm256_blend_ps(writer.Constants[1], _mm256_permutevar8x32_ps(data, writer.QuadIndices[1]), 0xF0),
+				_mm256_permutevar8x32_ps(corners, writer.CornerIndices[1]), 0x0C));
+			_mm256_storeu_ps(dst + 16, _mm256_blend_ps(_mm256_blend_ps(writer.Constants[2], _mm256_permutevar8x32_ps(data, writer.QuadIndices[2]), 0xC1),
+				_mm256_permutevar8x32_ps(corners, writer.CornerIndices[2]), 0x30));
+			_mm256_storeu_ps(dst + 24, _mm256_blend_ps(_mm256_blend_ps(writer.Constants[3], _mm256_permutevar8x32_ps(data, writer.QuadIndices[3]), 0x07),
+				_mm256_permutevar8x32_ps(corners, writer.CornerIndices[3]), 0xC0));
+			_mm256_storeu_ps(dst + 32, _mm256_blend_ps(writer.Constants[4], _mm256_permutevar8x32_ps(data, writer.QuadIndices[4]), 0x1F));
+		}
+
+		PX_TARGET_AVX2 static void TransformQuadsAVX2(const Quad2D* quads, size_t count, float texID, QuadVertex* outVertices)
+		{
+			const QuadWriterAVX2 writer = CreateQuadWriterAVX2(texID);
+			float* dst = reinterpret_cast<float*>(outVertices);
+
+			alignas(32) float xx[8], xy[8], yx[8], yy[8];
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const Quad2D* q = quads + i;
+				__m256 rotation = _mm256_set_ps(q[7].Rotation, q[6].Rotation, q[5].Rotation, q[4].Rotation, q[3].Rotation, q[2].Rotation, q[1].Rotation, q[0].Rotation);
+				__m256 halfX = _mm256_mul_ps(_mm256_set_ps(q[7].Size.x, q[6].Size.x, q[5].Size.x, q[4].Size.x, q[3].Size.x, q[2].Size.x, q[1].Size.x, q[0].Size.x), _mm256_set1_ps(0.5f));
+				__m256 halfY = _mm256_mul_ps(_mm256_set_ps(q[7].Size.y, q[6].Size.y, q[5].Size.y, q[4].Size.y, q[3].Size.y, q[2].Size.y, q[1].Size.y, q[0].Size.y), _mm256_set1_ps(0.5f));
+
+				__m256 s, c;
+				SinCosAVX2(rotation, s, c);
+				_mm256_store_ps(xx, _mm256_mul_ps(halfX, c));
+				_mm256_store_ps(xy, _mm256_mul_ps(halfX, s));
+				_mm256_store_ps(yx, _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(halfY, s)));
+				_mm256_store_ps(yy, _mm256_mul_ps(halfY, c));
+
+				for (uint32_t j = 0; j < 8; j++)
+				{
+					__m256 axisX = _mm256_blend_ps(_mm256_broadcast_ss(&xx[j]), _mm256_broadcast_ss(&xy[j]), 0xAA);
+					__m256 axisY = _mm256_blend_ps(_mm256_broadcast_ss(&yx[j]), _mm256_broadcast_ss(&yy[j]), 0xAA);
+					WriteQuadAVX2(q[j], axisX, axisY, writer, dst + (i + j) * 4 * FloatsPerVertex);
+				}
+			}
+			// The remaining quads go through the legacy encoded SSE path
+			_mm256_zeroupper();
+
+			if (i < count)
+				TransformQuadsSSE(quads + i, count - i, texID, outVertices + i * 4);
+		}
+
+		static SimdPath DetectSimdPath()
+		{
+	#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return SimdPath::SSE;
+
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			// The OS has to save the ymm registers on context switches
+			if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+				return SimdPath::SSE;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) ? SimdPath::AVX2 : SimdPath::SSE;
+	#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") ? SimdPath::AVX2 : SimdPath::SSE;
+	#endif
+		}
+#endif // PX_SIMD_X86
+	}
+
+	SimdPath GetSimdPath()
+	{
+#if PX_SIMD_X86
+		static const SimdPath s_Path = Utils::DetectSimdPath();
+		return s_Path;
+#else
+		return SimdPath::Scalar;
+#endif
+	}
+
+	const char* SimdPathToString(SimdPath path)
+	{
+		switch (path)
+		{
+			case SimdPath::Scalar:	return "Scalar";
+			case SimdPath::SSE:		return "SSE";
+			case SimdPath::AVX2:	return "AVX2";
+		}
+		return "Unknown";
+	}
+
+	void TransformQuads2D(const Quad2D* quads, size_t count, float texID, QuadVertex* outVertices, SimdPath path)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		PX_CORE_ASSERT((uint32_t)path <= (uint32_t)GetSimdPath(), "SimdPath is not supported by this CPU!");
+
+		switch (path)
+		{
+#if PX_SIMD_X86
+			case SimdPath::AVX2:	Utils::TransformQuadsAVX2(quads, count, texID, outVertices); return;
+			case SimdPath::SSE:		Utils::TransformQuadsSSE(quads, count, texID, outVertices); return;
+#endif
+			default:				Utils::TransformQuadsScalar(quads, count, texID, outVertices); return;
+		}
+	}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Povox/Renderer/Renderable.h"
+
+#include <glm/glm.hpp>
+
+
+namespace Povox::Math {
+
+	enum class SimdPath
+	{
+		Scalar = 0,
+		SSE,
+		AVX2
+	};
+
+	// Widest path the CPU (and OS) supports, queried once
+	SimdPath GetSimdPath();
+	const char* SimdPathToString(SimdPath path);
+
+	/**
+	 * Expands 2D quads into four QuadVertex each, corners in the order of Renderer2D's unit quad.
+	 * Every quad is a 2D affine transform (rotation around z, scale, translation), so only two half axes are computed per quad
+	 * instead of building and applying a 4x4 matrix per vertex. The SIMD paths evaluate sin/cos for 4 (SSE) or 8 (AVX2) quads at once
+	 * with a polynomial approximation, results differ from the scalar path by a few ulp.
+	 */
+	void TransformQuads2D(const Quad2D* quads, size_t count, float texID, QuadVertex* outVertices, SimdPath path);
+	inline void TransformQuads2D(const Quad2D* quads, size_t count, float texID, QuadVertex* outVertices) { TransformQuads2D(quads, count, texID, outVertices, GetSimdPath()); }
+
+}
@@ -134,6 +134,8 @@ namespace Povox {
 		uint32_t ElementCount = 0;
 		uint32_t ElementSize = 0;
 		size_t Size = 0;
+		// Shared by the graphics, compute and transfer queues without ownership transfers, e.g. for data compute writes while graphics reads another part of it
+		bool Concurrent = false;
 
 		std::string DebugName = "Buffer";
 	};
@@ -147,11 +149,26 @@ namespace Povox {
 
 		virtual void SetData(void* data, size_t size) = 0;
 		virtual void SetData(void* inputData, size_t offset, size_t size) = 0;
+		/**
+		 * Copies the data into staging memory and uploads it on the transfer queue without blocking.
+		 * The range must not be used by the GPU until Renderer::IsUploadComplete returns true for the returned handle.
+		 */
+		virtual UploadHandle SetDataAsync(void* inputData, size_t offset, size_t size) = 0;
 
 		virtual void SetLayout(const BufferLayout& layout) = 0;
 		virtual BufferSpecification& GetSpecification() = 0;
 
+		/**
+		 * Returns the persistently mapped memory of MemoryUsage::DIRECT_WRITE buffers, nullptr for all others.
+		 * Writes have to be made visible with FlushMappedData before the buffer is used by the GPU.
+		 */
+		virtual void* GetMappedData() = 0;
+		virtual void FlushMappedData(size_t offset, size_t size) = 0;
+
+		// Carves an aligned range out of this buffer, nullptr if there is no free range large enough
 		virtual Ref<BufferSuballocation> GetSuballocation(size_t size) = 0;
+		// Called by ~BufferSuballocation, ranges of pooled buffers are released once the GPU is done with them
+		virtual void FreeSuballocation(size_t offset, size_t size) = 0;
 		
 		static uint32_t GetPadding() { return 0; }
 		static size_t PadSize(size_t initialSize) { return initialSize; }
@@ -170,11 +187,48 @@ namespace Povox {
 	{
 		BufferSuballocation() = default;
 		BufferSuballocation(Ref<Buffer> buffer, size_t offset, size_t range) : Buffer(buffer), Offset(offset), Range(range) {};
+		~BufferSuballocation() { if (Buffer) Buffer->FreeSuballocation(Offset, Range); }
+
+		// Owns its range, copies would free it twice
+		BufferSuballocation(const BufferSuballocation&) = delete;
+		BufferSuballocation& operator=(const BufferSuballocation&) = delete;
 
 		void SetData(void* data, size_t partialOffset, size_t size) { Buffer->SetData(data, Offset + partialOffset, size); };
+		UploadHandle SetDataAsync(void* data, size_t partialOffset, size_t size) { return Buffer->SetDataAsync(data, Offset + partialOffset, size); };
 
 		Ref<Buffer> Buffer = nullptr;
 		size_t Offset = 0;
 		size_t Range = 0;
 	};
+
+	struct BufferPoolStatistics
+	{
+		uint32_t BackingBufferCount = 0;
+		uint32_t AllocationCount = 0;
+
+		size_t ReservedBytes = 0;
+		// Including alignment padding
+		size_t UsedBytes = 0;
+		size_t FreeBytes = 0;
+		size_t LargestFreeRange = 0;
+		uint32_t FreeRangeCount = 0;
+
+		// 0 if the free memory of each backing buffer is one contiguous range, approaching 1 the more it is split up
+		float Fragmentation = 0.0f;
+	};
+
+	/**
+	 * Hands out suballocations of a few large backing buffers per BufferUsage instead of one allocation per resource.
+	 * Grows by adding backing buffers and releases freed ranges once the frames that used them have finished.
+	 */
+	class BufferPool
+	{
+	public:
+		virtual ~BufferPool() = default;
+
+		virtual Ref<BufferSuballocation> Allocate(BufferUsage usage, size_t size) = 0;
+
+		virtual BufferPoolStatistics GetStatistics(BufferUsage usage) const = 0;
+		virtual BufferPoolStatistics GetStatistics() const = 0;
+	};
 }
@@ -9,7 +9,8 @@ namespace Povox {
 		MemoryUtils::MemoryUsage Memory = MemoryUtils::MemoryUsage::GPU_ONLY;
 		ImageTiling Tiling = ImageTiling::LINEAR;
 		std::vector<ImageUsage> Usages = { ImageUsage::COLOR_ATTACHMENT };
-
+		// See ImageSpecification::Transient, e.g. depth buffers nothing reads after the pass
+		bool Transient = false;
 
 		// TODO: Filtering/wrapping to choose or create right sampler
 	};
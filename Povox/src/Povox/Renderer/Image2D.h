@@ -102,6 +102,9 @@ namespace Povox {
 
 		bool DedicatedSampler = false;
 		bool CreateDescriptorOnInit = true;
+		// The contents only live from the first write to the last read within one frame of a RenderGraph.
+		// The graph may place the image in memory shared with other transient images whose lifetimes do not overlap
+		bool Transient = false;
 
 		std::string DebugName = "Image";
 	};
@@ -116,6 +119,8 @@ namespace Povox {
 		virtual const ImageSpecification& GetSpecification() const = 0;
 		
 		virtual void SetData(void* data) = 0;
+		// Uploads on the transfer queue without blocking, the image must not be used before the upload is complete
+		virtual UploadHandle SetDataAsync(void* data) = 0;
 
 		virtual int ReadPixel(int posX, int posY) = 0;
 
@@ -4,6 +4,7 @@
 #include "Povox/Renderer/Framebuffer.h"
 #include "Povox/Renderer/RenderPass.h"
 #include "Povox/Renderer/Buffer.h"
+#include "Povox/Renderer/Shader.h"
 
 namespace Povox {
 
@@ -46,6 +47,21 @@ namespace Povox {
 
 	}
 
+	// Value of one specialization constant, matched against the constants the shader declares by name and type
+	struct SpecializationConstantValue
+	{
+		ShaderDataType Type = ShaderDataType::None;
+		// Raw 32 bits, bools are stored as VkBool32
+		uint32_t Data = 0;
+
+		SpecializationConstantValue() = default;
+		SpecializationConstantValue(bool value) : Type(ShaderDataType::Bool), Data(value ? 1 : 0) {}
+		SpecializationConstantValue(int32_t value) : Type(ShaderDataType::Int) { memcpy(&Data, &value, sizeof(value)); }
+		SpecializationConstantValue(uint32_t value) : Type(ShaderDataType::UInt), Data(value) {}
+		SpecializationConstantValue(float value) : Type(ShaderDataType::Float) { memcpy(&Data, &value, sizeof(value)); }
+	};
+	using SpecializationConstantMap = std::map<std::string, SpecializationConstantValue>;
+
 	class Shader;
 	struct PipelineSpecification
 	{
@@ -62,6 +78,9 @@ namespace Povox {
 		bool DepthTesting = true;
 		bool DepthWriting = true;
 
+		// Constants the shader does not declare are ignored with a warning, undeclared ones keep their default from the shader
+		SpecializationConstantMap SpecializationConstants;
+
 
 		bool DynamicViewAndScissors = true;
 		struct Viewport
@@ -108,10 +127,13 @@ namespace Povox {
 	{
 		Ref<Shader> Shader = nullptr;
 
+		// If not 0, specializes the shader's local_size_x/y/z, which requires the shader to declare them with local_size_*_id
 		uint32_t WorkGroupSizeX = 0;
 		uint32_t WorkGroupSizeY = 0;
 		uint32_t WorkGroupSizeZ = 0;
 
+		SpecializationConstantMap SpecializationConstants;
+
 		std::string DebugName = "ComputePipeline";
 	};
 
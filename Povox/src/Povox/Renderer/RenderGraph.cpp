@@ -0,0 +1,22 @@
+#include "pxpch.h"
+#include "RenderGraph.h"
+
+#include "Platform/Vulkan/VulkanRenderGraph.h"
+
+#include "Povox/Renderer/Renderer.h"
+
+namespace Povox {
+
+	Ref<RenderGraph> RenderGraph::Create(const RenderGraphSpecification& spec)
+	{
+		switch (Renderer::GetAPI())
+		{
+			case RendererAPI::API::Vulkan:
+			{
+				return CreateRef<VulkanRenderGraph>(spec);
+			}
+		}
+		PX_CORE_ASSERT(true, "Unknown RendererAPI");
+		return nullptr;
+	}
+}
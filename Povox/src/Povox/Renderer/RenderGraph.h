@@ -0,0 +1,59 @@
+#pragma once
+#include "Povox/Core/Core.h"
+
+#include "Povox/Renderer/RenderPass.h"
+
+#include <functional>
+
+namespace Povox {
+
+	struct RenderGraphSpecification
+	{
+		std::string DebugName = "RenderGraph";
+	};
+
+	// Images with ImageSpecification::Transient, the ones the graph placed in shared memory and the ones it could not
+	struct TransientMemoryStatistics
+	{
+		uint32_t ImageCount = 0;
+		uint32_t AllocationCount = 0;
+		// What the images would take with an allocation each and what they take sharing memory
+		uint64_t RequiredBytes = 0;
+		uint64_t AllocatedBytes = 0;
+		// Transient images whose uses do not allow aliasing, they keep an allocation each
+		uint32_t UnaliasedImageCount = 0;
+		uint64_t UnaliasedBytes = 0;
+	};
+
+	/**
+	 * Orders GPUPasses by the ShaderResources they read (BindInput) and write (BindOutput).
+	 * A pass runs after every other pass writing a resource it reads, independent of the order the passes were added in.
+	 * Passes whose writes nobody reads are culled, unless they are marked as output (e.g. their framebuffer is shown).
+	 *
+	 * Barriers, image layout transitions and queue family ownership transfers between the passes are derived from these accesses,
+	 * so passes do not have to be chained by hand anymore.
+	 */
+	class RenderGraph
+	{
+	public:
+		virtual ~RenderGraph() = default;
+
+		// Called by Execute, a RenderPass' callback records its draws and is wrapped in Begin- and EndRenderPass.
+		// A ComputePass is dispatched by the graph, its callback may be empty
+		virtual void AddPass(Ref<GPUPass> pass, std::function<void()> record = nullptr) = 0;
+		virtual void MarkOutput(Ref<GPUPass> pass) = 0;
+		// Disabled passes are skipped in Execute as if they were culled, e.g. while their input is still uploading
+		virtual void SetPassEnabled(Ref<GPUPass> pass, bool enabled) = 0;
+
+		// Has to be called after all passes are added and baked, and again once passes or their bound resources change (e.g. after a resize).
+		// Transient images used by the passes are placed in shared memory here
+		virtual void Compile() = 0;
+		// Runs the compiled passes inside the active command buffer
+		virtual void Execute() = 0;
+
+		virtual const std::vector<Ref<GPUPass>>& GetExecutionOrder() const = 0;
+		virtual const TransientMemoryStatistics& GetTransientMemoryStatistics() const = 0;
+
+		static Ref<RenderGraph> Create(const RenderGraphSpecification& spec);
+	};
+}
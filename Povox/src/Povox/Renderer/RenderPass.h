@@ -26,8 +26,9 @@ namespace Povox {
 
 		virtual void Bake() = 0;
 
-		virtual void SetPredecessor(Ref<GPUPass> predecessor) = 0;
-		virtual void SetSuccessor(Ref<GPUPass> successor) = 0;
+		// Names bound via BindInput (reads) and BindOutput (writes), a RenderGraph orders and synchronizes passes by them
+		virtual const std::vector<std::string>& GetInputs() const = 0;
+		virtual const std::vector<std::string>& GetOutputs() const = 0;
 
 		virtual const std::string& GetDebugName() const = 0;
 
@@ -28,6 +28,25 @@ namespace Povox {
 		float TexID; // -> MaterialID after MaterialSystem//DescriptorManager implementation
 	};
 
+	// Instanced quads: one record per quad instead of four QuadVertex, matches the std430 layout of Renderer2D_QuadInstanced.glsl
+	struct QuadInstance
+	{
+		glm::vec4 AxisX;		// xyz: first transform column, w: tiling factor
+		glm::vec4 AxisY;		// xyz: second transform column, w: bits of the bindless texture index
+		glm::vec3 Translation;
+		uint32_t Color;			// RGBA8
+	};
+	static_assert(sizeof(QuadInstance) == 48, "QuadInstance has to match the shader's std430 layout!");
+
+	// Input of the batched Renderer2D::DrawQuads, rotation around z in radians
+	struct Quad2D
+	{
+		glm::vec3 Position{ 0.0f };
+		float Rotation = 0.0f;
+		glm::vec2 Size{ 1.0f };
+		glm::vec4 Color{ 1.0f };
+	};
+
 	class Buffer;
 	struct Mesh
 	{
@@ -80,10 +80,15 @@ namespace Povox {
 		return s_RendererAPI->BeginFrame();
 	}
 	void Renderer::DrawRenderable(const Renderable& renderable) { s_RendererAPI->DrawRenderable(renderable); }
-	void Renderer::Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless)
+	void Renderer::Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless, int32_t vertexOffset)
 	{
 		PX_PROFILE_FUNCTION();
-		s_RendererAPI->Draw(vertices, material, indices, indexCount, textureless);
+		s_RendererAPI->Draw(vertices, material, indices, indexCount, textureless, vertexOffset);
+	}
+	void Renderer::DrawInstanced(Ref<Material> material, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance, bool textureless)
+	{
+		PX_PROFILE_FUNCTION();
+		s_RendererAPI->DrawInstanced(material, vertexCount, instanceCount, firstInstance, textureless);
 	}
 	void Renderer::DrawGUI()
 	{
@@ -99,6 +104,8 @@ namespace Povox {
 
 	uint32_t Renderer::GetCurrentFrameIndex() { return s_RendererAPI->GetCurrentFrameIndex(); }	
 	uint32_t Renderer::GetLastFrameIndex() { return s_RendererAPI->GetLastFrameIndex(); }
+	uint64_t Renderer::GetCurrentFrameNumber() { return s_RendererAPI->GetCurrentFrameNumber(); }
+	uint64_t Renderer::GetCompletedFrameNumber() { return s_RendererAPI->GetCompletedFrameNumber(); }
 
 	void Renderer::PrepareSwapchainImage(Ref<Image2D> finalImage) { s_RendererAPI->PrepareSwapchainImage(finalImage); }
 	void Renderer::CreateFinalImage(Ref<Image2D> finalImage) { s_RendererAPI->CreateFinalImage(finalImage); }
@@ -113,6 +120,7 @@ namespace Povox {
 	Ref<TextureSystem> Renderer::GetTextureSystem()	{ return s_RendererAPI->GetTextureSystem(); }
 	Ref<MaterialSystem> Renderer::GetMaterialSystem() { return s_RendererAPI->GetMaterialSystem(); }
 	Ref<ShaderResourceSystem> Renderer::GetShaderResourceSystem() { return s_RendererAPI->GetShaderResourceSystem(); }
+	Ref<BufferPool> Renderer::GetBufferPool() { return s_RendererAPI->GetBufferPool(); }
 
 	// State
 	void Renderer::OnResize(uint32_t width, uint32_t height)
@@ -126,17 +134,26 @@ namespace Povox {
 	void Renderer::BeginCommandBuffer(const void* cmd) { s_RendererAPI->BeginCommandBuffer(cmd); }
 	void Renderer::EndCommandBuffer() {	s_RendererAPI->EndCommandBuffer(); }
 	const void* Renderer::GetCommandBuffer(uint32_t index) { return s_RendererAPI->GetCommandBuffer(index); }
+	const void* Renderer::BeginSecondaryCommandBuffer(uint32_t threadIndex) { return s_RendererAPI->BeginSecondaryCommandBuffer(threadIndex); }
+	void Renderer::EndSecondaryCommandBuffer() { s_RendererAPI->EndSecondaryCommandBuffer(); }
+	void Renderer::ExecuteSecondaryCommandBuffers(const std::vector<const void*>& commandBuffers) { s_RendererAPI->ExecuteSecondaryCommandBuffers(commandBuffers); }
 
 	// Renderpass
 	void Renderer::BeginRenderPass(Ref<RenderPass> renderPass) { s_RendererAPI->BeginRenderPass(renderPass); }
+	void Renderer::BeginParallelRenderPass(Ref<RenderPass> renderPass) { s_RendererAPI->BeginParallelRenderPass(renderPass); }
 	void Renderer::EndRenderPass() { s_RendererAPI->EndRenderPass(); }
 	
 	// Pipeline
 	void Renderer::BindPipeline(Ref<Pipeline> pipeline) { s_RendererAPI->BindPipeline(pipeline); }
+	void Renderer::PushConstantData(Ref<Pipeline> pipeline, const void* data, uint32_t size, uint32_t offset/* = 0*/) { s_RendererAPI->PushConstants(pipeline, data, size, offset); }
 	
 	// Compute
 	void Renderer::DispatchCompute(Ref<ComputePass> computePass) { s_RendererAPI->DispatchCompute(computePass); }
 
+	// Uploads
+	bool Renderer::IsUploadComplete(UploadHandle handle) { return s_RendererAPI->IsUploadComplete(handle); }
+	void Renderer::WaitForUpload(UploadHandle handle) { s_RendererAPI->WaitForUpload(handle); }
+
 	// GUI
 	void Renderer::BeginGUIRenderPass() { s_RendererAPI->BeginGUIRenderPass(); }
 	void Renderer::EndGUIRenderPass() {	s_RendererAPI->EndGUIRenderPass(); }
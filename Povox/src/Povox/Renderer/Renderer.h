@@ -34,8 +34,11 @@ namespace Povox {
 	{
 		RendererState State{};
 
-		uint32_t MaxFramesInFlight = 1;
+		uint32_t MaxFramesInFlight = 2;
 		size_t MaxSceneObjects = 1000;
+		// Threads that may record secondary command buffers at the same time, each one gets its own command pools
+		uint32_t MaxRecordingThreads = 1;
+		ShaderOptimizationSettings ShaderOptimization = ShaderOptimizationSettings::ForBuildConfiguration();
 	};
 
 	struct RendererData
@@ -127,12 +130,18 @@ namespace Povox {
 		// Render
 		static bool BeginFrame();
 		static void DrawRenderable(const Renderable& renderable);
-		static void Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless);
+		static void Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless, int32_t vertexOffset = 0);
+		// Draws without vertex buffers, the vertex shader builds its vertices from gl_VertexIndex and gl_InstanceIndex
+		static void DrawInstanced(Ref<Material> material, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance, bool textureless);
 		static void DrawGUI();
 		static void EndFrame();
 
 		static uint32_t GetCurrentFrameIndex();
 		static uint32_t GetLastFrameIndex();
+		// Frames are numbered from 1 in the order they were begun. Everything the GPU did for a frame number <= GetCompletedFrameNumber() is finished,
+		// so e.g. resources retired in that frame can be destroyed or reused
+		static uint64_t GetCurrentFrameNumber();
+		static uint64_t GetCompletedFrameNumber();
 
 		static void CreateFinalImage(Ref<Image2D> finalImage);
 		static Ref<Image2D> GetFinalImage(uint32_t frameIndex);
@@ -143,6 +152,7 @@ namespace Povox {
 		static Ref<TextureSystem> GetTextureSystem();
 		static Ref<MaterialSystem> GetMaterialSystem();
 		static Ref<ShaderResourceSystem> GetShaderResourceSystem();
+		static Ref<BufferPool> GetBufferPool();
 		static const RendererSpecification& GetSpecification();
 		static void* GetGUIDescriptorSet(Ref<Image2D> image);
 
@@ -151,17 +161,34 @@ namespace Povox {
 		static const void* GetGUICommandBuffer(uint32_t index);
 		static void BeginCommandBuffer(const void* cmd);
 		static void EndCommandBuffer();
+		// Secondary command buffers continue a parallel render pass, draws of the calling thread go into it until it is ended.
+		// Every thread recording at the same time needs its own thread index (< RendererSpecification::MaxRecordingThreads)
+		static const void* BeginSecondaryCommandBuffer(uint32_t threadIndex);
+		static void EndSecondaryCommandBuffer();
+		// Main thread only, executes the buffers in the given order
+		static void ExecuteSecondaryCommandBuffers(const std::vector<const void*>& commandBuffers);
 
 		// Renderpass
 		static void BeginRenderPass(Ref<RenderPass> renderPass);
+		// All contents of the render pass have to be recorded into secondary command buffers
+		static void BeginParallelRenderPass(Ref<RenderPass> renderPass);
 		static void EndRenderPass();
 
 		// Pipeline
 		static void BindPipeline(Ref<Pipeline> pipeline);
+		// Recorded into the command buffer of the calling thread, [offset, offset + size) has to lie within a push constant block of the pipeline's shader
+		static void PushConstantData(Ref<Pipeline> pipeline, const void* data, uint32_t size, uint32_t offset = 0);
+		template<typename T>
+		static void PushConstants(Ref<Pipeline> pipeline, const T& data, uint32_t offset = 0) { PushConstantData(pipeline, &data, sizeof(T), offset); }
 
 		// Compute
 		static void DispatchCompute(Ref<ComputePass> computePass);
 
+		// Uploads
+		// An asynchronous upload may be used by the GPU once it is complete, waiting stalls the CPU
+		static bool IsUploadComplete(UploadHandle handle);
+		static void WaitForUpload(UploadHandle handle);
+
 		// Gui
 		static void BeginGUIRenderPass();
 		static void EndGUIRenderPass();
@@ -2,11 +2,14 @@
 #include "Povox/Renderer/Renderer2D.h"
 
 #include "Povox/Core/Application.h"
+#include "Povox/Math/QuadTransform.h"
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 namespace Povox {
 	
+	static const ShaderDefines s_FogQuadDefines = { { "PX_FOG", "1" } };
 	
 	Renderer2D::Renderer2D(const Renderer2DSpecification& specs)
 		: m_Specification(specs)
@@ -16,8 +19,10 @@ namespace Povox {
 
 		// TODO: Instead of taking a name and a path, just take in a name and pass the path upon ShaderLib creation inside the RendererBackend, pointing to root/.../assets/shaders/
 		//Renderer::GetShaderLibrary()->Add("TextureShader", Shader::Create("assets/shaders/Texture.glsl"));
-		Renderer::GetShaderManager()->Add("Renderer2D_Quad", Shader::Create(std::filesystem::path("assets/shaders/Renderer2D_Quad.glsl")));
-		Renderer::GetShaderManager()->Add("Renderer2D_FullscreenQuad", Shader::Create(std::filesystem::path("assets/shaders/Renderer2D_FullscreenQuad.glsl")));
+		std::vector<std::filesystem::path> shaders = { "Renderer2D_Quad.glsl", "Renderer2D_FullscreenQuad.glsl" };
+		if (m_Specification.InstancedQuads)
+			shaders.push_back("Renderer2D_QuadInstanced.glsl");
+		Renderer::GetShaderManager()->LoadAll(shaders);
 	}
 
 	bool Renderer2D::Init()
@@ -86,6 +91,10 @@ namespace Povox {
 
 			m_QuadPipeline->PrintShaderLayout();
 
+			// Starts compiling the fog variant, see UpdateFogQuadRenderpass
+			if (m_Specification.Fog)
+				Renderer::GetShaderManager()->Get("Renderer2D_Quad", s_FogQuadDefines);
+
 		// Fullscreen
 			pipelineSpecs.Shader = Renderer::GetShaderManager()->Get("Renderer2D_FullscreenQuad");
 			m_FullscreenQuadPipeline = Pipeline::Create(pipelineSpecs);
@@ -99,14 +108,47 @@ namespace Povox {
 
 			m_FullscreenQuadPipeline->PrintShaderLayout();
 
+		// Instanced
+			if (m_Specification.InstancedQuads)
+			{
+				m_QuadInstanceData = CreateRef<StorageBuffer>(BufferLayout({
+					{ ShaderDataType::Float4, "AxisX" },
+					{ ShaderDataType::Float4, "AxisY" },
+					{ ShaderDataType::Float3, "Translation" },
+					{ ShaderDataType::UInt, "Color" } }),
+					m_Specification.QuadInstances,
+					"QuadInstanceSSBO",
+					true,
+					MemoryUtils::MemoryUsage::DIRECT_WRITE
+					);
+
+				pipelineSpecs.DebugName = "InstancedQuadPipeline";
+				pipelineSpecs.Shader = Renderer::GetShaderManager()->Get("Renderer2D_QuadInstanced");
+				pipelineSpecs.VertexInputLayout = {};
+				m_InstancedQuadPipeline = Pipeline::Create(pipelineSpecs);
+
+				renderpassSpecs.DebugName = "InstancedRenderRenderpass";
+				renderpassSpecs.Pipeline = m_InstancedQuadPipeline;
+				m_InstancedQuadRenderpass = RenderPass::Create(renderpassSpecs);
+				m_InstancedQuadRenderpass->BindInput("CameraData", m_CameraData);
+				m_InstancedQuadRenderpass->BindInput("SceneData", m_SceneData);
+				m_InstancedQuadRenderpass->BindInput("QuadInstanceData", m_QuadInstanceData);
+				m_InstancedQuadRenderpass->Bake();
+
+				m_InstancedQuadMaterial = Material::Create(Renderer::GetShaderManager()->Get("Renderer2D_QuadInstanced"), "InstancedQuad");
+
+				uint32_t maxFrames = Renderer::GetSpecification().MaxFramesInFlight;
+				m_QuadInstanceBases.resize(maxFrames);
+				m_QuadInstanceCapacities.resize(maxFrames, m_Specification.QuadInstances);
+				for (uint32_t i = 0; i < maxFrames; i++)
+				{
+					QuadInstance* mappedInstances = (QuadInstance*)m_QuadInstanceData->GetMappedData(i);
+					m_DirectInstanceWrites = mappedInstances != nullptr;
+					m_QuadInstanceBases[i] = m_DirectInstanceWrites ? mappedInstances : new QuadInstance[m_Specification.QuadInstances];
+				}
+			}
 		}
 
-		BufferSpecification vertexBufferSpecs{};
-		vertexBufferSpecs.Usage = BufferUsage::VERTEX_BUFFER;
-		vertexBufferSpecs.MemUsage = MemoryUtils::MemoryUsage::GPU_ONLY;
-		vertexBufferSpecs.ElementCount = m_Specification.MaxVertices;
-		vertexBufferSpecs.Size = sizeof(QuadVertex) * m_Specification.MaxVertices;
-
 		m_QuadVertexPositions[0] = { -0.5f, -0.5f, 0.0f, 1.0f };
 		m_QuadVertexPositions[1] = { 0.5f, -0.5f, 0.0f, 1.0f };
 		m_QuadVertexPositions[2] = { 0.5f, 0.5f, 0.0f, 1.0f };
@@ -137,14 +179,13 @@ namespace Povox {
 
 		uint32_t maxFrames = Renderer::GetSpecification().MaxFramesInFlight;
 		m_QuadVertexBuffers.resize(maxFrames);
-		m_QuadVertexBufferBases.resize(maxFrames);
+		m_QuadVertexBufferBases.resize(maxFrames, nullptr);
+		m_QuadVertexCapacities.resize(maxFrames, 0);
 		m_QuadIndexBuffers.resize(maxFrames);
 		for (uint32_t i = 0; i < maxFrames; i++)
 		{
 			// Batch
-			vertexBufferSpecs.DebugName = "Renderer2D Batch Vertexbuffer Frame: " + std::to_string(i);
-			m_QuadVertexBuffers[i] = Buffer::Create(vertexBufferSpecs);
-			m_QuadVertexBufferBases[i] = new QuadVertex[m_Specification.MaxVertices];
+			CreateQuadVertexBuffer(i, m_Specification.MaxVertices);
 
 			indexBufferSpecs.DebugName = "Renderer2D Batch Indices Frame: " + std::to_string(i);
 			m_QuadIndexBuffers[i] = Buffer::Create(indexBufferSpecs);
@@ -163,12 +204,12 @@ namespace Povox {
 		m_WhiteTexture->SetData(&whiteTextureData);
 		Renderer::GetTextureSystem()->RegisterTexture("WhiteTexture", m_WhiteTexture);
 
-		m_WhiteTextureSlot = Renderer::GetTextureSystem()->BindFixedTexture(m_WhiteTexture);
+		m_WhiteTextureSlot = Renderer::GetTextureSystem()->BindTexture(m_WhiteTexture);
 		
 		glm::vec4 vec = glm::vec4(1.0f);
 		m_SceneUniform.AmbientColor = vec;
 		m_SceneUniform.FogColor = vec;
-		m_SceneUniform.FogDistance = vec;
+		m_SceneUniform.FogDistance = glm::vec4(10.0f, 50.0f, 0.0f, 0.0f);
 		m_SceneUniform.SunlightColor = vec;
 		m_SceneUniform.SunlightDirection = vec;
 		m_SceneData->SetData((void*)&m_SceneUniform, sizeof(SceneUniform));
@@ -208,11 +249,18 @@ namespace Povox {
 		PX_PROFILE_FUNCTION();
 
 		//TODO: Investigate shutdown read access error here!
-		uint32_t maxFrames = Renderer::GetSpecification().MaxFramesInFlight;
-		for (uint32_t i = 0; i < maxFrames; i++)
+		if (!m_DirectVertexWrites)
+		{
+			for (QuadVertex* base : m_QuadVertexBufferBases)
+				delete[] base;
+		}
+		m_QuadVertexBufferBases.clear();
+		if (!m_DirectInstanceWrites)
 		{
-			delete[] m_QuadVertexBufferBases[i];
+			for (QuadInstance* base : m_QuadInstanceBases)
+				delete[] base;
 		}
+		m_QuadInstanceBases.clear();
 	}
 
 	void Renderer2D::OnResize(uint32_t width, uint32_t height)
@@ -232,6 +280,10 @@ namespace Povox {
 		// Quads
 		m_QuadRenderpass->Recreate(width, height);
 		m_FullscreenQuadRenderpass->Recreate(width, height);
+		if (m_FogQuadRenderpass)
+			m_FogQuadRenderpass->Recreate(width, height);
+		if (m_InstancedQuadRenderpass)
+			m_InstancedQuadRenderpass->Recreate(width, height);
 	}
 
 	void Renderer2D::BeginScene(const OrthographicCamera& camera)
@@ -263,8 +315,14 @@ namespace Povox {
 		auto cmd = Renderer::GetCommandBuffer(currentFrameIndex);
 		Renderer::BeginCommandBuffer(cmd);
 
+		UpdateFogQuadRenderpass();
+
 		Renderer::StartTimestampQuery("RenderRenderpass");
-		Renderer::BeginRenderPass(m_QuadRenderpass);
+		Ref<RenderPass> renderpass = m_Specification.InstancedQuads ? m_InstancedQuadRenderpass : (m_FogQuadRenderpass ? m_FogQuadRenderpass : m_QuadRenderpass);
+		if (m_Specification.ParallelRecording)
+			Renderer::BeginParallelRenderPass(renderpass);
+		else
+			Renderer::BeginRenderPass(renderpass);
 
 		m_CameraUniform.View = camera.GetViewMatrix();
 		m_CameraUniform.Projection = camera.GetProjectionMatrix();
@@ -291,6 +349,31 @@ namespace Povox {
 		}
 	}
 
+	void Renderer2D::UpdateFogQuadRenderpass()
+	{
+		if (!m_Specification.Fog || m_FogQuadRenderpass)
+			return;
+
+		// nullptr while the variant is still compiling or if it failed to compile
+		Ref<Shader> shader = Renderer::GetShaderManager()->Get("Renderer2D_Quad", s_FogQuadDefines);
+		if (!shader)
+			return;
+
+		PipelineSpecification pipelineSpecs = m_QuadPipeline->GetSpecification();
+		pipelineSpecs.DebugName = "FogTexturePipeline";
+		pipelineSpecs.Shader = shader;
+		m_FogQuadPipeline = Pipeline::Create(pipelineSpecs);
+
+		RenderPassSpecification renderpassSpecs = m_QuadRenderpass->GetSpecification();
+		renderpassSpecs.DebugName = "FogRenderRenderpass";
+		renderpassSpecs.Pipeline = m_FogQuadPipeline;
+		m_FogQuadRenderpass = RenderPass::Create(renderpassSpecs);
+		m_FogQuadRenderpass->BindInput("CameraData", m_CameraData);
+		m_FogQuadRenderpass->BindInput("SceneData", m_SceneData);
+		m_FogQuadRenderpass->BindInput("ObjectData", m_ObjectData);
+		m_FogQuadRenderpass->Bake();
+	}
+
 	void Renderer2D::StartBatch()
 	{
 		PX_PROFILE_FUNCTION();
@@ -298,9 +381,102 @@ namespace Povox {
 
 		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
 		m_QuadIndexCount = 0;
-		m_QuadVertexBufferPtr = m_QuadVertexBufferBases[currentFrame];
 
-		Renderer::GetTextureSystem()->ResetActiveTextures();
+		// Batches and scenes of one frame are laid out back to back, so no batch overwrites vertices the GPU has not consumed yet
+		uint64_t frameNumber = Renderer::GetCurrentFrameNumber();
+		bool newFrame = m_BatchFrameNumber != frameNumber;
+		m_BatchFrameNumber = frameNumber;
+		if (newFrame)
+			m_QuadVertexBufferPtr = m_QuadVertexBufferBases[currentFrame];
+
+		// Every batch before this one is flushed already, so a full buffer is replaced by a larger one instead of being overwritten
+		if (m_QuadVertexBufferPtr + 4 > m_QuadVertexBufferBases[currentFrame] + m_QuadVertexCapacities[currentFrame])
+		{
+			uint32_t capacity = m_QuadVertexCapacities[currentFrame] * 2;
+			PX_CORE_INFO("Renderer2D::StartBatch: Vertex buffer of frame {0} is full, growing it to {1} vertices.", currentFrame, capacity);
+			CreateQuadVertexBuffer(currentFrame, capacity);
+			m_QuadVertexBufferPtr = m_QuadVertexBufferBases[currentFrame];
+		}
+		m_QuadVertexBatchBase = m_QuadVertexBufferPtr;
+
+		if (m_Specification.InstancedQuads)
+		{
+			if (newFrame)
+			{
+				// The instance buffer is read through the descriptor set of this frame index, which may only change before the frame's first draw binds it
+				if (m_QuadInstanceDemand > m_QuadInstanceCapacities[currentFrame])
+					GrowQuadInstanceBuffer(currentFrame, m_QuadInstanceDemand);
+				m_QuadInstancePtr = m_QuadInstanceBases[currentFrame];
+				m_FrameQuadInstances = 0;
+				m_QuadInstanceOverflow = false;
+			}
+			m_QuadInstanceBatchBase = m_QuadInstancePtr;
+		}
+	}
+
+	void Renderer2D::GrowQuadInstanceBuffer(uint32_t frameIndex, uint32_t instanceCount)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		uint32_t capacity = m_QuadInstanceCapacities[frameIndex];
+		while (capacity < instanceCount)
+			capacity *= 2;
+		PX_CORE_INFO("Renderer2D::GrowQuadInstanceBuffer: Growing the instance buffer of frame {0} to {1} instances.", frameIndex, capacity);
+
+		if (!m_DirectInstanceWrites)
+			delete[] m_QuadInstanceBases[frameIndex];
+		m_QuadInstanceData->Resize(frameIndex, capacity);
+		m_QuadInstanceCapacities[frameIndex] = capacity;
+
+		QuadInstance* mappedInstances = (QuadInstance*)m_QuadInstanceData->GetMappedData(frameIndex);
+		m_QuadInstanceBases[frameIndex] = m_DirectInstanceWrites ? mappedInstances : new QuadInstance[capacity];
+
+		// Written right away for this frame index, the other frames' sets are rewritten once they begin the pass
+		m_InstancedQuadRenderpass->UpdateDescriptor("QuadInstanceData");
+	}
+
+	bool Renderer2D::ReserveQuadInstance()
+	{
+		m_QuadInstanceDemand = std::max(m_QuadInstanceDemand, ++m_FrameQuadInstances);
+
+		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
+		if (m_QuadInstancePtr < m_QuadInstanceBases[currentFrame] + m_QuadInstanceCapacities[currentFrame])
+			return true;
+
+		// Earlier batches of this frame still read the buffer, so the quad is dropped instead of overwriting them
+		if (!m_QuadInstanceOverflow)
+		{
+			PX_CORE_WARN("Renderer2D::ReserveQuadInstance: Instance buffer of frame {0} is full, dropping quads until it grows next frame!", currentFrame);
+			m_QuadInstanceOverflow = true;
+		}
+		return false;
+	}
+
+	void Renderer2D::CreateQuadVertexBuffer(uint32_t frameIndex, uint32_t vertexCount)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		// Draws recorded into the old buffer are still pending, Free() keeps it alive until this frame completed
+		if (m_QuadVertexBuffers[frameIndex])
+			m_QuadVertexBuffers[frameIndex]->Free();
+		if (!m_DirectVertexWrites)
+			delete[] m_QuadVertexBufferBases[frameIndex];
+
+		BufferSpecification vertexBufferSpecs{};
+		vertexBufferSpecs.Usage = BufferUsage::VERTEX_BUFFER;
+		vertexBufferSpecs.MemUsage = MemoryUtils::MemoryUsage::DIRECT_WRITE;
+		vertexBufferSpecs.ElementCount = vertexCount;
+		vertexBufferSpecs.Size = sizeof(QuadVertex) * vertexCount;
+		vertexBufferSpecs.DebugName = "Renderer2D Batch Vertexbuffer Frame: " + std::to_string(frameIndex);
+		m_QuadVertexBuffers[frameIndex] = Buffer::Create(vertexBufferSpecs);
+		m_QuadVertexCapacities[frameIndex] = vertexCount;
+
+		// Quads are written straight into the mapped vertex buffer, the CPU side array is only needed if mapping is unavailable
+		QuadVertex* mappedVertices = (QuadVertex*)m_QuadVertexBuffers[frameIndex]->GetMappedData();
+		m_DirectVertexWrites = mappedVertices != nullptr;
+		m_QuadVertexBufferBases[frameIndex] = m_DirectVertexWrites ? mappedVertices : new QuadVertex[vertexCount];
 	}
 
 	void Renderer2D::Flush()
@@ -312,9 +488,39 @@ namespace Povox {
 		if (m_QuadIndexCount == 0)
 			return; // nothing to draw
 
-		uint32_t dataSize = (uint32_t)((uint8_t*)m_QuadVertexBufferPtr - (uint8_t*)m_QuadVertexBufferBases[currentFrame]);
-		m_QuadVertexBuffers[currentFrame]->SetData(m_QuadVertexBufferBases[currentFrame], dataSize);		
-		Renderer::Draw(m_QuadVertexBuffers[currentFrame], m_QuadMaterial, m_QuadIndexBuffers[currentFrame], m_QuadIndexCount, false);
+		if (m_Specification.InstancedQuads)
+		{
+			uint32_t firstInstance = (uint32_t)(m_QuadInstanceBatchBase - m_QuadInstanceBases[currentFrame]);
+			uint32_t instanceCount = (uint32_t)(m_QuadInstancePtr - m_QuadInstanceBatchBase);
+			size_t dataSize = instanceCount * sizeof(QuadInstance);
+			if (m_DirectInstanceWrites)
+				m_QuadInstanceData->FlushMappedData(currentFrame, firstInstance * sizeof(QuadInstance), dataSize);
+			else
+				m_QuadInstanceData->SetData(m_QuadInstanceBatchBase, firstInstance * sizeof(QuadInstance), dataSize);
+
+			if (m_Specification.ParallelRecording)
+				m_SecondaryCommandBuffers.push_back(Renderer::BeginSecondaryCommandBuffer(0));
+			Renderer::DrawInstanced(m_InstancedQuadMaterial, 6, instanceCount, firstInstance, false);
+			if (m_Specification.ParallelRecording)
+				Renderer::EndSecondaryCommandBuffer();
+
+			m_Stats.DrawCalls++;
+			return;
+		}
+
+		uint32_t vertexOffset = (uint32_t)(m_QuadVertexBatchBase - m_QuadVertexBufferBases[currentFrame]);
+		uint32_t dataSize = (uint32_t)((uint8_t*)m_QuadVertexBufferPtr - (uint8_t*)m_QuadVertexBatchBase);
+		if (m_DirectVertexWrites)
+			m_QuadVertexBuffers[currentFrame]->FlushMappedData(vertexOffset * sizeof(QuadVertex), dataSize);
+		else
+			m_QuadVertexBuffers[currentFrame]->SetData(m_QuadVertexBatchBase, vertexOffset * sizeof(QuadVertex), dataSize);
+
+		// The main thread records with thread index 0, it never does so while workers record
+		if (m_Specification.ParallelRecording)
+			m_SecondaryCommandBuffers.push_back(Renderer::BeginSecondaryCommandBuffer(0));
+		Renderer::Draw(m_QuadVertexBuffers[currentFrame], m_QuadMaterial, m_QuadIndexBuffers[currentFrame], m_QuadIndexCount, false, (int32_t)vertexOffset);
+		if (m_Specification.ParallelRecording)
+			Renderer::EndSecondaryCommandBuffer();
 
 		
 		m_Stats.DrawCalls++;
@@ -326,6 +532,11 @@ namespace Povox {
 
 		Flush();
 
+		if (m_Specification.ParallelRecording)
+		{
+			Renderer::ExecuteSecondaryCommandBuffers(m_SecondaryCommandBuffers);
+			m_SecondaryCommandBuffers.clear();
+		}
 
 		Renderer::EndRenderPass();
 		Renderer::StopTimestampQuery("RenderRenderpass");
@@ -335,6 +546,31 @@ namespace Povox {
 		m_FinalImage = m_QuadFramebuffer->GetColorAttachment(0);
 	}
 
+	bool Renderer2D::IsFrameVertexBufferFull() const
+	{
+		// Instances never start a new batch, ReserveQuadInstance rejects the ones that do not fit
+		if (m_Specification.InstancedQuads)
+			return false;
+		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
+		return m_QuadVertexBufferPtr + 4 > m_QuadVertexBufferBases[currentFrame] + m_QuadVertexCapacities[currentFrame];
+	}
+
+	void Renderer2D::WriteQuadInstance(const glm::mat4& transform, const glm::vec4& color, uint32_t textureIndex, float tilingFactor)
+	{
+		if (!ReserveQuadInstance())
+			return;
+
+		// Quad corners are (+-0.5, +-0.5, 0, 1), so the third column of the transform never contributes
+		m_QuadInstancePtr->AxisX = glm::vec4(glm::vec3(transform[0]), tilingFactor);
+		m_QuadInstancePtr->AxisY = glm::vec4(glm::vec3(transform[1]), glm::uintBitsToFloat(textureIndex));
+		m_QuadInstancePtr->Translation = glm::vec3(transform[3]);
+		m_QuadInstancePtr->Color = glm::packUnorm4x8(color);
+		m_QuadInstancePtr++;
+
+		m_QuadIndexCount += 6;
+		m_Stats.QuadCount++;
+	}
+
 	void Renderer2D::NextBatch()
 	{
 		Flush();
@@ -377,12 +613,8 @@ namespace Povox {
 	}
 	void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2 size, const glm::vec4& color)
 	{
-		constexpr glm::vec2 textureCoords[4] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
-
-		glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
-			* glm::scale(glm::mat4(1.0f), { size.x, size.y, 1.0f });		
-
-		DrawQuad(transform, color);
+		Quad2D quad{ position, 0.0f, size, color };
+		DrawQuads(&quad, 1);
 	}
 	void Renderer2D::DrawQuad(const glm::mat4& transform, const glm::vec4& color, UUID entityID)
 	{
@@ -392,9 +624,15 @@ namespace Povox {
 		constexpr glm::vec2 textureCoords[4] = { {1.0f, 1.0f}, {1.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 1.0f} };
 
 		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
-		if (m_QuadIndexCount >= m_Specification.MaxIndices)
+		if (m_QuadIndexCount >= m_Specification.MaxIndices || IsFrameVertexBufferFull())
 			NextBatch();
 
+		if (m_Specification.InstancedQuads)
+		{
+			WriteQuadInstance(transform, color, m_WhiteTextureSlot, 1.0f);
+			return;
+		}
+
 		for (uint32_t i = 0; i < 4; i++)
 		{
 			m_QuadVertexBufferPtr->Position = transform * m_QuadVertexPositions[i];
@@ -414,10 +652,8 @@ namespace Povox {
 	}
 	void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2 size, const Ref<Texture2D>& texture, float tilingFactor, const glm::vec4& tintingColor)
 	{
-		glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
-			* glm::scale(glm::mat4(1.0f), { size.x, size.y, 1.0f });
-
-		DrawQuad(transform, texture, tilingFactor, tintingColor);
+		Quad2D quad{ position, 0.0f, size, tintingColor };
+		DrawQuads(&quad, 1, texture, tilingFactor);
 	}
 	void Renderer2D::DrawQuad(const glm::mat4& transform, const Ref<Texture2D>& texture, float tilingFactor, const glm::vec4& tintingColor, UUID entityID)
 	{
@@ -427,14 +663,18 @@ namespace Povox {
 		constexpr glm::vec2 textureCoords[4] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
 		
 		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
-		if (m_QuadIndexCount >= m_Specification.MaxIndices)
+		if (m_QuadIndexCount >= m_Specification.MaxIndices || IsFrameVertexBufferFull())
 			NextBatch();
 
-		//Will return the first slot possible if allSlotsFull is true
-		uint32_t textureIndex = Renderer::GetTextureSystem()->BindTexture(texture);
-		if (textureIndex >= m_Specification.MaxTextureSlots)
-			NextBatch();
-		textureIndex = Renderer::GetTextureSystem()->BindTexture(texture);
+		// Textures still uploading on the transfer queue are drawn white until they are ready
+		// The bindless index is stable, so the number of different textures never breaks the batch
+		uint32_t textureIndex = texture->IsReady() ? Renderer::GetTextureSystem()->BindTexture(texture) : m_WhiteTextureSlot;
+
+		if (m_Specification.InstancedQuads)
+		{
+			WriteQuadInstance(transform, tintingColor, textureIndex, tilingFactor);
+			return;
+		}
 
 		for (uint32_t i = 0; i < 4; i++)
 		{
@@ -467,7 +707,7 @@ namespace Povox {
 
 		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
 
-		if (m_QuadIndexCount >= m_Specification.MaxIndices)
+		if (m_QuadIndexCount >= m_Specification.MaxIndices || IsFrameVertexBufferFull())
 			NextBatch();
 
 		//float textureIndex = 0.0f;
@@ -510,11 +750,8 @@ namespace Povox {
 	}
 	void Renderer2D::DrawRotatedQuad(const glm::vec3& position, const glm::vec2 size, float rotation, const glm::vec4& color)
 	{
-		glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
-			* glm::rotate(glm::mat4(1.0f), rotation, { 0.0f, 0.0f, 1.0f })
-			* glm::scale(glm::mat4(1.0f), { size.x, size.y, 1.0f });
-
-		DrawQuad(transform, color);
+		Quad2D quad{ position, rotation, size, color };
+		DrawQuads(&quad, 1);
 	}
 	void Renderer2D::DrawRotatedQuad(const glm::vec2& position, const glm::vec2 size, float rotation, const Ref<Texture2D>& texture, float tilingFactor, const glm::vec4& tintingColor)
 	{
@@ -522,11 +759,8 @@ namespace Povox {
 	}
 	void Renderer2D::DrawRotatedQuad(const glm::vec3& position, const glm::vec2 size, float rotation, const Ref<Texture2D>& texture, float tilingFactor, const glm::vec4& tintingColor)
 	{
-		glm::mat4 transform = glm::translate(glm::mat4(1.0f), position)
-			* glm::rotate(glm::mat4(1.0f), rotation, { 0.0f, 0.0f, 1.0f })
-			* glm::scale(glm::mat4(1.0f), { size.x, size.y, 1.0f });
-		
-		DrawQuad(transform, texture, tilingFactor, tintingColor);
+		Quad2D quad{ position, rotation, size, tintingColor };
+		DrawQuads(&quad, 1, texture, tilingFactor);
 	}
 	void Renderer2D::DrawRotatedQuad(const glm::vec2& position, const glm::vec2 size, float rotation, const Ref<SubTexture2D>& subTexture, float tilingFactor, const glm::vec4& tintingColor)
 	{
@@ -542,6 +776,126 @@ namespace Povox {
 	}
 
 
+//Batched
+	void Renderer2D::DrawQuads(const Quad2D* quads, size_t count, const Ref<Texture2D>& texture, float tilingFactor)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		uint32_t textureIndex = (texture && texture->IsReady()) ? Renderer::GetTextureSystem()->BindTexture(texture) : m_WhiteTextureSlot;
+
+		if (m_Specification.InstancedQuads)
+		{
+			uint32_t written = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (!ReserveQuadInstance())
+					continue;
+
+				const Quad2D& quad = quads[i];
+				float c = glm::cos(quad.Rotation);
+				float s = glm::sin(quad.Rotation);
+				m_QuadInstancePtr->AxisX = glm::vec4(c * quad.Size.x, s * quad.Size.x, 0.0f, tilingFactor);
+				m_QuadInstancePtr->AxisY = glm::vec4(-s * quad.Size.y, c * quad.Size.y, 0.0f, glm::uintBitsToFloat(textureIndex));
+				m_QuadInstancePtr->Translation = quad.Position;
+				m_QuadInstancePtr->Color = glm::packUnorm4x8(quad.Color);
+				m_QuadInstancePtr++;
+
+				m_QuadIndexCount += 6;
+				written++;
+			}
+			m_Stats.QuadCount += written;
+			return;
+		}
+
+		// Quads are transformed in runs that fit into the current batch
+		while (count > 0)
+		{
+			bool parallel = m_Specification.ParallelRecording && count >= 2 * (size_t)m_Specification.MinQuadsPerThread;
+
+			// A parallel run records its own draws, the pending batch has to be drawn before it to keep the order
+			if (m_QuadIndexCount >= m_Specification.MaxIndices || IsFrameVertexBufferFull() || (parallel && m_QuadIndexCount > 0))
+				NextBatch();
+
+			uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
+			QuadVertex* frameEnd = m_QuadVertexBufferBases[currentFrame] + m_QuadVertexCapacities[currentFrame];
+			if (parallel)
+			{
+				// Every thread draws at most MaxQuads, the index buffer is not any larger
+				size_t runCount = std::min<size_t>(count, (frameEnd - m_QuadVertexBufferPtr) / 4);
+				runCount = std::min<size_t>(runCount, (size_t)Renderer::GetSpecification().MaxRecordingThreads * m_Specification.MaxQuads);
+				DrawQuadsParallel(quads, runCount, textureIndex);
+
+				quads += runCount;
+				count -= runCount;
+				continue;
+			}
+
+			size_t freeQuads = std::min<size_t>((m_Specification.MaxIndices - m_QuadIndexCount) / 6, (frameEnd - m_QuadVertexBufferPtr) / 4);
+			size_t runCount = std::min(count, freeQuads);
+
+			Math::TransformQuads2D(quads, runCount, (float)textureIndex, m_QuadVertexBufferPtr);
+			m_QuadVertexBufferPtr += runCount * 4;
+			m_QuadIndexCount += (uint32_t)runCount * 6;
+			m_Stats.QuadCount += (uint32_t)runCount;
+
+			quads += runCount;
+			count -= runCount;
+		}
+	}
+
+	void Renderer2D::DrawQuadsParallel(const Quad2D* quads, size_t count, uint32_t textureIndex)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		uint32_t currentFrame = Renderer::GetCurrentFrameIndex();
+		uint32_t maxThreads = Renderer::GetSpecification().MaxRecordingThreads;
+		uint32_t taskCount = (uint32_t)std::clamp<size_t>(count / m_Specification.MinQuadsPerThread, 1, maxThreads);
+		taskCount = std::max(taskCount, (uint32_t)((count + m_Specification.MaxQuads - 1) / m_Specification.MaxQuads));
+
+		QuadVertex* runBase = m_QuadVertexBufferPtr;
+		uint32_t runVertexOffset = (uint32_t)(runBase - m_QuadVertexBufferBases[currentFrame]);
+		Ref<Buffer> vertexBuffer = m_QuadVertexBuffers[currentFrame];
+		Ref<Buffer> indexBuffer = m_QuadIndexBuffers[currentFrame];
+
+		// Every task fills its own vertex range and records it into a secondary buffer from the pool of its thread index
+		std::vector<const void*> taskCommandBuffers(taskCount);
+		Application::Get()->GetThreadPool().ParallelFor(taskCount, [&](uint32_t task)
+		{
+			size_t first = count * task / taskCount;
+			size_t last = count * (task + 1) / taskCount;
+			if (first == last)
+				return;
+
+			Math::TransformQuads2D(quads + first, last - first, (float)textureIndex, runBase + first * 4);
+
+			taskCommandBuffers[task] = Renderer::BeginSecondaryCommandBuffer(task);
+			Renderer::Draw(vertexBuffer, m_QuadMaterial, indexBuffer, (last - first) * 6, false, (int32_t)(runVertexOffset + first * 4));
+			Renderer::EndSecondaryCommandBuffer();
+		});
+
+		// Uploads are not thread safe, the whole run goes up at once
+		uint32_t dataSize = (uint32_t)(count * 4 * sizeof(QuadVertex));
+		if (m_DirectVertexWrites)
+			vertexBuffer->FlushMappedData(runVertexOffset * sizeof(QuadVertex), dataSize);
+		else
+			vertexBuffer->SetData(runBase, runVertexOffset * sizeof(QuadVertex), dataSize);
+
+		for (const void* cmd : taskCommandBuffers)
+		{
+			if (cmd)
+			{
+				m_SecondaryCommandBuffers.push_back(cmd);
+				m_Stats.DrawCalls++;
+			}
+		}
+
+		m_QuadVertexBufferPtr += count * 4;
+		m_QuadVertexBatchBase = m_QuadVertexBufferPtr;
+		m_Stats.QuadCount += (uint32_t)count;
+	}
+
 //Sprite
 	void Renderer2D::DrawSprite(const glm::mat4& transform, SpriteRendererComponent& src, UUID entityID)
 	{
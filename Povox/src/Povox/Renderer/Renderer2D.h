@@ -25,7 +25,18 @@ namespace Povox {
 		static const uint32_t MaxQuads = 60000;
 		static const uint32_t MaxVertices = MaxQuads * 4;
 		static const uint32_t MaxIndices = MaxQuads * 6;
-		static const uint32_t MaxTextureSlots = 32; //TODO: needs to be dynamic to the GPU, comes from Renderer Capabilities
+
+		// Quads are written as one QuadInstance each and expanded by the vertex shader instead of four CPU transformed vertices
+		bool InstancedQuads = false;
+		// Instances per frame the instance buffer starts with, it grows to the largest frame drawn so far
+		uint32_t QuadInstances = 16384;
+		// Quads are recorded into secondary command buffers, large DrawQuads calls are split across the application's worker threads
+		bool ParallelRecording = false;
+		// DrawQuads calls with less quads per thread stay on the calling thread
+		uint32_t MinQuadsPerThread = 4096;
+		// Batched quads fade into SceneUniform::FogColor with their view depth. The fog variant of the quad shader is compiled in the background,
+		// quads are drawn without fog until it is ready
+		bool Fog = false;
 
 		//TODO: Temp, move to scene
 		uint32_t ViewportWidth = 0;
@@ -86,6 +97,9 @@ namespace Povox {
 		void DrawRotatedQuad(const glm::vec3& position, const glm::vec2 size, float rotation, const Ref<SubTexture2D>& subTexture, float tilingFactor = 1.0f, const glm::vec4& tintingColor = glm::vec4(1.0f));
 		void DrawQuad(const glm::mat4& transform, const Ref<SubTexture2D>& texture, float tilingFactor = 1.0f, const glm::vec4& tintingColor = glm::vec4(1.0f), UUID entityID = UUID(0));
 
+		//Batched, all quads share the texture (white if none), Quad2D::Color tints it
+		void DrawQuads(const Quad2D* quads, size_t count, const Ref<Texture2D>& texture = nullptr, float tilingFactor = 1.0f);
+
 
 		void DrawSprite(const glm::mat4& transform, SpriteRendererComponent& src, UUID enittyID);
 		void DrawFullscreenQuad();
@@ -98,6 +112,13 @@ namespace Povox {
 	private:
 		void NextBatch();
 		void StartBatch();
+		bool IsFrameVertexBufferFull() const;
+		void CreateQuadVertexBuffer(uint32_t frameIndex, uint32_t vertexCount);
+		bool ReserveQuadInstance();
+		void GrowQuadInstanceBuffer(uint32_t frameIndex, uint32_t instanceCount);
+		void WriteQuadInstance(const glm::mat4& transform, const glm::vec4& color, uint32_t textureIndex, float tilingFactor);
+		void DrawQuadsParallel(const Quad2D* quads, size_t count, uint32_t textureIndex);
+		void UpdateFogQuadRenderpass();
 
 	private:
 		Renderer2DSpecification m_Specification{};
@@ -125,14 +146,41 @@ namespace Povox {
 		Ref<Framebuffer> m_QuadFramebuffer = nullptr;
 		Ref<Pipeline> m_QuadPipeline = nullptr;
 		Ref<Material> m_QuadMaterial = nullptr;
+		// Replaces the quad renderpass once the fog variant is ready
+		Ref<RenderPass> m_FogQuadRenderpass = nullptr;
+		Ref<Pipeline> m_FogQuadPipeline = nullptr;
 
 		std::vector<Ref<Buffer>> m_QuadVertexBuffers;
 		std::vector<QuadVertex*> m_QuadVertexBufferBases;
+		std::vector<uint32_t> m_QuadVertexCapacities;
+		QuadVertex* m_QuadVertexBatchBase = nullptr;
 		QuadVertex* m_QuadVertexBufferPtr = nullptr;
+		bool m_DirectVertexWrites = false;
+		// Frame number the write pointers belong to, every scene of one frame appends behind the previous one
+		uint64_t m_BatchFrameNumber = 0;
 
 		std::vector<Ref<Buffer>> m_QuadIndexBuffers;
 		uint32_t m_QuadIndexCount = 0;
 
+		// Secondary command buffers of the scene in draw order, executed at EndScene
+		std::vector<const void*> m_SecondaryCommandBuffers;
+
+		// Instanced Quads
+		Ref<RenderPass> m_InstancedQuadRenderpass = nullptr;
+		Ref<Pipeline> m_InstancedQuadPipeline = nullptr;
+		Ref<Material> m_InstancedQuadMaterial = nullptr;
+
+		Ref<StorageBuffer> m_QuadInstanceData = nullptr;
+		std::vector<QuadInstance*> m_QuadInstanceBases;
+		std::vector<uint32_t> m_QuadInstanceCapacities;
+		// Instances requested this frame and the most any frame requested, including the ones that did not fit
+		uint32_t m_FrameQuadInstances = 0;
+		uint32_t m_QuadInstanceDemand = 0;
+		bool m_QuadInstanceOverflow = false;
+		QuadInstance* m_QuadInstanceBatchBase = nullptr;
+		QuadInstance* m_QuadInstancePtr = nullptr;
+		bool m_DirectInstanceWrites = false;
+
 		glm::vec4 m_QuadVertexPositions[4];
 
 		// FullscreenQuad
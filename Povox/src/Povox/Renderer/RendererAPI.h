@@ -46,10 +46,13 @@ namespace Povox {
 		virtual bool BeginFrame() = 0;
 		virtual void EndFrame() = 0;
 		virtual void DrawRenderable(const Renderable& renderable) = 0;
-		virtual void Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless) = 0;
+		virtual void Draw(Ref<Buffer> vertices, Ref<Material> material, Ref<Buffer> indices, size_t indexCount, bool textureless, int32_t vertexOffset) = 0;
+		virtual void DrawInstanced(Ref<Material> material, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstInstance, bool textureless) = 0;
 
 		virtual uint32_t GetCurrentFrameIndex() const = 0;
 		virtual uint32_t GetLastFrameIndex() const = 0;
+		virtual uint64_t GetCurrentFrameNumber() const = 0;
+		virtual uint64_t GetCompletedFrameNumber() const = 0;
 
 		virtual void CreateFinalImage(Ref<Image2D> finalImage) = 0;
 		virtual Ref<Image2D> GetFinalImage(uint32_t frameIndex) const = 0;
@@ -68,6 +71,7 @@ namespace Povox {
 		virtual Ref<TextureSystem> GetTextureSystem() const = 0;
 		virtual Ref<MaterialSystem> GetMaterialSystem() const = 0;
 		virtual Ref<ShaderResourceSystem> GetShaderResourceSystem() const = 0;
+		virtual Ref<BufferPool> GetBufferPool() const = 0;
 
 		virtual const RendererSpecification& GetSpecification() const = 0;
 		virtual void* GetGUIDescriptorSet(Ref<Image2D> image) const = 0;
@@ -77,14 +81,22 @@ namespace Povox {
 		virtual const void* GetGUICommandBuffer(uint32_t index) = 0;
 		virtual void BeginCommandBuffer(const void* cmd) = 0;
 		virtual void EndCommandBuffer() = 0;
+		virtual const void* BeginSecondaryCommandBuffer(uint32_t threadIndex) = 0;
+		virtual void EndSecondaryCommandBuffer() = 0;
+		virtual void ExecuteSecondaryCommandBuffers(const std::vector<const void*>& commandBuffers) = 0;
 
 		// Renderpass
 		virtual void BeginRenderPass(Ref<RenderPass> renderPass) = 0;
+		virtual void BeginParallelRenderPass(Ref<RenderPass> renderPass) = 0;
 		virtual void EndRenderPass() = 0;
 
 		// Compute
 		virtual void DispatchCompute(Ref<ComputePass> computePass) = 0;
 
+		// Uploads
+		virtual bool IsUploadComplete(UploadHandle handle) const = 0;
+		virtual void WaitForUpload(UploadHandle handle) = 0;
+
 		// GUI
 		virtual void DrawGUI() = 0;
 		virtual void BeginGUIRenderPass() = 0;
@@ -92,6 +104,7 @@ namespace Povox {
 
 		// Pipeline
 		virtual void BindPipeline(Ref<Pipeline> pipeline) = 0;
+		virtual void PushConstants(Ref<Pipeline> pipeline, const void* data, uint32_t size, uint32_t offset) = 0;
 
 
 		// Debugging and Statistics
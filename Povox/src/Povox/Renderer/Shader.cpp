@@ -44,4 +44,38 @@ namespace Povox {
 		PX_CORE_ASSERT(false, "Unknown RendererAPI");
 		return nullptr;
 	}
+	std::vector<Ref<Shader>> Shader::Create(const std::vector<ShaderSource>& shaderSources)
+	{
+		switch (Renderer::GetAPI())
+		{
+			case RendererAPI::API::Vulkan:
+			{
+				return VulkanShader::CreateBatch(shaderSources);
+			}
+			case RendererAPI::API::NONE:
+			{
+				PX_CORE_ASSERT(false, "RendererAPI::NONE is not supported!");
+				return {};
+			}
+		}
+		PX_CORE_ASSERT(false, "Unknown RendererAPI");
+		return {};
+	}
+	Ref<Shader> Shader::CreateDeferred(const std::string& debugName, const ShaderDefines& defines)
+	{
+		switch (Renderer::GetAPI())
+		{
+			case RendererAPI::API::Vulkan:
+			{
+				return CreateRef<VulkanShader>(debugName, defines);
+			}
+			case RendererAPI::API::NONE:
+			{
+				PX_CORE_ASSERT(false, "RendererAPI::NONE is not supported!");
+				return nullptr;
+			}
+		}
+		PX_CORE_ASSERT(false, "Unknown RendererAPI");
+		return nullptr;
+	}
 }
@@ -2,8 +2,10 @@
 #include "Povox/Core/UUID.h"
 //#include "Povox/Renderer/Pipeline.h"
 
+#include <map>
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <filesystem>
 
 #include <glm/glm.hpp>
@@ -88,6 +90,68 @@ namespace Povox {
 	}
 	
 	using ShaderHandle = UUID;
+	// Preprocessor defines a shader is compiled with, ordered so equal sets hash equal
+	using ShaderDefines = std::map<std::string, std::string>;
+
+	// Reflected from `layout(constant_id = N) const` declarations, a compute shader's local_size_*_id constants are named local_size_x/y/z
+	struct ShaderSpecializationConstant
+	{
+		uint32_t ConstantID = 0;
+		// Bool, Int, UInt or Float, specialization constants are 32 bit only
+		ShaderDataType Type = ShaderDataType::None;
+		std::string Name;
+	};
+
+	enum class ShaderOptimizationLevel
+	{
+		None = 0,
+		Size,
+		Performance
+	};
+
+	struct ShaderOptimizationSettings
+	{
+		ShaderOptimizationLevel Level = ShaderOptimizationLevel::None;
+		// spirv-opt flags run after the level's passes, e.g. "--eliminate-dead-code-aggressive"
+		std::vector<std::string> Passes;
+		// Strips names and source info from the modules handed to the driver. The stripped copy is cached next to the full binary, which keeps them for reflection
+		bool StripDebugInfo = false;
+
+		static ShaderOptimizationSettings ForBuildConfiguration()
+		{
+			ShaderOptimizationSettings settings{};
+#if defined(PX_RELEASE)
+			settings.Level = ShaderOptimizationLevel::Performance;
+#elif defined(PX_DIST)
+			settings.Level = ShaderOptimizationLevel::Performance;
+			settings.StripDebugInfo = true;
+#endif
+			return settings;
+		}
+	};
+
+	struct ShaderStageStatistics
+	{
+		// Before is the unoptimized output of the compiler, it stays 0 for binaries loaded from the cache
+		uint32_t InstructionsBefore = 0;
+		uint32_t InstructionsAfter = 0;
+		size_t SizeBefore = 0;
+		size_t SizeAfter = 0;
+		float CompileTimeMs = 0.0f;
+		bool Cached = false;
+	};
+
+	struct ShaderCompileStatistics
+	{
+		std::map<std::string, ShaderStageStatistics> Stages;
+	};
+
+	struct ShaderSource
+	{
+		std::string DebugName;
+		std::string Sources;
+		ShaderDefines Defines;
+	};
 
 	struct ShaderResourceDescription;
 	class Pipeline;
@@ -99,8 +163,14 @@ namespace Povox {
 
 		virtual void Free() = 0;
 		virtual bool Recompile(const std::string& sources) = 0;
+		// Two halves of Recompile: Prepare compiles and reflects on any thread, Apply swaps the result in on the main thread between frames.
+		// Apply keeps the current version if the new one does not fit the layout of the pipelines already using this shader
+		virtual bool PrepareRecompile(const std::string& sources) = 0;
+		virtual bool ApplyPendingRecompile() = 0;
 
 		virtual const std::unordered_map<std::string, Ref<ShaderResourceDescription>>& GetResourceDescriptions() const = 0;
+		virtual const ShaderCompileStatistics& GetCompileStatistics() const = 0;
+		virtual const ShaderDefines& GetDefines() const = 0;
 
 		virtual void AddPipeline(Ref<Pipeline> pipeline) = 0;
 		virtual void AddComputePipeline(Ref<ComputePipeline> pipeline) = 0;
@@ -113,6 +183,10 @@ namespace Povox {
 		
 		static Ref<Shader> Create(const std::string& sources, const std::string& debugName);
 		static Ref<Shader> Create(const std::filesystem::path& filepath);
+		// Compiles all shaders at once, the result has the same order as shaderSources
+		static std::vector<Ref<Shader>> Create(const std::vector<ShaderSource>& shaderSources);
+		// Creates a shader without any stages, PrepareRecompile and ApplyPendingRecompile compile it later, e.g. on a worker thread
+		static Ref<Shader> CreateDeferred(const std::string& debugName, const ShaderDefines& defines);
 	};
 	
 }
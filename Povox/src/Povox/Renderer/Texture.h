@@ -9,6 +9,13 @@ namespace Povox {
 
 	using TextureHandle = UUID;
 
+	// Slot in the TextureSystem's slot table, the generation invalidates handles to slots that got reused
+	struct TextureSlotHandle
+	{
+		uint32_t Slot = UINT32_MAX;
+		uint32_t Generation = 0;
+	};
+
 	class Texture
 	{
 	public:
@@ -19,6 +26,9 @@ namespace Povox {
 		virtual uint32_t GetHeight() const = 0;
 
 		virtual void SetData(void* data) = 0;
+		virtual UploadHandle SetDataAsync(void* data) = 0;
+		// False while the initial upload of a loaded texture is still in flight
+		virtual bool IsReady() const = 0;
 
 		virtual const Ref<Image2D> GetImage() const = 0;
 		virtual Ref<Image2D> GetImage() = 0;
@@ -27,6 +37,13 @@ namespace Povox {
 		virtual const std::string& GetDebugName() const = 0;
 
 		virtual bool operator==(const Texture& other) const = 0;
+
+		// Assigned by the TextureSystem, invalid as long as the texture has no slot
+		inline TextureSlotHandle GetSlotHandle() const { return m_SlotHandle; }
+		inline void SetSlotHandle(TextureSlotHandle handle) { m_SlotHandle = handle; }
+
+	protected:
+		TextureSlotHandle m_SlotHandle{};
 	};
 
 	class Texture2D : public Texture
@@ -39,6 +56,9 @@ namespace Povox {
 		virtual uint32_t GetHeight() const = 0;
 
 		virtual void SetData(void* data) = 0;
+		virtual UploadHandle SetDataAsync(void* data) = 0;
+		// False while the initial upload of a loaded texture is still in flight
+		virtual bool IsReady() const = 0;
 
 		virtual const Ref<Image2D> GetImage() const = 0;
 		virtual Ref<Image2D> GetImage() = 0;
@@ -14,8 +14,19 @@ namespace Povox {
 			DOWNLOAD = 4,
 
 			CPU_COPY = 5,
+			// Persistently mapped and written by the CPU in place, device local if the device exposes host visible VRAM (ReBAR), CPU_TO_GPU otherwise
+			DIRECT_WRITE = 6,
+
 			CPU_TO_GPU = UPLOAD,
 			GPU_TO_CPU = DOWNLOAD
 		};
 	}
+
+	// Identifies an asynchronous upload. Value is the transfer timeline value that signals its completion, 0 if the data was written synchronously
+	struct UploadHandle
+	{
+		uint64_t Value = 0;
+
+		inline bool IsSynchronous() const { return Value == 0; }
+	};
 }
@@ -13,6 +13,21 @@
 
 namespace Povox {
 
+	static Hash_128Bit HashShaderSources(const std::string& sources)
+	{
+		std::vector<char> cstr(sources.c_str(), sources.c_str() + sources.size() + 1);
+		auto hash = XXH3_128bits((const void*)cstr.data(), cstr.size());
+		return Hash_128Bit{ hash.low64, hash.high64 };
+	}
+
+	static uint64_t HashShaderDefines(const ShaderDefines& defines)
+	{
+		std::string combined;
+		for (const auto& [name, value] : defines)
+			combined += name + "=" + value + "\n";
+		return XXH3_64bits(combined.data(), combined.size());
+	}
+
 	//------------------ShaderLibrary---------------------
 	ShaderManager::ShaderManager(const std::filesystem::path& fileSystemShadersPath)
 		: m_FileSystemShadersPath(fileSystemShadersPath)
@@ -31,6 +46,11 @@ namespace Povox {
 		{
 			shader.second->Free();
 		}
+		for (auto& [handle, meta] : m_Registry)
+		{
+			for (auto& [definesHash, variant] : meta.Variants)
+				variant.Shader->Free();
+		}
 
 
 		PX_CORE_INFO("ShaderLibrary::Shutdown: Completed.");
@@ -62,32 +82,57 @@ namespace Povox {
 	}
 
 	ShaderHandle ShaderManager::Load(const std::filesystem::path& shaderName)
-	{	
-		PX_CORE_WARN("File name: {}", shaderName.string());
-		PX_CORE_WARN("File name: {}", shaderName.extension().string());
-		if (shaderName.extension().string() != ".glsl")
+	{
+		return LoadAll({ shaderName }).front();
+	}
+
+	std::vector<ShaderHandle> ShaderManager::LoadAll(const std::vector<std::filesystem::path>& shaderNames)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		std::vector<ShaderHandle> handles(shaderNames.size(), 0);
+		std::vector<ShaderMetaData> metas;
+		std::vector<ShaderSource> shaderSources;
+		std::vector<size_t> metaToHandleIndex;
+		for (size_t i = 0; i < shaderNames.size(); i++)
 		{
-			PX_CORE_WARN("File is no shader");
-			return 0;
-		}
+			const std::filesystem::path& shaderName = shaderNames[i];
+			if (shaderName.extension().string() != ".glsl")
+			{
+				PX_CORE_WARN("ShaderManager::LoadAll: File {} is no shader", shaderName.string());
+				continue;
+			}
 
-		ShaderMetaData meta{};
-		meta.DebugName = shaderName.stem().string();
-		meta.Path = m_FileSystemShadersPath / shaderName;
+			ShaderMetaData meta{};
+			meta.DebugName = shaderName.stem().string();
+			meta.Path = m_FileSystemShadersPath / shaderName;
 
-		std::string sources = Utils::Shader::ReadFile(m_FileSystemShadersPath / shaderName);
-		std::vector<char> cstr(sources.c_str(), sources.c_str() + sources.size() + 1);
-		auto hash = XXH3_128bits((const void*)cstr.data(), cstr.size());
-		meta.ContentHash.Low64 = hash.low64;
-		meta.ContentHash.High64 = hash.high64;
+			std::string sources = Utils::Shader::ReadFile(meta.Path);
+			meta.ContentHash = HashShaderSources(sources);
 
-		meta.Shader = Shader::Create(sources, meta.DebugName);
-		ShaderHandle handle = meta.Shader->GetID();
-		Add(meta.Shader);
-		m_Registry[handle] = meta;
-		m_NameToHandle[meta.DebugName] = handle;
+			shaderSources.push_back(ShaderSource{ meta.DebugName, std::move(sources) });
+			metas.push_back(std::move(meta));
+			metaToHandleIndex.push_back(i);
+		}
 
-		return handle;
+		std::vector<Ref<Shader>> shaders = Shader::Create(shaderSources);
+		for (size_t i = 0; i < metas.size(); i++)
+		{
+			if (!shaders[i])
+				continue;
+
+			ShaderMetaData& meta = metas[i];
+			meta.Shader = shaders[i];
+			ShaderHandle handle = meta.Shader->GetID();
+			Add(meta.Shader);
+			m_NameToHandle[meta.DebugName] = handle;
+			m_Registry[handle] = std::move(meta);
+			handles[metaToHandleIndex[i]] = handle;
+		}
+
+		ReportCompileStatistics(handles);
+		return handles;
 	}
 
 	Ref<Shader> ShaderManager::Get(ShaderHandle handle) const
@@ -105,152 +150,244 @@ namespace Povox {
 		return m_Shaders.at(name);
 	}
 
+	Ref<Shader> ShaderManager::Get(const std::string& name, const ShaderDefines& defines)
+	{
+		if (defines.empty())
+			return Get(name);
+
+		if (m_NameToHandle.find(name) == m_NameToHandle.end())
+		{
+			PX_CORE_WARN("ShaderManager::Get: Shader {} not registered, variants need a shader loaded from file!", name);
+			return nullptr;
+		}
+		ShaderHandle handle = m_NameToHandle.at(name);
+		ShaderMetaData& meta = m_Registry.at(handle);
+
+		const uint64_t definesHash = HashShaderDefines(defines);
+		auto it = meta.Variants.find(definesHash);
+		if (it != meta.Variants.end())
+			return it->second.CurrentState == ShaderVariant::State::Ready ? it->second.Shader : nullptr;
+
+		std::stringstream debugName;
+		debugName << meta.DebugName << "_" << std::hex << definesHash;
+		ShaderVariant& variant = meta.Variants[definesHash];
+		variant.Shader = Shader::CreateDeferred(debugName.str(), defines);
+
+		CompileVariant(handle, definesHash);
+		return nullptr;
+	}
+
 	bool ShaderManager::Contains(const std::string& name) const
 	{
 		return m_Shaders.find(name) != m_Shaders.end();
 	}
 
+	void ShaderManager::ReportCompileStatistics(const std::vector<ShaderHandle>& handles) const
+	{
+		for (ShaderHandle handle : handles)
+		{
+			if (m_Registry.find(handle) == m_Registry.end())
+				continue;
+
+			const ShaderMetaData& meta = m_Registry.at(handle);
+			for (const auto& [stage, stats] : meta.Shader->GetCompileStatistics().Stages)
+			{
+				if (stats.Cached)
+				{
+					PX_CORE_INFO("Shader {0} ({1}): {2} instructions, {3} bytes, cached ({4:.2f}ms)", meta.DebugName, stage, stats.InstructionsAfter, stats.SizeAfter, stats.CompileTimeMs);
+					continue;
+				}
+
+				float reduction = stats.InstructionsBefore > 0 ? 100.0f * (1.0f - static_cast<float>(stats.InstructionsAfter) / static_cast<float>(stats.InstructionsBefore)) : 0.0f;
+				PX_CORE_INFO("Shader {0} ({1}): {2} -> {3} instructions ({4:.1f}% less), {5} -> {6} bytes, compiled in {7:.2f}ms", meta.DebugName, stage,
+					stats.InstructionsBefore, stats.InstructionsAfter, reduction, stats.SizeBefore, stats.SizeAfter, stats.CompileTimeMs);
+			}
+		}
+	}
+
+	void ShaderManager::ReportCompileStatistics() const
+	{
+		std::vector<ShaderHandle> handles;
+		handles.reserve(m_Registry.size());
+		for (const auto& [handle, meta] : m_Registry)
+			handles.push_back(handle);
+		ReportCompileStatistics(handles);
+	}
+
 	void ShaderManager::InitFilewatcher()
 	{
 		m_FileWatcher = CreateScope<filewatch::FileWatch<std::wstring>>(m_FileSystemShadersPath,
 			[this](const std::wstring& changedFile, const filewatch::Event changeType) { OnShaderFileWatchEvent(changedFile, changeType); });
-		m_FileWatcherPending = false;
 	}
 
 	void ShaderManager::OnShaderFileWatchEvent(const std::wstring& changedFile, const filewatch::Event changeType)
 	{
 		std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
-		const std::string fileNameString = converter.to_bytes(changedFile);
-		
-
-		if (m_FileWatcherPending)
+		const std::filesystem::path changedPath = converter.to_bytes(changedFile);
+		if (changedPath.extension().string() != ".glsl")
 			return;
-		m_FileWatcherPending = true;
-
-		std::string name = std::filesystem::path(fileNameString).stem().string();
-		if (m_NameToHandle.find(name) == m_NameToHandle.end())
-		{
-			PX_CORE_WARN("Renamed Shader that was not registered: {}", fileNameString);
-			return;
-		}
-		ShaderHandle handle = m_NameToHandle.at(name);
 
+		// Editors save through temp files and renames, every event that leaves new content behind is treated as a modification.
+		// The watcher keeps running, reloads of the same shader are coalesced in RequestReload
 		switch (changeType)
 		{
 			case filewatch::Event::added:
+			case filewatch::Event::modified:
+			case filewatch::Event::renamed_new:
 			{
-				Application::Get()->AddMainThreadQueueInstruction([this, fileNameString]()
-					{
-						m_FileWatcher.reset();
-
-						PX_CORE_WARN("Added: {}", fileNameString);
-
-						InitFilewatcher();
-					});
+				std::string name = changedPath.stem().string();
+				Application::Get()->AddMainThreadQueueInstruction([this, name]() { RequestReload(name); });
 				break;
 			}
 			case filewatch::Event::removed:
-			{
-				Application::Get()->AddMainThreadQueueInstruction([this, fileNameString]()
-					{
-						m_FileWatcher.reset();
+			case filewatch::Event::renamed_old:
+				break;
+			default:
+				PX_CORE_WARN("FileWatch::EventType unknown!");
+		}
+	}
+
+	void ShaderManager::RequestReload(const std::string& shaderName)
+	{
+		if (m_NameToHandle.find(shaderName) == m_NameToHandle.end())
+		{
+			PX_CORE_WARN("ShaderManager::RequestReload: Shader {} not registered!", shaderName);
+			return;
+		}
+		ShaderHandle handle = m_NameToHandle.at(shaderName);
+		if (m_ReloadsInFlight.find(handle) != m_ReloadsInFlight.end())
+		{
+			m_ReloadsRequested.insert(handle);
+			return;
+		}
+		m_ReloadsInFlight.insert(handle);
 
-						PX_CORE_WARN("Removed: {}", fileNameString);
+		// Variants still compiling are compiled again in FinishVariant if this reload is swapped in before they finish
+		const ShaderMetaData& meta = m_Registry.at(handle);
+		std::vector<std::pair<uint64_t, Ref<Shader>>> variants;
+		for (const auto& [definesHash, variant] : meta.Variants)
+		{
+			if (!variant.CompileInFlight)
+				variants.emplace_back(definesHash, variant.Shader);
+		}
 
-						InitFilewatcher();
-					});
-				break;
-			}
-			case filewatch::Event::renamed_new:
+		Application::Get()->GetThreadPool().Submit([this, handle, path = meta.Path, oldHash = meta.ContentHash, shader = meta.Shader, variants]()
 			{
-				if (name == m_RenamedOldName)
+				std::string sources = Utils::Shader::ReadFile(path);
+				Hash_128Bit newHash = HashShaderSources(sources);
+				bool prepared = !(newHash == oldHash) && shader->PrepareRecompile(sources);
+				std::vector<uint64_t> reloadedVariants;
+				std::vector<uint64_t> failedVariants;
+				if (prepared)
 				{
-					Application::Get()->AddMainThreadQueueInstruction([this, handle]()
-						{
-							m_FileWatcher.reset();
-
-							RecompileShader(handle);
-
-							InitFilewatcher();
-						});
-					m_RenamedOldName = std::string();
+					for (const auto& [definesHash, variant] : variants)
+					{
+						if (variant->PrepareRecompile(sources))
+							reloadedVariants.push_back(definesHash);
+						else
+							failedVariants.push_back(definesHash);
+					}
 				}
-				else
-				{
-					Application::Get()->AddMainThreadQueueInstruction([this, handle, name]()
-						{
-							m_FileWatcher.reset();
 
+				Application::Get()->AddMainThreadQueueInstruction([this, handle, prepared, newHash, reloadedVariants, failedVariants]() { FinishReload(handle, prepared, newHash, reloadedVariants, failedVariants); });
+			});
+	}
 
-							InitFilewatcher();
-						});
-				}
-				break;
-			}
-			case filewatch::Event::renamed_old:
-			{				
-				m_RenamedOldName = name;
-
-				Application::Get()->AddMainThreadQueueInstruction([this]()
-					{
-						m_FileWatcher.reset();
+	void ShaderManager::FinishReload(ShaderHandle handle, bool prepared, Hash_128Bit newHash, const std::vector<uint64_t>& reloadedVariants, const std::vector<uint64_t>& failedVariants)
+	{
+		m_ReloadsInFlight.erase(handle);
+		if (m_Registry.find(handle) == m_Registry.end())
+			return;
 
+		ShaderMetaData& meta = m_Registry.at(handle);
+		if (prepared && meta.Shader->ApplyPendingRecompile())
+		{
+			meta.ContentHash = newHash;
+			meta.SourceGeneration++;
+			PX_CORE_INFO("ShaderManager::FinishReload: Reloaded shader {}!", meta.DebugName);
+			ReportCompileStatistics({ handle });
 
-						InitFilewatcher();
-					});
-				break;
-			}
-			case filewatch::Event::modified:
+			for (auto& [definesHash, variant] : meta.Variants)
 			{
-				Application::Get()->AddMainThreadQueueInstruction([this, handle]()
-					{
-						m_FileWatcher.reset();
+				// Picked up by FinishVariant
+				if (variant.CompileInFlight)
+					continue;
 
-						PX_CORE_WARN("RecompileShader:: Recompiled shader {}!", handle);
-						RecompileShader(handle);
+				// Not retried until the source file changes again, Get stops handing out the outdated binaries
+				if (std::find(failedVariants.begin(), failedVariants.end(), definesHash) != failedVariants.end())
+				{
+					variant.SourceGeneration = meta.SourceGeneration;
+					variant.CurrentState = ShaderVariant::State::Failed;
+					PX_CORE_ERROR("ShaderManager::FinishReload: Failed to compile variant {} of shader {}!", variant.Shader->GetDebugName(), meta.DebugName);
+					continue;
+				}
 
-						InitFilewatcher();
-					});
-				break;
+				// Variants that finished compiling after the reload was submitted were built from the old source
+				if (std::find(reloadedVariants.begin(), reloadedVariants.end(), definesHash) == reloadedVariants.end())
+				{
+					CompileVariant(handle, definesHash);
+					continue;
+				}
+
+				variant.SourceGeneration = meta.SourceGeneration;
+				if (variant.Shader->ApplyPendingRecompile())
+					variant.CurrentState = ShaderVariant::State::Ready;
+				else
+				{
+					variant.CurrentState = ShaderVariant::State::Failed;
+					PX_CORE_ERROR("ShaderManager::FinishReload: Variant {} of shader {} does not fit its previous layout anymore!", variant.Shader->GetDebugName(), meta.DebugName);
+				}
 			}
-			default:
-				PX_CORE_WARN("FileWatch::EventType unknown!");
 		}
-	}
 
+		if (m_ReloadsRequested.erase(handle) > 0)
+			RequestReload(meta.DebugName);
+	}
 
-	void ShaderManager::RecompileShader(const std::filesystem::path& path)
+	void ShaderManager::CompileVariant(ShaderHandle handle, uint64_t definesHash)
 	{
-		if (!Contains(path.filename().string()))
-			PX_CORE_WARN("Shader {} not registered!", path.filename().string());
+		ShaderMetaData& meta = m_Registry.at(handle);
+		ShaderVariant& variant = meta.Variants.at(definesHash);
+		variant.SourceGeneration = meta.SourceGeneration;
+		variant.CompileInFlight = true;
 
-		PX_CORE_WARN("Manipulated shader: {}", path.filename().string().c_str());
+		Application::Get()->GetThreadPool().Submit([this, handle, definesHash, path = meta.Path, shader = variant.Shader]()
+			{
+				bool prepared = shader->PrepareRecompile(Utils::Shader::ReadFile(path));
 
-		RecompileShader(path.filename().string());
+				Application::Get()->AddMainThreadQueueInstruction([this, handle, definesHash, prepared]() { FinishVariant(handle, definesHash, prepared); });
+			});
 	}
-	void ShaderManager::RecompileShader(const std::string& shaderName)
-	{
 
-	}
-	void ShaderManager::RecompileShader(ShaderHandle handle)
+	void ShaderManager::FinishVariant(ShaderHandle handle, uint64_t definesHash, bool prepared)
 	{
 		if (m_Registry.find(handle) == m_Registry.end())
-		{
-			PX_CORE_WARN("RecompileShader:: Shader {} not registered!", handle);
 			return;
-		}
-		
+
 		ShaderMetaData& meta = m_Registry.at(handle);
-		std::string sources = Utils::Shader::ReadFile(meta.Path);
-		std::vector<char> cstr(sources.c_str(), sources.c_str() + sources.size() + 1);
-		auto hash = XXH3_128bits((const void*)cstr.data(), cstr.size());
-		Hash_128Bit newHash{hash.low64, hash.high64};
-		if (meta.ContentHash == newHash)
+		auto it = meta.Variants.find(definesHash);
+		if (it == meta.Variants.end())
 			return;
 
-		// if recompilation succeeded:
-		if(meta.Shader->Recompile(sources))
-			meta.ContentHash = newHash;
+		ShaderVariant& variant = it->second;
+		variant.CompileInFlight = false;
+		if (prepared && variant.Shader->ApplyPendingRecompile())
+		{
+			variant.CurrentState = ShaderVariant::State::Ready;
+			PX_CORE_INFO("ShaderManager::FinishVariant: Compiled variant {} of shader {}!", variant.Shader->GetDebugName(), meta.DebugName);
+		}
+		else
+		{
+			// Not retried until the source file changes, see FinishReload
+			variant.CurrentState = ShaderVariant::State::Failed;
+			PX_CORE_WARN("ShaderManager::FinishVariant: Failed to compile variant {} of shader {}!", variant.Shader->GetDebugName(), meta.DebugName);
+		}
+
+		if (variant.SourceGeneration != meta.SourceGeneration)
+		{
+			PX_CORE_INFO("ShaderManager::FinishVariant: Shader {} was reloaded while variant {} compiled, compiling it again.", meta.DebugName, variant.Shader->GetDebugName());
+			CompileVariant(handle, definesHash);
+		}
 	}
 
 	void ShaderManager::RenameShader(ShaderHandle handle, const std::string& newName)
@@ -18,6 +18,22 @@ namespace Povox {
 		}
 	};
 
+	struct ShaderVariant
+	{
+		enum class State
+		{
+			Compiling = 0,
+			Ready,
+			Failed
+		};
+
+		Ref<Shader> Shader;
+		State CurrentState = State::Compiling;
+		// Source generation of the shader the variant was last compiled from, see ShaderMetaData::SourceGeneration
+		uint64_t SourceGeneration = 0;
+		bool CompileInFlight = false;
+	};
+
 	struct ShaderMetaData
 	{
 		ShaderHandle Handle = 0;
@@ -32,8 +48,12 @@ namespace Povox {
 		//			only needs to linearly (roughly, render graph will come at some point)
 		std::filesystem::path Path;
 		Hash_128Bit ContentHash = { 0, 0 };
+		// Increased with every reload that is swapped in, variants compiled from an older generation are compiled again
+		uint64_t SourceGeneration = 0;
 
 		Ref<Shader> Shader;
+		// Permutations of this shader, keyed by the hash of their defines
+		std::unordered_map<uint64_t, ShaderVariant> Variants;
 	};
 
 	using ShaderRegistry = std::unordered_map<ShaderHandle, ShaderMetaData>;
@@ -51,19 +71,34 @@ namespace Povox {
 
 		Ref<Shader> Load(const std::string& name, const std::string& fileSystemShadersPath);
 		ShaderHandle Load(const std::filesystem::path& fileName);
+		// Compiles all shaders concurrently, handles are in the order of fileNames, 0 for files that failed to load
+		std::vector<ShaderHandle> LoadAll(const std::vector<std::filesystem::path>& fileNames);
 
 		Ref<Shader> Get(const std::string& name) const;
 		Ref<Shader> Get(ShaderHandle handle) const;
+		// Permutation of a loaded shader compiled with defines. Unknown permutations are compiled on the ThreadPool,
+		// nullptr is returned until they are ready, so callers keep using the base shader in the meantime
+		Ref<Shader> Get(const std::string& name, const ShaderDefines& defines);
 
 		bool Contains(const std::string& name) const;
 
+		// Logs instruction counts, binary sizes and compile times of every stage of the given shaders
+		void ReportCompileStatistics(const std::vector<ShaderHandle>& handles) const;
+		void ReportCompileStatistics() const;
+
 
 	private:
 		void InitFilewatcher();
+		// Called on the FileWatch thread, only forwards the changed shader to the main thread
 		void OnShaderFileWatchEvent(const std::wstring& path, const filewatch::Event change_type);
-		void RecompileShader(const std::filesystem::path& path);
-		void RecompileShader(const std::string& shaderName);
-		void RecompileShader(ShaderHandle handle);
+		// Main thread. Compiles the shader on the ThreadPool, at most one reload per shader is in flight, changes in the meantime are picked up afterwards
+		void RequestReload(const std::string& shaderName);
+		// Main thread, between frames. Swaps in the prepared shader, its pipelines are recreated right away
+		void FinishReload(ShaderHandle handle, bool prepared, Hash_128Bit newHash, const std::vector<uint64_t>& reloadedVariants, const std::vector<uint64_t>& failedVariants);
+		// Main thread. Compiles the variant from the current source file on the ThreadPool
+		void CompileVariant(ShaderHandle handle, uint64_t definesHash);
+		// Main thread, between frames. Compiles the variant again if the shader was reloaded in the meantime
+		void FinishVariant(ShaderHandle handle, uint64_t definesHash, bool prepared);
 
 		void RenameShader(ShaderHandle handle, const std::string& newName);
 
@@ -78,7 +113,7 @@ namespace Povox {
 
 
 		Scope<filewatch::FileWatch<std::wstring>> m_FileWatcher;
-		bool m_FileWatcherPending = false;
-		std::string m_RenamedOldName;
+		std::unordered_set<ShaderHandle> m_ReloadsInFlight;
+		std::unordered_set<ShaderHandle> m_ReloadsRequested;
 	};
 }
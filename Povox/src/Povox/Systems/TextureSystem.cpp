@@ -27,10 +27,10 @@ namespace Povox {
 		PX_CORE_INFO("TextureSystem::Init: Initializing...");
 
 		m_SystemState.Config.TexturesPath = "assets/textures/";
-		m_SystemState.RegisteredTextures.reserve(m_SystemState.Config.MaxTextures);
+		m_SystemState.Slots.reserve(m_SystemState.Config.MaxTextures);
+		m_SystemState.NameToHandle.reserve(m_SystemState.Config.MaxTextures);
 
 		CreateDefaultTexture();
-		ResetFixedTextures(); //Also resets active textures
 
 		PX_CORE_INFO("TextureSystem::Init: Initialization complete.");
 	}
@@ -43,15 +43,24 @@ namespace Povox {
 
 		PX_CORE_INFO("TextureSystem::Shutdown: Starting...");
 		
-		ResetFixedTextures();
 		// TODO: Clean all textures upon shutdown by calling destroy texture? Or let smart pointers handle the cleanup -> clear the pixel array(s)
-		for (auto& texture : m_SystemState.RegisteredTextures)
+		for (auto& slot : m_SystemState.Slots)
 		{
-			texture.second->Free();
+			if (!slot.Texture)
+				continue;
+
+			slot.Texture->SetSlotHandle({});
+			if (!slot.Names.empty())
+				slot.Texture->Free();
 		}
-		m_SystemState.RegisteredTextures.clear();
-		std::memset(m_SystemState.ActiveTextures.data(), 0, m_SystemState.ActiveTextures.size());
-		std::memset(m_SystemState.ActiveTexturesCounter.data(), 0, m_SystemState.ActiveTexturesCounter.size());
+		m_SystemState.Slots.clear();
+		m_SystemState.NameToHandle.clear();
+		m_SystemState.RetiredSlots.clear();
+		m_SystemState.PendingWrites.clear();
+		m_SystemState.AnonymousSlots.clear();
+		m_SystemState.FallbackTextures.clear();
+		m_SystemState.SlotsExhausted = false;
+		m_SystemState.DefaultTexture = nullptr;
 
 		PX_CORE_INFO("TextureSystem::Shutdown: Completed.");
 	}
@@ -73,7 +82,7 @@ namespace Povox {
 		{
 			return m_SystemState.DefaultTexture != nullptr ? m_SystemState.DefaultTexture : nullptr;
 		}
-		m_SystemState.RegisteredTextures[name] = texture;
+		m_SystemState.NameToHandle[name] = AssignSlot(texture, name);
 
 		return texture;
 	}
@@ -88,13 +97,56 @@ namespace Povox {
 		{
 			PX_CORE_WARN("TextureSystem::RegisterTexture: Name '{0}' already registered ({1}). Adding '_duplicateName' to the name!", name, RegisteredTexturesContains(texture));
 			const std::string newName = name + "_duplicateName";
-			m_SystemState.RegisteredTextures[newName] = newTexture;
+			m_SystemState.NameToHandle[newName] = AssignSlot(newTexture, newName);
 			return newTexture;
 		}
-		m_SystemState.RegisteredTextures[name] = newTexture;
+		m_SystemState.NameToHandle[name] = AssignSlot(newTexture, name);
 		return newTexture;
 	}
 
+	/**
+	 * Removes the name. Once the texture's last name is gone, its slot is released and the texture freed, registered textures are owned by the system.
+	 * Existing handles become invalid right away, the slot and the texture's memory are only reused once all frames that might still sample them have finished.
+	 */
+	void TextureSystem::UnregisterTexture(const std::string& name)
+	{
+		PX_PROFILE_FUNCTION();
+
+
+		auto it = m_SystemState.NameToHandle.find(name);
+		if (it == m_SystemState.NameToHandle.end())
+		{
+			PX_CORE_WARN("TextureSystem::UnregisterTexture: Texture '{0}' not registered!", name);
+			return;
+		}
+
+		TextureSlotHandle handle = it->second;
+		if (!IsValid(handle))
+		{
+			m_SystemState.NameToHandle.erase(it);
+			return;
+		}
+
+		TextureSlot& slot = m_SystemState.Slots[handle.Slot];
+		if (slot.Texture == m_SystemState.DefaultTexture)
+		{
+			PX_CORE_WARN("TextureSystem::UnregisterTexture: The DefaultTexture can not be unregistered!");
+			return;
+		}
+
+		m_SystemState.NameToHandle.erase(it);
+		slot.Names.erase(std::remove(slot.Names.begin(), slot.Names.end(), name), slot.Names.end());
+		// Still registered under another name
+		if (!slot.Names.empty())
+			return;
+
+		slot.Texture->SetSlotHandle({});
+		slot.Texture->Free();
+		slot.Texture = nullptr;
+		slot.Generation++;
+		m_SystemState.RetiredSlots.emplace_back(handle.Slot, Renderer::GetCurrentFrameNumber());
+	}
+
 	/**
 	 * Gets the texture from the registered textures array of this TextureSystem. Returns nullptr and error message not able to register.
 	 */
@@ -103,12 +155,16 @@ namespace Povox {
 		PX_PROFILE_FUNCTION();
 
 
-		if (RegisteredTexturesContains(name))
-			return m_SystemState.RegisteredTextures[name];
+		if (Ref<Texture> texture = RegisteredTexturesContains(name))
+			return texture;
 
 		PX_CORE_WARN("TextureSystem::GetTexture: Texture '{0}' not found. Returning nullptr!", name);
 		return nullptr;
 	}
+	Ref<Texture> TextureSystem::GetTexture(TextureSlotHandle handle) const
+	{
+		return IsValid(handle) ? m_SystemState.Slots[handle.Slot].Texture : nullptr;
+	}
 	/**
 	 * Gets the texture from the registered textures array of this TextureSystem or tries to Register it using 'name' Returns nullptr and error message not able to register.
 	 */
@@ -124,35 +180,27 @@ namespace Povox {
 		return RegisterTexture(name);
 	}
 
+	bool TextureSystem::IsRegistered(const Ref<Texture>& texture) const
+	{
+		return texture && IsValid(texture->GetSlotHandle()) && !m_SystemState.Slots[texture->GetSlotHandle().Slot].Names.empty();
+	}
+
 	/**
-	 * The texture is not needed to be in the RegisteredTexture Array!
+	 * Returns the stable bindless index of the texture. The texture is not needed to be in the RegisteredTexture Array,
+	 * unregistered textures get a slot assigned on first use and keep it until ReleaseUnreferencedTextures finds the system holding their last Ref.
 	 */
-	const uint32_t TextureSystem::BindTexture(Ref<Texture> texture)
+	const uint32_t TextureSystem::BindTexture(const Ref<Texture>& texture)
 	{
-		PX_PROFILE_FUNCTION();
-
-
 		PX_CORE_ASSERT(texture, "No texture set");
-		for (uint32_t i = 0; i < m_SystemState.NextTextureSlot; i++)
-		{
-			if (*texture.get() == *m_SystemState.ActiveTextures[i].get())
-			{
-				m_SystemState.ActiveTexturesCounter[i]++;
-				return i;
-			}
-		}
-
-		if (m_SystemState.NextTextureSlot + 1 == MAX_TEXTURE_SLOTS)
-		{
-			PX_CORE_WARN("TextureSystem::BindTexture: Max_Texture_Slots reached. Pls draw and reset!");
-			return MAX_TEXTURE_SLOTS + 1;
-		}
+		TextureSlotHandle handle = texture->GetSlotHandle();
+		if (IsValid(handle))
+			return handle.Slot;
 
-		m_SystemState.ActiveTextures[m_SystemState.NextTextureSlot] = texture;
-		m_SystemState.ActiveTexturesCounter[m_SystemState.NextTextureSlot] = 1;
+		// Still no slot to give, the texture keeps drawing with the DefaultTexture
+		if (!m_SystemState.FallbackTextures.empty() && !HasFreeSlot() && m_SystemState.FallbackTextures.count(texture))
+			return m_SystemState.DefaultTexture->GetSlotHandle().Slot;
 
-
-		return m_SystemState.NextTextureSlot++;
+		return AssignSlot(texture, "").Slot;
 	}
 	const uint32_t TextureSystem::BindTexture(const std::string& name)
 	{
@@ -161,104 +209,137 @@ namespace Povox {
 	}
 
 	/**
-	 * When ActiveTextures gets reset, all textures up until this slot dont get touched
-	 * This Binding also overrides the first non-fixed texture currently bound
+	 * Releases the slots of bound but unregistered textures only the system still references, their owners dropped them without unbinding.
+	 * The textures are not freed, the system does not own them. Like unregistered slots, the slots are reused once the frames that might still sample them have finished.
 	 */
-	const uint32_t TextureSystem::BindFixedTexture(Ref<Texture> texture)
+	void TextureSystem::ReleaseUnreferencedTextures()
 	{
 		PX_PROFILE_FUNCTION();
 
 
-		PX_CORE_ASSERT(texture, "No texture set");
-		if(RegisteredTexturesContains(texture).empty())
+		auto& anonymousSlots = m_SystemState.AnonymousSlots;
+		for (size_t i = 0; i < anonymousSlots.size();)
 		{
-			PX_CORE_WARN("Texture {} not registered!", texture);
-		}
-
-		PX_CORE_ASSERT(m_SystemState.NextFixedSlot < m_SystemState.Config.MaxTextureSlots, "No more Textures can be bound into ActiveTextures!");
-		m_SystemState.ActiveTextures[m_SystemState.NextFixedSlot] = texture;
-		m_SystemState.ActiveTexturesCounter[m_SystemState.NextFixedSlot] = 0;
-
-		m_SystemState.NextFixedSlot++;
-		m_SystemState.NextTextureSlot = m_SystemState.NextFixedSlot;
-
-		return m_SystemState.NextFixedSlot - 1;
-	}
-	const uint32_t TextureSystem::BindFixedTexture(const std::string& name)
-	{
-		Ref<Texture> texture = RegisteredTexturesContains(name);
-		return BindFixedTexture(texture);
-	}
-
-
-	/*
-	* This only resets the texture slots that are not persistently bound, but resets all active textures counters to 0
-	*/
-	void TextureSystem::ResetActiveTextures()
-	{
-		PX_PROFILE_FUNCTION();
-
-
-		if (!m_SystemState.DefaultTexture)
-			PX_CORE_WARN("TextureSystem::ResetActiveTextures: No DefaultTexture has been set!");
+			TextureSlot& slot = m_SystemState.Slots[anonymousSlots[i]];
+			bool anonymous = slot.Texture && slot.Names.empty();
+			if (anonymous && slot.Texture.use_count() > 1)
+			{
+				i++;
+				continue;
+			}
 
-		for (uint32_t i = m_SystemState.NextFixedSlot; i < m_SystemState.Config.MaxTextureSlots; i++)
-		{
-			m_SystemState.ActiveTextures[i] = m_SystemState.DefaultTexture;
-			m_SystemState.ActiveTexturesCounter[i] = 0;
+			if (anonymous)
+			{
+				slot.Texture->SetSlotHandle({});
+				slot.Texture = nullptr;
+				slot.Generation++;
+				m_SystemState.RetiredSlots.emplace_back(anonymousSlots[i], Renderer::GetCurrentFrameNumber());
+			}
+			// Released now, or the slot got registered or reused in the meantime
+			anonymousSlots[i] = anonymousSlots.back();
+			anonymousSlots.pop_back();
 		}
-		for (uint32_t i = 0; i < m_SystemState.Config.MaxTextureSlots; i++)
+
+		for (auto it = m_SystemState.FallbackTextures.begin(); it != m_SystemState.FallbackTextures.end();)
 		{
-			m_SystemState.ActiveTexturesCounter[i] = 0;
+			if (it->use_count() == 1)
+				it = m_SystemState.FallbackTextures.erase(it);
+			else
+				it++;
 		}
-		m_SystemState.NextTextureSlot = m_SystemState.NextFixedSlot;
 	}
 
 	/**
-	 * Resets the FixedTextures -> Active Textures also get reset, all pointers get set to 0
+	 * Returns the slots assigned since the last call, their descriptors have to be written before the next draw using them
 	 */
-	void TextureSystem::ResetFixedTextures()
+	std::vector<uint32_t> TextureSystem::ConsumePendingWrites()
 	{
-		m_SystemState.NextFixedSlot = 0;
-		ResetActiveTextures();
+		std::vector<uint32_t> pending;
+		pending.swap(m_SystemState.PendingWrites);
+		return pending;
 	}
 
-	const std::array<Ref<Texture>, MAX_TEXTURE_SLOTS>& TextureSystem::GetActiveTextures()
+	void TextureSystem::CreateDefaultTexture()
 	{
-		PX_PROFILE_FUNCTION();
-
+		m_SystemState.DefaultTexture = RegisterTexture("DefaultPXTexture");
+		PX_CORE_ASSERT(m_SystemState.DefaultTexture, "No Default Texture was set!");
+	}
 
-		for (uint32_t i = m_SystemState.NextTextureSlot; i < MAX_TEXTURE_SLOTS; i++)
+	TextureSlotHandle TextureSystem::AssignSlot(const Ref<Texture>& texture, const std::string& name)
+	{
+		TextureSlotHandle handle = texture->GetSlotHandle();
+		if (IsValid(handle))
 		{
-			m_SystemState.ActiveTextures[i] = m_SystemState.DefaultTexture;
+			// Same texture under another name, the slot keeps its first name for the reverse lookup
+			std::vector<std::string>& names = m_SystemState.Slots[handle.Slot].Names;
+			if (!name.empty() && std::find(names.begin(), names.end(), name) == names.end())
+				names.push_back(name);
+			return handle;
 		}
 
-		return m_SystemState.ActiveTextures;
+		uint32_t slotIndex = UINT32_MAX;
+		if (!m_SystemState.RetiredSlots.empty()
+			&& m_SystemState.RetiredSlots.front().second <= Renderer::GetCompletedFrameNumber())
+		{
+			slotIndex = m_SystemState.RetiredSlots.front().first;
+			m_SystemState.RetiredSlots.pop_front();
+		}
+		else if (m_SystemState.Slots.size() < m_SystemState.Config.MaxTextures)
+		{
+			slotIndex = static_cast<uint32_t>(m_SystemState.Slots.size());
+			m_SystemState.Slots.emplace_back();
+		}
+		else
+		{
+			if (m_SystemState.DefaultTexture)
+				m_SystemState.FallbackTextures.insert(texture);
+			if (!m_SystemState.SlotsExhausted)
+				PX_CORE_WARN("TextureSystem::AssignSlot: MaxTextures ({0}) reached. Textures without a slot use the DefaultTexture instead!", m_SystemState.Config.MaxTextures);
+			m_SystemState.SlotsExhausted = true;
+			return m_SystemState.DefaultTexture ? m_SystemState.DefaultTexture->GetSlotHandle() : TextureSlotHandle{ 0, 0 };
+		}
+		m_SystemState.FallbackTextures.erase(texture);
+		m_SystemState.SlotsExhausted = false;
+
+		TextureSlot& slot = m_SystemState.Slots[slotIndex];
+		slot.Texture = texture;
+		slot.Names.clear();
+		if (!name.empty())
+			slot.Names.push_back(name);
+		else
+			m_SystemState.AnonymousSlots.push_back(slotIndex);
+
+		handle.Slot = slotIndex;
+		handle.Generation = slot.Generation;
+		texture->SetSlotHandle(handle);
+
+		m_SystemState.PendingWrites.push_back(slotIndex);
+		return handle;
 	}
 
-	void TextureSystem::CreateDefaultTexture()
+	bool TextureSystem::HasFreeSlot() const
 	{
-		m_SystemState.DefaultTexture = RegisterTexture("DefaultPXTexture");
-		PX_CORE_ASSERT(m_SystemState.DefaultTexture, "No Default Texture was set!");
+		return m_SystemState.Slots.size() < m_SystemState.Config.MaxTextures
+			|| (!m_SystemState.RetiredSlots.empty() && m_SystemState.RetiredSlots.front().second <= Renderer::GetCompletedFrameNumber());
 	}
 
 	//TODO: maybe return boolean instead and pass in pointers to texture and name
 	Ref<Texture> TextureSystem::RegisteredTexturesContains(const std::string& name)
 	{
-		if (m_SystemState.RegisteredTextures.find(name) == m_SystemState.RegisteredTextures.end())
+		auto it = m_SystemState.NameToHandle.find(name);
+		if (it == m_SystemState.NameToHandle.end())
 			return nullptr;
-		return m_SystemState.RegisteredTextures[name];
+		return GetTexture(it->second);
 	}
 
 	//TODO: maybe return boolean instead and pass in pointers to texture and name
-	const std::string& TextureSystem::RegisteredTexturesContains(Ref<Texture> texture)
+	const std::string& TextureSystem::RegisteredTexturesContains(const Ref<Texture>& texture)
 	{
-		for (auto& entry : m_SystemState.RegisteredTextures)
-		{
-			if (*entry.second.get() == *texture.get())
-				return entry.first;
-		}
-		return std::string();
+		static const std::string s_NotRegistered = "";
+
+		if (!IsRegistered(texture))
+			return s_NotRegistered;
+		return m_SystemState.Slots[texture->GetSlotHandle().Slot].Names.front();
 	}
 
 }
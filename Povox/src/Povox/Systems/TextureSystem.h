@@ -3,31 +3,47 @@
 #include "Povox/Core/Core.h"
 #include "Povox/Renderer/Texture.h"
 
-
+#include <deque>
 
 namespace Povox {
 
-#define MAX_TEXTURE_SLOTS 32
 #define MAX_TEXTURES 1024
 
 	struct TextureSystemConfig
 	{
-		static const uint32_t MaxTextureSlots = MAX_TEXTURE_SLOTS;
 		static const uint32_t MaxTextures = MAX_TEXTURES;
 
 		std::string TexturesPath = "";
 	};
 
+	struct TextureSlot
+	{
+		Ref<Texture> Texture = nullptr;
+		// Every name the texture is registered under, the first one is the reverse lookup. Empty for textures that were bound without being registered
+		std::vector<std::string> Names;
+		uint32_t Generation = 0;
+	};
+
+	/**
+	 * Every texture owns a slot in the slot table while registered, the slot index is the stable index into the bindless texture array.
+	 * Textures bound without being registered keep their slot as long as anything outside the system holds a Ref to them.
+	 * Textures carry their generation tagged handle, so binding and the registered check never search the table.
+	 * Descriptor writes are only needed for newly assigned slots, the renderer consumes them via ConsumePendingWrites.
+	 */
 	struct TextureSystemState
 	{
 		TextureSystemConfig Config{};
 
-		std::array<Ref<Texture>, MAX_TEXTURE_SLOTS> ActiveTextures;
-		std::array<uint32_t, MAX_TEXTURE_SLOTS> ActiveTexturesCounter; // index equal the active textures vector, entry is counter
-		uint32_t NextFixedSlot = 0;
-		uint32_t NextTextureSlot = 0;
-
-		std::unordered_map<std::string, Ref<Texture>> RegisteredTextures;
+		std::vector<TextureSlot> Slots;
+		std::unordered_map<std::string, TextureSlotHandle> NameToHandle;
+		std::deque<std::pair<uint32_t, uint64_t>> RetiredSlots; // Slot and the frame number it got unregistered in, reused once that frame completed
+		std::vector<uint32_t> PendingWrites;
+		// Slots of bound but unregistered textures, checked for textures nothing else references anymore once per frame
+		std::vector<uint32_t> AnonymousSlots;
+		// Textures that got the DefaultTexture's slot because all slots were taken, they retry once a retired slot can be reused
+		std::unordered_set<Ref<Texture>> FallbackTextures;
+		// Latched when MaxTextures is reached so the warning is logged once, cleared once a slot could be assigned again
+		bool SlotsExhausted = false;
 
 		Ref<Texture> DefaultTexture = nullptr;
 	};
@@ -43,27 +59,35 @@ namespace Povox {
 
 		Ref<Texture> RegisterTexture(const std::string& name);
 		Ref<Texture> RegisterTexture(const std::string& name, Ref<Texture> texture);
+		void UnregisterTexture(const std::string& name);
 		Ref<Texture> GetTexture(const std::string& name);
+		Ref<Texture> GetTexture(TextureSlotHandle handle) const;
 		Ref<Texture> GetOrRegisterTexture(const std::string& name);
 
-		const uint32_t BindTexture(Ref<Texture> texture);
-		const uint32_t BindTexture(const std::string& name);
-
-		const uint32_t BindFixedTexture(Ref<Texture> texture);
-		const uint32_t BindFixedTexture(const std::string& name);
+		bool IsRegistered(const Ref<Texture>& texture) const;
 
-		void ResetFixedTextures();
-		void ResetActiveTextures();
+		const uint32_t BindTexture(const Ref<Texture>& texture);
+		const uint32_t BindTexture(const std::string& name);
+		// Called once per frame by the renderer
+		void ReleaseUnreferencedTextures();
 
-		const std::array<Ref<Texture>, MAX_TEXTURE_SLOTS>& GetActiveTextures();
+		inline const Ref<Texture>& GetSlotTexture(uint32_t slot) const { return m_SystemState.Slots[slot].Texture; }
+		inline bool HasPendingWrites() const { return !m_SystemState.PendingWrites.empty(); }
+		std::vector<uint32_t> ConsumePendingWrites();
 
 		inline const TextureSystemState& GetState() const { return m_SystemState; }
 		inline const TextureSystemConfig& GetConfig() const { return m_SystemState.Config; }
 
 	private:
 		void CreateDefaultTexture();
+		TextureSlotHandle AssignSlot(const Ref<Texture>& texture, const std::string& name);
+		bool HasFreeSlot() const;
+		inline bool IsValid(TextureSlotHandle handle) const
+		{
+			return handle.Slot < m_SystemState.Slots.size() && m_SystemState.Slots[handle.Slot].Generation == handle.Generation;
+		}
 		Ref<Texture> RegisteredTexturesContains(const std::string& name);
-		const std::string& RegisteredTexturesContains(Ref<Texture> texture);
+		const std::string& RegisteredTexturesContains(const Ref<Texture>& texture);
 
 	private:
 		TextureSystemState m_SystemState = {};
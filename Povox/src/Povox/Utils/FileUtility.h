@@ -92,6 +92,22 @@ namespace Povox { namespace Utils {
 
 	}
 
+	namespace Pipeline {
+
+		static const char* GetVKCacheDirectory()
+		{
+			return "assets/cache/pipeline/vulkan";
+		}
+
+		static void CreateVKCacheDirectoryIfNeeded()
+		{
+			std::string path = GetVKCacheDirectory();
+			if (!std::filesystem::exists(path))
+				std::filesystem::create_directories(path);
+		}
+
+	}
+
 	static std::string GetFileExtension(const std::string filepath)
 	{
 		std::string extension;
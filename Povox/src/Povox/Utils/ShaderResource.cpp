@@ -65,48 +65,38 @@ namespace Povox {
 	UniformBuffer::UniformBuffer(const BufferLayout& layout, const std::string& name /*= "UniformBufferDefault"*/, bool perFrame /*= true*/)
 		: m_Layout(layout), ShaderResource(ShaderResourceType::UNIFORM_BUFFER, perFrame, name)
 	{
-		BufferSpecification specs{};
-		specs.Usage = BufferUsage::UNIFORM_BUFFER;
-		specs.MemUsage = MemoryUtils::MemoryUsage::GPU_ONLY;
-		specs.Layout = m_Layout;
-		specs.ElementSize = m_Layout.GetStride();
-		specs.Size = Buffer::PadSize(m_Layout.GetStride());
-
-		if (!m_PerFrame)
-		{
-			specs.DebugName = name + "_Single";
-			m_Buffers.push_back(Buffer::Create(specs));
-			return;
-		}
+		// Uniform buffers are small, they all share the backing buffers of the pool
+		Ref<BufferPool> pool = Renderer::GetBufferPool();
+		size_t size = m_Layout.GetStride();
 
-		uint32_t framesPerFlight = Renderer::GetSpecification().MaxFramesInFlight;
-		m_Buffers.resize(framesPerFlight);
-		for (uint32_t i = 0; i < m_Buffers.size(); i++)
+		uint32_t count = m_PerFrame ? Renderer::GetSpecification().MaxFramesInFlight : 1;
+		m_Suballocations.resize(count);
+		for (uint32_t i = 0; i < m_Suballocations.size(); i++)
 		{
-			specs.DebugName = name + "_Frame_" + std::to_string(i);
-			m_Buffers[i] = Buffer::Create(specs);
+			m_Suballocations[i] = pool->Allocate(BufferUsage::UNIFORM_BUFFER, size);
+			PX_CORE_ASSERT(m_Suballocations[i], "Failed to allocate UniformBuffer from the BufferPool!");
 		}
 	}
 
 	void UniformBuffer::SetData(void* data, size_t size)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			m_Buffers[0]->SetData(data, size);
+			m_Suballocations[0]->SetData(data, 0, size);
 		else
 		{
 			uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
-			m_Buffers[frameIndex]->SetData(data, size);
+			m_Suballocations[frameIndex]->SetData(data, 0, size);
 		}
 	}
 
 	void UniformBuffer::Set(void* data, const std::string& name, size_t size)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			m_Buffers[0]->SetData(data, size);
+			m_Suballocations[0]->SetData(data, 0, size);
 		else
 		{
 			uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
@@ -114,84 +104,106 @@ namespace Povox {
 			const BufferElement* element = m_Layout.GetElement(name);
 			uint32_t offset = element->Offset;
 
-			m_Buffers[frameIndex]->SetData(data, offset, size);
+			m_Suballocations[frameIndex]->SetData(data, offset, size);
 		}
 	}
 
 	Ref<Buffer> UniformBuffer::GetBuffer(uint32_t frameIndex /*= 0*/)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		return GetSuballocation(frameIndex)->Buffer;
+	}
+
+	Ref<BufferSuballocation> UniformBuffer::GetSuballocation(uint32_t frameIndex /*= 0*/)
+	{
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			return m_Buffers[0];
+			return m_Suballocations[0];
 
-		PX_CORE_ASSERT(frameIndex < m_Buffers.size(), "FrameIndex is too large!");
-		return m_Buffers[frameIndex];
+		PX_CORE_ASSERT(frameIndex < m_Suballocations.size(), "FrameIndex is too large!");
+		return m_Suballocations[frameIndex];
 	}
 
 //---- Storage Buffer ----
-	StorageBuffer::StorageBuffer(const BufferLayout& layout, size_t elements, const std::string& name /*= "StorageBufferDefault"*/, bool perFrame /*= true*/)
-		: m_Layout(layout), ShaderResource(ShaderResourceType::STORAGE_BUFFER, perFrame, name)
+	StorageBuffer::StorageBuffer(const BufferLayout& layout, size_t elements, const std::string& name /*= "StorageBufferDefault"*/, bool perFrame /*= true*/, MemoryUtils::MemoryUsage memUsage /*= GPU_ONLY*/)
+		: m_Layout(layout), m_MemUsage(memUsage), ShaderResource(ShaderResourceType::STORAGE_BUFFER, perFrame, name)
 	{
-		BufferSpecification specs{};
-		specs.Usage = BufferUsage::STORAGE_BUFFER;
-		specs.MemUsage = MemoryUtils::MemoryUsage::GPU_ONLY;
-		specs.Layout = m_Layout;
-		specs.ElementCount = elements;
-		specs.ElementSize = m_Layout.GetStride();
-		specs.Size = specs.ElementSize * elements;
+		uint32_t count = m_PerFrame ? Renderer::GetSpecification().MaxFramesInFlight : 1;
+		m_Suballocations.resize(count);
+		for (uint32_t i = 0; i < m_Suballocations.size(); i++)
+			m_Suballocations[i] = Allocate(i, elements);
+	}
 
-		if (!m_PerFrame)
+	Ref<BufferSuballocation> StorageBuffer::Allocate(uint32_t frameIndex, size_t elements)
+	{
+		size_t size = m_Layout.GetStride() * elements;
+		if (m_MemUsage == MemoryUtils::MemoryUsage::DIRECT_WRITE)
 		{
-			specs.DebugName = m_Name + "_Single";
-			m_Buffers.push_back(Buffer::Create(specs));
-			return;
+			// Written by the CPU every frame, pooling them would only make the pool's blocks host visible
+			BufferSpecification specs{};
+			specs.Usage = BufferUsage::STORAGE_BUFFER;
+			specs.MemUsage = m_MemUsage;
+			specs.Layout = m_Layout;
+			specs.ElementCount = elements;
+			specs.ElementSize = m_Layout.GetStride();
+			specs.Size = size;
+			specs.DebugName = m_Name + "_Frame" + std::to_string(frameIndex);
+			Ref<BufferSuballocation> suballocation = Buffer::Create(specs)->GetSuballocation(size);
+			PX_CORE_ASSERT(suballocation, "Failed to create StorageBuffer!");
+			return suballocation;
 		}
 
-		uint32_t framesPerFlight = Renderer::GetSpecification().MaxFramesInFlight;
-		m_Buffers.resize(framesPerFlight);
-		for (uint32_t i = 0; i < m_Buffers.size(); i++)
-		{
-			specs.DebugName = m_Name + "_Frame_" + std::to_string(i);
-			m_Buffers[i] = Buffer::Create(specs);
-		}
+		// Large storage buffers end up in a dedicated backing buffer of the pool
+		Ref<BufferSuballocation> suballocation = Renderer::GetBufferPool()->Allocate(BufferUsage::STORAGE_BUFFER, size);
+		PX_CORE_ASSERT(suballocation, "Failed to allocate StorageBuffer from the BufferPool!");
+		return suballocation;
+	}
+
+	void StorageBuffer::Resize(uint32_t frameIndex, size_t elements)
+	{
+		Ref<BufferSuballocation>& suballocation = m_Suballocations[m_PerFrame ? frameIndex : 0];
+
+		// Pooled ranges are retired by the pool, a direct write buffer is owned by this resource alone
+		if (m_MemUsage == MemoryUtils::MemoryUsage::DIRECT_WRITE)
+			suballocation->Buffer->Free();
+		suballocation = Allocate(frameIndex, elements);
 	}
 
 	void StorageBuffer::SetData(void* data, size_t size)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			m_Buffers[0]->SetData(data, size);
+			m_Suballocations[0]->SetData(data, 0, size);
 		else
 		{
 			uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 
-			m_Buffers[frameIndex]->SetData(data, size);
+			m_Suballocations[frameIndex]->SetData(data, 0, size);
 		}
 	}
 
 	void StorageBuffer::SetData(void* data, uint32_t index, size_t size)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			m_Buffers[0]->SetData(data, index, size);
+			m_Suballocations[0]->SetData(data, index, size);
 		else
 		{
 			uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
 
-			m_Buffers[frameIndex]->SetData(data, index, size);
+			m_Suballocations[frameIndex]->SetData(data, index, size);
 		}
 
 	}
 
 	void StorageBuffer::Set(void* data, uint32_t index, const std::string& name, size_t size)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			m_Buffers[0]->SetData(data, index, size);
+			m_Suballocations[0]->SetData(data, index, size);
 		else
 		{
 			uint32_t frameIndex = Renderer::GetCurrentFrameIndex();
@@ -199,24 +211,42 @@ namespace Povox {
 			const BufferElement* element = m_Layout.GetElement(name);
 			uint32_t offset = index * element->Size + element->Offset;
 
-			m_Buffers[frameIndex]->SetData(data, offset, size);
+			m_Suballocations[frameIndex]->SetData(data, offset, size);
 		}
 	}
 
+	void* StorageBuffer::GetMappedData(uint32_t frameIndex /*= 0*/)
+	{
+		Ref<BufferSuballocation> suballocation = GetSuballocation(frameIndex);
+		uint8_t* mapped = (uint8_t*)suballocation->Buffer->GetMappedData();
+		return mapped ? mapped + suballocation->Offset : nullptr;
+	}
+
+	void StorageBuffer::FlushMappedData(uint32_t frameIndex, size_t offset, size_t size)
+	{
+		Ref<BufferSuballocation> suballocation = GetSuballocation(frameIndex);
+		suballocation->Buffer->FlushMappedData(suballocation->Offset + offset, size);
+	}
+
 	Ref<Buffer> StorageBuffer::GetBuffer(uint32_t frameIndex /*= 0*/)
 	{
-		PX_CORE_ASSERT(m_Buffers.size(), "Buffers are unset!");
+		return GetSuballocation(frameIndex)->Buffer;
+	}
+
+	Ref<BufferSuballocation> StorageBuffer::GetSuballocation(uint32_t frameIndex /*= 0*/)
+	{
+		PX_CORE_ASSERT(m_Suballocations.size(), "Suballocations are unset!");
 
 		if (!m_PerFrame)
-			return m_Buffers[0];
+			return m_Suballocations[0];
 
-		PX_CORE_ASSERT(frameIndex < m_Buffers.size(), "FrameIndex is too large!");
-		return m_Buffers[frameIndex];
+		PX_CORE_ASSERT(frameIndex < m_Suballocations.size(), "FrameIndex is too large!");
+		return m_Suballocations[frameIndex];
 	}
 
 
 //---- StorageBuffer Dynamic ----
-	StorageBufferDynamic::StorageBufferDynamic(const BufferLayout& layout, size_t totalSize /*= 1*/, const std::string& name /*= "StorageBufferDynamicDefault"*/, bool perFrame /*= true*/)
+	StorageBufferDynamic::StorageBufferDynamic(const BufferLayout& layout, size_t totalSize /*= 1*/, const std::string& name /*= "StorageBufferDynamicDefault"*/, bool perFrame /*= true*/, bool concurrent /*= false*/)
 		: m_Layout(layout), ShaderResource(ShaderResourceType::STORAGE_BUFFER_DYNAMIC, perFrame, name)
 	{
 		BufferSpecification specs{};
@@ -226,6 +256,7 @@ namespace Povox {
 		specs.ElementCount = 0;
 		specs.ElementSize = layout.GetStride();
 		specs.Size = totalSize;
+		specs.Concurrent = concurrent;
 		specs.DebugName = m_Name + "_Single";
 				
 		m_Buffer = Buffer::Create(specs);
@@ -246,6 +277,9 @@ namespace Povox {
 		}
 
 		m_ContainedDescriptors[name] = DynamicBufferElement{ sub, initialFrame, usage, linkedDescriptorName };
+		// New In/Out pairs start with In pointing at their own range, that is where their data gets uploaded to
+		if (usage == FrameBehaviour::FRAME_SWAP_IN_OUT)
+			m_Swapped = false;
 	}
 
 	const std::vector<uint32_t>& StorageBufferDynamic::GetOffsets(const std::string& name, uint32_t currentFrameIndex) const
@@ -298,7 +332,7 @@ namespace Povox {
 			{
 				const std::string& link = element.LinkedDescriptorName;
 
-				if (currentFrameIndex == 0)
+				if (!m_Swapped)
 					return element.Suballocation->Offset;
 				else
 				{
@@ -334,4 +368,14 @@ namespace Povox {
 		m_ContainedDescriptors.at(name).Suballocation->SetData(data, partialOffset, size);
 	}
 
+	UploadHandle StorageBufferDynamic::SetDescriptorDataAsync(const std::string& name, void* data, size_t size, size_t partialOffset /*= 0*/)
+	{
+		if (m_ContainedDescriptors.find(name) == m_ContainedDescriptors.end())
+		{
+			PX_CORE_ERROR("StorageBufferDynamic::SetDescriptorDataAsync: Descriptor {} not contained!", name);
+			return UploadHandle{};
+		}
+		return m_ContainedDescriptors.at(name).Suballocation->SetDataAsync(data, partialOffset, size);
+	}
+
 }
\ No newline at end of file
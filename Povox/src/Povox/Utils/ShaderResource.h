@@ -179,30 +179,49 @@ namespace Povox {
 		void Set(void* data, const std::string& name, size_t size);
 
 
+		// Backing buffer of the pool, use GetSuballocation for the range of this resource
 		Ref<Buffer> GetBuffer(uint32_t frameIndex = 0);
+		Ref<BufferSuballocation> GetSuballocation(uint32_t frameIndex = 0);
+
+	private:
+		Ref<BufferSuballocation> Allocate(uint32_t frameIndex, size_t elements);
 
 	private:
 		BufferLayout m_Layout;
-		std::vector<Ref<Buffer>> m_Buffers;
+		MemoryUtils::MemoryUsage m_MemUsage;
+		std::vector<Ref<BufferSuballocation>> m_Suballocations;
 	};
 
 
 	class StorageBuffer : public ShaderResource
 	{
 	public:
-		StorageBuffer(const BufferLayout& layout, size_t elements, const std::string& name = "StorageBufferDefault", bool perFrame = true);
+		// MemoryUsage::DIRECT_WRITE gives each frame its own persistently mapped buffer instead of a range of the GPU_ONLY pool
+		StorageBuffer(const BufferLayout& layout, size_t elements, const std::string& name = "StorageBufferDefault", bool perFrame = true, MemoryUtils::MemoryUsage memUsage = MemoryUtils::MemoryUsage::GPU_ONLY);
 		~StorageBuffer() = default;
 
 		void SetData(void* data, size_t size);
 		void SetData(void* data, uint32_t index, size_t size);
 		void Set(void* data, uint32_t index, const std::string& name, size_t size);
 
+		// Start of this resource in the mapped memory of a DIRECT_WRITE storage buffer, nullptr if it can not be written directly
+		void* GetMappedData(uint32_t frameIndex = 0);
+		void FlushMappedData(uint32_t frameIndex, size_t offset, size_t size);
+		// Replaces the range of one frame with room for elements, its contents are lost. The old range stays valid until the current frame completed
+		void Resize(uint32_t frameIndex, size_t elements);
+
 
+		// Backing buffer of the pool, use GetSuballocation for the range of this resource
 		Ref<Buffer> GetBuffer(uint32_t frameIndex = 0);
+		Ref<BufferSuballocation> GetSuballocation(uint32_t frameIndex = 0);
+
+	private:
+		Ref<BufferSuballocation> Allocate(uint32_t frameIndex, size_t elements);
 
 	private:
 		BufferLayout m_Layout;
-		std::vector<Ref<Buffer>> m_Buffers;
+		MemoryUtils::MemoryUsage m_MemUsage;
+		std::vector<Ref<BufferSuballocation>> m_Suballocations;
 	};
 
 
@@ -216,8 +235,8 @@ namespace Povox {
 			// FRAME_ITERATE		- Backing buffer contains enough space for all the data per FRAME_IN_FLIGHT. TotalSize = (BaseSize + Padding) * FRAME_IN_FLIGHT
 			//						  Offsets iterate via frame index. Example: Frame_0 (0) Offset = 0; Frame_1 (1) Offset = 1; Frame_2 (0) Offset = 0.
 			FRAME_ITERATE, 
-			// FRAME_SWAP_IN_OUT	- Backing buffer contains enough space for all the data per FRAME_IN_FLIGHT. TotalSize = (BaseSize + Padding) * FRAME_IN_FLIGHT
-			//						  Offsets swap per frame. Example: Frame_0 In = 0; Out = 1. Frame_1 In = 1; Out = 0.
+			// FRAME_SWAP_IN_OUT	- Descriptor and its linked descriptor point at two ranges of the backing buffer (e.g. particles read and written by one pass).
+			//						  Offsets swap with every SwapInOut. Example: Step_0 In = 0; Out = 1. Step_1 In = 1; Out = 0.
 			FRAME_SWAP_IN_OUT
 		};
 
@@ -235,7 +254,8 @@ namespace Povox {
 		};
 
 	public:
-		StorageBufferDynamic(const BufferLayout& layout, size_t totalSize = 1024, const std::string& name = "StorageBufferDynamicDefault", bool perFrame = true);
+		// Concurrent buffers can be read by one queue while another writes a different descriptor's range, see BufferSpecification::Concurrent
+		StorageBufferDynamic(const BufferLayout& layout, size_t totalSize = 1024, const std::string& name = "StorageBufferDynamicDefault", bool perFrame = true, bool concurrent = false);
 		~StorageBufferDynamic() = default;
 
 		void AddDescriptor(const std::string& name, size_t size, FrameBehaviour usage = FrameBehaviour::STANDARD, uint8_t initialFrame = 0, const std::string& linkedDescriptorName = NULL);
@@ -249,9 +269,14 @@ namespace Povox {
 		 * @param partialOffset The offset, that gets added to the offset of this descriptor within the backing buffer
 		 */
 		void SetDescriptorData(const std::string& name, void* data, size_t size, size_t partialOffset = 0);
+		// Same as SetDescriptorData, but uploads on the transfer queue. The descriptor must not be used before Renderer::IsUploadComplete(handle)
+		UploadHandle SetDescriptorDataAsync(const std::string& name, void* data, size_t size, size_t partialOffset = 0);
 
 		const std::vector<uint32_t>& GetOffsets(const std::string& name, uint32_t currentFrameIndex) const;
 		const uint32_t GetOffset(const std::string& name, uint32_t currentFrameIndex) const;
+		// Swaps the ranges of all FRAME_SWAP_IN_OUT descriptors, once the pass writing Out has been recorded. What it wrote is In from now on
+		inline void SwapInOut() { m_Swapped = !m_Swapped; }
+		inline bool HasDescriptor(const std::string& name) const { return m_ContainedDescriptors.find(name) != m_ContainedDescriptors.end(); }
 
 		Ref<Buffer> GetBuffer(const std::string& descriptorName) { return m_Buffer; }		
 		DynamicBufferElement GetDescriptorInfo(const std::string& name);
@@ -261,6 +286,7 @@ namespace Povox {
 
 		Ref<Buffer> m_Buffer = nullptr;
 		std::unordered_map<std::string, DynamicBufferElement> m_ContainedDescriptors;
+		bool m_Swapped = false;
 	};
 }
 
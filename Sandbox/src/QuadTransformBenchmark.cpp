@@ -0,0 +1,157 @@
+#include "QuadTransformBenchmark.h"
+
+#include "Povox/Core/Time.h"
+
+#include <ImGui/imgui.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <numeric>
+#include <random>
+
+
+namespace Utils {
+
+	static constexpr size_t FloatsPerVertex = sizeof(Povox::QuadVertex) / sizeof(float);
+
+	static double Checksum(const std::vector<Povox::QuadVertex>& vertices)
+	{
+		const float* values = reinterpret_cast<const float*>(vertices.data());
+		return std::accumulate(values, values + vertices.size() * FloatsPerVertex, 0.0);
+	}
+
+	// Returns the index of the first float that differs from the reference by more than the tolerance, or -1.
+	// The SIMD paths approximate sin/cos and skip the matrix, so they are compared relative to the magnitude of the value
+	static int64_t FindMismatch(const std::vector<Povox::QuadVertex>& vertices, const std::vector<Povox::QuadVertex>& reference)
+	{
+		constexpr float epsilon = 1e-5f;
+
+		const float* values = reinterpret_cast<const float*>(vertices.data());
+		const float* expected = reinterpret_cast<const float*>(reference.data());
+		size_t count = reference.size() * FloatsPerVertex;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!(std::abs(values[i] - expected[i]) <= epsilon * std::max(1.0f, std::abs(expected[i]))))
+				return (int64_t)i;
+		}
+		return -1;
+	}
+}
+
+
+QuadTransformBenchmark::QuadTransformBenchmark()
+	: Layer("QuadTransformBenchmark")
+{
+}
+
+void QuadTransformBenchmark::OnAttach()
+{
+	Run();
+}
+
+void QuadTransformBenchmark::OnImGuiRender()
+{
+	ImGui::Begin("Quad Transform Benchmark");
+	ImGui::Text("Best path: %s", Povox::Math::SimdPathToString(Povox::Math::GetSimdPath()));
+	ImGui::DragScalar("Quads", ImGuiDataType_U32, &m_QuadCount, 1000.0f);
+	ImGui::DragScalar("Iterations", ImGuiDataType_U32, &m_Iterations, 1.0f);
+	if (ImGui::Button("Run"))
+		Run();
+
+	for (const auto& result : m_Results)
+	{
+		ImGui::Text("%-16s %8.3f ms  (%.2fx)  checksum %.3f", result.Name.c_str(), result.Milliseconds, m_Results[0].Milliseconds / result.Milliseconds, result.Checksum);
+		if (!result.Matches)
+		{
+			ImGui::SameLine();
+			ImGui::TextColored({ 1.0f, 0.2f, 0.2f, 1.0f }, "MISMATCH");
+		}
+	}
+	ImGui::End();
+}
+
+void QuadTransformBenchmark::Run()
+{
+	m_QuadCount = std::max(m_QuadCount, 1u);
+	m_Iterations = std::max(m_Iterations, 1u);
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> size(0.1f, 4.0f);
+	std::uniform_real_distribution<float> angle(-glm::pi<float>(), glm::pi<float>());
+	std::uniform_real_distribution<float> channel(0.0f, 1.0f);
+
+	std::vector<Povox::Quad2D> quads(m_QuadCount);
+	for (auto& quad : quads)
+	{
+		quad.Position = { position(rng), position(rng), 0.0f };
+		quad.Rotation = angle(rng);
+		quad.Size = { size(rng), size(rng) };
+		quad.Color = { channel(rng), channel(rng), channel(rng), 1.0f };
+	}
+	// Touch the output once up front, the first run would pay for the page faults otherwise
+	std::vector<Povox::QuadVertex> vertices(m_QuadCount * 4);
+
+	m_Results.clear();
+
+	// Per call path, same math as Renderer2D::DrawRotatedQuad used before the batched API
+	{
+		constexpr glm::vec4 quadVertexPositions[4] = { { -0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, -0.5f, 0.0f, 1.0f }, { 0.5f, 0.5f, 0.0f, 1.0f }, { -0.5f, 0.5f, 0.0f, 1.0f } };
+		constexpr glm::vec2 textureCoords[4] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+
+		Povox::Timer timer;
+		for (uint32_t iteration = 0; iteration < m_Iterations; iteration++)
+		{
+			Povox::QuadVertex* vertex = vertices.data();
+			for (const auto& quad : quads)
+			{
+				glm::mat4 transform = glm::translate(glm::mat4(1.0f), quad.Position)
+					* glm::rotate(glm::mat4(1.0f), quad.Rotation, { 0.0f, 0.0f, 1.0f })
+					* glm::scale(glm::mat4(1.0f), { quad.Size.x, quad.Size.y, 1.0f });
+
+				for (uint32_t i = 0; i < 4; i++)
+				{
+					vertex->Position = transform * quadVertexPositions[i];
+					vertex->Color = quad.Color;
+					vertex->TexCoord = textureCoords[i];
+					vertex->TexID = 0.0f;
+					vertex++;
+				}
+			}
+		}
+		m_Results.push_back({ "mat4 per call", timer.ElapsedMilliseconds() / m_Iterations, Utils::Checksum(vertices) });
+	}
+	// Every other path has to produce the same vertices
+	const std::vector<Povox::QuadVertex> reference = vertices;
+
+	Povox::Math::SimdPath best = Povox::Math::GetSimdPath();
+	for (uint32_t path = 0; path <= (uint32_t)best; path++)
+	{
+		Povox::Math::SimdPath simdPath = (Povox::Math::SimdPath)path;
+
+		// Results of the previous path must not be mistaken for this one's
+		std::fill(vertices.begin(), vertices.end(), Povox::QuadVertex{});
+
+		Povox::Timer timer;
+		for (uint32_t iteration = 0; iteration < m_Iterations; iteration++)
+			Povox::Math::TransformQuads2D(quads.data(), quads.size(), 0.0f, vertices.data(), simdPath);
+		Result& result = m_Results.emplace_back(Result{ Povox::Math::SimdPathToString(simdPath), timer.ElapsedMilliseconds() / m_Iterations, Utils::Checksum(vertices) });
+
+		int64_t mismatch = Utils::FindMismatch(vertices, reference);
+		if (mismatch >= 0)
+		{
+			const float* values = reinterpret_cast<const float*>(vertices.data());
+			const float* expected = reinterpret_cast<const float*>(reference.data());
+			PX_ERROR("QuadTransformBenchmark: {0} differs from the mat4 path at vertex {1}, float {2}: {3} instead of {4}!", result.Name,
+				mismatch / Utils::FloatsPerVertex, mismatch % Utils::FloatsPerVertex, values[mismatch], expected[mismatch]);
+			result.Matches = false;
+		}
+	}
+
+	for (const auto& result : m_Results)
+		PX_INFO("QuadTransformBenchmark: {0} quads, {1}: {2} ms, checksum {3}", m_QuadCount, result.Name, result.Milliseconds, result.Checksum);
+	PX_ASSERT(std::all_of(m_Results.begin(), m_Results.end(), [](const Result& result) { return result.Matches; }), "QuadTransformBenchmark: A path differs from the mat4 path!");
+}
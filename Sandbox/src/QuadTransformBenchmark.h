@@ -0,0 +1,31 @@
+#pragma once
+#include <Povox.h>
+
+// Compares the per call mat4 quad path of Renderer2D against the batched Math::TransformQuads2D kernels, CPU only
+class QuadTransformBenchmark : public Povox::Layer
+{
+public:
+	QuadTransformBenchmark();
+	~QuadTransformBenchmark() = default;
+
+	virtual void OnAttach() override;
+	virtual void OnImGuiRender() override;
+
+private:
+	void Run();
+
+private:
+	struct Result
+	{
+		std::string Name;
+		float Milliseconds = 0.0f;
+		// Sum of all written floats, reading the output keeps the compiler from dropping the timed loop
+		double Checksum = 0.0;
+		// Within the tolerance of the mat4 path
+		bool Matches = true;
+	};
+
+	uint32_t m_QuadCount = 60000;
+	uint32_t m_Iterations = 20;
+	std::vector<Result> m_Results;
+};
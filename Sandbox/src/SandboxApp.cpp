@@ -2,6 +2,7 @@
 #include <Povox/Core/EntryPoint.h>
 
 #include "ExampleLayer.h"
+//#include "QuadTransformBenchmark.h"
 //#include "Sandbox2D.h"
 //#include "VoxelExample.h"
 
@@ -14,6 +15,7 @@ public:
 		PushLayer(new ExampleLayer());
 		//PushLayer(new Sandbox2D());
 		//PushLayer(new VoxelExample());
+		//PushLayer(new QuadTransformBenchmark());
 	}
 
 	~Sandbox()